@@ -934,6 +934,63 @@ RcppExport SEXP R_FG_estimate_diameter(SEXP graph, SEXP pdirected)
 	return ret;
 }
 
+RcppExport SEXP R_FG_compute_bfs(SEXP graph, SEXP pstart, SEXP pmode)
+{
+	FG_graph::ptr fg = R_FG_get_graph(graph);
+	vertex_id_t start = REAL(pstart)[0];
+	std::string mode_str = CHAR(STRING_ELT(pmode, 0));
+	edge_type type = edge_type::NONE;
+	if (mode_str == "in")
+		type = edge_type::IN_EDGE;
+	else if (mode_str == "out")
+		type = edge_type::OUT_EDGE;
+	else if (mode_str == "all")
+		type = edge_type::BOTH_EDGES;
+	else {
+		fprintf(stderr, "wrong edge type\n");
+		return R_NilValue;
+	}
+
+	FG_vector<int>::ptr fg_vec = compute_do_bfs(fg, start, type);
+	if (fg_vec == NULL)
+		return R_NilValue;
+	Rcpp::IntegerVector res(fg_vec->get_size());
+	fg_vec->copy_to(res.begin(), fg_vec->get_size());
+	return res;
+}
+
+RcppExport SEXP R_FG_compute_sssp(SEXP graph, SEXP psource, SEXP pmode,
+		SEXP pdelta, SEXP pweight)
+{
+	FG_graph::ptr fg = R_FG_get_graph(graph);
+	vertex_id_t source = REAL(psource)[0];
+	double delta = REAL(pdelta)[0];
+	std::string mode_str = CHAR(STRING_ELT(pmode, 0));
+	std::string weight_type = CHAR(STRING_ELT(pweight, 0));
+	edge_type type = edge_type::NONE;
+	if (mode_str == "in")
+		type = edge_type::IN_EDGE;
+	else if (mode_str == "out")
+		type = edge_type::OUT_EDGE;
+	else if (mode_str == "all")
+		type = edge_type::BOTH_EDGES;
+	else {
+		fprintf(stderr, "wrong edge type\n");
+		return R_NilValue;
+	}
+	// All edges have the weight of 1 if the edge weights aren't used.
+	if (weight_type == "none")
+		weight_type = "";
+
+	FG_vector<double>::ptr fg_vec = compute_sssp(fg, source, type, delta,
+			weight_type);
+	if (fg_vec == NULL)
+		return R_NilValue;
+	Rcpp::NumericVector res(fg_vec->get_size());
+	fg_vec->copy_to(res.begin(), fg_vec->get_size());
+	return res;
+}
+
 template<class MatrixType>
 FG_vector<double>::ptr multiply_v(FG_graph::ptr fg, bool transpose,
 		FG_vector<double>::ptr in_vec)
@@ -22,6 +22,7 @@
 
 #include <limits.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 namespace fg
 {
@@ -30,11 +31,25 @@ namespace fg
   * \brief Basic data types used in FlashGraph
 */
 
+/*
+ * By default, vertex IDs and the number of edges of a vertex are 32 bits.
+ * A graph with more than 4 billion vertices or a vertex with more than
+ * 4 billion edges requires FlashGraph to be compiled with VERTEX_ID_64.
+ * The width of vertex IDs is recorded in the graph header, so a graph
+ * constructed by one build can't be used by a build with a different width.
+ */
+#ifdef VERTEX_ID_64
+typedef uint64_t vsize_t;
+typedef uint64_t vertex_id_t; /** Used to represent vertex IDs in graph */
+const vertex_id_t MAX_VERTEX_ID = UINT64_MAX;
+const size_t MAX_VERTEX_SIZE = LONG_MAX;
+#else
 typedef unsigned int vsize_t; 
 typedef unsigned int vertex_id_t; /** Used to represent vertex IDs in graph */
 const vertex_id_t MAX_VERTEX_ID = UINT_MAX;
-const vertex_id_t INVALID_VERTEX_ID = -1;
 const size_t MAX_VERTEX_SIZE = INT_MAX;
+#endif
+const vertex_id_t INVALID_VERTEX_ID = -1;
 
 }
 
@@ -25,6 +25,7 @@
 #include "vertex.h"
 #include "in_mem_storage.h"
 #include "vertex_index.h"
+#include "ts_graph.h"
 #include "safs_file.h"
 
 using namespace safs;
@@ -63,9 +64,11 @@ FG_graph::ptr FG_graph::create(const std::string &graph_file,
 	in_mem_graph::ptr graph_data;
 	if (graph_conf.use_in_mem_graph() && graph_in_safs)
 		graph_data = in_mem_graph::load_safs_graph(graph_file);
+	// If we can't initialize SAFS, we assume the graph file is
+	// in the local filesystem.
+	else if (!graph_in_safs && graph_conf.use_mmap_graph())
+		graph_data = in_mem_graph::map_graph(graph_file);
 	else if (!graph_in_safs)
-		// If we can't initialize SAFS, we assume the graph file is
-		// in the local filesystem.
 		graph_data = in_mem_graph::load_graph(graph_file);
 
 	vertex_index::ptr index_data;
@@ -89,6 +92,7 @@ FG_graph::FG_graph(const std::string &graph_file, vertex_index::ptr index_data,
 	this->index_data = index_data;
 	this->configs = configs;
 	this->header = index_data->get_graph_header();
+	this->delta_base = 0;
 }
 
 FG_graph::FG_graph(in_mem_graph::ptr graph_data, vertex_index::ptr index_data,
@@ -99,6 +103,7 @@ FG_graph::FG_graph(in_mem_graph::ptr graph_data, vertex_index::ptr index_data,
 	this->configs = configs;
 	graph_file = graph_name;
 	header = index_data->get_graph_header();
+	delta_base = 0;
 }
 
 graph_engine::ptr FG_graph::create_engine(graph_index::ptr index)
@@ -451,6 +456,32 @@ void ts_degree_vertex::run(vertex_program &prog, const page_vertex &vertex)
 FG_vector<vsize_t>::ptr get_ts_degree(FG_graph::ptr fg, edge_type type,
 		time_t start_time, time_t time_interval)
 {
+	// The degrees are computed from the timestamp index without reading
+	// the graph.
+	ts_edge_index::ptr ts_index = load_ts_index(fg->get_graph_header(),
+			start_time, time_interval);
+	if (ts_index && ts_index->has_all_lists()) {
+		size_t num_vertices = ts_index->get_num_vertices();
+		FG_vector<vsize_t>::ptr degree_vec = FG_vector<vsize_t>::create(
+				num_vertices);
+#pragma omp parallel for
+		for (size_t i = 0; i < num_vertices; i++) {
+			vsize_t degree = 0;
+			if (type == edge_type::IN_EDGE || type == edge_type::BOTH_EDGES) {
+				std::pair<vsize_t, vsize_t> range = ts_index->get_edge_range(i,
+						edge_type::IN_EDGE, start_time, time_interval);
+				degree += range.second - range.first;
+			}
+			if (type == edge_type::OUT_EDGE || type == edge_type::BOTH_EDGES) {
+				std::pair<vsize_t, vsize_t> range = ts_index->get_edge_range(i,
+						edge_type::OUT_EDGE, start_time, time_interval);
+				degree += range.second - range.first;
+			}
+			degree_vec->set(i, degree);
+		}
+		return degree_vec;
+	}
+
 	graph_index::ptr index = NUMA_graph_index<ts_degree_vertex>::create(
 			fg->get_graph_header());
 	graph_engine::ptr graph = fg->create_engine(index);
@@ -577,4 +608,46 @@ std::pair<time_t, time_t> get_time_range(FG_graph::ptr fg)
 	return std::pair<time_t, time_t>(start_time, end_time);
 }
 
+/******************* Implementation of compacting a graph *********************/
+
+FG_graph::ptr compact_graph(FG_graph::ptr fg, bool truncate,
+		const std::string &new_graph_file, const std::string &new_index_file)
+{
+	graph_delta::ptr delta = fg->get_delta_store();
+	if (delta == NULL)
+		return fg;
+
+	in_mem_graph::ptr data = fg->get_graph_data();
+	graph_compactor::ptr compactor;
+	// The graph in SAFS is streamed to a new file in SAFS.
+	if (data == NULL) {
+		if (new_graph_file.empty() || new_index_file.empty())
+			throw invalid_arg_exception(
+					"compacting a graph in SAFS needs the new graph and index files");
+		compactor = graph_compactor::create(fg->get_graph_file(), delta,
+				fg->get_delta_base(), new_graph_file, new_index_file);
+	}
+	else
+		compactor = graph_compactor::create(data, delta,
+				fg->get_delta_base(), fg->get_graph_file());
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	compactor->run();
+	gettimeofday(&end, NULL);
+	BOOST_LOG_TRIVIAL(info) << boost::format("compacting the graph takes %1% seconds")
+		% time_diff(start, end);
+
+	FG_graph::ptr ret;
+	if (data == NULL)
+		ret = FG_graph::create(new_graph_file, new_index_file,
+				fg->get_configs());
+	else
+		ret = FG_graph::create(compactor->get_graph(),
+				compactor->get_index(), fg->get_graph_file(), fg->get_configs());
+	ret->set_delta_store(delta, compactor->get_snapshot());
+	if (truncate)
+		delta->truncate(compactor->get_snapshot());
+	return ret;
+}
+
 }
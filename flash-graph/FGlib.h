@@ -24,6 +24,7 @@
 #include "graph.h"
 #include "FG_vector.h"
 #include "graph_file_header.h"
+#include "graph_delta.h"
 
 namespace safs
 {
@@ -47,6 +48,10 @@ class FG_graph
 	std::shared_ptr<in_mem_graph> graph_data;
 	std::shared_ptr<vertex_index> index_data;
 	config_map::ptr configs;
+	// The updates made to the graph after the graph image was created.
+	graph_delta::ptr delta;
+	// The sequence number of the last update in the graph image.
+	uint64_t delta_base;
 
 	// In this case, the graph file is kept in SAFS and the index is read to
 	// memory.
@@ -112,8 +117,38 @@ public:
 
 	std::shared_ptr<vertex_index> get_index_data() const;
 
+	/**
+	 * \brief Get the name of the graph file, or the name of the graph if
+	 *        the graph is stored in memory.
+	 */
+	const std::string &get_graph_file() const {
+		return graph_file;
+	}
+
 	graph_engine::ptr create_engine(graph_index::ptr index);
 
+	/**
+	 * \brief Attach a delta store to the graph. The graph engines created
+	 *        afterwards run on the graph with the updates in the store.
+	 * \param delta The delta store.
+	 * \param base The sequence number of the last update that is already
+	 *        in the graph image.
+	 */
+	void set_delta_store(graph_delta::ptr delta, uint64_t base = 0) {
+		assert(delta == NULL || delta->get_num_vertices()
+				== header.get_num_vertices());
+		this->delta = delta;
+		this->delta_base = base;
+	}
+
+	graph_delta::ptr get_delta_store() const {
+		return delta;
+	}
+
+	uint64_t get_delta_base() const {
+		return delta_base;
+	}
+
 	/**
 	 * \brief Get the header of the graph that contains basic information of the graph.
 	 * \return The graph header.
@@ -169,6 +204,44 @@ FG_vector<vertex_id_t>::ptr compute_wcc(FG_graph::ptr fg);
  */
 FG_vector<vertex_id_t>::ptr compute_sync_wcc(FG_graph::ptr fg);
 
+/**
+ * \brief A list of edges. Each edge is a pair of its source vertex and
+ *        its destination vertex.
+ */
+typedef std::vector<std::pair<vertex_id_t, vertex_id_t> > edge_list_t;
+
+/**
+  * \brief Update the weakly connected components of a graph after edges
+  *        are added to and deleted from the graph. Only the vertices
+  *        in the components that may be split by the deleted edges and
+  *        the endpoints of the added edges are activated.
+  *
+  *        It works on both directed and undirected graphs. The components
+  *        of an undirected graph are the same as computed by `compute_cc'.
+  *
+  * \param fg The FlashGraph graph object that has the updates.
+  * \param prev The components computed by `compute_wcc' on a directed
+  *        graph or by `compute_cc' on an undirected graph before
+  *        the updates.
+  * \param added The edges added to the graph.
+  * \param deleted The edges deleted from the graph.
+  * \return A vector with a component ID for each vertex in the graph.
+  *         It's the same as computed by `compute_wcc' or `compute_cc' on
+  *         the updated graph.
+  */
+FG_vector<vertex_id_t>::ptr compute_incremental_wcc(FG_graph::ptr fg,
+		FG_vector<vertex_id_t>::ptr prev, const edge_list_t &added,
+		const edge_list_t &deleted);
+
+/**
+  * \brief Compute all weakly connectected components of a graph with
+  * the graph engine in the async mode, where there are no level barriers.
+  *
+  * \param fg The FlashGraph graph object for which you want to compute.
+  * \return A vector with a component ID for each vertex in the graph.
+ */
+FG_vector<vertex_id_t>::ptr compute_async_wcc(FG_graph::ptr fg);
+
 /**
  * \brief Compute all weakly connectected components of a time-series graph
  *        in a specified time interval.
@@ -237,6 +310,52 @@ FG_vector<size_t>::ptr compute_local_scan2(FG_graph::ptr fg);
 FG_vector<std::pair<vertex_id_t, size_t> >::ptr compute_topK_scan(
 		FG_graph::ptr, size_t topK);
 
+/**
+ * \brief Breadth-first search from a vertex. Each level of the search
+ *        reads the edges of all vertices in the frontier.
+ *
+ * \param fg The FlashGraph graph object for which you want to compute.
+ * \param start_vertex The vertex where the search starts.
+ * \param traverse_e The type of edges to follow in a directed graph.
+ * \return The number of vertices visited by the search.
+ */
+size_t bfs(FG_graph::ptr fg, vertex_id_t start_vertex, edge_type traverse_e);
+
+/**
+ * \brief Direction-optimizing breadth-first search from a vertex.
+ *        When the frontier is large, a level is searched bottom-up:
+ *        unvisited vertices read their edges in the opposite direction
+ *        until they find a neighbor in the frontier.
+ *
+ * \param fg The FlashGraph graph object for which you want to compute.
+ * \param start_vertex The vertex where the search starts.
+ * \param traverse_e The type of edges to follow in a directed graph.
+ * \return A vector with the BFS level (the distance from the start vertex)
+ *         of each vertex. It is -1 for vertices that can't be reached.
+ */
+FG_vector<int>::ptr compute_do_bfs(FG_graph::ptr fg, vertex_id_t start_vertex,
+		edge_type traverse_e);
+
+/**
+ * \brief Single-source shortest paths with delta-stepping. The vertices
+ *        are processed in buckets of distances of width `delta'.
+ *        A small `delta' does less redundant work and a large `delta'
+ *        has more parallelism.
+ *
+ * \param fg The FlashGraph graph object for which you want to compute.
+ * \param source The vertex where the paths start.
+ * \param traverse_e The type of edges to follow in a directed graph.
+ * \param delta The width of a bucket. It has to be positive.
+ * \param weight_type The type of the edge weights in the edge data:
+ *        "I" (int), "L" (long), "F" (float), "D" (double). The weights
+ *        can't be negative. All edges have the weight of 1 if it's empty.
+ * \return A vector with the distance from the source to each vertex.
+ *         It is infinity for vertices that can't be reached.
+ */
+FG_vector<double>::ptr compute_sssp(FG_graph::ptr fg, vertex_id_t source,
+		edge_type traverse_e, double delta,
+		const std::string &weight_type = "");
+
 /**
   * \brief Compute the diameter estimation for a graph. 
   * \param fg The FlashGraph graph object for which you want to compute.
@@ -277,6 +396,44 @@ FG_vector<float>::ptr compute_pagerank(FG_graph::ptr fg, int num_iters,
 FG_vector<float>::ptr compute_pagerank2(FG_graph::ptr, int num_iters,
 		float damping_factor);
 
+/**
+  * \brief Compute the PageRank of a graph with the push method in
+  *       the async mode of the graph engine. A vertex pushes the change
+  *       of its PageRank as soon as it receives messages, and the computation
+  *       runs until no vertex changes its PageRank by more than the tolerance.
+  *
+  * \param fg The FlashGraph graph object for which you want to compute.
+  * \param damping_factor The damping factor. Originally .85.
+  *
+  * \return A vector with an entry for each vertex in the graph's
+  *         PageRank value.
+  *
+*/
+FG_vector<float>::ptr compute_async_pagerank(FG_graph::ptr fg,
+		float damping_factor);
+
+/**
+  * \brief Update the PageRank of a graph after edges are added to and
+  *       deleted from the graph. It starts from the PageRank computed on
+  *       the graph before the updates. The vertices whose out-edges changed
+  *       take back the PageRank they pushed along the old out-edges and push
+  *       it along the new out-edges, and the changes propagate the same way
+  *       as in `compute_pagerank2'.
+  *
+  * \param fg The FlashGraph graph object that has the updates.
+  * \param prev The PageRank computed by `compute_pagerank2' or
+  *        `compute_async_pagerank' on the graph before the updates.
+  * \param added The edges added to the graph. They weren't in the graph.
+  * \param deleted The edges deleted from the graph. They were in the graph.
+  * \param damping_factor The damping factor used to compute `prev'.
+  *
+  * \return A vector with an entry for each vertex in the graph's
+  *         PageRank value.
+  */
+FG_vector<float>::ptr compute_incremental_pagerank(FG_graph::ptr fg,
+		FG_vector<float>::ptr prev, const edge_list_t &added,
+		const edge_list_t &deleted, float damping_factor);
+
 FG_vector<float>::ptr compute_sstsg(FG_graph::ptr fg, time_t start_time,
 		time_t interval, int num_intervals);
 
@@ -333,6 +490,38 @@ FG_vector<float>::ptr compute_transitivity(FG_graph::ptr fg);
 FG_vector<float>::ptr compute_betweenness_centrality(FG_graph::ptr fg,
 		const std::vector<vertex_id_t>& vids);
 
+/**
+ * \brief Estimate the betweenness and closeness centrality of all vertices
+ *        from the shortest paths of a random sample of source vertices.
+ *        The sources run BFS and back propagation in batches of up to 64,
+ *        so an edge list read from SSDs serves all sources in a batch that
+ *        reach the vertex in the same level.
+ *
+ *        A batch keeps the number of shortest paths and the dependency of
+ *        every vertex for each of its sources in memory, i.e.,
+ *        8 * batch_size bytes per vertex (512 bytes per vertex with
+ *        the default batch size). The batch size is reduced if this doesn't
+ *        fit in the available physical memory.
+ *
+ * \param fg The FlashGraph graph object for which you want to compute.
+ * \param num_samples The number of sampled sources. All vertices are
+ *        sources if it's 0 or larger than the number of vertices with edges,
+ *        which gives the exact centrality.
+ * \param btwn The output vector with the betweenness centrality of each
+ *        vertex, scaled to estimate the centrality from all sources.
+ * \param closeness The output vector with the closeness centrality of each
+ *        vertex, i.e., the inverse of its mean distance from the sources that
+ *        reach it. In a directed graph, it is computed from the paths to
+ *        the vertex.
+ * \param seed The seed for sampling the sources.
+ * \param max_batch_size The max number of sources in a batch, between
+ *        1 and 64. A smaller batch uses less memory, but reads edge lists
+ *        more times.
+ */
+void compute_sampled_centrality(FG_graph::ptr fg, size_t num_samples,
+		FG_vector<float>::ptr &btwn, FG_vector<float>::ptr &closeness,
+		unsigned seed = 0, int max_batch_size = 64);
+
 /**
  * \brief Get the degree of all vertices in a specified time interval in
  *        a time-series graph.
@@ -375,5 +564,27 @@ FG_vector<float>::ptr compute_transitivity(FG_graph::ptr fg);
  * \param levels The number of levels of the hierarchy to do.
  */
 void compute_louvain(FG_graph::ptr fg, const uint32_t levels);
+
+/**
+ * \brief Merge the updates in the delta store of a graph to a new graph
+ *        image. The new image of a graph in memory is kept in memory.
+ *        The new image of a graph in SAFS is streamed to a new SAFS file
+ *        and its index to a file in the local filesystem, so the graph
+ *        doesn't need to fit in memory. Use `graph_compactor' directly to
+ *        compact a graph in the background while the graph is being used.
+ * \param fg The FlashGraph graph object with a delta store.
+ * \param truncate Whether to drop the merged updates from the delta store.
+ *        The old graph object shouldn't be used afterwards if the updates
+ *        are dropped.
+ * \param new_graph_file The SAFS file for the new image of a graph in SAFS.
+ *        It can't exist.
+ * \param new_index_file The file for the index of the new image of a graph
+ *        in SAFS.
+ * \return The graph with the new image. It shares the delta store with
+ *        the old graph.
+ */
+FG_graph::ptr compact_graph(FG_graph::ptr fg, bool truncate = true,
+		const std::string &new_graph_file = "",
+		const std::string &new_index_file = "");
 }
 #endif
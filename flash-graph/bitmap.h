@@ -289,6 +289,25 @@ public:
 		for (size_t i = 0; i < num_longs; i++)
 			new (ptr + i) std::atomic_ulong();
 	}
+
+	/*
+	 * This method collects all bits that have been set to 1 and clears them.
+	 */
+	template<class T>
+	size_t get_reset_set_bits(std::vector<T> &v) {
+		size_t num_longs = ROUNDUP(max_num_bits, NUM_BITS_LONG) / NUM_BITS_LONG;
+		size_t orig_size = v.size();
+		for (size_t i = 0; i < num_longs; i++) {
+			if (ptr[i].load(std::memory_order_relaxed) == 0)
+				continue;
+			unsigned long value = ptr[i].exchange(0, std::memory_order_relaxed);
+			for (int j = 0; j < NUM_BITS_LONG; j++) {
+				if (value & (1UL << j))
+					v.push_back(j + i * NUM_BITS_LONG);
+			}
+		}
+		return v.size() - orig_size;
+	}
 };
 
 #endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#ifdef __x86_64__
+#include <tmmintrin.h>
+#endif
+
+#include "edge_codec.h"
+
+namespace fg
+{
+
+namespace
+{
+
+/*
+ * The tables for decoding a group of four integers with a control byte.
+ */
+class svb_tables
+{
+public:
+	// The shuffle mask that moves the bytes of the four integers
+	// to their 32-bit slots.
+	uint8_t shuffle[256][16] __attribute__((aligned(16)));
+	// The number of data bytes used by the four integers.
+	uint8_t lengths[256];
+
+	svb_tables() {
+		for (int c = 0; c < 256; c++) {
+			int off = 0;
+			for (int i = 0; i < 4; i++) {
+				int len = ((c >> (2 * i)) & 3) + 1;
+				for (int j = 0; j < 4; j++)
+					shuffle[c][i * 4 + j] = j < len ? off + j : 0x80;
+				off += len;
+			}
+			lengths[c] = off;
+		}
+	}
+};
+
+const svb_tables tables;
+
+inline int get_code(uint32_t val)
+{
+	if (val < (1U << 8))
+		return 0;
+	else if (val < (1U << 16))
+		return 1;
+	else if (val < (1U << 24))
+		return 2;
+	else
+		return 3;
+}
+
+const uint8_t *svb_decode_sw(const uint8_t *ctrl, const uint8_t *data,
+		size_t num, uint32_t out[])
+{
+	for (size_t i = 0; i < num; i++) {
+		int len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+		uint32_t val = 0;
+		for (int j = 0; j < len; j++)
+			val |= ((uint32_t) data[j]) << (8 * j);
+		out[i] = val;
+		data += len;
+	}
+	return data;
+}
+
+#ifdef __x86_64__
+__attribute__((target("ssse3")))
+const uint8_t *svb_decode_hw(const uint8_t *ctrl, const uint8_t *data,
+		const uint8_t *end, size_t num, uint32_t out[])
+{
+	size_t i = 0;
+	// We always load 16 bytes for a group, so the last few groups are
+	// decoded one integer at a time to avoid reading beyond the data.
+	for (; i + 4 <= num && data + 16 <= end; i += 4) {
+		uint8_t c = ctrl[i / 4];
+		__m128i in = _mm_loadu_si128((const __m128i *) data);
+		__m128i mask = _mm_load_si128((const __m128i *) tables.shuffle[c]);
+		_mm_storeu_si128((__m128i *) (out + i), _mm_shuffle_epi8(in, mask));
+		data += tables.lengths[c];
+	}
+	return svb_decode_sw(ctrl + i / 4, data, num - i, out + i);
+}
+
+const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+#endif
+
+/*
+ * Decode `num' integers. `ctrl' points to the control byte of the first
+ * integer, which has to be the first one in a group. It returns the location
+ * of the data bytes of the next integer.
+ */
+const uint8_t *svb_decode_block(const uint8_t *ctrl, const uint8_t *data,
+		const uint8_t *end, size_t num, uint32_t out[])
+{
+#ifdef __x86_64__
+	if (has_ssse3)
+		return svb_decode_hw(ctrl, data, end, num, out);
+	else
+#endif
+		return svb_decode_sw(ctrl, data, num, out);
+}
+
+}
+
+size_t svb_max_encoded_size(size_t num)
+{
+	return (num + 3) / 4 + num * sizeof(uint32_t);
+}
+
+size_t svb_encode(const uint32_t in[], size_t num, uint8_t out[])
+{
+	uint8_t *ctrl = out;
+	uint8_t *data = out + (num + 3) / 4;
+	memset(ctrl, 0, (num + 3) / 4);
+	for (size_t i = 0; i < num; i++) {
+		int code = get_code(in[i]);
+		ctrl[i / 4] |= code << (2 * (i % 4));
+		for (int j = 0; j <= code; j++)
+			*data++ = (in[i] >> (8 * j)) & 0xff;
+	}
+	return data - out;
+}
+
+size_t svb_decode(const uint8_t in[], size_t in_size, size_t num,
+		uint32_t out[])
+{
+	const uint8_t *data = in + (num + 3) / 4;
+	assert((size_t) (data - in) <= in_size);
+	return svb_decode_block(in, data, in + in_size, num, out) - in;
+}
+
+size_t max_encoded_neighbors_size(size_t num_edges)
+{
+	return svb_max_encoded_size(num_edges * sizeof(vertex_id_t)
+			/ sizeof(uint32_t));
+}
+
+size_t encode_neighbors(const vertex_id_t neighs[], size_t num_edges,
+		uint8_t buf[], bool &wide)
+{
+	wide = false;
+	for (size_t i = 1; i < num_edges; i++) {
+		assert(neighs[i] >= neighs[i - 1]);
+		if ((uint64_t) (neighs[i] - neighs[i - 1]) > UINT32_MAX)
+			wide = true;
+	}
+	if (num_edges > 0 && (uint64_t) neighs[0] > UINT32_MAX)
+		wide = true;
+
+	std::vector<uint32_t> deltas;
+	deltas.reserve(wide ? num_edges * 2 : num_edges);
+	vertex_id_t prev = 0;
+	for (size_t i = 0; i < num_edges; i++) {
+		uint64_t delta = neighs[i] - prev;
+		deltas.push_back(delta);
+		if (wide)
+			deltas.push_back(delta >> 32);
+		prev = neighs[i];
+	}
+	return svb_encode(deltas.data(), deltas.size(), buf);
+}
+
+void decode_neighbors(const uint8_t buf[], size_t size, size_t num_edges,
+		bool wide, vertex_id_t neighs[])
+{
+	// The deltas are decoded to a small buffer in the L1 cache one block
+	// at a time and the prefix sum turns them into vertex IDs.
+	// A block has to contain whole groups of integers.
+	const size_t BLOCK_SIZE = 256;
+	uint32_t deltas[BLOCK_SIZE];
+
+	size_t num = wide ? num_edges * 2 : num_edges;
+	const uint8_t *data = buf + (num + 3) / 4;
+	const uint8_t *end = buf + size;
+	assert(data <= end || num_edges == 0);
+	vertex_id_t prev = 0;
+	size_t idx = 0;
+	for (size_t i = 0; i < num; i += BLOCK_SIZE) {
+		size_t block_size = std::min(BLOCK_SIZE, num - i);
+		data = svb_decode_block(buf + i / 4, data, end, block_size, deltas);
+		if (wide) {
+			for (size_t j = 0; j < block_size; j += 2) {
+				prev += deltas[j] | (((uint64_t) deltas[j + 1]) << 32);
+				neighs[idx++] = prev;
+			}
+		}
+		else {
+			for (size_t j = 0; j < block_size; j++) {
+				prev += deltas[j];
+				neighs[idx++] = prev;
+			}
+		}
+	}
+	assert(data <= end);
+	assert(idx == num_edges);
+}
+
+}
@@ -0,0 +1,71 @@
+#ifndef __EDGE_CODEC_H__
+#define __EDGE_CODEC_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "FG_basic_types.h"
+
+namespace fg
+{
+
+/*
+ * These functions encode 32-bit integers with StreamVByte.
+ * The encoded data of n integers starts with (n + 3) / 4 control bytes,
+ * followed by the data bytes. Each control byte has 2 bits for each of
+ * the four integers in a group, which indicate the number of bytes
+ * (from 1 to 4) the integer uses in the data bytes. Keeping the control
+ * bytes and the data bytes apart allows us to decode four integers with
+ * a single SSSE3 shuffle.
+ */
+
+size_t svb_max_encoded_size(size_t num);
+/*
+ * It returns the number of bytes in the encoded data.
+ */
+size_t svb_encode(const uint32_t in[], size_t num, uint8_t out[]);
+/*
+ * It returns the number of bytes consumed in the encoded data.
+ * The SSSE3 instructions are used if the CPU supports them.
+ */
+size_t svb_decode(const uint8_t in[], size_t in_size, size_t num,
+		uint32_t out[]);
+
+/*
+ * These functions encode a sorted neighbor list of a vertex.
+ * A neighbor list is delta-encoded first and the deltas are stored with
+ * StreamVByte. When vertex IDs have 64 bits, a list whose deltas don't fit
+ * in 32 bits is wide, and each delta is stored as two 32-bit integers.
+ */
+
+size_t max_encoded_neighbors_size(size_t num_edges);
+/*
+ * It returns the number of bytes in the encoded list and sets `wide'.
+ */
+size_t encode_neighbors(const vertex_id_t neighs[], size_t num_edges,
+		uint8_t buf[], bool &wide);
+void decode_neighbors(const uint8_t buf[], size_t size, size_t num_edges,
+		bool wide, vertex_id_t neighs[]);
+
+}
+
+#endif
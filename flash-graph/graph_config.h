@@ -40,12 +40,17 @@ class graph_config
 	int max_processing_vertices;
 	bool enable_elevator;
 	int part_range_size_log;
+	std::string part_file;
+	std::string ts_index_file;
 	bool _preload;
 	int index_file_weight;
 	bool _in_mem_graph;
+	bool _mmap_graph;
 	int num_vparts;
 	int min_vpart_degree;
 	bool serial_run;
+	bool disable_msg_combiner;
+	int msg_block_size_log;
 	// in pages.
 	int vertex_merge_gap;
 public:
@@ -61,9 +66,13 @@ public:
 		_preload = false;
 		index_file_weight = 10;
 		_in_mem_graph = false;
+		_mmap_graph = false;
 		num_vparts = 1;
 		min_vpart_degree = std::numeric_limits<int>::max();
 		serial_run = false;
+		disable_msg_combiner = false;
+		// A block of 8192 vertices fits in L2 cache for most vertex types.
+		msg_block_size_log = 13;
 		// When the gap is 0, it means two vertices either in the same page
 		// or two adjacent pages.
 		vertex_merge_gap = 0;
@@ -134,6 +143,24 @@ public:
 		return part_range_size_log;
 	}
 
+	/**
+	 * \brief Get the file that maps vertices to the partitions of worker
+	 * threads. If it's empty, vertices are assigned by range partitioning.
+	 * \return the partition file name.
+	 */
+	const std::string &get_part_file() const {
+		return part_file;
+	}
+
+	/**
+	 * \brief Get the timestamp index of a time-series graph. If it's
+	 * empty, the time-series algorithms read the timestamps of edges.
+	 * \return the timestamp index file name.
+	 */
+	const std::string &get_ts_index_file() const {
+		return ts_index_file;
+	}
+
 	/**
 	 * \brief Determine whether to preload the graph data to the page cache.
 	 * \return true if the graph is preloaded; else false.
@@ -162,6 +189,16 @@ public:
 		return _in_mem_graph;
 	}
 
+	/**
+	 * \brief Determine whether to map an in-mem graph from the local
+	 * filesystem directly instead of copying it to memory.
+	 * \return true if the graph file is mmap'ed and accessed without
+	 * memory copy.
+	 */
+	bool use_mmap_graph() const {
+		return _mmap_graph;
+	}
+
 	/**
 	 * \brief Determine whether to run the user code on a vertex in serial.
 	 * \return true if the graph engine runs the user code on a vertex in serial.
@@ -170,6 +207,26 @@ public:
 		return serial_run;
 	}
 
+	/**
+	 * \brief Determine whether to merge the messages sent to the same vertex
+	 * with the combiners of vertex programs.
+	 * \return true if message combiners are used.
+	 */
+	bool use_msg_combiner() const {
+		return !disable_msg_combiner;
+	}
+
+	/**
+	 * \brief Get the log2 of the number of vertices in a block.
+	 * Messages are grouped by the blocks of their destination vertices
+	 * before they are delivered, so the state of vertices is accessed
+	 * one block at a time.
+	 * \return The log2 of the block size.
+	 */
+	int get_msg_block_size_log() const {
+		return msg_block_size_log;
+	}
+
 	/**
 	 * \brief Get the number of vertical partitions.
 	 * \return The number of vertical partitions.
@@ -0,0 +1,741 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include <boost/format.hpp>
+
+#include "log.h"
+#include "comm_exception.h"
+#include "safs_exception.h"
+#include "safs_file.h"
+#include "io_interface.h"
+
+#include "graph_delta.h"
+#include "vertex_program.h"
+#include "vertex_index.h"
+#include "in_mem_storage.h"
+
+using namespace safs;
+
+namespace fg
+{
+
+graph_delta::graph_delta(const graph_header &header): updated(
+		header.get_num_vertices(), 0)
+{
+	if (header.has_edge_data())
+		throw unsupported_exception(
+				"the delta store doesn't support graphs with edge data");
+	if (header.get_graph_type() != graph_type::DIRECTED
+			&& header.get_graph_type() != graph_type::UNDIRECTED)
+		throw unsupported_exception(
+				"the delta store only supports directed and undirected graphs");
+	directed = header.is_directed_graph();
+	num_vertices = header.get_num_vertices();
+	seq = 0;
+	num_updates = 0;
+	pthread_rwlock_init(&seq_lock, NULL);
+	shards = std::unique_ptr<shard[]>(new shard[NUM_SHARDS]);
+	for (int i = 0; i < NUM_SHARDS; i++)
+		pthread_spin_init(&shards[i].lock, PTHREAD_PROCESS_PRIVATE);
+}
+
+graph_delta::~graph_delta()
+{
+	for (int i = 0; i < NUM_SHARDS; i++)
+		pthread_spin_destroy(&shards[i].lock);
+	pthread_rwlock_destroy(&seq_lock);
+}
+
+void graph_delta::add_update(vertex_id_t id, edge_type type, const update &u)
+{
+	shard &s = get_shard(id);
+	pthread_spin_lock(&s.lock);
+	s.logs[id].get(type).push_back(u);
+	pthread_spin_unlock(&s.lock);
+	updated.set(id);
+}
+
+void graph_delta::update_edge(vertex_id_t from, vertex_id_t to, bool deleted)
+{
+	if (from >= num_vertices || to >= num_vertices)
+		throw invalid_arg_exception(boost::str(boost::format(
+						"the edge (%1%, %2%) has a vertex out of range")
+					% from % to));
+
+	pthread_rwlock_rdlock(&seq_lock);
+	update u;
+	u.deleted = deleted;
+	u.seq = __sync_add_and_fetch(&seq, 1);
+	// Both endpoints of an edge get the same sequence number, so they
+	// are always in the same snapshot.
+	u.neigh = to;
+	add_update(from, edge_type::OUT_EDGE, u);
+	u.neigh = from;
+	add_update(to, directed ? edge_type::IN_EDGE : edge_type::OUT_EDGE, u);
+	__sync_add_and_fetch(&num_updates, 1);
+	pthread_rwlock_unlock(&seq_lock);
+}
+
+uint64_t graph_delta::get_snapshot()
+{
+	pthread_rwlock_wrlock(&seq_lock);
+	uint64_t ret = seq;
+	pthread_rwlock_unlock(&seq_lock);
+	return ret;
+}
+
+size_t graph_delta::get_num_updates() const
+{
+	return num_updates;
+}
+
+size_t graph_delta::get_updates(vertex_id_t id, edge_type type, uint64_t base,
+		uint64_t snapshot, std::vector<update> &updates) const
+{
+	if (!directed)
+		type = edge_type::OUT_EDGE;
+	size_t orig_size = updates.size();
+	shard &s = get_shard(id);
+	pthread_spin_lock(&s.lock);
+	auto it = s.logs.find(id);
+	if (it != s.logs.end()) {
+		const std::vector<update> &log = it->second.get(type);
+		for (size_t i = 0; i < log.size(); i++) {
+			if (log[i].seq > base && log[i].seq <= snapshot)
+				updates.push_back(log[i]);
+		}
+	}
+	pthread_spin_unlock(&s.lock);
+	return updates.size() - orig_size;
+}
+
+namespace
+{
+
+/*
+ * The updates on the same neighbor are sorted in the order they were made,
+ * so the last one decides whether the edge exists.
+ */
+struct update_less
+{
+	bool operator()(const graph_delta::update &u1,
+			const graph_delta::update &u2) const {
+		if (u1.neigh != u2.neigh)
+			return u1.neigh < u2.neigh;
+		return u1.seq < u2.seq;
+	}
+};
+
+struct neigh_less
+{
+	bool operator()(const graph_delta::update &u, vertex_id_t id) const {
+		return u.neigh < id;
+	}
+};
+
+}
+
+void graph_delta::merge(const vertex_id_t edges[], size_t num_edges,
+		const std::vector<update> &updates, std::vector<vertex_id_t> &merged)
+{
+	std::vector<update> last(updates);
+	std::sort(last.begin(), last.end(), update_less());
+	size_t num_last = 0;
+	for (size_t i = 0; i < last.size(); i++) {
+		if (i + 1 < last.size() && last[i + 1].neigh == last[i].neigh)
+			continue;
+		last[num_last++] = last[i];
+	}
+	last.resize(num_last);
+
+	// An added neighbor that is already in the list isn't added again.
+	std::vector<bool> exist(last.size());
+	merged.clear();
+	for (size_t i = 0; i < num_edges; i++) {
+		auto it = std::lower_bound(last.begin(), last.end(), edges[i],
+				neigh_less());
+		if (it == last.end() || it->neigh != edges[i])
+			merged.push_back(edges[i]);
+		else if (!it->deleted) {
+			merged.push_back(edges[i]);
+			exist[it - last.begin()] = true;
+		}
+	}
+	for (size_t i = 0; i < last.size(); i++) {
+		if (!last[i].deleted && !exist[i])
+			merged.push_back(last[i].neigh);
+	}
+	std::sort(merged.begin(), merged.end());
+}
+
+namespace
+{
+
+/*
+ * Get the neighbor list of a vertex with the updates applied and
+ * construct the vertex in the byte array.
+ */
+void construct_vertex(const graph_delta &delta, const page_vertex &pg_v,
+		edge_type type, uint64_t base, uint64_t snapshot,
+		decoded_vertex_array &arr)
+{
+	std::vector<vertex_id_t> edges(pg_v.get_num_edges(type));
+	if (!edges.empty())
+		pg_v.read_edges(type, edges.data(), edges.size());
+	std::vector<graph_delta::update> updates;
+	delta.get_updates(pg_v.get_id(), type, base, snapshot, updates);
+	std::vector<vertex_id_t> merged;
+	graph_delta::merge(edges.data(), edges.size(), updates, merged);
+
+	size_t size = ext_mem_undirected_vertex::num_edges2vsize(merged.size(), 0);
+	char *buf = arr.alloc(size, 0);
+	ext_mem_undirected_vertex *v = new (buf) ext_mem_undirected_vertex(
+			pg_v.get_id(), merged.size(), 0);
+	for (size_t i = 0; i < merged.size(); i++)
+		v->set_neighbor(i, merged[i]);
+}
+
+}
+
+void graph_delta::run_on_vertex(vertex_program &prog, compute_vertex &v,
+		const page_vertex &pg_v, uint64_t base, uint64_t snapshot) const
+{
+	if (!pg_v.is_directed()) {
+		decoded_vertex_array arr;
+		construct_vertex(*this, pg_v, edge_type::OUT_EDGE, base, snapshot, arr);
+		page_undirected_vertex merged(arr);
+		prog.run(v, merged);
+		return;
+	}
+
+	// A directed vertex may only have the part of the edges requested.
+	const page_directed_vertex &dv = (const page_directed_vertex &) pg_v;
+	decoded_vertex_array in_arr;
+	decoded_vertex_array out_arr;
+	if (dv.get_in_size() > 0)
+		construct_vertex(*this, pg_v, edge_type::IN_EDGE, base, snapshot,
+				in_arr);
+	if (dv.get_out_size() > 0)
+		construct_vertex(*this, pg_v, edge_type::OUT_EDGE, base, snapshot,
+				out_arr);
+	if (dv.get_in_size() > 0 && dv.get_out_size() > 0) {
+		page_directed_vertex merged(in_arr, out_arr);
+		prog.run(v, merged);
+	}
+	else if (dv.get_in_size() > 0) {
+		page_directed_vertex merged(in_arr, true);
+		prog.run(v, merged);
+	}
+	else {
+		page_directed_vertex merged(out_arr, false);
+		prog.run(v, merged);
+	}
+}
+
+void graph_delta::truncate(uint64_t seq)
+{
+	size_t num_removed = 0;
+	for (int i = 0; i < NUM_SHARDS; i++) {
+		shard &s = shards[i];
+		pthread_spin_lock(&s.lock);
+		for (auto it = s.logs.begin(); it != s.logs.end(); ) {
+			vertex_log &log = it->second;
+			for (int j = 0; j < 2; j++) {
+				std::vector<update> &updates = j == 0
+					? log.in_updates : log.out_updates;
+				size_t num = 0;
+				for (size_t k = 0; k < updates.size(); k++) {
+					if (updates[k].seq > seq)
+						updates[num++] = updates[k];
+				}
+				num_removed += updates.size() - num;
+				updates.resize(num);
+			}
+			if (log.in_updates.empty() && log.out_updates.empty()) {
+				updated.clear(it->first);
+				it = s.logs.erase(it);
+			}
+			else
+				it++;
+		}
+		pthread_spin_unlock(&s.lock);
+	}
+	// Each edge update is logged in both of its endpoints.
+	__sync_fetch_and_sub(&num_updates, num_removed / 2);
+}
+
+graph_compactor::graph_compactor(std::shared_ptr<in_mem_graph> graph,
+		const std::string &graph_file, graph_delta::ptr delta, uint64_t base,
+		const std::string &new_name, const std::string &new_index_file)
+{
+	this->graph = graph;
+	this->graph_file = graph_file;
+	this->delta = delta;
+	this->base = base;
+	this->snapshot = base;
+	this->new_name = new_name;
+	this->new_index_file = new_index_file;
+	running = false;
+}
+
+graph_compactor::~graph_compactor()
+{
+	if (running)
+		wait4complete();
+}
+
+void *graph_compactor::run_compaction(void *arg)
+{
+	graph_compactor *compactor = (graph_compactor *) arg;
+	compactor->compact();
+	return NULL;
+}
+
+void graph_compactor::start()
+{
+	assert(!running);
+	snapshot = delta->get_snapshot();
+	running = true;
+	int ret = pthread_create(&tid, NULL, run_compaction, this);
+	if (ret)
+		ABORT_MSG(boost::format("fail to create a compaction thread: %1%")
+				% strerror(ret));
+}
+
+void graph_compactor::run()
+{
+	snapshot = delta->get_snapshot();
+	compact();
+}
+
+void graph_compactor::wait4complete()
+{
+	if (!running)
+		return;
+	pthread_join(tid, NULL);
+	running = false;
+}
+
+namespace
+{
+
+// The size of the I/O for reading and writing graph images in SAFS.
+const size_t IMAGE_IO_SIZE = 64 * 1024 * 1024;
+
+struct free_deleter
+{
+	void operator()(char *buf) const {
+		free(buf);
+	}
+};
+
+/*
+ * The compactor reads the old image in the order of offsets.
+ */
+class image_reader
+{
+public:
+	virtual ~image_reader() {
+	}
+	virtual size_t get_size() const = 0;
+	virtual void read(char *buf, size_t size, off_t off) = 0;
+};
+
+class mem_image_reader: public image_reader
+{
+	std::shared_ptr<in_mem_graph> graph;
+public:
+	mem_image_reader(std::shared_ptr<in_mem_graph> graph) {
+		this->graph = graph;
+	}
+
+	virtual size_t get_size() const {
+		return graph->get_size();
+	}
+
+	virtual void read(char *buf, size_t size, off_t off) {
+		graph->copy_to(buf, size, off);
+	}
+};
+
+/*
+ * This reads a graph image in SAFS through a window of pages. The window
+ * moves forward as the image is read, so each page is read from SSDs once.
+ */
+class safs_image_reader: public image_reader
+{
+	io_interface::ptr io;
+	size_t file_size;
+	char *win;
+	size_t win_capacity;
+	// The location in the file of the first byte in the window.
+	off_t win_off;
+	size_t win_size;
+public:
+	safs_image_reader(const std::string &file) {
+		file_io_factory::shared_ptr factory = create_io_factory(file,
+				REMOTE_ACCESS);
+		if (factory == NULL)
+			throw io_exception(std::string("can't open ") + file);
+		io = create_io(factory, thread::get_curr_thread());
+		file_size = factory->get_file_size();
+		win = NULL;
+		win_capacity = 0;
+		win_off = 0;
+		win_size = 0;
+	}
+
+	~safs_image_reader() {
+		free(win);
+	}
+
+	virtual size_t get_size() const {
+		return file_size;
+	}
+
+	virtual void read(char *buf, size_t size, off_t off);
+};
+
+void safs_image_reader::read(char *buf, size_t size, off_t off)
+{
+	assert(off + size <= file_size);
+	if (off < win_off || off + size > win_off + win_size) {
+		off_t start = ROUND_PAGE(off);
+		size_t len = std::max(IMAGE_IO_SIZE,
+				(size_t) (ROUNDUP_PAGE(off + size) - start));
+		len = std::min(len, (size_t) (ROUNDUP_PAGE(file_size) - start));
+		if (len > win_capacity) {
+			free(win);
+			win = NULL;
+			if (posix_memalign((void **) &win, PAGE_SIZE, len) != 0)
+				throw oom_exception("can't allocate memory to read a graph image");
+			win_capacity = len;
+		}
+		data_loc_t loc(io->get_file_id(), start);
+		io_request req(win, loc, len, READ);
+		io->access(&req, 1);
+		io->wait4complete(1);
+		win_off = start;
+		win_size = len;
+	}
+	memcpy(buf, win + (off - win_off), size);
+}
+
+/*
+ * The compactor writes the new image sequentially. The space returned by
+ * `append' is valid until the next call.
+ */
+class image_writer
+{
+public:
+	virtual ~image_writer() {
+	}
+	virtual char *append(size_t num_bytes) = 0;
+	virtual size_t get_size() const = 0;
+	/*
+	 * Write the remaining data and the graph header at the beginning of
+	 * the image.
+	 */
+	virtual void finish(const graph_header &header) = 0;
+};
+
+/*
+ * The new graph image grows in memory as it is written.
+ */
+class image_buf: public image_writer
+{
+	char *buf;
+	size_t capacity;
+	size_t size;
+public:
+	image_buf(size_t init_capacity) {
+		capacity = init_capacity;
+		buf = (char *) malloc(capacity);
+		if (buf == NULL)
+			throw oom_exception("can't allocate memory for a graph image");
+		size = 0;
+	}
+
+	~image_buf() {
+		free(buf);
+	}
+
+	virtual char *append(size_t num_bytes) {
+		if (size + num_bytes > capacity) {
+			capacity = std::max(capacity * 2, size + num_bytes);
+			buf = (char *) realloc(buf, capacity);
+			if (buf == NULL)
+				throw oom_exception("can't allocate memory for a graph image");
+		}
+		char *ret = buf + size;
+		size += num_bytes;
+		return ret;
+	}
+
+	virtual size_t get_size() const {
+		return size;
+	}
+
+	virtual void finish(const graph_header &header) {
+		memcpy(buf, &header, graph_header::get_header_size());
+	}
+
+	std::shared_ptr<char> release() {
+		std::shared_ptr<char> ret(buf, free_deleter());
+		buf = NULL;
+		capacity = 0;
+		size = 0;
+		return ret;
+	}
+};
+
+/*
+ * This writes a graph image to a new SAFS file through a buffer.
+ * A SAFS file has a fixed size, so the file is created with the max size
+ * of the image and the image is padded.
+ */
+class safs_image_writer: public image_writer
+{
+	io_interface::ptr io;
+	char *buf;
+	size_t capacity;
+	size_t buf_size;
+	// The location in the file of the first byte in the buffer.
+	off_t buf_off;
+
+	void write(char *data, size_t size, off_t off) {
+		assert(size % PAGE_SIZE == 0 && off % PAGE_SIZE == 0);
+		data_loc_t loc(io->get_file_id(), off);
+		io_request req(data, loc, size, WRITE);
+		io->access(&req, 1);
+		io->wait4complete(1);
+	}
+
+	void alloc_buf(size_t size) {
+		char *new_buf = NULL;
+		if (posix_memalign((void **) &new_buf, PAGE_SIZE, size) != 0)
+			throw oom_exception("can't allocate memory to write a graph image");
+		memcpy(new_buf, buf, buf_size);
+		free(buf);
+		buf = new_buf;
+		capacity = size;
+	}
+public:
+	safs_image_writer(const std::string &file, size_t max_size) {
+		safs_file f(get_sys_RAID_conf(), file);
+		if (f.exist())
+			throw io_exception(boost::str(boost::format(
+							"the graph file %1% exists") % file));
+		if (!f.create_file(ROUNDUP_PAGE(max_size)))
+			throw io_exception(std::string("can't create ") + file);
+		file_io_factory::shared_ptr factory = create_io_factory(file,
+				REMOTE_ACCESS);
+		io = create_io(factory, thread::get_curr_thread());
+		buf = NULL;
+		buf_size = 0;
+		buf_off = 0;
+		alloc_buf(IMAGE_IO_SIZE);
+	}
+
+	~safs_image_writer() {
+		free(buf);
+	}
+
+	virtual char *append(size_t num_bytes) {
+		if (buf_size + num_bytes > capacity) {
+			// Write the full pages in the buffer.
+			size_t num_full = ROUND_PAGE(buf_size);
+			write(buf, num_full, buf_off);
+			memmove(buf, buf + num_full, buf_size - num_full);
+			buf_off += num_full;
+			buf_size -= num_full;
+			// A large vertex may not fit in the buffer.
+			if (buf_size + num_bytes > capacity)
+				alloc_buf(ROUNDUP_PAGE(buf_size + num_bytes));
+		}
+		char *ret = buf + buf_size;
+		buf_size += num_bytes;
+		return ret;
+	}
+
+	virtual size_t get_size() const {
+		return buf_off + buf_size;
+	}
+
+	virtual void finish(const graph_header &header) {
+		size_t size = ROUNDUP_PAGE(buf_size);
+		memset(buf + buf_size, 0, size - buf_size);
+		if (size > 0)
+			write(buf, size, buf_off);
+		buf_off += buf_size;
+		buf_size = 0;
+		// The header takes the whole first page.
+		assert(graph_header::get_header_size() == PAGE_SIZE);
+		memcpy(buf, &header, graph_header::get_header_size());
+		write(buf, PAGE_SIZE, 0);
+	}
+};
+
+}
+
+/*
+ * The image has the graph header followed by the vertices. All vertices
+ * in a directed graph have the in-part stored first and then the out-part.
+ * We walk through the old image in order and write the new image in order.
+ */
+void graph_compactor::compact()
+{
+	std::unique_ptr<image_reader> in;
+	if (graph)
+		in = std::unique_ptr<image_reader>(new mem_image_reader(graph));
+	else
+		in = std::unique_ptr<image_reader>(new safs_image_reader(graph_file));
+	graph_header header;
+	in->read((char *) &header, graph_header::get_header_size(), 0);
+	size_t num_vertices = header.get_num_vertices();
+	assert(num_vertices == delta->get_num_vertices());
+	bool compressed = header.has_compressed_edges();
+	int num_parts = header.is_directed_graph() ? 2 : 1;
+
+	// An update adds at most one neighbor to each of its endpoints.
+	size_t max_added = delta->get_num_updates() * 2 * sizeof(vertex_id_t);
+	std::unique_ptr<image_writer> out;
+	image_buf *mem_out = NULL;
+	if (graph) {
+		mem_out = new image_buf(in->get_size() + max_added);
+		out = std::unique_ptr<image_writer>(mem_out);
+	}
+	else {
+		// Each edge is in two adjacency lists, and vertices in the new
+		// image aren't compressed.
+		size_t max_size = graph_header::get_header_size()
+			+ num_parts * num_vertices * ext_mem_undirected_vertex::get_header_size()
+			+ header.get_num_edges() * 2 * sizeof(vertex_id_t);
+		max_size = std::max(max_size, in->get_size()) + max_added;
+		out = std::unique_ptr<image_writer>(new safs_image_writer(new_name,
+					max_size));
+	}
+	out->append(graph_header::get_header_size());
+
+	std::vector<std::vector<off_t> > offs(num_parts);
+	size_t num_edges = 0;
+	size_t num_rewritten = 0;
+	off_t old_off = graph_header::get_header_size();
+	std::vector<char> vbuf;
+	std::vector<char> decoded_buf;
+	std::vector<graph_delta::update> updates;
+	std::vector<vertex_id_t> merged;
+	for (int part = 0; part < num_parts; part++) {
+		edge_type type = header.is_directed_graph() && part == 0
+			? edge_type::IN_EDGE : edge_type::OUT_EDGE;
+		offs[part].resize(num_vertices + 1);
+		for (vertex_id_t id = 0; id < num_vertices; id++) {
+			ext_mem_undirected_vertex v;
+			in->read((char *) &v, ext_mem_undirected_vertex::get_header_size(),
+					old_off);
+			assert(v.get_id() == id);
+			size_t vsize;
+			if (v.is_compressed()) {
+				ext_mem_compressed_vertex c_v;
+				in->read((char *) &c_v,
+						ext_mem_compressed_vertex::get_header_size(), old_off);
+				vsize = c_v.get_size();
+			}
+			else
+				vsize = v.get_size();
+
+			updates.clear();
+			if (delta->has_delta(id))
+				delta->get_updates(id, type, base, snapshot, updates);
+			offs[part][id] = out->get_size();
+			if (!v.is_compressed() && updates.empty()) {
+				in->read(out->append(vsize), vsize, old_off);
+				old_off += vsize;
+				num_edges += v.get_num_edges();
+				continue;
+			}
+
+			vbuf.resize(vsize);
+			in->read(vbuf.data(), vsize, old_off);
+			const ext_mem_undirected_vertex *orig
+				= (const ext_mem_undirected_vertex *) vbuf.data();
+			if (v.is_compressed()) {
+				const ext_mem_compressed_vertex *c_v
+					= (const ext_mem_compressed_vertex *) vbuf.data();
+				decoded_buf.resize(c_v->get_decoded_size());
+				c_v->decode(decoded_buf.data(), decoded_buf.size());
+				orig = (const ext_mem_undirected_vertex *) decoded_buf.data();
+			}
+			const vertex_id_t *edges = (const vertex_id_t *) (((const char *) orig)
+					+ ext_mem_undirected_vertex::get_header_size());
+			if (updates.empty())
+				merged.assign(edges, edges + orig->get_num_edges());
+			else {
+				graph_delta::merge(edges, orig->get_num_edges(), updates,
+						merged);
+				num_rewritten++;
+			}
+			size_t new_size = ext_mem_undirected_vertex::num_edges2vsize(
+					merged.size(), 0);
+			ext_mem_undirected_vertex *new_v = new (out->append(new_size))
+				ext_mem_undirected_vertex(id, merged.size(), 0);
+			for (size_t i = 0; i < merged.size(); i++)
+				new_v->set_neighbor(i, merged[i]);
+			num_edges += merged.size();
+			old_off += vsize;
+		}
+		offs[part][num_vertices] = out->get_size();
+	}
+	// The graph file may be padded.
+	assert((size_t) old_off <= in->get_size());
+
+	// Each edge is in the lists of both of its endpoints.
+	num_edges /= 2;
+	graph_header new_header(header.get_graph_type(), num_vertices, num_edges, 0);
+	size_t new_size = out->get_size();
+	out->finish(new_header);
+
+	if (header.is_directed_graph()) {
+		std::vector<directed_vertex_entry> entries(num_vertices + 1);
+		for (size_t i = 0; i <= num_vertices; i++)
+			entries[i] = directed_vertex_entry(offs[0][i], offs[1][i]);
+		new_index = directed_vertex_index::create(new_header, entries);
+	}
+	else {
+		std::vector<vertex_offset> entries(num_vertices + 1);
+		for (size_t i = 0; i <= num_vertices; i++)
+			entries[i] = vertex_offset(offs[0][i]);
+		new_index = undirected_vertex_index::create(new_header, entries);
+	}
+	if (mem_out)
+		new_graph = in_mem_graph::create(new_name, mem_out->release(), new_size);
+	else
+		new_index->dump(new_index_file);
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("compact %1% updates to %2%: rewrite %3% adjacency lists, %4% -> %5% bytes%6%")
+		% (snapshot - base) % new_name % num_rewritten
+		% in->get_size() % new_size
+		% (compressed ? " (decompressed)" : "");
+}
+
+}
@@ -0,0 +1,296 @@
+#ifndef __GRAPH_DELTA_H__
+#define __GRAPH_DELTA_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "vertex.h"
+#include "bitmap.h"
+#include "graph_file_header.h"
+
+namespace fg
+{
+
+class compute_vertex;
+class vertex_program;
+class in_mem_graph;
+class vertex_index;
+
+/**
+ * \brief The delta store keeps the edges added to and deleted from a graph
+ * after its image was created.
+ *
+ * The updates of a vertex are appended to a log in memory and each update
+ * gets a sequence number. When a graph engine runs on a graph with a delta
+ * store, the log of a vertex is merged with the adjacency list read from
+ * the graph image before a vertex program gets the vertex, so algorithms
+ * run on the updated graph without rebuilding it. An engine sees
+ * the updates made before it starts; the updates made during a run are
+ * seen in the next run. `graph_compactor' merges the logs to a new graph
+ * image, so the logs don't grow forever.
+ *
+ * An edge is either in the graph or not: adding an existing edge doesn't
+ * duplicate it and deleting an edge removes all of its copies. The store
+ * doesn't support graphs with edge data and it can't add vertices.
+ * The number of edges in the vertex index and in the vertex headers doesn't
+ * include the updates until they are compacted.
+ */
+class graph_delta
+{
+public:
+	struct update
+	{
+		vertex_id_t neigh;
+		bool deleted;
+		uint64_t seq;
+	};
+private:
+	struct vertex_log
+	{
+		std::vector<update> in_updates;
+		// The updates of an undirected vertex are kept here.
+		std::vector<update> out_updates;
+
+		std::vector<update> &get(edge_type type) {
+			return type == edge_type::IN_EDGE ? in_updates : out_updates;
+		}
+	};
+
+	struct shard
+	{
+		pthread_spinlock_t lock;
+		std::unordered_map<vertex_id_t, vertex_log> logs;
+	};
+	static const int NUM_SHARDS = 64;
+
+	bool directed;
+	size_t num_vertices;
+	uint64_t seq;
+	size_t num_updates;
+	// Updates hold the read lock while they get a sequence number and
+	// append to the logs. A snapshot holds the write lock, so all updates
+	// before the snapshot are in the logs.
+	pthread_rwlock_t seq_lock;
+	std::unique_ptr<shard[]> shards;
+	// The vertices with logs. It's checked before the logs are searched.
+	thread_safe_bitmap updated;
+
+	graph_delta(const graph_header &header);
+
+	shard &get_shard(vertex_id_t id) const {
+		return shards[id % NUM_SHARDS];
+	}
+	void add_update(vertex_id_t id, edge_type type, const update &u);
+	void update_edge(vertex_id_t from, vertex_id_t to, bool deleted);
+public:
+	typedef std::shared_ptr<graph_delta> ptr;
+
+	static ptr create(const graph_header &header) {
+		return ptr(new graph_delta(header));
+	}
+
+	~graph_delta();
+
+	bool is_directed() const {
+		return directed;
+	}
+
+	size_t get_num_vertices() const {
+		return num_vertices;
+	}
+
+	/**
+	 * \brief Add an edge. The edge is added to both of its endpoints.
+	 */
+	void add_edge(vertex_id_t from, vertex_id_t to) {
+		update_edge(from, to, false);
+	}
+
+	/**
+	 * \brief Delete an edge from both of its endpoints.
+	 */
+	void delete_edge(vertex_id_t from, vertex_id_t to) {
+		update_edge(from, to, true);
+	}
+
+	/**
+	 * \brief Get the sequence number of the last update in the store.
+	 * All updates up to it are in the logs.
+	 */
+	uint64_t get_snapshot();
+
+	/**
+	 * \brief The number of updates kept in the logs.
+	 */
+	size_t get_num_updates() const;
+
+	/**
+	 * \brief Whether a vertex may have updates. It's a quick check and
+	 * the updates may not be in the range a reader is interested in.
+	 */
+	bool has_delta(vertex_id_t id) const {
+		return updated.get(id);
+	}
+
+	/**
+	 * \brief Get the updates of a vertex whose sequence numbers are
+	 * in (base, snapshot], in the order they were made.
+	 * The edge type is ignored in an undirected graph.
+	 */
+	size_t get_updates(vertex_id_t id, edge_type type, uint64_t base,
+			uint64_t snapshot, std::vector<update> &updates) const;
+
+	/**
+	 * \brief Apply updates to the neighbor list of a vertex.
+	 * The merged neighbor list is sorted.
+	 */
+	static void merge(const vertex_id_t edges[], size_t num_edges,
+			const std::vector<update> &updates, std::vector<vertex_id_t> &merged);
+
+	/**
+	 * \brief Run a vertex program on the adjacency list of a vertex with
+	 * the updates in (base, snapshot] applied.
+	 */
+	void run_on_vertex(vertex_program &prog, compute_vertex &v,
+			const page_vertex &pg_v, uint64_t base, uint64_t snapshot) const;
+
+	/**
+	 * \brief Drop the updates whose sequence numbers are no larger than
+	 * `seq'. This is called after the updates are compacted to a graph
+	 * image and no engine runs on the old image.
+	 */
+	void truncate(uint64_t seq);
+};
+
+/**
+ * \brief This merges the updates in a delta store to a graph image in
+ * a background thread.
+ *
+ * The new image contains the updates up to the snapshot taken when
+ * the compaction starts. The old image is read and the new image is
+ * written sequentially. The vertices without updates are copied from
+ * the old image and only the adjacency lists of the updated vertices are
+ * rewritten. Vertices in the new image aren't compressed, and the index
+ * of the new image is constructed along the way.
+ * The old image can still be used during compaction, and the store keeps
+ * receiving updates.
+ *
+ * The new image of a graph in memory is kept in memory. The new image of
+ * a graph in SAFS is streamed to a new SAFS file and its index is written
+ * to a file in the local filesystem, so neither image has to fit in memory.
+ */
+class graph_compactor
+{
+	// The old image is either in memory or in a SAFS file.
+	std::shared_ptr<in_mem_graph> graph;
+	std::string graph_file;
+	graph_delta::ptr delta;
+	uint64_t base;
+	uint64_t snapshot;
+
+	std::shared_ptr<in_mem_graph> new_graph;
+	std::shared_ptr<vertex_index> new_index;
+	std::string new_name;
+	std::string new_index_file;
+
+	pthread_t tid;
+	bool running;
+
+	graph_compactor(std::shared_ptr<in_mem_graph> graph,
+			const std::string &graph_file, graph_delta::ptr delta,
+			uint64_t base, const std::string &new_name,
+			const std::string &new_index_file);
+	static void *run_compaction(void *arg);
+	void compact();
+public:
+	typedef std::shared_ptr<graph_compactor> ptr;
+
+	/**
+	 * \brief Create a compactor for a graph image in memory.
+	 * \param graph The old graph image.
+	 * \param delta The delta store of the graph.
+	 * \param base The sequence number of the last update in the old image.
+	 * \param new_name The name of the new graph image.
+	 */
+	static ptr create(std::shared_ptr<in_mem_graph> graph,
+			graph_delta::ptr delta, uint64_t base,
+			const std::string &new_name) {
+		return ptr(new graph_compactor(graph, "", delta, base, new_name, ""));
+	}
+
+	/**
+	 * \brief Create a compactor for a graph image in SAFS.
+	 * \param graph_file The SAFS file of the old graph image.
+	 * \param delta The delta store of the graph.
+	 * \param base The sequence number of the last update in the old image.
+	 * \param new_name The SAFS file of the new graph image. It can't exist.
+	 * \param new_index_file The file in the local filesystem for the index
+	 *        of the new image.
+	 */
+	static ptr create(const std::string &graph_file, graph_delta::ptr delta,
+			uint64_t base, const std::string &new_name,
+			const std::string &new_index_file) {
+		return ptr(new graph_compactor(std::shared_ptr<in_mem_graph>(),
+					graph_file, delta, base, new_name, new_index_file));
+	}
+
+	~graph_compactor();
+
+	/**
+	 * \brief Take a snapshot of the delta store and start compaction in
+	 * a background thread.
+	 */
+	void start();
+
+	/**
+	 * \brief Compact the graph in the current thread.
+	 */
+	void run();
+
+	void wait4complete();
+
+	/**
+	 * \brief The sequence number of the last update in the new image.
+	 */
+	uint64_t get_snapshot() const {
+		return snapshot;
+	}
+
+	/**
+	 * \brief The new image if the old image is in memory.
+	 */
+	std::shared_ptr<in_mem_graph> get_graph() const {
+		return new_graph;
+	}
+
+	std::shared_ptr<vertex_index> get_index() const {
+		return new_index;
+	}
+};
+
+}
+
+#endif
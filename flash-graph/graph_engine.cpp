@@ -17,6 +17,8 @@
  * limitations under the License.
  */
 
+#include <sched.h>
+
 #include <algorithm>
 
 #include "io_interface.h"
@@ -27,11 +29,13 @@
 #include "graph_engine.h"
 #include "messaging.h"
 #include "worker_thread.h"
+#include "message_processor.h"
 #include "vertex_compute.h"
 #include "vertex_request.h"
 #include "vertex_index_reader.h"
 #include "in_mem_storage.h"
 #include "FGlib.h"
+#include "graph_exception.h"
 
 using namespace safs;
 
@@ -383,13 +387,16 @@ bool vpart_index_compute::run(vertex_id_t start_vid, index_iterator &it)
 	vertex_id_t vid = start_vid;
 	while (it.has_next()) {
 		if (graph.is_directed()) {
-			vsize_t num_edges = graph.cal_num_edges(it.get_curr_size())
-				+ graph.cal_num_edges(it.get_curr_out_size());
+			vsize_t num_edges = graph.cal_num_edges(vid, edge_type::IN_EDGE,
+					it.get_curr_size())
+				+ graph.cal_num_edges(vid, edge_type::OUT_EDGE,
+						it.get_curr_out_size());
 			if (num_edges >= (vsize_t) graph_conf.get_min_vpart_degree())
 				large_degree_ids->push_back(vid);
 		}
 		else {
-			vsize_t num_edges = graph.cal_num_edges(it.get_curr_size());
+			vsize_t num_edges = graph.cal_num_edges(vid, edge_type::IN_EDGE,
+					it.get_curr_size());
 			if (num_edges >= (vsize_t) graph_conf.get_min_vpart_degree())
 				large_degree_ids->push_back(vid);
 		}
@@ -544,11 +551,19 @@ void graph_engine::init(graph_index::ptr index)
 	int num_threads = graph_conf.get_num_threads();
 	this->num_nodes = params.get_num_nodes();
 
+	// Local vertex IDs are 32 bits, so a partition can't have more
+	// vertices than a local ID can address.
+	if (header.get_num_vertices() / num_threads >= MAX_LOCAL_ID)
+		throw conf_exception(boost::str(boost::format(
+						"%1% threads are too few for %2% vertices")
+					% num_threads % header.get_num_vertices()));
+
 	// Construct the vertex states.
 	index->init(num_threads, num_nodes);
 
 	max_processing_vertices = graph_conf.get_max_processing_vertices();
 	is_complete = false;
+	async = false;
 	this->vertices = index;
 
 	pthread_mutex_init(&lock, NULL);
@@ -600,6 +615,9 @@ graph_engine::graph_engine(FG_graph &graph, graph_index::ptr index)
 
 	header = graph.get_graph_header();
 	header.verify();
+	delta = graph.get_delta_store();
+	delta_base = graph.get_delta_base();
+	delta_snapshot = delta_base;
 	out_part_off = 0;
 	if (header.is_directed_graph()) {
 		assert(sizeof(vertex_index) == sizeof(header));
@@ -630,6 +648,9 @@ static inline int get_node_id(int thread_idx, int num_nodes)
 
 void graph_engine::init_threads(vertex_program_creater::ptr creater)
 {
+	// The engine doesn't see the updates made to the graph during the run.
+	if (delta)
+		delta_snapshot = delta->get_snapshot();
 	std::vector<std::shared_ptr<slab_allocator> > msg_allocs(num_nodes);
 	std::vector<std::shared_ptr<slab_allocator> > flush_msg_allocs(num_nodes);
 	// It turns out that it's important to respect the NUMA effect here.
@@ -676,6 +697,9 @@ void graph_engine::start(const vertex_id_t ids[], int num,
 		vertex_initializer::ptr init, vertex_program_creater::ptr creater)
 {
 	level = 0; // We always reset the level
+	num_active_threads = atomic_integer(get_num_threads());
+	async_epoch = atomic_number<long>(0);
+	is_complete = false;
 	gettimeofday(&start_time, NULL);
 	init_threads(std::move(creater));
 	int num_threads = get_num_threads();
@@ -697,6 +721,9 @@ void graph_engine::start(std::shared_ptr<vertex_filter> filter,
 		vertex_program_creater::ptr creater)
 {
 	level = 0; // We always reset the level
+	num_active_threads = atomic_integer(get_num_threads());
+	async_epoch = atomic_number<long>(0);
+	is_complete = false;
 	gettimeofday(&start_time, NULL);
 	init_threads(std::move(creater));
 	// Let's assume all vertices will be activated first.
@@ -711,6 +738,9 @@ void graph_engine::start_all(vertex_initializer::ptr init,
 		vertex_program_creater::ptr creater)
 {
 	level = 0; // We always reset the level
+	num_active_threads = atomic_integer(get_num_threads());
+	async_epoch = atomic_number<long>(0);
+	is_complete = false;
 	gettimeofday(&start_time, NULL);
 	init_threads(std::move(creater));
 	BOOST_FOREACH(worker_thread *t, worker_threads) {
@@ -754,6 +784,14 @@ bool graph_engine::progress_next_level()
 {
 	static atomic_number<long> tot_num_activates;
 	static atomic_integer num_threads;
+	// The longest tail among threads in microseconds.
+	static atomic_number<long> max_tail_time;
+	// The messages received and delivered to vertices in the level.
+	static atomic_number<size_t> tot_recv_msgs;
+	static atomic_number<size_t> tot_recv_bytes;
+	static atomic_number<size_t> tot_delivered_msgs;
+	// The messages sent to the vertices in other partitions in the level.
+	static atomic_number<size_t> tot_remote_msgs;
 	// We have to make sure all threads have reach here, so we can switch
 	// queues to progress to the next level.
 	// If the queue of the next level is empty, the program can terminate.
@@ -766,6 +804,19 @@ bool graph_engine::progress_next_level()
 	worker_thread *curr = (worker_thread *) thread::get_curr_thread();
 	int num_activates = curr->enter_next_level();
 	tot_num_activates.inc(num_activates);
+	size_t num_recv_msgs, num_recv_bytes, num_delivered_msgs;
+	curr->get_msg_processor().get_msg_stat(num_recv_msgs, num_recv_bytes,
+			num_delivered_msgs);
+	tot_recv_msgs.inc(num_recv_msgs);
+	tot_recv_bytes.inc(num_recv_bytes);
+	tot_delivered_msgs.inc(num_delivered_msgs);
+	tot_remote_msgs.inc(
+			curr->get_vertex_program(false).fetch_reset_num_remote_msgs()
+			+ curr->get_vertex_program(true).fetch_reset_num_remote_msgs());
+	long tail_time = curr->get_tail_time() * 1000000;
+	long max_tail = max_tail_time.get();
+	while (tail_time > max_tail && !max_tail_time.CAS(max_tail, tail_time))
+		max_tail = max_tail_time.get();
 	// If all threads have reached here.
 	if (num_threads.inc(1) == get_num_threads()) {
 		level.inc(1);
@@ -775,6 +826,22 @@ bool graph_engine::progress_next_level()
 			<< boost::format("Iter %1% takes %2% seconds, and %3% vertices are in iter %4%")
 				% (level.get() - 1) % time_diff(iter_start, curr)
 				% tot_num_activates.get() % level.get();
+		BOOST_LOG_TRIVIAL(info)
+			<< boost::format("The longest tail in iter %1% takes %2% seconds")
+				% (level.get() - 1) % (max_tail_time.get() / 1000000.0);
+		BOOST_LOG_TRIVIAL(info)
+			<< boost::format("Iter %1% receives %2% messages in %3% bytes and delivers %4% messages")
+				% (level.get() - 1) % tot_recv_msgs.get() % tot_recv_bytes.get()
+				% tot_delivered_msgs.get();
+		BOOST_LOG_TRIVIAL(info)
+			<< boost::format("Iter %1% sends %2% messages to other partitions")
+				% (level.get() - 1) % tot_remote_msgs.get();
+		num_remote_msgs += tot_remote_msgs.get();
+		max_tail_time = atomic_number<long>(0);
+		tot_recv_msgs = atomic_number<size_t>(0);
+		tot_recv_bytes = atomic_number<size_t>(0);
+		tot_delivered_msgs = atomic_number<size_t>(0);
+		tot_remote_msgs = atomic_number<size_t>(0);
 		iter_start = curr;
 		assert(num_remaining_vertices_in_level.get() == 0);
 		num_remaining_vertices_in_level = atomic_number<size_t>(
@@ -796,6 +863,50 @@ bool graph_engine::progress_next_level()
 	return is_complete;
 }
 
+/*
+ * The graph computation completes when all worker threads are idle and
+ * all message queues are empty. A thread sends all of its messages before
+ * it becomes idle and becomes active before it fetches messages, so
+ * the computation is complete if no thread becomes idle while we check
+ * the message queues.
+ */
+bool graph_engine::check_async_complete()
+{
+	if (is_complete)
+		return true;
+
+	long epoch = async_epoch.get();
+	if (num_active_threads.get() > 0)
+		return false;
+	for (size_t i = 0; i < worker_threads.size(); i++) {
+		if (!worker_threads[i]->get_msg_processor().get_msg_queue().is_empty())
+			return false;
+	}
+	if (num_active_threads.get() > 0 || async_epoch.get() != epoch)
+		return false;
+	is_complete = true;
+	return true;
+}
+
+bool graph_engine::wait4async_work()
+{
+	worker_thread *curr = (worker_thread *) thread::get_curr_thread();
+	msg_queue &q = curr->get_msg_processor().get_msg_queue();
+	async_epoch.inc(1);
+	num_active_threads.dec(1);
+	while (true) {
+		// We have to become active before we fetch the messages or
+		// steal vertices from other threads.
+		if (!q.is_empty() || get_num_remaining_vertices() > 0) {
+			num_active_threads.inc(1);
+			return false;
+		}
+		if (check_async_complete())
+			return true;
+		sched_yield();
+	}
+}
+
 void graph_engine::wait4complete()
 {
 	for (unsigned i = 0; i < worker_threads.size(); i++) {
@@ -915,6 +1026,7 @@ size_t graph_get_vertices(graph_engine &graph, const worker_thread &t,
 }
 
 std::atomic<long> graph_engine::init_count;
+std::atomic<size_t> graph_engine::num_remote_msgs;
 
 void graph_engine::init_flash_graph(config_map::ptr configs)
 {
@@ -134,6 +134,16 @@ public:
 
 	void broadcast_vpart(const vertex_message &msg);
 
+	/*
+	 * This decides whether an activated vertex with vertical partitions
+	 * runs on its part vertices in the current iteration. If not,
+	 * the main vertex runs as an unpartitioned vertex. A part vertex type
+	 * can hide this method.
+	 */
+	static bool run_on_vparts(vertex_program &prog, const compute_vertex &v) {
+		return true;
+	}
+
 	void run_on_message(vertex_program &vprog, const vertex_message &msg) {
 		ABORT_MSG("run_on_message isn't implemented");
 	}
@@ -190,7 +200,8 @@ public:
      *          of bringing both *in* and *out* edges into the page cache when an algorithm
      *          only requires one of the two.
 	 * \param reqs This is an array corresponding to the vertices you are requesting and defines
-     *              which part of the vertex you want (e.g `IN_EDGE`).
+     *              which part of the vertex you want (e.g `IN_EDGE`). A request
+     *              may only want a range of edges in the edge list.
      * \param num the number of elements in `reqs`.
 	 */
 	void request_partial_vertices(directed_vertex_request reqs[], size_t num);
@@ -226,6 +237,13 @@ public:
 	void request_vertices(vertex_id_t ids[], size_t num);
 	void request_partial_vertices(directed_vertex_request reqs[], size_t num);
 
+	/*
+	 * The same as part_compute_vertex::run_on_vparts.
+	 */
+	static bool run_on_vparts(vertex_program &prog, const compute_vertex &v) {
+		return true;
+	}
+
 	void run_on_message(vertex_program &vprog, const vertex_message &msg) {
 		ABORT_MSG("run_on_message isn't implemented");
 	}
@@ -331,6 +349,9 @@ class FG_graph;
 class graph_engine
 {
 	static std::atomic<long> init_count;
+	// The number of messages sent to the vertices in other partitions
+	// by all graph engines in the process.
+	static std::atomic<size_t> num_remote_msgs;
 
 	graph_header header;
 	// The location of the out-part of the graph. It's valid only
@@ -348,6 +369,13 @@ class graph_engine
 	atomic_integer level;
 	volatile bool is_complete;
 
+	// Whether vertices are processed without level barriers.
+	bool async;
+	// The number of worker threads that still have work in the async mode.
+	atomic_integer num_active_threads;
+	// This increases whenever a worker thread becomes idle in the async mode.
+	atomic_number<long> async_epoch;
+
 	// These are used for switching queues.
 	pthread_mutex_t lock;
 	pthread_barrier_t barrier1;
@@ -359,12 +387,20 @@ class graph_engine
 
 	trace_logger::ptr logger;
 	std::shared_ptr<safs::file_io_factory> graph_factory;
+	// The updates made to the graph after its image was created.
+	// The engine sees the updates whose sequence numbers are
+	// in (delta_base, delta_snapshot]. The snapshot is taken when
+	// the engine starts.
+	graph_delta::ptr delta;
+	uint64_t delta_base;
+	uint64_t delta_snapshot;
 	int max_processing_vertices;
 
 	// The time when the current iteration starts.
 	struct timeval start_time, iter_start;
 
 	void init_threads(vertex_program_creater::ptr creater);
+	bool check_async_complete();
 protected:
 	graph_engine(FG_graph &graph, graph_index::ptr index);
 	void init(graph_index::ptr index);
@@ -373,6 +409,17 @@ public:
 
 	static void init_flash_graph(config_map::ptr configs);
 	static void destroy_flash_graph();
+
+	/**
+	 * \brief Get the number of messages and activations that all graph
+	 * engines in the process have sent to the vertices in other partitions.
+	 * It shows how well the partitioner keeps the neighbors of a vertex
+	 * in the same partition.
+	 * \return The number of messages.
+	 */
+	static size_t get_num_remote_msgs() {
+		return num_remote_msgs.load();
+	}
     
     /**
      * \brief Constructor usable by inheriting classes.
@@ -470,6 +517,29 @@ public:
      * \param scheduler The user-defined vertex scheduler.
      */
 	void set_vertex_scheduler(vertex_scheduler::ptr scheduler);
+
+	/**
+	 * \brief Run the graph computation asynchronously.
+	 * In the async mode, the graph engine doesn't have level barriers.
+	 * A worker thread processes the vertices activated by messages as soon
+	 * as it runs out of vertices, and the computation ends when all worker
+	 * threads are idle and no messages are in flight. A vertex may run
+	 * again before other vertices run, so only the algorithms that converge
+	 * regardless of the order of vertex computation should use this mode.
+	 * The level of the graph engine stays at 0 in the async mode.
+	 * \param async Whether to run the graph computation asynchronously.
+	 */
+	void set_async(bool async) {
+		this->async = async;
+	}
+
+	/**
+	 * \brief Determine whether the graph computation runs asynchronously.
+	 * \return true if the graph engine runs in the async mode.
+	 */
+	bool is_async() const {
+		return async;
+	}
     
     /**
      * \brief Start the graph engine and begin computation on a subset of vertices.
@@ -574,6 +644,14 @@ public:
 	 */
 	bool progress_next_level();
 	bool progress_first_level();
+
+	/**
+	 * \internal
+	 * A worker thread in the async mode calls this when it has no work.
+	 * It returns false when the thread gets more work and returns true
+	 * when the graph computation completes.
+	 */
+	bool wait4async_work();
     
     /** \internal*/
 	trace_logger::ptr get_logger() const {
@@ -595,6 +673,26 @@ public:
 	int get_num_threads() const {
 		return worker_threads.size();
 	}
+
+    /**\internal */
+	const graph_delta::ptr &get_delta_store() const {
+		return delta;
+	}
+
+    /**\internal */
+	uint64_t get_delta_base() const {
+		return delta_base;
+	}
+
+    /**\internal */
+	uint64_t get_delta_snapshot() const {
+		return delta_snapshot;
+	}
+
+    /**\internal */
+	int get_num_nodes() const {
+		return num_nodes;
+	}
     
     /**\internal */
 	worker_thread *get_thread(int idx) const {
@@ -623,6 +721,14 @@ public:
 		return num_remaining_vertices_in_level.get();
 	}
 
+	/**
+	 * \internal
+	 * A worker thread in the async mode has activated more vertices.
+	 */
+	void add_remaining_vertices(size_t num) {
+		num_remaining_vertices_in_level.inc(num);
+	}
+
 	const in_mem_query_vertex_index::ptr get_in_mem_index() const {
 		return vindex;
 	}
@@ -643,7 +749,16 @@ public:
 		return out_part_off;
 	}
 
-	vsize_t cal_num_edges(vsize_t vertex_size) const {
+	/*
+	 * Compute the number of edges of the specified type of a vertex
+	 * from the size of the vertex on the disks. The size of a compressed
+	 * vertex doesn't tell the number of edges, so it's looked up in
+	 * the vertex index.
+	 */
+	vsize_t cal_num_edges(vertex_id_t id, edge_type type,
+			vsize_t vertex_size) const {
+		if (header.has_compressed_edges())
+			return vindex->get_num_edges(id, type);
 		return ext_mem_undirected_vertex::vsize2num_edges(vertex_size,
 				header.get_edge_data_size());
 	}
@@ -25,6 +25,7 @@
 
 #include "common.h"
 #include "parameters.h"
+#include "FG_basic_types.h"
 
 namespace fg
 {
@@ -51,6 +52,27 @@ struct graph_header_struct
 	int max_num_timestamps;
 };
 
+/*
+ * The fields added to the graph header after graph_header_struct was fixed.
+ * The header of a vertex index starts with graph_header_struct, so new
+ * fields can't be appended to it without moving the fields of the index.
+ * Instead, they are stored in the second half of the header page, which is
+ * zero in the files created before these fields were added.
+ */
+struct graph_header_ext_struct
+{
+	/*
+	 * The number of bytes of a vertex ID and the number of edges of a vertex
+	 * in the graph. 0 means 32-bit vertex IDs.
+	 */
+	int vertex_id_size;
+	/*
+	 * Whether the neighbor lists of vertices are compressed.
+	 * See ext_mem_compressed_vertex for the format of a compressed vertex.
+	 */
+	int compressed_edges;
+};
+
 /**
  * This is the graph header. It should be stored on the files
  * of both vertex index and adjacency list.
@@ -59,16 +81,33 @@ class graph_header
 {
 public:
 	static const int HEADER_SIZE = 4096;
+	static const int EXT_OFFSET = HEADER_SIZE / 2;
 private:
 	union {
 		struct graph_header_struct data;
 		char page[HEADER_SIZE];
 	} h;
+
+	graph_header_ext_struct &get_ext() {
+		return *(graph_header_ext_struct *) (h.page + EXT_OFFSET);
+	}
+
+	const graph_header_ext_struct &get_ext() const {
+		return *(const graph_header_ext_struct *) (h.page + EXT_OFFSET);
+	}
 public:
 	static int get_header_size() {
 		return sizeof(graph_header);
 	}
 
+	/*
+	 * Copy the header to a header page, which may belong to a vertex index.
+	 */
+	void copy_to(char *page) const {
+		memcpy(page, &h.data, sizeof(h.data));
+		memcpy(page + EXT_OFFSET, &get_ext(), sizeof(graph_header_ext_struct));
+	}
+
 	static void init(struct graph_header_struct &data) {
 		data.magic_number = MAGIC_NUMBER;
 		data.version_number = CURR_VERSION;
@@ -83,6 +122,7 @@ public:
 		assert(sizeof(*this) == HEADER_SIZE);
 		memset(this, 0, sizeof(*this));
 		init(h.data);
+		get_ext().vertex_id_size = sizeof(vertex_id_t);
 	}
 
 	graph_header(graph_type type, size_t num_vertices, size_t num_edges,
@@ -96,6 +136,7 @@ public:
 		h.data.num_edges = num_edges;
 		h.data.edge_data_size = edge_data_size;
 		h.data.max_num_timestamps = max_num_timestamps;
+		get_ext().vertex_id_size = sizeof(vertex_id_t);
 	}
 
 	bool is_graph_file() const {
@@ -106,6 +147,19 @@ public:
 		return h.data.version_number == CURR_VERSION;
 	}
 
+	/*
+	 * Test whether the graph uses vertex IDs of the same width as
+	 * the current build of FlashGraph.
+	 */
+	bool is_right_id_size() const {
+		return get_vertex_id_size() == sizeof(vertex_id_t);
+	}
+
+	int get_vertex_id_size() const {
+		return get_ext().vertex_id_size == 0 ? sizeof(uint32_t)
+			: get_ext().vertex_id_size;
+	}
+
 	bool is_directed_graph() const {
 		return h.data.type == graph_type::DIRECTED
 			|| h.data.type == graph_type::TS_DIRECTED;
@@ -135,6 +189,14 @@ public:
 		return h.data.max_num_timestamps;
 	}
 
+	bool has_compressed_edges() const {
+		return get_ext().compressed_edges;
+	}
+
+	void set_compressed_edges(bool compressed) {
+		get_ext().compressed_edges = compressed;
+	}
+
 	void verify() const {
 		if (!is_graph_file()) {
 			fprintf(stderr, "wrong magic number: %ld\n", h.data.magic_number);
@@ -142,8 +204,12 @@ public:
 		if (!is_right_version()) {
 			fprintf(stderr, "wrong version number: %d\n", h.data.version_number);
 		}
+		if (!is_right_id_size()) {
+			fprintf(stderr, "wrong vertex ID size: %d\n", get_vertex_id_size());
+		}
 		assert(is_graph_file());
 		assert(is_right_version());
+		assert(is_right_id_size());
 	}
 };
 
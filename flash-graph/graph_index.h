@@ -29,6 +29,7 @@
 #include "log.h"
 #include "vertex.h"
 #include "partitioner.h"
+#include "graph_config.h"
 #include "vertex_program.h"
 #include "graph_file_header.h"
 #include "vertex_pointer.h"
@@ -109,6 +110,11 @@ public:
 			compute_vertex_pointer vertices[]) const = 0;
 	virtual size_t get_vpart_vertices(vertex_id_t id,
 			compute_vertex_pointer vertices[], int num) const = 0;
+	/*
+	 * Whether the activated vertex with vertical partitions runs on
+	 * its part vertices in the current iteration.
+	 */
+	virtual bool run_on_vparts(vertex_program &prog, vertex_id_t id) const = 0;
 
 	virtual vertex_id_t get_max_vertex_id() const = 0;
 
@@ -318,7 +324,7 @@ class NUMA_graph_index: public graph_index
 	graph_header header;
 	vertex_id_t max_vertex_id;
 	vertex_id_t min_vertex_id;
-	std::unique_ptr<range_graph_partitioner> partitioner;
+	std::unique_ptr<graph_partitioner> partitioner;
 	// A graph index per thread
 	std::vector<std::unique_ptr<graph_local_partition<vertex_type, part_vertex_type> > > index_arr;
 
@@ -345,8 +351,27 @@ public:
 	}
 
 	void init(int num_threads, int num_nodes) {
-		partitioner = std::unique_ptr<range_graph_partitioner>(
-				new range_graph_partitioner(num_threads));
+		if (graph_conf.get_part_file().empty())
+			partitioner = std::unique_ptr<graph_partitioner>(
+					new range_graph_partitioner(num_threads));
+		else {
+			map_graph_partitioner::ptr map_partitioner
+				= map_graph_partitioner::load(graph_conf.get_part_file());
+			if (map_partitioner->get_num_partitions() != num_threads)
+				throw conf_exception(boost::str(boost::format(
+								"%1% has %2% partitions for %3% threads")
+							% graph_conf.get_part_file()
+							% map_partitioner->get_num_partitions() % num_threads));
+			if (map_partitioner->get_num_vertices() != header.get_num_vertices())
+				throw conf_exception(boost::str(boost::format(
+								"%1% has %2% vertices, but the graph has %3% vertices")
+							% graph_conf.get_part_file()
+							% map_partitioner->get_num_vertices()
+							% header.get_num_vertices()));
+			BOOST_LOG_TRIVIAL(info) << boost::format(
+					"vertices are partitioned by %1%") % graph_conf.get_part_file();
+			partitioner = std::move(map_partitioner);
+		}
 
 		// Construct the indices.
 		for (int i = 0; i < num_threads; i++) {
@@ -432,6 +457,18 @@ public:
 		return index_arr[part_id]->get_vpart_vertices(id, vertices, num);
 	}
 
+	virtual bool run_on_vparts(vertex_program &prog, vertex_id_t id) const {
+		// The updates of a vertex in the delta store have to be applied
+		// to its edge list once, so the vertex runs unpartitioned.
+		if (prog.has_delta(id))
+			return false;
+		int part_id;
+		off_t part_off;
+		partitioner->map2loc(id, part_id, part_off);
+		return part_vertex_type::run_on_vparts(prog,
+				(const vertex_type &) index_arr[part_id]->get_vertex(part_off));
+	}
+
 	virtual vertex_id_t get_max_vertex_id() const {
 		return max_vertex_id;
 	}
@@ -75,6 +75,26 @@ in_mem_graph::ptr in_mem_graph::load_graph(const std::string &file_name)
 	graph_header *header = (graph_header *) data.first;
 	if (!header->is_graph_file() || !header->is_right_version())
 		throw wrong_format("wrong graph file or format version");
+	if (!header->is_right_id_size())
+		throw wrong_format("the graph uses vertex IDs of a different size");
+	return graph;
+}
+
+in_mem_graph::ptr in_mem_graph::map_graph(const std::string &file_name)
+{
+	safs::NUMA_buffer::ptr numa_buf = safs::NUMA_buffer::map(file_name);
+	in_mem_graph::ptr graph = in_mem_graph::ptr(new in_mem_graph());
+	graph->graph_size = numa_buf->get_length();
+	graph->graph_data = numa_buf;
+	graph->graph_file_name = file_name;
+
+	safs::NUMA_buffer::cdata_info data = numa_buf->get_data(0, PAGE_SIZE);
+	assert(data.first);
+	graph_header *header = (graph_header *) data.first;
+	if (!header->is_graph_file() || !header->is_right_version())
+		throw wrong_format("wrong graph file or format version");
+	if (!header->is_right_id_size())
+		throw wrong_format("the graph uses vertex IDs of a different size");
 	return graph;
 }
 
@@ -99,6 +119,8 @@ in_mem_graph::ptr in_mem_graph::load_safs_graph(const std::string &file_name)
 	graph_header *header = (graph_header *) data.first;
 	if (!header->is_graph_file() || !header->is_right_version())
 		throw wrong_format("wrong graph file or format version");
+	if (!header->is_right_id_size())
+		throw wrong_format("the graph uses vertex IDs of a different size");
 	return graph;
 }
 
@@ -66,6 +66,26 @@ public:
 
 	static ptr load_graph(const std::string &graph_file);
 	static ptr load_safs_graph(const std::string &graph_file);
+	/*
+	 * Map the graph file in the local filesystem to memory directly.
+	 * The graph data isn't copied, so the graph is read-only.
+	 */
+	static ptr map_graph(const std::string &graph_file);
+
+	size_t get_size() const {
+		return graph_size;
+	}
+
+	const std::string &get_name() const {
+		return graph_file_name;
+	}
+
+	/*
+	 * Copy the graph data in the specified location to the given buffer.
+	 */
+	void copy_to(char *buf, size_t size, off_t off) const {
+		graph_data->copy_to(buf, size, off);
+	}
 
 	void dump(const std::string &file) const;
 
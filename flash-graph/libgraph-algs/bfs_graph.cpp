@@ -26,7 +26,9 @@
 
 #include "graph_engine.h"
 #include "graph_config.h"
+#include "FG_vector.h"
 #include "FGlib.h"
+#include "bitmap.h"
 
 using namespace safs;
 using namespace fg;
@@ -172,8 +174,154 @@ public:
 	}
 };
 
+/*
+ * Direction-optimizing BFS.
+ *
+ * The BFS runs one level at a time. In a top-down level, the vertices in
+ * the frontier read their edges and add their unvisited neighbors to the
+ * next frontier. In a bottom-up level, all unvisited vertices read their
+ * edges in the opposite direction and join the next frontier once they
+ * find a neighbor in the current frontier. The bottom-up search avoids
+ * reading the edges of a large frontier, most of which lead to vertices
+ * that have been visited. We switch between the two directions with
+ * the heuristic in the paper below.
+ *
+ * Scott Beamer, Krste Asanovic, David Patterson: Direction-Optimizing
+ * Breadth-First Search, SC 2012.
+ *
+ * The levels of vertices are only changed between BFS levels, so vertices
+ * can read the levels of their neighbors without synchronization.
+ */
+
+// The BFS level being processed.
+int curr_bfs_level;
+bool bottom_up;
+bool directed_graph;
+// The edges read by an unvisited vertex in a bottom-up level.
+edge_type search_edge = edge_type::IN_EDGE;
+std::unique_ptr<thread_safe_bitmap> next_frontier;
+
+class do_bfs_vertex: public compute_directed_vertex
+{
+	int level;
+public:
+	do_bfs_vertex(vertex_id_t id): compute_directed_vertex(id) {
+		level = -1;
+	}
+
+	bool has_visited() const {
+		return level >= 0;
+	}
+
+	int get_level() const {
+		return level;
+	}
+
+	void set_level(int level) {
+		this->level = level;
+	}
+
+	int get_result() const {
+		return level;
+	}
+
+	void run(vertex_program &prog) {
+		vertex_id_t id = prog.get_vertex_id(*this);
+		if (!directed_graph)
+			request_vertices(&id, 1);
+		else {
+			directed_vertex_request req(id,
+					bottom_up ? search_edge : traverse_edge);
+			request_partial_vertices(&req, 1);
+		}
+	}
+
+	void run(vertex_program &prog, const page_vertex &vertex);
+
+	void run_on_message(vertex_program &prog, const vertex_message &msg) {
+	}
+};
+
+/*
+ * Add the unvisited neighbors to the next frontier.
+ */
+void expand_frontier(graph_engine &graph, const page_vertex &vertex,
+		edge_type type)
+{
+	edge_seq_iterator it = vertex.get_neigh_seq_it(type);
+	while (it.has_next()) {
+		vertex_id_t neigh = it.next();
+		if (!((do_bfs_vertex &) graph.get_vertex(neigh)).has_visited())
+			next_frontier->set(neigh);
+	}
+}
+
+/*
+ * Search for a neighbor in the current frontier.
+ */
+bool find_parent(graph_engine &graph, const page_vertex &vertex,
+		edge_type type)
+{
+	edge_seq_iterator it = vertex.get_neigh_seq_it(type);
+	while (it.has_next()) {
+		vertex_id_t neigh = it.next();
+		if (((do_bfs_vertex &) graph.get_vertex(neigh)).get_level()
+				== curr_bfs_level)
+			return true;
+	}
+	return false;
+}
+
+void do_bfs_vertex::run(vertex_program &prog, const page_vertex &vertex)
+{
+	graph_engine &graph = prog.get_graph();
+	// Undirected vertices only have one list of edges.
+	if (!directed_graph) {
+		if (!bottom_up)
+			expand_frontier(graph, vertex, edge_type::BOTH_EDGES);
+		else if (find_parent(graph, vertex, edge_type::BOTH_EDGES))
+			next_frontier->set(prog.get_vertex_id(*this));
+		return;
+	}
+
+	edge_type type = bottom_up ? search_edge : traverse_edge;
+	edge_type types[2];
+	int num_types = 0;
+	if (type == edge_type::BOTH_EDGES) {
+		types[num_types++] = edge_type::IN_EDGE;
+		types[num_types++] = edge_type::OUT_EDGE;
+	}
+	else
+		types[num_types++] = type;
+	for (int i = 0; i < num_types; i++) {
+		if (!bottom_up)
+			expand_frontier(graph, vertex, types[i]);
+		else if (find_parent(graph, vertex, types[i])) {
+			next_frontier->set(prog.get_vertex_id(*this));
+			break;
+		}
+	}
+}
+
+class unvisited_filter: public vertex_filter
+{
+public:
+	bool keep(vertex_program &prog, compute_vertex &v) {
+		return !((do_bfs_vertex &) v).has_visited();
+	}
+};
+
+// The parameters of the heuristic in the paper.
+const size_t BFS_ALPHA = 14;
+const size_t BFS_BETA = 24;
+
 }
 
+#include "save_result.h"
+
+namespace fg
+{
+
 size_t bfs(FG_graph::ptr fg, vertex_id_t start_vertex, edge_type traverse_e)
 {
 	bool directed = fg->get_graph_header().is_directed_graph();
@@ -213,3 +361,97 @@ size_t bfs(FG_graph::ptr fg, vertex_id_t start_vertex, edge_type traverse_e)
 #endif
 	return num_visited;
 }
+
+FG_vector<int>::ptr compute_do_bfs(FG_graph::ptr fg, vertex_id_t start_vertex,
+		edge_type traverse_e)
+{
+	directed_graph = fg->get_graph_header().is_directed_graph();
+	if (!directed_graph)
+		traverse_e = edge_type::BOTH_EDGES;
+	traverse_edge = traverse_e;
+	if (traverse_e == edge_type::OUT_EDGE)
+		search_edge = edge_type::IN_EDGE;
+	else if (traverse_e == edge_type::IN_EDGE)
+		search_edge = edge_type::OUT_EDGE;
+	else
+		search_edge = edge_type::BOTH_EDGES;
+
+	graph_index::ptr index = NUMA_graph_index<do_bfs_vertex>::create(
+			fg->get_graph_header());
+	graph_engine::ptr graph = fg->create_engine(index);
+	if (start_vertex > graph->get_max_vertex_id()) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("invalid start vertex: %1%") % start_vertex;
+		return FG_vector<int>::ptr();
+	}
+	size_t num_vertices = graph->get_num_vertices();
+	next_frontier = std::unique_ptr<thread_safe_bitmap>(
+			new thread_safe_bitmap(graph->get_max_vertex_id() + 1, 0));
+	BOOST_LOG_TRIVIAL(info) << "direction-optimizing BFS starts";
+#ifdef PROFILER
+	if (!graph_conf.get_prof_file().empty())
+		ProfilerStart(graph_conf.get_prof_file().c_str());
+#endif
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	// The number of edges to check from the frontier in a top-down level
+	// and from the unvisited vertices in a bottom-up level.
+	size_t frontier_edges = graph->get_num_edges(start_vertex, traverse_e);
+	size_t unvisited_edges = 0;
+	for (vertex_id_t id = 0; id <= graph->get_max_vertex_id(); id++)
+		unvisited_edges += graph->get_num_edges(id, search_edge);
+	unvisited_edges -= graph->get_num_edges(start_vertex, search_edge);
+
+	std::vector<vertex_id_t> frontier(1, start_vertex);
+	((do_bfs_vertex &) graph->get_vertex(start_vertex)).set_level(0);
+	size_t prev_frontier_size = 0;
+	bottom_up = false;
+	for (curr_bfs_level = 0; !frontier.empty(); curr_bfs_level++) {
+		if (!bottom_up)
+			bottom_up = frontier_edges > unvisited_edges / BFS_ALPHA;
+		else
+			bottom_up = frontier.size() >= num_vertices / BFS_BETA
+				|| frontier.size() > prev_frontier_size;
+		BOOST_LOG_TRIVIAL(info)
+			<< boost::format("BFS level %1% has %2% vertices and runs %3%")
+			% curr_bfs_level % frontier.size()
+			% (bottom_up ? "bottom-up" : "top-down");
+
+		if (bottom_up)
+			graph->start(std::shared_ptr<vertex_filter>(
+						new unvisited_filter()));
+		else
+			graph->start(frontier.data(), frontier.size());
+		graph->wait4complete();
+
+		prev_frontier_size = frontier.size();
+		frontier.clear();
+		next_frontier->get_reset_set_bits(frontier);
+		frontier_edges = 0;
+		BOOST_FOREACH(vertex_id_t id, frontier) {
+			do_bfs_vertex &v = (do_bfs_vertex &) graph->get_vertex(id);
+			assert(!v.has_visited());
+			v.set_level(curr_bfs_level + 1);
+			frontier_edges += graph->get_num_edges(id, traverse_e);
+			unvisited_edges -= graph->get_num_edges(id, search_edge);
+		}
+	}
+	gettimeofday(&end, NULL);
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("BFS takes %1% seconds and has %2% levels")
+		% time_diff(start, end) % curr_bfs_level;
+
+#ifdef PROFILER
+	if (!graph_conf.get_prof_file().empty())
+		ProfilerStop();
+#endif
+	next_frontier.reset();
+
+	FG_vector<int>::ptr vec = FG_vector<int>::create(graph);
+	graph->query_on_all(vertex_query::ptr(
+				new save_query<int, do_bfs_vertex>(vec)));
+	return vec;
+}
+
+}
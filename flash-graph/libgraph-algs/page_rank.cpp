@@ -22,9 +22,13 @@
 
 #include <limits>
 #include <cmath>
+#include <set>
+#include <unordered_map>
 
 #include "graph_engine.h"
 #include "graph_config.h"
+#include "vertex_state.h"
+#include "vertex_cut.h"
 #include "FGlib.h"
 
 using namespace fg;
@@ -47,12 +51,19 @@ enum pr_stage_t
 };
 pr_stage_t pr_stage;
 
+/*
+ * In the vertex-cut mode, the in-edges of a vertex with many edges are
+ * gathered in chunks, the result is applied once and the out-neighbors
+ * are activated in chunks.
+ */
 class pgrank_vertex: public compute_directed_vertex
 {
   float curr_itr_pr; // Current iteration's page rank
   vsize_t num_out_edges;
 
 public:
+  typedef float gather_type;
+
   pgrank_vertex(vertex_id_t id): compute_directed_vertex(id) {
     this->curr_itr_pr = 1 - DAMPING_FACTOR; // Must be this
   }
@@ -73,6 +84,22 @@ public:
 
 	void run(vertex_program &prog, const page_vertex &vertex);
 
+	edge_type get_cut_edges(vertex_program &prog) const {
+		if (pr_stage == pr_stage_t::RUN
+				&& prog.get_graph().get_curr_level() < max_num_iters)
+			return edge_type::IN_EDGE;
+		else
+			return edge_type::NONE;
+	}
+
+	void run_on_edges(vertex_program &prog, const page_vertex &vertex,
+			edge_type type, size_t start, size_t end, float &accum) const;
+
+	bool apply(vertex_program &prog, float accum);
+
+	void scatter(vertex_program &prog, const page_vertex &vertex,
+			size_t start, size_t end) const;
+
 	void run_on_message(vertex_program &,
 /* Only serves to activate on the next iteration */
 			const vertex_message &msg) { }; 
@@ -101,30 +128,43 @@ void pgrank_vertex::run(vertex_program &prog)
 void pgrank_vertex::run(vertex_program &prog, const page_vertex &vertex) {
   // Gather
   float accum = 0;
-  edge_iterator end_it = vertex.get_neigh_end(IN_EDGE);
-  
-  for (edge_iterator it = vertex.get_neigh_begin(IN_EDGE); it != end_it; ++it) {
-    vertex_id_t id = *it;
-    pgrank_vertex& v = (pgrank_vertex&) prog.get_graph().get_vertex(id);
-    // Notice I want this iteration's pagerank
-    accum += (v.get_curr_itr_pr()/v.get_num_out_edges()); 
-  }   
+  run_on_edges(prog, vertex, IN_EDGE, 0, vertex.get_num_edges(IN_EDGE), accum);
+  if (apply(prog, accum))
+    scatter(prog, vertex, 0, vertex.get_num_edges(OUT_EDGE));
+}
+
+void pgrank_vertex::run_on_edges(vertex_program &prog,
+		const page_vertex &vertex, edge_type type, size_t start, size_t end,
+		float &accum) const
+{
+	assert(type == IN_EDGE);
+	edge_seq_iterator it = vertex.get_neigh_seq_it(IN_EDGE, start, end);
+	PAGE_FOREACH(vertex_id_t, id, it) {
+		pgrank_vertex& v = (pgrank_vertex&) prog.get_graph().get_vertex(id);
+		// Notice I want this iteration's pagerank
+		accum += (v.get_curr_itr_pr()/v.get_num_out_edges());
+	} PAGE_FOREACH_END
+}
 
+/*
+ * A vertex without in-edges keeps its initial PageRank, so it never
+ * scatters.
+ */
+bool pgrank_vertex::apply(vertex_program &prog, float accum) {
   // Apply
-  float last_change = 0;
-  if (vertex.get_num_edges(IN_EDGE) > 0) {
-    float new_pr = ((1 - DAMPING_FACTOR)) + (DAMPING_FACTOR*(accum));
-    last_change = new_pr - curr_itr_pr;
-    curr_itr_pr = new_pr;
-  }   
-  
+  float new_pr = ((1 - DAMPING_FACTOR)) + (DAMPING_FACTOR*(accum));
+  float last_change = new_pr - curr_itr_pr;
+  curr_itr_pr = new_pr;
+  return std::fabs( last_change ) > TOLERANCE;
+}
+
+void pgrank_vertex::scatter(vertex_program &prog, const page_vertex &vertex,
+		size_t start, size_t end) const
+{
   // Scatter (activate your out-neighbors ... if you have any :) 
-  if ( std::fabs( last_change ) > TOLERANCE ) {
-	int num_dests = vertex.get_num_edges(OUT_EDGE);
-    if (num_dests > 0) {
-		edge_seq_iterator it = vertex.get_neigh_seq_it(OUT_EDGE, 0, num_dests);
-		prog.activate_vertices(it) ;
-    }   
+  if (start < end) {
+	edge_seq_iterator it = vertex.get_neigh_seq_it(OUT_EDGE, start, end);
+	prog.activate_vertices(it) ;
   }
 }
 
@@ -140,20 +180,41 @@ public:
 	float get_delta() const {
 		return delta;
 	}
+
+	float get_value() const {
+		return delta;
+	}
+
+	void set_value(float delta) {
+		this->delta = delta;
+	}
+};
+
+/*
+ * The state of pgrank_vertex2 is stored in columns, so an iteration only
+ * brings the PageRank values of vertices to the CPU cache.
+ */
+vertex_state<float>::ptr new_prs;
+vertex_state<float>::ptr curr_itr_prs; // Current iteration's page rank
+// The graph engine has no levels in the async mode, so a vertex
+// remembers whether it has pushed its initial PageRank.
+vertex_state<bool>::ptr pushed;
+
+/*
+ * In incremental PageRank, these are the out-edges added to and deleted
+ * from the vertices since the previous PageRank was computed.
+ */
+struct out_edge_changes
+{
+	std::vector<vertex_id_t> added;
+	std::vector<vertex_id_t> deleted;
 };
+std::unordered_map<vertex_id_t, out_edge_changes> edge_changes;
 
 class pgrank_vertex2: public compute_directed_vertex
 {
-	float new_pr;
-	float curr_itr_pr; // Current iteration's page rank
 public:
 	pgrank_vertex2(vertex_id_t id): compute_directed_vertex(id) {
-		this->curr_itr_pr = 1 - DAMPING_FACTOR; // Must be this
-		this->new_pr = curr_itr_pr;
-	}
-
-	float get_result() const{
-		return new_pr;
 	}
 
 	void run(vertex_program &prog) { 
@@ -167,9 +228,61 @@ public:
 
 	void run(vertex_program &, const page_vertex &vertex);
 
-	void run_on_message(vertex_program &, const vertex_message &msg1) {
+	void run_on_message(vertex_program &prog, const vertex_message &msg1) {
 		const pr_message &msg = (const pr_message &) msg1;
-		new_pr += msg.get_delta();
+		new_prs->get(prog, *this) += msg.get_delta();
+	}
+
+	void retract_old_edges(vertex_program &prog, const page_vertex &vertex,
+			float curr_itr_pr);
+};
+
+/*
+ * A vertex whose out-edges changed takes back the PageRank it pushed
+ * along its old out-edges. The old out-edges are the current out-edges
+ * without the added edges, plus the deleted edges.
+ */
+void pgrank_vertex2::retract_old_edges(vertex_program &prog,
+		const page_vertex &vertex, float curr_itr_pr)
+{
+	auto it = edge_changes.find(prog.get_vertex_id(*this));
+	if (it == edge_changes.end())
+		return;
+
+	std::vector<vertex_id_t> old_edges(vertex.get_num_edges(OUT_EDGE));
+	if (!old_edges.empty())
+		vertex.read_edges(OUT_EDGE, old_edges.data(), old_edges.size());
+	std::multiset<vertex_id_t> added(it->second.added.begin(),
+			it->second.added.end());
+	size_t num_old = 0;
+	for (size_t i = 0; i < old_edges.size(); i++) {
+		auto added_it = added.find(old_edges[i]);
+		if (added_it != added.end())
+			added.erase(added_it);
+		else
+			old_edges[num_old++] = old_edges[i];
+	}
+	old_edges.resize(num_old);
+	old_edges.insert(old_edges.end(), it->second.deleted.begin(),
+			it->second.deleted.end());
+	if (old_edges.empty())
+		return;
+
+	pr_message msg(-curr_itr_pr / old_edges.size() * DAMPING_FACTOR);
+	prog.multicast_msg(old_edges.data(), old_edges.size(), msg);
+}
+
+/*
+ * A vertex only needs the sum of the deltas it receives, so we merge
+ * the messages to the same vertex.
+ */
+class pgrank2_vertex_program_creater: public vertex_program_creater
+{
+public:
+	vertex_program::ptr create() const {
+		vertex_program::ptr prog(new vertex_program_impl<pgrank_vertex2>());
+		prog->set_message_combiner(create_sum_combiner<pr_message>());
+		return prog;
 	}
 };
 
@@ -178,10 +291,18 @@ void pgrank_vertex2::run(vertex_program &prog, const page_vertex &vertex)
 	int num_dests = vertex.get_num_edges(OUT_EDGE);
 	edge_seq_iterator it = vertex.get_neigh_seq_it(OUT_EDGE, 0, num_dests);
 
-	// If this is the first iteration.
-	if (prog.get_graph().get_curr_level() == 0) {
+	vertex_loc_t loc = prog.get_vertex_loc(*this);
+	float &curr_itr_pr = curr_itr_prs->get(loc.first, loc.second);
+	float new_pr = new_prs->get(loc.first, loc.second);
+	bool &vpushed = pushed->get(loc.first, loc.second);
+	// If this is the first iteration, or the out-edges of the vertex
+	// changed in incremental PageRank.
+	if (!vpushed) {
+		if (!edge_changes.empty())
+			retract_old_edges(prog, vertex, curr_itr_pr);
 		pr_message msg(curr_itr_pr / num_dests * DAMPING_FACTOR);
 		prog.multicast_msg(it, msg);
+		vpushed = true;
 	}
 	else if (std::fabs(new_pr - curr_itr_pr) > TOLERANCE) {
 		pr_message msg((new_pr - curr_itr_pr) / num_dests * DAMPING_FACTOR);
@@ -214,8 +335,8 @@ FG_vector<float>::ptr compute_pagerank(FG_graph::ptr fg, int num_iters,
 		exit(-1);
 	}
 
-	graph_index::ptr index = NUMA_graph_index<pgrank_vertex>::create(
-			fg->get_graph_header());
+	graph_index::ptr index = NUMA_graph_index<pgrank_vertex,
+		gas_part_vertex<pgrank_vertex> >::create(fg->get_graph_header());
 	graph_engine::ptr graph = fg->create_engine(index);
 	max_num_iters = num_iters;
 	BOOST_LOG_TRIVIAL(info)
@@ -253,8 +374,8 @@ FG_vector<float>::ptr compute_pagerank(FG_graph::ptr fg, int num_iters,
 	return ret;
 }
 
-FG_vector<float>::ptr compute_pagerank2(FG_graph::ptr fg, int num_iters,
-		float damping_factor)
+static FG_vector<float>::ptr run_pagerank2(FG_graph::ptr fg, int num_iters,
+		float damping_factor, bool async)
 {
 	bool directed = fg->get_graph_header().is_directed_graph();
 	if (!directed) {
@@ -273,10 +394,20 @@ FG_vector<float>::ptr compute_pagerank2(FG_graph::ptr fg, int num_iters,
 	graph_index::ptr index = NUMA_graph_index<pgrank_vertex2>::create(
 			fg->get_graph_header());
 	graph_engine::ptr graph = fg->create_engine(index);
+	graph->set_async(async);
+	new_prs = vertex_state<float>::create(*graph, 1 - DAMPING_FACTOR);
+	curr_itr_prs = vertex_state<float>::create(*graph, 1 - DAMPING_FACTOR);
+	pushed = vertex_state<bool>::create(*graph, false);
+	BOOST_LOG_TRIVIAL(info) << boost::format("The vertex state uses %1% bytes")
+		% (new_prs->get_mem_size() + curr_itr_prs->get_mem_size()
+				+ pushed->get_mem_size());
 	max_num_iters = num_iters;
-	BOOST_LOG_TRIVIAL(info)
-		<< boost::format("Pagerank (at maximal %1% iterations) starting")
-		% max_num_iters;
+	if (async)
+		BOOST_LOG_TRIVIAL(info) << "Pagerank starts asynchronously";
+	else
+		BOOST_LOG_TRIVIAL(info)
+			<< boost::format("Pagerank (at maximal %1% iterations) starting")
+			% max_num_iters;
 	BOOST_LOG_TRIVIAL(info) << "prof_file: " << graph_conf.get_prof_file();
 #ifdef PROFILER
 	if (!graph_conf.get_prof_file().empty())
@@ -285,14 +416,18 @@ FG_vector<float>::ptr compute_pagerank2(FG_graph::ptr fg, int num_iters,
 
 	struct timeval start, end;
 	gettimeofday(&start, NULL);
-	graph->start_all(); 
+	graph->start_all(vertex_initializer::ptr(),
+			vertex_program_creater::ptr(new pgrank2_vertex_program_creater()));
 	graph->wait4complete();
 	gettimeofday(&end, NULL);
 
 	FG_vector<float>::ptr ret = FG_vector<float>::create(
 			graph->get_num_vertices());
-	graph->query_on_all(vertex_query::ptr(
-				new save_query<float, pgrank_vertex2>(ret)));
+	new_prs->copy_to(ret->get_data());
+	// The columns can't outlive the graph engine.
+	new_prs.reset();
+	curr_itr_prs.reset();
+	pushed.reset();
 
 #ifdef PROFILER
 	if (!graph_conf.get_prof_file().empty())
@@ -305,4 +440,83 @@ FG_vector<float>::ptr compute_pagerank2(FG_graph::ptr fg, int num_iters,
 	return ret;
 }
 
+FG_vector<float>::ptr compute_pagerank2(FG_graph::ptr fg, int num_iters,
+		float damping_factor)
+{
+	return run_pagerank2(fg, num_iters, damping_factor, false);
+}
+
+FG_vector<float>::ptr compute_async_pagerank(FG_graph::ptr fg,
+		float damping_factor)
+{
+	return run_pagerank2(fg, INT_MAX, damping_factor, true);
+}
+
+FG_vector<float>::ptr compute_incremental_pagerank(FG_graph::ptr fg,
+		FG_vector<float>::ptr prev, const edge_list_t &added,
+		const edge_list_t &deleted, float damping_factor)
+{
+	bool directed = fg->get_graph_header().is_directed_graph();
+	if (!directed) {
+		BOOST_LOG_TRIVIAL(error)
+			<< "This algorithm works on a directed graph";
+		return FG_vector<float>::ptr();
+	}
+	assert(prev->get_size() == fg->get_graph_header().get_num_vertices());
+
+	DAMPING_FACTOR = damping_factor;
+	if (DAMPING_FACTOR < 0 || DAMPING_FACTOR > 1) {
+		BOOST_LOG_TRIVIAL(fatal)
+			<< "Damping factor must be between 0 and 1 inclusive";
+		exit(-1);
+	}
+
+	graph_index::ptr index = NUMA_graph_index<pgrank_vertex2>::create(
+			fg->get_graph_header());
+	graph_engine::ptr graph = fg->create_engine(index);
+	// All vertices have pushed the previous PageRank along their old
+	// out-edges.
+	new_prs = vertex_state<float>::create(*graph);
+	new_prs->copy_from(prev->get_data());
+	curr_itr_prs = vertex_state<float>::create(*graph);
+	curr_itr_prs->copy_from(prev->get_data());
+	pushed = vertex_state<bool>::create(*graph, true);
+	max_num_iters = INT_MAX;
+
+	for (size_t i = 0; i < added.size(); i++)
+		edge_changes[added[i].first].added.push_back(added[i].second);
+	for (size_t i = 0; i < deleted.size(); i++)
+		edge_changes[deleted[i].first].deleted.push_back(deleted[i].second);
+	// Only the vertices whose out-edges changed start to push.
+	std::vector<vertex_id_t> start_vertices;
+	for (auto it = edge_changes.begin(); it != edge_changes.end(); it++) {
+		start_vertices.push_back(it->first);
+		pushed->get(it->first) = false;
+	}
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("Incremental Pagerank starts from %1% vertices")
+		% start_vertices.size();
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	graph->start(start_vertices.data(), start_vertices.size(),
+			vertex_initializer::ptr(),
+			vertex_program_creater::ptr(new pgrank2_vertex_program_creater()));
+	graph->wait4complete();
+	gettimeofday(&end, NULL);
+
+	FG_vector<float>::ptr ret = FG_vector<float>::create(
+			graph->get_num_vertices());
+	new_prs->copy_to(ret->get_data());
+	new_prs.reset();
+	curr_itr_prs.reset();
+	pushed.reset();
+	edge_changes.clear();
+
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("It takes %1% seconds in total")
+		% time_diff(start, end);
+	return ret;
+}
+
 }
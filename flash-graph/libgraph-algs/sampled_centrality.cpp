@@ -0,0 +1,593 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef PROFILER
+#include <gperftools/profiler.h>
+#endif
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <map>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "graph_engine.h"
+#include "graph_config.h"
+#include "FG_vector.h"
+#include "FGlib.h"
+
+using namespace fg;
+
+namespace
+{
+
+/*
+ * Betweenness and closeness centrality from the shortest paths of a sample
+ * of source vertices.
+ *
+ * The sources are processed in batches of up to 64. A batch runs
+ * a multi-source BFS, where each source owns a bit in the 64-bit masks of
+ * a vertex, followed by Brandes' back propagation of dependencies, so
+ * a vertex reads its edge list once for all sources in the batch that reach
+ * it in the same level.
+ *
+ * Manuel Then, et al.: The More the Merrier: Efficient Multi-Source Graph
+ * Traversal, VLDB 2015.
+ *
+ * With k sources sampled uniformly from the n candidate sources, the sum of
+ * their dependencies scaled by n / k is an unbiased estimate of betweenness
+ * (Brandes and Pich, 2007), and the mean distance from the sources that
+ * reach a vertex estimates its closeness (Eppstein and Wang, 2004).
+ *
+ * The number of shortest paths and the dependency of a vertex for each
+ * source are in the arrays below, instead of in the vertices, because
+ * neighbors read them when they receive messages. The arrays take
+ * 2 * sizeof(float) * batch_size bytes per vertex, so the batch size is
+ * reduced if the arrays don't fit in the available memory.
+ */
+
+const int MAX_BATCH_SIZE = 64;
+
+enum centrality_phase_t
+{
+	ms_bfs,
+	back_prop,
+};
+
+centrality_phase_t phase;
+bool directed_graph;
+// The number of sources in the current batch.
+int batch_size;
+// The number of shortest paths and the dependency of a vertex for
+// each source in the batch.
+std::vector<float> sigmas;
+std::vector<float> deltas;
+// The last level of BFS, where back propagation starts.
+int bp_max_level;
+
+float *get_sigmas(vertex_id_t id)
+{
+	return sigmas.data() + ((size_t) id) * batch_size;
+}
+
+float *get_deltas(vertex_id_t id)
+{
+	return deltas.data() + ((size_t) id) * batch_size;
+}
+
+/*
+ * Messages from different levels can be processed in the same level of
+ * the graph engine, so the sender tells its level.
+ */
+class ms_message: public vertex_message
+{
+	vertex_id_t sender;
+	int level;
+	uint64_t mask;
+public:
+	ms_message(vertex_id_t sender, int level, uint64_t mask,
+			bool activate): vertex_message(sizeof(ms_message), activate) {
+		this->sender = sender;
+		this->level = level;
+		this->mask = mask;
+	}
+
+	vertex_id_t get_sender() const {
+		return sender;
+	}
+
+	int get_level() const {
+		return level;
+	}
+
+	uint64_t get_mask() const {
+		return mask;
+	}
+};
+
+class centrality_vertex: public compute_directed_vertex
+{
+	// The sources that have reached the vertex.
+	uint64_t seen;
+	// The sources that reach the vertex in the next level, indexed by
+	// the parity of the level.
+	uint64_t next_bits[2];
+	// The sources that reach the vertex in the level it runs, indexed by
+	// the parity of the level. Threads prepare the next level of back
+	// propagation while other threads may still send messages in
+	// the current level.
+	uint64_t curr_bits[2];
+	// The sources whose paths go through the vertex in the level before
+	// the sender's level in back propagation, indexed by the level modulo 3.
+	// A vertex can be in different levels for different sources, so a slot
+	// is cleared for the vertices in one level while another slot is set
+	// for the vertices two levels before.
+	uint64_t pred_bits[3];
+	float btwn;
+	size_t dist_sum;
+	vsize_t num_reached;
+
+	void send(vertex_program &prog, const page_vertex &vertex, int level,
+			edge_type type);
+public:
+	centrality_vertex(vertex_id_t id): compute_directed_vertex(id) {
+		reset(0);
+		btwn = 0;
+		dist_sum = 0;
+		num_reached = 0;
+	}
+
+	/*
+	 * Reset the vertex for a new batch. `bits' has the bit of the vertex if
+	 * the vertex is a source of the batch.
+	 */
+	void reset(uint64_t bits) {
+		seen = bits;
+		next_bits[0] = bits;
+		next_bits[1] = 0;
+		curr_bits[0] = 0;
+		curr_bits[1] = 0;
+		pred_bits[0] = 0;
+		pred_bits[1] = 0;
+		pred_bits[2] = 0;
+	}
+
+	void set_curr_bits(int level, uint64_t bits) {
+		curr_bits[level & 1] = bits;
+	}
+
+	void set_pred_bits(int level, uint64_t bits) {
+		pred_bits[level % 3] = bits;
+	}
+
+	float get_btwn() const {
+		return btwn;
+	}
+
+	float get_closeness() const {
+		if (dist_sum == 0)
+			return 0;
+		return ((float) num_reached) / dist_sum;
+	}
+
+	void run(vertex_program &prog);
+	void run(vertex_program &prog, const page_vertex &vertex);
+	void run_on_message(vertex_program &prog, const vertex_message &msg);
+};
+
+typedef std::pair<vertex_id_t, uint64_t> level_vertex_t;
+typedef std::vector<std::vector<level_vertex_t> > level_vertices_t;
+// The vertices visited in each level of BFS in each partition.
+typedef std::map<int, std::shared_ptr<level_vertices_t> > level_map_t;
+
+class ms_bfs_vertex_program: public vertex_program_impl<centrality_vertex>
+{
+	std::shared_ptr<level_vertices_t> levels;
+public:
+	typedef std::shared_ptr<ms_bfs_vertex_program> ptr;
+
+	static ptr cast2(vertex_program::ptr prog) {
+		return std::static_pointer_cast<ms_bfs_vertex_program, vertex_program>(
+				prog);
+	}
+
+	ms_bfs_vertex_program() {
+		levels = std::shared_ptr<level_vertices_t>(new level_vertices_t());
+	}
+
+	void add_visited(vertex_id_t id, uint64_t bits) {
+		size_t level = get_graph().get_curr_level();
+		if (levels->size() <= level)
+			levels->resize(level + 1);
+		(*levels)[level].push_back(level_vertex_t(id, bits));
+	}
+
+	void collect_vertices(level_map_t &vertices) const {
+		vertices.insert(level_map_t::value_type(get_partition_id(), levels));
+	}
+};
+
+/*
+ * Back propagation runs from the vertices in the last level of BFS. At
+ * the end of each level, a thread activates its vertices in the level
+ * before and marks the bits of the vertices two levels before, which
+ * receive messages in the next level.
+ */
+class bp_vertex_program: public vertex_program_impl<centrality_vertex>
+{
+	std::shared_ptr<level_map_t> all_levels;
+	std::shared_ptr<level_vertices_t> levels;
+public:
+	bp_vertex_program(std::shared_ptr<level_map_t> levels) {
+		this->all_levels = levels;
+	}
+
+	virtual void run_on_engine_start() {
+		level_map_t::const_iterator it = all_levels->find(get_partition_id());
+		if (it != all_levels->end())
+			levels = it->second;
+	}
+
+	virtual void run_on_iteration_end();
+};
+
+class ms_bfs_vertex_program_creater: public vertex_program_creater
+{
+public:
+	vertex_program::ptr create() const {
+		return vertex_program::ptr(new ms_bfs_vertex_program());
+	}
+};
+
+class bp_vertex_program_creater: public vertex_program_creater
+{
+	std::shared_ptr<level_map_t> levels;
+public:
+	bp_vertex_program_creater(std::shared_ptr<level_map_t> levels) {
+		this->levels = levels;
+	}
+
+	vertex_program::ptr create() const {
+		return vertex_program::ptr(new bp_vertex_program(levels));
+	}
+};
+
+void bp_vertex_program::run_on_iteration_end()
+{
+	if (levels == NULL)
+		return;
+	// The level of the vertices that have sent messages.
+	int level = bp_max_level - get_graph().get_curr_level();
+	if (level <= 1)
+		return;
+
+	graph_engine &graph = get_graph();
+	// The messages from this level have been processed when the next
+	// level ends, so the bits of the receivers can be reused.
+	if ((size_t) level < levels->size()) {
+		BOOST_FOREACH(level_vertex_t v, (*levels)[level])
+			((centrality_vertex &) graph.get_vertex(v.first)).set_pred_bits(
+					level, 0);
+	}
+	if (level >= 3 && (size_t) level - 2 < levels->size()) {
+		BOOST_FOREACH(level_vertex_t v, (*levels)[level - 2])
+			((centrality_vertex &) graph.get_vertex(v.first)).set_pred_bits(
+					level - 2, v.second);
+	}
+	if ((size_t) level - 1 < levels->size()) {
+		std::vector<vertex_id_t> ids;
+		BOOST_FOREACH(level_vertex_t v, (*levels)[level - 1]) {
+			((centrality_vertex &) graph.get_vertex(v.first)).set_curr_bits(
+					level - 1, v.second);
+			ids.push_back(v.first);
+		}
+		activate_vertices(ids.data(), ids.size());
+	}
+}
+
+void centrality_vertex::run(vertex_program &prog)
+{
+	vertex_id_t id = prog.get_vertex_id(*this);
+	int level = prog.get_graph().get_curr_level();
+	switch (phase) {
+		case ms_bfs:
+			{
+				uint64_t bits = next_bits[level & 1];
+				curr_bits[level & 1] = bits;
+				next_bits[level & 1] = 0;
+				if (bits == 0)
+					return;
+				((ms_bfs_vertex_program &) prog).add_visited(id, bits);
+				num_reached += __builtin_popcountll(bits) * (level > 0);
+				dist_sum += __builtin_popcountll(bits) * level;
+				break;
+			}
+		case back_prop:
+			{
+				level = bp_max_level - level;
+				const float *delta = get_deltas(id);
+				for (uint64_t bits = curr_bits[level & 1]; bits;
+						bits &= bits - 1)
+					btwn += delta[__builtin_ctzll(bits)];
+				// The vertices in the first level only send messages to
+				// the sources, which don't count their own dependencies.
+				if (level <= 1)
+					return;
+				break;
+			}
+		default:
+			assert(0);
+	}
+
+	if (!directed_graph)
+		request_vertices(&id, 1);
+	else {
+		directed_vertex_request req(id, phase == ms_bfs
+				? edge_type::OUT_EDGE : edge_type::IN_EDGE);
+		request_partial_vertices(&req, 1);
+	}
+}
+
+void centrality_vertex::run(vertex_program &prog, const page_vertex &vertex)
+{
+	int level = prog.get_graph().get_curr_level();
+	if (phase == back_prop)
+		level = bp_max_level - level;
+	if (!directed_graph)
+		send(prog, vertex, level, edge_type::BOTH_EDGES);
+	else if (phase == ms_bfs)
+		send(prog, vertex, level, edge_type::OUT_EDGE);
+	else
+		send(prog, vertex, level, edge_type::IN_EDGE);
+}
+
+void centrality_vertex::send(vertex_program &prog, const page_vertex &vertex,
+		int level, edge_type type)
+{
+	if (vertex.get_num_edges(type) == 0)
+		return;
+	edge_seq_iterator it = vertex.get_neigh_seq_it(type, 0,
+			vertex.get_num_edges(type));
+	ms_message msg(vertex.get_id(), level, curr_bits[level & 1],
+			phase == ms_bfs);
+	prog.multicast_msg(it, msg);
+}
+
+void centrality_vertex::run_on_message(vertex_program &prog,
+		const vertex_message &msg1)
+{
+	const ms_message &msg = (const ms_message &) msg1;
+	vertex_id_t id = prog.get_vertex_id(*this);
+	int level = msg.get_level();
+	if (phase == ms_bfs) {
+		uint64_t new_bits = msg.get_mask() & ~seen;
+		seen |= new_bits;
+		next_bits[(level + 1) & 1] |= new_bits;
+		// The sender is on the shortest paths from the sources that reach
+		// this vertex in the next level.
+		float *sigma = get_sigmas(id);
+		const float *sender_sigma = get_sigmas(msg.get_sender());
+		for (uint64_t bits = msg.get_mask() & next_bits[(level + 1) & 1];
+				bits; bits &= bits - 1) {
+			int i = __builtin_ctzll(bits);
+			sigma[i] += sender_sigma[i];
+		}
+	}
+	else {
+		const float *sigma = get_sigmas(id);
+		const float *sender_sigma = get_sigmas(msg.get_sender());
+		const float *sender_delta = get_deltas(msg.get_sender());
+		float *delta = get_deltas(id);
+		for (uint64_t bits = msg.get_mask() & pred_bits[(level - 1) % 3];
+				bits; bits &= bits - 1) {
+			int i = __builtin_ctzll(bits);
+			delta[i] += sigma[i] / sender_sigma[i] * (1 + sender_delta[i]);
+		}
+	}
+}
+
+class batch_initializer: public vertex_initializer
+{
+public:
+	virtual void init(compute_vertex &v) {
+		((centrality_vertex &) v).reset(0);
+	}
+};
+
+class centrality_query: public vertex_query
+{
+	FG_vector<float>::ptr btwn;
+	FG_vector<float>::ptr closeness;
+	float scale;
+public:
+	centrality_query(FG_vector<float>::ptr btwn,
+			FG_vector<float>::ptr closeness, float scale) {
+		this->btwn = btwn;
+		this->closeness = closeness;
+		this->scale = scale;
+	}
+
+	virtual void run(graph_engine &graph, compute_vertex &v1) {
+		centrality_vertex &v = (centrality_vertex &) v1;
+		vertex_id_t id = graph.get_graph_index().get_vertex_id(v);
+		btwn->set(id, v.get_btwn() * scale);
+		closeness->set(id, v.get_closeness());
+	}
+
+	virtual void merge(graph_engine &graph, vertex_query::ptr q) {
+	}
+
+	virtual ptr clone() {
+		return vertex_query::ptr(new centrality_query(btwn, closeness, scale));
+	}
+};
+
+/*
+ * Run BFS and back propagation for a batch of sources.
+ */
+void run_batch(graph_engine::ptr graph, const vertex_id_t sources[], int num)
+{
+	batch_size = num;
+	size_t num_vertices = graph->get_max_vertex_id() + 1;
+	sigmas.assign(num_vertices * num, 0);
+	deltas.assign(num_vertices * num, 0);
+	for (int i = 0; i < num; i++)
+		get_sigmas(sources[i])[i] = 1;
+	graph->init_all_vertices(vertex_initializer::ptr(new batch_initializer()));
+	for (int i = 0; i < num; i++)
+		((centrality_vertex &) graph->get_vertex(sources[i])).reset(1UL << i);
+
+	phase = ms_bfs;
+	graph->start(sources, num, vertex_initializer::ptr(),
+			vertex_program_creater::ptr(new ms_bfs_vertex_program_creater()));
+	graph->wait4complete();
+
+	std::vector<vertex_program::ptr> programs;
+	graph->get_vertex_programs(programs);
+	std::shared_ptr<level_map_t> levels(new level_map_t());
+	BOOST_FOREACH(vertex_program::ptr prog, programs)
+		ms_bfs_vertex_program::cast2(prog)->collect_vertices(*levels);
+	bp_max_level = 0;
+	for (level_map_t::const_iterator it = levels->begin();
+			it != levels->end(); it++)
+		bp_max_level = std::max(bp_max_level, (int) it->second->size() - 1);
+	if (bp_max_level <= 0)
+		return;
+
+	// Prepare the senders in the last level and their receivers.
+	std::vector<vertex_id_t> ids;
+	for (level_map_t::const_iterator it = levels->begin();
+			it != levels->end(); it++) {
+		const level_vertices_t &part_levels = *it->second;
+		if ((int) part_levels.size() <= bp_max_level - 1)
+			continue;
+		BOOST_FOREACH(level_vertex_t v, part_levels[bp_max_level - 1])
+			((centrality_vertex &) graph->get_vertex(v.first)).set_pred_bits(
+					bp_max_level - 1, v.second);
+		if ((int) part_levels.size() <= bp_max_level)
+			continue;
+		BOOST_FOREACH(level_vertex_t v, part_levels[bp_max_level]) {
+			((centrality_vertex &) graph->get_vertex(v.first)).set_curr_bits(
+					bp_max_level, v.second);
+			ids.push_back(v.first);
+		}
+	}
+	phase = back_prop;
+	graph->start(ids.data(), ids.size(), vertex_initializer::ptr(),
+			vertex_program_creater::ptr(new bp_vertex_program_creater(levels)));
+	graph->wait4complete();
+}
+
+}
+
+namespace fg
+{
+
+void compute_sampled_centrality(FG_graph::ptr fg, size_t num_samples,
+		FG_vector<float>::ptr &btwn, FG_vector<float>::ptr &closeness,
+		unsigned seed, int max_batch_size)
+{
+	if (max_batch_size <= 0 || max_batch_size > MAX_BATCH_SIZE) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("The batch size has to be between 1 and %1%")
+			% MAX_BATCH_SIZE;
+		return;
+	}
+	directed_graph = fg->get_graph_header().is_directed_graph();
+	graph_index::ptr index = NUMA_graph_index<centrality_vertex>::create(
+			fg->get_graph_header());
+	graph_engine::ptr graph = fg->create_engine(index);
+
+	// Vertices without edges to follow don't reach other vertices, so they
+	// aren't sampled.
+	std::vector<vertex_id_t> sources;
+	for (vertex_id_t id = 0; id <= graph->get_max_vertex_id(); id++) {
+		if (graph->get_num_edges(id, directed_graph
+					? edge_type::OUT_EDGE : edge_type::BOTH_EDGES) > 0)
+			sources.push_back(id);
+	}
+	size_t num_candidates = sources.size();
+	if (num_samples > 0 && num_samples < num_candidates) {
+		std::mt19937 gen(seed);
+		std::shuffle(sources.begin(), sources.end(), gen);
+		sources.resize(num_samples);
+		// Vertices in nearby sources are close to each other in the batch.
+		std::sort(sources.begin(), sources.end());
+	}
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("Compute centrality from %1% of %2% sources")
+		% sources.size() % num_candidates;
+
+	// sigmas and deltas are dense arrays with an entry for each vertex and
+	// each source in a batch.
+	size_t bytes_per_source = (((size_t) graph->get_max_vertex_id()) + 1)
+		* sizeof(float) * 2;
+	size_t avail_mem = ((size_t) sysconf(_SC_AVPHYS_PAGES))
+		* sysconf(_SC_PAGESIZE);
+	size_t mem_batch_size = avail_mem / bytes_per_source;
+	if (mem_batch_size == 0) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("Centrality needs %1% bytes for a source, but only %2% bytes are available")
+			% bytes_per_source % avail_mem;
+		return;
+	}
+	if (mem_batch_size < (size_t) max_batch_size) {
+		BOOST_LOG_TRIVIAL(warning)
+			<< boost::format("Reduce the batch size from %1% to %2% to fit in memory")
+			% max_batch_size % mem_batch_size;
+		max_batch_size = mem_batch_size;
+	}
+
+#ifdef PROFILER
+	if (!graph_conf.get_prof_file().empty())
+		ProfilerStart(graph_conf.get_prof_file().c_str());
+#endif
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	for (size_t i = 0; i < sources.size(); i += max_batch_size) {
+		int num = std::min((size_t) max_batch_size, sources.size() - i);
+		run_batch(graph, sources.data() + i, num);
+	}
+	gettimeofday(&end, NULL);
+#ifdef PROFILER
+	if (!graph_conf.get_prof_file().empty())
+		ProfilerStop();
+#endif
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("It takes %1% seconds to run %2% batches")
+		% time_diff(start, end)
+		% ((sources.size() + max_batch_size - 1) / max_batch_size);
+	std::vector<float>().swap(sigmas);
+	std::vector<float>().swap(deltas);
+
+	float scale = 1;
+	if (!sources.empty())
+		scale = ((float) num_candidates) / sources.size();
+	// Each path in an undirected graph is counted from both of its ends.
+	if (!directed_graph)
+		scale /= 2;
+	btwn = FG_vector<float>::create(graph);
+	closeness = FG_vector<float>::create(graph);
+	graph->query_on_all(vertex_query::ptr(
+				new centrality_query(btwn, closeness, scale)));
+}
+
+}
@@ -19,6 +19,7 @@
 
 #include <set>
 #include <vector>
+#include <algorithm>
 
 #include "graph_engine.h"
 #include "graph_config.h"
@@ -28,8 +29,6 @@
 
 using namespace fg;
 
-const double BIN_SEARCH_RATIO = 100;
-
 size_t neighbor_list::count_edges_hash(const page_vertex *v,
 		edge_iterator other_it, edge_iterator other_end,
 		std::vector<vertex_id_t> *common_neighs) const
@@ -90,6 +89,11 @@ int neighbor_list::count_edges_bin_search_this(const page_vertex *v,
 }
 #endif
 
+/*
+ * Search for the neighbors of this vertex in the edge list of `v' with
+ * galloping. The edges in the list of `v' may be duplicated, and
+ * the duplicated edges are counted multiple times.
+ */
 size_t neighbor_list::count_edges_bin_search_other(const page_vertex *v,
 		neighbor_list::id_iterator this_it,
 		neighbor_list::id_iterator this_end,
@@ -97,39 +101,21 @@ size_t neighbor_list::count_edges_bin_search_other(const page_vertex *v,
 		std::vector<vertex_id_t> *common_neighs) const
 {
 	size_t num_local_edges = 0;
-
-	for (; this_it != this_end; this_it++) {
-		vertex_id_t this_neighbor = *this_it;
-		// We need to skip loops.
-		if (this_neighbor == v->get_id()
-				|| this_neighbor == this->get_id()) {
-			continue;
-		}
-
-		edge_iterator first = std::lower_bound(other_it, other_end,
-				this_neighbor);
-		// found it.
-		if (first != other_end && !(this_neighbor < *first)) {
-			int num_dups = 0;
-			do {
-#if 0
-				safs::page_byte_array::const_iterator<edge_count> data_it
-					= other_data_it;
-				data_it += first - other_it;
-				// Edges in the v's neighbor lists may duplicated.
-				// The duplicated neighbors need to be counted
-				// multiple times.
-				num_local_edges += (*data_it).get_count();
-				++data_it;
-#endif
-				num_dups++;
-				num_local_edges++;
-				++first;
-			} while (first != other_end && this_neighbor == *first);
-			if (common_neighs)
-				common_neighs->push_back(this_neighbor);
-		}
-	}
+	gallop_intersect(this_it, this_end, other_it, other_end,
+			[&](size_t i, size_t j) {
+				vertex_id_t this_neighbor = *(other_it + j);
+				// We need to skip loops.
+				if (this_neighbor == v->get_id()
+						|| this_neighbor == this->get_id())
+					return;
+				edge_iterator first = other_it + j;
+				do {
+					num_local_edges++;
+					++first;
+				} while (first != other_end && this_neighbor == *first);
+				if (common_neighs)
+					common_neighs->push_back(this_neighbor);
+			});
 	return num_local_edges;
 }
 
@@ -180,6 +166,42 @@ size_t neighbor_list::count_edges_scan(const page_vertex *v,
 	return num_local_edges;
 }
 
+/*
+ * Merge the first `num_this' neighbors of this vertex with the first
+ * `num_other' edges of `v' with SIMD instructions. The edges of `v' are
+ * copied to a contiguous buffer first. The SIMD code finds each common
+ * neighbor once, so we fall back to the scalar code if `v' has duplicated
+ * edges.
+ */
+size_t neighbor_list::count_edges_merge(const page_vertex *v, edge_type type,
+		size_t num_this, size_t num_other,
+		std::vector<vertex_id_t> *common_neighs) const
+{
+	neigh_buf.resize(v->get_num_edges(type));
+	v->read_edges(type, neigh_buf.data(), neigh_buf.size());
+	if (std::adjacent_find(neigh_buf.begin(), neigh_buf.begin() + num_other)
+			!= neigh_buf.begin() + num_other) {
+		neighbor_list::id_iterator this_end = this->get_id_begin();
+		this_end += num_this;
+		return count_edges_scan(v, this->get_id_begin(), this_end,
+				v->get_neigh_seq_it(type, 0, num_other), common_neighs);
+	}
+
+	idx_buf.resize(num_this);
+	size_t num = intersect_sorted(id_list.data(), num_this, neigh_buf.data(),
+			num_other, idx_buf.data());
+	size_t num_local_edges = 0;
+	for (size_t i = 0; i < num; i++) {
+		vertex_id_t neigh_neighbor = id_list[idx_buf[i]];
+		if (neigh_neighbor == v->get_id() || neigh_neighbor == this->get_id())
+			continue;
+		num_local_edges++;
+		if (common_neighs)
+			common_neighs->push_back(neigh_neighbor);
+	}
+	return num_local_edges;
+}
+
 size_t neighbor_list::count_edges(const page_vertex *v, edge_type type,
 		std::vector<vertex_id_t> *common_neighs) const
 {
@@ -206,7 +228,7 @@ size_t neighbor_list::count_edges(const page_vertex *v, edge_type type,
 	this_end = std::lower_bound(this_it, this_end,
 			v->get_id());
 
-	if (num_v_edges / this->size() > BIN_SEARCH_RATIO) {
+	if (num_v_edges > GALLOP_RATIO * this->size()) {
 #ifdef PV_STAT
 		int size_log2 = log2(num_v_edges);
 		scan_bytes += this->size() * sizeof(vertex_id_t);
@@ -227,8 +249,8 @@ size_t neighbor_list::count_edges(const page_vertex *v, edge_type type,
 		scan_bytes += num_v_edges * sizeof(vertex_id_t);
 		scan_bytes += this->size() * sizeof(vertex_id_t);
 #endif
-		return count_edges_scan(v, this_it, this_end,
-				v->get_neigh_seq_it(type, 0, num_v_edges), common_neighs);
+		return count_edges_merge(v, type, this_end - this_it, num_v_edges,
+				common_neighs);
 	}
 }
 
@@ -24,6 +24,7 @@
 
 #include "graphlab/cuckoo_set_pow2.hpp"
 #include "graph_engine.h"
+#include "set_intersect.h"
 
 /*
  * The edge has two attributes:
@@ -194,7 +195,14 @@ protected:
 	fg::vertex_id_t id;
 	std::vector<fg::vertex_id_t> id_list;
 	std::vector<int> num_dup_list;
+	// The neighbors are searched in a bitmap if they are dense in their
+	// range, or in a hash table otherwise.
+	fg::rank_bitmap neighbor_bitmap;
 	edge_set_t *neighbor_set;
+	// The buffers for intersecting the neighbor list with another one.
+	// A neighbor list is only used by the thread that runs the vertex.
+	mutable std::vector<fg::vertex_id_t> neigh_buf;
+	mutable std::vector<uint32_t> idx_buf;
 public:
 	class id_iterator: public std::iterator<std::random_access_iterator_tag, fg::vertex_id_t>
 	{
@@ -229,6 +237,11 @@ public:
 			return ret;
 		}
 
+		id_iterator &operator--() {
+			it--;
+			return *this;
+		}
+
 		bool operator==(const id_iterator &it) const {
 			return it.it == this->it;
 		}
@@ -254,7 +267,8 @@ public:
 			num_dup_list[i] = neighbors[i].get_num_dups();
 		}
 		neighbor_set = NULL;
-		if (num_neighbors > 0) {
+		if (num_neighbors > 0
+				&& !neighbor_bitmap.init(id_list.data(), num_neighbors)) {
 			neighbor_set = new edge_set_t(index_entry(),
 					0, 2 * neighbors.size());
 			for (size_t i = 0; i < neighbors.size(); i++)
@@ -271,9 +285,24 @@ public:
 		return id_list[idx];
 	}
 
-	bool contains(fg::vertex_id_t id) const {
+	/*
+	 * The location of a neighbor in the list, or -1 if it isn't a neighbor.
+	 */
+	off_t find_idx(fg::vertex_id_t id) const {
+		if (!neighbor_bitmap.empty())
+			return neighbor_bitmap.find(id);
 		edge_set_t::const_iterator it = neighbor_set->find(id);
-		return it != neighbor_set->end();
+		if (it == neighbor_set->end())
+			return -1;
+		else {
+			size_t idx = (*it).get_idx();
+			assert(idx < id_list.size());
+			return idx;
+		}
+	}
+
+	bool contains(fg::vertex_id_t id) const {
+		return find_idx(id) >= 0;
 	}
 
 	id_iterator get_id_begin() const {
@@ -327,6 +356,9 @@ public:
 			neighbor_list::id_iterator this_it,
 			neighbor_list::id_iterator this_end, fg::edge_seq_iterator other_it,
 			std::vector<fg::vertex_id_t> *common_neighs) const;
+	virtual size_t count_edges_merge(const fg::page_vertex *v,
+			fg::edge_type type, size_t num_this, size_t num_other,
+			std::vector<fg::vertex_id_t> *common_neighs) const;
 };
 
 /*
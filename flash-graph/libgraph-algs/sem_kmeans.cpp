@@ -38,7 +38,7 @@ namespace {
     static struct timeval start, end;
     static std::map<vertex_id_t, unsigned> g_init_hash; // Used for forgy init
     static unsigned  g_kmspp_cluster_idx; // Used for kmeans++ init
-    static unsigned g_kmspp_next_cluster; // Sample row selected as the next cluster
+    static vertex_id_t g_kmspp_next_cluster; // Sample row selected as the next cluster
     static std::vector<double> g_kmspp_distance; // Used for kmeans++ init
     static unsigned g_iter;
     static bool g_even_iter;
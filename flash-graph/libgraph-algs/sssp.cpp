@@ -0,0 +1,383 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef PROFILER
+#include <gperftools/profiler.h>
+#endif
+
+#include <limits>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include "graph_engine.h"
+#include "graph_config.h"
+#include "FG_vector.h"
+#include "FGlib.h"
+#include "bitmap.h"
+#include "save_result.h"
+
+using namespace fg;
+
+namespace
+{
+
+/*
+ * Single-source shortest paths with delta-stepping.
+ *
+ * Ulrich Meyer, Peter Sanders: Delta-stepping: a parallelizable shortest
+ * path algorithm, Journal of Algorithms, 2003.
+ *
+ * Vertices are put in buckets of distances of width delta, and
+ * the buckets are processed in increasing order, each in a separate run
+ * of the graph engine. In a run, a vertex in the bucket reads its edges
+ * and sends the new distances to its neighbors. A neighbor whose distance
+ * drops is activated in the next level of the run if it stays in
+ * the bucket. Otherwise, it's recorded and put in its bucket after
+ * the run. A small delta does little redundant work like Dijkstra's
+ * algorithm, and a large one has more parallelism like Bellman-Ford.
+ *
+ * The paper relaxes the light edges of a bucket repeatedly and the heavy
+ * edges once when the bucket is settled. Here a vertex relaxes all of its
+ * edges whenever it runs, so its edge list is only read once from SSDs
+ * for each distance it gets.
+ */
+
+edge_type traverse_edge = edge_type::OUT_EDGE;
+bool directed_graph;
+// The width of a bucket, which is delta in the paper.
+double bucket_width;
+// The bucket being processed in the current run of the graph engine.
+size_t curr_bucket;
+// The vertices whose distances drop to a later bucket.
+std::unique_ptr<thread_safe_bitmap> later_vertices;
+
+size_t get_bucket(double dist)
+{
+	return dist / bucket_width;
+}
+
+class dist_message: public vertex_message
+{
+	double dist;
+public:
+	dist_message(double dist, bool activate): vertex_message(
+			sizeof(dist_message), activate) {
+		this->dist = dist;
+	}
+
+	double get_value() const {
+		return dist;
+	}
+
+	void set_value(double dist) {
+		this->dist = dist;
+	}
+};
+
+template<class weight_type>
+class sssp_vertex: public compute_directed_vertex
+{
+	double dist;
+	// The distance when the vertex relaxed its edges last time.
+	double relaxed_dist;
+
+	void relax_edges(vertex_program &prog, const page_vertex &vertex,
+			edge_type type);
+public:
+	sssp_vertex(vertex_id_t id): compute_directed_vertex(id) {
+		dist = std::numeric_limits<double>::infinity();
+		relaxed_dist = std::numeric_limits<double>::infinity();
+	}
+
+	double get_dist() const {
+		return dist;
+	}
+
+	void set_dist(double dist) {
+		this->dist = dist;
+	}
+
+	/*
+	 * Whether the vertex needs to relax its edges with its current distance.
+	 */
+	bool need_relax() const {
+		return dist < relaxed_dist;
+	}
+
+	double get_result() const {
+		return dist;
+	}
+
+	void run(vertex_program &prog) {
+		// A message may activate the vertex without decreasing its distance.
+		if (!need_relax())
+			return;
+
+		vertex_id_t id = prog.get_vertex_id(*this);
+		if (!directed_graph)
+			request_vertices(&id, 1);
+		else {
+			directed_vertex_request req(id, traverse_edge);
+			request_partial_vertices(&req, 1);
+		}
+	}
+
+	void run(vertex_program &prog, const page_vertex &vertex) {
+		relaxed_dist = dist;
+		if (!directed_graph)
+			relax_edges(prog, vertex, edge_type::BOTH_EDGES);
+		else if (traverse_edge == edge_type::BOTH_EDGES) {
+			relax_edges(prog, vertex, edge_type::IN_EDGE);
+			relax_edges(prog, vertex, edge_type::OUT_EDGE);
+		}
+		else
+			relax_edges(prog, vertex, traverse_edge);
+	}
+
+	void run_on_message(vertex_program &prog, const vertex_message &msg) {
+		double new_dist = ((const dist_message &) msg).get_value();
+		if (new_dist >= dist)
+			return;
+		dist = new_dist;
+		// The message has activated the vertex if it's in the current bucket.
+		if (get_bucket(dist) != curr_bucket)
+			later_vertices->set(prog.get_vertex_id(*this));
+	}
+};
+
+/*
+ * Send the new distances to the neighbors whose distances drop. A vertex's
+ * distance only decreases, so we skip a neighbor if the distance we read
+ * is already shorter.
+ */
+template<class weight_type>
+void sssp_vertex<weight_type>::relax_edges(vertex_program &prog,
+		const page_vertex &vertex, edge_type type)
+{
+	graph_engine &graph = prog.get_graph();
+	edge_seq_iterator it = vertex.get_neigh_seq_it(type);
+	safs::page_byte_array::seq_const_iterator<weight_type> weight_it
+		= directed_graph
+		? ((const page_directed_vertex &) vertex).get_data_seq_it<weight_type>(
+				type)
+		: ((const page_undirected_vertex &) vertex).get_data_seq_it<
+		weight_type>();
+	while (it.has_next()) {
+		vertex_id_t neigh = it.next();
+		weight_type weight = weight_it.next();
+		assert(weight >= 0);
+		double new_dist = dist + weight;
+		if (((sssp_vertex &) graph.get_vertex(neigh)).get_dist() <= new_dist)
+			continue;
+		dist_message msg(new_dist, get_bucket(new_dist) == curr_bucket);
+		prog.send_msg(neigh, msg);
+	}
+}
+
+/*
+ * All edges have the weight of 1 when we don't use the edge data, so
+ * the neighbors get the same distance in one multicast message.
+ */
+template<>
+void sssp_vertex<empty_data>::relax_edges(vertex_program &prog,
+		const page_vertex &vertex, edge_type type)
+{
+	graph_engine &graph = prog.get_graph();
+	double new_dist = dist + 1;
+	std::vector<vertex_id_t> dests;
+	edge_seq_iterator it = vertex.get_neigh_seq_it(type);
+	while (it.has_next()) {
+		vertex_id_t neigh = it.next();
+		if (((sssp_vertex &) graph.get_vertex(neigh)).get_dist() > new_dist)
+			dests.push_back(neigh);
+	}
+	if (dests.empty())
+		return;
+	dist_message msg(new_dist, get_bucket(new_dist) == curr_bucket);
+	prog.multicast_msg(dests.data(), dests.size(), msg);
+}
+
+/*
+ * A worker thread processes the activated vertices in a level in
+ * the order of their distances, so the vertices with shorter distances
+ * relax their edges first and the others are less likely to relax their
+ * edges with distances that will drop later in the level. Vertices with
+ * the same distance stay in the order of their IDs, so their edge lists
+ * are still read sequentially.
+ */
+template<class vertex_type>
+class dist_scheduler: public vertex_scheduler
+{
+public:
+	void schedule(vertex_program &prog,
+			std::vector<compute_vertex_pointer> &vertices) {
+		struct comp_dist {
+			bool operator()(compute_vertex_pointer v1,
+					compute_vertex_pointer v2) const {
+				return ((vertex_type &) *v1).get_dist()
+					< ((vertex_type &) *v2).get_dist();
+			}
+		};
+		std::stable_sort(vertices.begin(), vertices.end(), comp_dist());
+	}
+};
+
+template<class vertex_type>
+class sssp_vertex_program_creater: public vertex_program_creater
+{
+public:
+	vertex_program::ptr create() const {
+		vertex_program::ptr prog(new vertex_program_impl<vertex_type>());
+		prog->set_message_combiner(create_min_combiner<dist_message>());
+		return prog;
+	}
+};
+
+template<class weight_type>
+FG_vector<double>::ptr run_sssp(FG_graph::ptr fg, vertex_id_t source)
+{
+	typedef sssp_vertex<weight_type> vertex_type;
+	graph_index::ptr index = NUMA_graph_index<vertex_type>::create(
+			fg->get_graph_header());
+	graph_engine::ptr graph = fg->create_engine(index);
+	if (source > graph->get_max_vertex_id()) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("invalid source vertex: %1%") % source;
+		return FG_vector<double>::ptr();
+	}
+	graph->set_vertex_scheduler(vertex_scheduler::ptr(
+				new dist_scheduler<vertex_type>()));
+	later_vertices = std::unique_ptr<thread_safe_bitmap>(
+			new thread_safe_bitmap(graph->get_max_vertex_id() + 1, 0));
+
+	BOOST_LOG_TRIVIAL(info) << boost::format("SSSP starts with delta %1%")
+		% bucket_width;
+#ifdef PROFILER
+	if (!graph_conf.get_prof_file().empty())
+		ProfilerStart(graph_conf.get_prof_file().c_str());
+#endif
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+
+	// The vertices in a bucket may have moved to an earlier bucket or have
+	// been processed, so they are filtered when the bucket is processed.
+	std::map<size_t, std::vector<vertex_id_t> > buckets;
+	std::vector<vertex_id_t> vertices(1, source);
+	std::vector<vertex_id_t> later;
+	((vertex_type &) graph->get_vertex(source)).set_dist(0);
+	curr_bucket = 0;
+	size_t num_buckets = 0;
+	while (!vertices.empty()) {
+		graph->start(vertices.data(), vertices.size(), vertex_initializer::ptr(),
+				vertex_program_creater::ptr(
+					new sssp_vertex_program_creater<vertex_type>()));
+		graph->wait4complete();
+		num_buckets++;
+
+		later.clear();
+		later_vertices->get_reset_set_bits(later);
+		BOOST_FOREACH(vertex_id_t id, later) {
+			vertex_type &v = (vertex_type &) graph->get_vertex(id);
+			buckets[get_bucket(v.get_dist())].push_back(id);
+		}
+
+		vertices.clear();
+		while (vertices.empty() && !buckets.empty()) {
+			curr_bucket = buckets.begin()->first;
+			BOOST_FOREACH(vertex_id_t id, buckets.begin()->second) {
+				vertex_type &v = (vertex_type &) graph->get_vertex(id);
+				if (v.need_relax() && get_bucket(v.get_dist()) == curr_bucket)
+					vertices.push_back(id);
+			}
+			buckets.erase(buckets.begin());
+		}
+		std::sort(vertices.begin(), vertices.end());
+		vertices.erase(std::unique(vertices.begin(), vertices.end()),
+				vertices.end());
+	}
+
+	gettimeofday(&end, NULL);
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("SSSP takes %1% seconds and processes %2% buckets")
+		% time_diff(start, end) % num_buckets;
+#ifdef PROFILER
+	if (!graph_conf.get_prof_file().empty())
+		ProfilerStop();
+#endif
+	later_vertices.reset();
+
+	FG_vector<double>::ptr vec = FG_vector<double>::create(graph);
+	graph->query_on_all(vertex_query::ptr(
+				new save_query<double, vertex_type>(vec)));
+	return vec;
+}
+
+}
+
+namespace fg
+{
+
+FG_vector<double>::ptr compute_sssp(FG_graph::ptr fg, vertex_id_t source,
+		edge_type traverse_e, double delta, const std::string &weight_type)
+{
+	if (delta <= 0) {
+		BOOST_LOG_TRIVIAL(error) << "delta has to be positive";
+		return FG_vector<double>::ptr();
+	}
+	bucket_width = delta;
+	directed_graph = fg->get_graph_header().is_directed_graph();
+	if (!directed_graph)
+		traverse_e = edge_type::BOTH_EDGES;
+	traverse_edge = traverse_e;
+
+	size_t weight_size = 0;
+	if (weight_type == "I")
+		weight_size = sizeof(int);
+	else if (weight_type == "L")
+		weight_size = sizeof(long);
+	else if (weight_type == "F")
+		weight_size = sizeof(float);
+	else if (weight_type == "D")
+		weight_size = sizeof(double);
+	else if (!weight_type.empty()) {
+		BOOST_LOG_TRIVIAL(error) << boost::format(
+				"unsupported edge weight type %1%") % weight_type;
+		return FG_vector<double>::ptr();
+	}
+	if (weight_size > 0
+			&& weight_size != (size_t) fg->get_graph_header().get_edge_data_size()) {
+		BOOST_LOG_TRIVIAL(error) << boost::format(
+				"the edge data of the graph isn't of type %1%") % weight_type;
+		return FG_vector<double>::ptr();
+	}
+
+	if (weight_type.empty())
+		return run_sssp<empty_data>(fg, source);
+	else if (weight_type == "I")
+		return run_sssp<int>(fg, source);
+	else if (weight_type == "L")
+		return run_sssp<long>(fg, source);
+	else if (weight_type == "F")
+		return run_sssp<float>(fg, source);
+	else
+		return run_sssp<double>(fg, source);
+}
+
+}
@@ -38,11 +38,61 @@ namespace {
 time_t timestamp;
 time_t time_interval = 1;
 int num_time_intervals = 1;
+// If the graph has a timestamp index, only the edges of the neighbors
+// in the time intervals are read.
+const ts_edge_index *ts_index;
 
-class scan_vertex: public compute_vertex
+/*
+ * The time intervals start from `timestamp' backward. They don't go
+ * before time 0.
+ */
+int get_num_valid_intervals()
+{
+	int num = 0;
+	for (int i = 0; i < num_time_intervals && timestamp >= i * time_interval;
+			i++)
+		num++;
+	return num;
+}
+
+/*
+ * The time range that covers all time intervals.
+ */
+time_t get_range_start()
+{
+	return timestamp - (get_num_valid_intervals() - 1) * time_interval;
+}
+
+time_t get_range_length()
+{
+	return timestamp + time_interval - get_range_start();
+}
+
+/*
+ * Get the neighbors of a vertex in a time interval. If the page vertex
+ * only has the edges in the time range of all intervals, the edges in
+ * the interval are located by the timestamp index.
+ */
+edge_seq_iterator get_ts_neighbors(const page_directed_vertex &v,
+		edge_type type, time_t time_start, time_t time_interval)
 {
-	// The number of vertices that have joined with the vertex.
+	if (!v.is_partial_list())
+		return get_ts_iterator(v, type, time_start, time_interval);
+
+	vsize_t range_start = ts_index->get_edge_range(v.get_id(), type,
+			get_range_start(), get_range_length()).first;
+	std::pair<vsize_t, vsize_t> range = ts_index->get_edge_range(v.get_id(),
+			type, time_start, time_interval);
+	return v.get_neigh_seq_it(type, range.first - range_start,
+			range.second - range_start);
+}
+
+class scan_vertex: public compute_directed_vertex
+{
+	// The number of edge lists that have joined with the vertex.
 	int num_joined;
+	// The number of edge lists of the neighbors requested by the vertex.
+	int num_requested;
 	// Local scan in its neighborhood in different timestamps.
 	std::vector<size_t> *local_scans;
 	// All neighbors (in both in-edges and out-edges)
@@ -52,8 +102,9 @@ class scan_vertex: public compute_vertex
 	// The final result.
 	double result;
 public:
-	scan_vertex(vertex_id_t id): compute_vertex(id) {
+	scan_vertex(vertex_id_t id): compute_directed_vertex(id) {
 		num_joined = 0;
+		num_requested = 0;
 		local_scans = NULL;
 		neighbors = NULL;
 	}
@@ -83,6 +134,8 @@ public:
 
 	void run_on_itself(vertex_program &prog, const page_directed_vertex &vertex);
 	void run_on_neighbor(vertex_program &prog, const page_directed_vertex &vertex);
+	void request_neighbor_ranges();
+	void compute_result();
 
 	void run_on_message(vertex_program &prog, const vertex_message &msg) {
 	}
@@ -93,7 +146,7 @@ size_t scan_vertex::count_edges(vertex_program &prog, const page_directed_vertex
 		time_t time_interval, edge_type type)
 {
 	size_t num_local_edges = 0;
-	edge_seq_iterator it = get_ts_iterator(v, type, timestamp, time_interval);
+	edge_seq_iterator it = get_ts_neighbors(v, type, timestamp, time_interval);
 	// If there are no edges in the time interval.
 	if (it.get_num_tot_entries() == 0)
 		return 0;
@@ -119,10 +172,15 @@ size_t scan_vertex::count_edges(vertex_program &prog, const page_directed_vertex
 		time_t time_interval)
 {
 	assert(!neighbors->empty());
-	return count_edges(prog, v, neighbors, timestamp, time_interval,
-			edge_type::IN_EDGE)
-		+ count_edges(prog, v, neighbors, timestamp, time_interval,
-				edge_type::OUT_EDGE);
+	// A neighbor may be read in two parts if its edges are read by ranges.
+	size_t num_local_edges = 0;
+	if (v.has_in_part())
+		num_local_edges += count_edges(prog, v, neighbors, timestamp,
+				time_interval, edge_type::IN_EDGE);
+	if (v.has_out_part())
+		num_local_edges += count_edges(prog, v, neighbors, timestamp,
+				time_interval, edge_type::OUT_EDGE);
+	return num_local_edges;
 }
 
 template<class InputIterator1, class InputIterator2, class Skipper,
@@ -279,7 +337,42 @@ void scan_vertex::run_on_itself(vertex_program &prog,
 		} PAGE_FOREACH_END
 	}
 
-	request_vertices(neighbors->data(), neighbors->size());
+	if (ts_index)
+		request_neighbor_ranges();
+	else {
+		num_requested = neighbors->size();
+		request_vertices(neighbors->data(), neighbors->size());
+	}
+}
+
+/*
+ * Request the edges of the neighbors in the time range of all intervals.
+ * The edge lists that aren't indexed are small, so they're read entirely.
+ */
+void scan_vertex::request_neighbor_ranges()
+{
+	std::vector<directed_vertex_request> reqs;
+	time_t range_start = get_range_start();
+	time_t range_len = get_range_length();
+	edge_type types[] = {edge_type::IN_EDGE, edge_type::OUT_EDGE};
+	BOOST_FOREACH(vertex_id_t id, *neighbors) {
+		BOOST_FOREACH(edge_type type, types) {
+			if (!ts_index->is_indexed(id, type)) {
+				reqs.push_back(directed_vertex_request(id, type));
+				continue;
+			}
+			std::pair<vsize_t, vsize_t> range = ts_index->get_edge_range(id,
+					type, range_start, range_len);
+			if (range.first < range.second)
+				reqs.push_back(directed_vertex_request(id, type,
+							range.first, range.second));
+		}
+	}
+	num_requested = reqs.size();
+	if (reqs.empty())
+		compute_result();
+	else
+		request_partial_vertices(reqs.data(), reqs.size());
 }
 
 void scan_vertex::run_on_neighbor(vertex_program &prog,
@@ -297,36 +390,40 @@ void scan_vertex::run_on_neighbor(vertex_program &prog,
 
 	// If we have seen all required neighbors, we have complete
 	// the computation. We can release the memory now.
-	if (num_joined == (int) neighbors->size()) {
-		double avg = 0;
-		if (num_time_intervals - 1 > 0) {
-			double sum = 0;
-			for (int i = 1; i < num_time_intervals; i++)
-				sum += local_scans->at(i);
-			avg = sum / (num_time_intervals - 1);
-		}
+	if (num_joined == num_requested)
+		compute_result();
+}
 
-		double deviation;
-		if (num_time_intervals - 1 <= 1)
-			deviation = 1;
-		else {
-			double sum = 0;
-			for (int i = 1; i < num_time_intervals; i++) {
-				sum += (local_scans->at(i)
-						- avg) * (local_scans->at(i) - avg);
-			}
-			sum = sum / (num_time_intervals - 2);
-			deviation = sqrt(sum);
-			if (deviation < 1)
-				deviation = 1;
-		}
-		result = (local_scans->at(0) - avg) / deviation;
+void scan_vertex::compute_result()
+{
+	double avg = 0;
+	if (num_time_intervals - 1 > 0) {
+		double sum = 0;
+		for (int i = 1; i < num_time_intervals; i++)
+			sum += local_scans->at(i);
+		avg = sum / (num_time_intervals - 1);
+	}
 
-		delete local_scans;
-		delete neighbors;
-		local_scans = NULL;
-		neighbors = NULL;
+	double deviation;
+	if (num_time_intervals - 1 <= 1)
+		deviation = 1;
+	else {
+		double sum = 0;
+		for (int i = 1; i < num_time_intervals; i++) {
+			sum += (local_scans->at(i)
+					- avg) * (local_scans->at(i) - avg);
+		}
+		sum = sum / (num_time_intervals - 2);
+		deviation = sqrt(sum);
+		if (deviation < 1)
+			deviation = 1;
 	}
+	result = (local_scans->at(0) - avg) / deviation;
+
+	delete local_scans;
+	delete neighbors;
+	local_scans = NULL;
+	neighbors = NULL;
 }
 
 }
@@ -342,6 +439,9 @@ FG_vector<float>::ptr compute_sstsg(FG_graph::ptr fg, time_t start_time,
 	timestamp = start_time;
 	time_interval = interval;
 	num_time_intervals = num_intervals;
+	ts_edge_index::ptr index_ptr = load_ts_index(fg->get_graph_header(),
+			get_range_start(), get_range_length());
+	ts_index = index_ptr.get();
 
 	graph_index::ptr index = NUMA_graph_index<scan_vertex>::create(
 			fg->get_graph_header());
@@ -368,6 +468,7 @@ FG_vector<float>::ptr compute_sstsg(FG_graph::ptr fg, time_t start_time,
 #endif
 	BOOST_LOG_TRIVIAL(info)
 			<< boost::format("It takes %1% seconds") % time_diff(start, end);
+	ts_index = NULL;
 
 	FG_vector<float>::ptr vec = FG_vector<float>::create(graph);
 	graph->query_on_all(vertex_query::ptr(new save_query<float, scan_vertex>(vec)));
@@ -24,13 +24,13 @@
 #include "graphlab/cuckoo_set_pow2.hpp"
 #include "FG_vector.h"
 #include "FGlib.h"
+#include "set_intersect.h"
 
 /*
  * This contains the data structures shared directed triangle counting
  * and undirected triangle counting.
  */
 
-const double BIN_SEARCH_RATIO = 100;
 const int HASH_SEARCH_RATIO = 16;
 const int hash_threshold = 1000;
 
@@ -107,24 +107,136 @@ struct runtime_data_t
 	size_t num_required;
 	size_t num_triangles;
 
+	// A large vertex searches the neighbors of its neighbors in a bitmap
+	// if its edges are dense in their range, or in a hash table otherwise.
+	fg::rank_bitmap edge_bitmap;
 	edge_set_t edge_set;
+	// The buffers for intersecting the edge list with a neighbor's.
+	std::vector<fg::vertex_id_t> neigh_buf;
+	std::vector<uint32_t> idx_buf;
+	// The edge list of a multigraph may have duplicates.
+	bool has_dup_edges;
 public:
 	runtime_data_t(size_t num_edges, size_t num_triangles): edge_set(
 				index_entry(), 0, 2 * num_edges) {
 		num_joined = 0;
+		has_dup_edges = false;
 		this->num_required = 0;
 		this->num_triangles = num_triangles;
 	}
 
 	void finalize_init() {
 		// We only build a hash table on large vertices
-		if (edges.size() > (size_t) hash_threshold)
+		if (edges.size() > (size_t) hash_threshold
+				&& !edge_bitmap.init(edges.data(), edges.size()))
 			for (size_t i = 0; i < edges.size(); i++)
 				edge_set.insert(index_entry(edges[i], i));
 		triangles.resize(edges.size());
+		has_dup_edges = std::adjacent_find(edges.begin(),
+				edges.end()) != edges.end();
 	}
+
+	off_t find_edge(fg::vertex_id_t id) const {
+		if (!edge_bitmap.empty())
+			return edge_bitmap.find(id);
+		edge_set_t::const_iterator it = edge_set.find(id);
+		if (it == edge_set.end())
+			return -1;
+		else
+			return (*it).get_idx();
+	}
+
+	size_t intersect_neighbors(const fg::page_vertex &v, fg::edge_type type,
+			size_t num_other, size_t num_this, fg::vertex_id_t this_id);
 };
 
+/*
+ * Intersect the first `num_this' edges in the edge list with the first
+ * `num_other' edges of the neighbor `v'. A common neighbor forms
+ * a triangle with this vertex and `v', so its triangle count is increased.
+ * The loops to `v' and this vertex are skipped.
+ *
+ * A large vertex looks up the edges of a small neighbor in its bitmap
+ * or hash table. If the neighbor has way more edges than this vertex,
+ * we search for the edges of this vertex in the neighbor's edge list with
+ * galloping, which doesn't read the whole list. Otherwise, the neighbor's
+ * edges are copied to a contiguous buffer and the two lists are merged
+ * with SIMD instructions. An edge list with duplicates is merged one edge
+ * at a time, so a duplicated edge only matches one edge of the neighbor.
+ */
+inline size_t runtime_data_t::intersect_neighbors(const fg::page_vertex &v,
+		fg::edge_type type, size_t num_other, size_t num_this,
+		fg::vertex_id_t this_id)
+{
+	size_t num_local_triangles = 0;
+	if (num_other == 0 || num_this == 0)
+		return 0;
+
+	if ((!edge_bitmap.empty() || edge_set.size() > 0)
+			&& edges.size() > HASH_SEARCH_RATIO * num_other) {
+		fg::edge_iterator other_it = v.get_neigh_begin(type);
+		fg::edge_iterator other_end = other_it + num_other;
+		for (; other_it != other_end; ++other_it) {
+			fg::vertex_id_t neigh_neighbor = *other_it;
+			off_t idx = find_edge(neigh_neighbor);
+			if (idx >= 0 && neigh_neighbor != v.get_id()
+					&& neigh_neighbor != this_id) {
+				num_local_triangles++;
+				triangles[idx]++;
+			}
+		}
+	}
+	else if (has_dup_edges) {
+		std::vector<fg::vertex_id_t>::const_iterator this_it = edges.cbegin();
+		std::vector<fg::vertex_id_t>::const_iterator this_end
+			= this_it + num_this;
+		fg::edge_seq_iterator other_it = v.get_neigh_seq_it(type, 0, num_other);
+		while (this_it != this_end && other_it.has_next()) {
+			fg::vertex_id_t this_neighbor = *this_it;
+			fg::vertex_id_t neigh_neighbor = other_it.curr();
+			if (this_neighbor == neigh_neighbor) {
+				// skip loop
+				if (neigh_neighbor != v.get_id() && neigh_neighbor != this_id) {
+					num_local_triangles++;
+					triangles[this_it - edges.cbegin()]++;
+				}
+				++this_it;
+				other_it.next();
+			}
+			else if (this_neighbor < neigh_neighbor)
+				++this_it;
+			else
+				other_it.next();
+		}
+	}
+	// If the neighbor vertex has way more edges than this vertex.
+	else if (num_other > fg::GALLOP_RATIO * num_this) {
+		fg::edge_iterator other_it = v.get_neigh_begin(type);
+		fg::gallop_intersect(edges.cbegin(), edges.cbegin() + num_this,
+				other_it, other_it + num_other, [&](size_t i, size_t j) {
+					if (edges[i] != v.get_id() && edges[i] != this_id) {
+						num_local_triangles++;
+						triangles[i]++;
+					}
+				});
+	}
+	else {
+		neigh_buf.resize(v.get_num_edges(type));
+		v.read_edges(type, neigh_buf.data(), neigh_buf.size());
+		idx_buf.resize(num_this);
+		size_t num = fg::intersect_sorted(edges.data(), num_this,
+				neigh_buf.data(), num_other, idx_buf.data());
+		for (size_t i = 0; i < num; i++) {
+			fg::vertex_id_t id = edges[idx_buf[i]];
+			if (id != v.get_id() && id != this_id) {
+				num_local_triangles++;
+				triangles[idx_buf[i]]++;
+			}
+		}
+	}
+	return num_local_triangles;
+}
+
 enum multi_func_flags
 {
 	NUM_TRIANGLES,
@@ -21,7 +21,9 @@
 #endif
 
 #include <vector>
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "graph_engine.h"
 #include "graph_config.h"
@@ -69,6 +71,17 @@ public:
 		return component_id;
 	}
 
+	/*
+	 * Set the state of the vertex from a previous result. The vertex
+	 * sends its component ID to its neighbors when it's activated only if
+	 * `updated' is true.
+	 */
+	void init(vertex_id_t component_id, bool empty, bool updated) {
+		this->component_id = component_id;
+		this->empty = empty;
+		this->updated = updated;
+	}
+
 	void run(vertex_program &prog) {
 		if (updated) {
 			vertex_id_t id = prog.get_vertex_id(*this);
@@ -199,6 +212,15 @@ public:
 		return component_id;
 	}
 
+	/*
+	 * The same as wcc_vertex::init.
+	 */
+	void init(vertex_id_t component_id, bool empty, bool updated) {
+		this->component_id = component_id;
+		this->empty = empty;
+		this->updated = updated;
+	}
+
 	void run(vertex_program &prog) {
 		if (updated) {
 			vertex_id_t id = prog.get_vertex_id(*this);
@@ -446,7 +468,7 @@ FG_vector<vertex_id_t>::ptr compute_cc(FG_graph::ptr fg)
 	return vec;
 }
 
-FG_vector<vertex_id_t>::ptr compute_wcc(FG_graph::ptr fg)
+static FG_vector<vertex_id_t>::ptr run_wcc(FG_graph::ptr fg, bool async)
 {
 	bool directed = fg->get_graph_header().is_directed_graph();
 	if (!directed) {
@@ -458,6 +480,7 @@ FG_vector<vertex_id_t>::ptr compute_wcc(FG_graph::ptr fg)
 	graph_index::ptr index = NUMA_graph_index<wcc_vertex>::create(
 			fg->get_graph_header());
 	graph_engine::ptr graph = fg->create_engine(index);
+	graph->set_async(async);
 	BOOST_LOG_TRIVIAL(info) << "weakly connected components starts";
 #ifdef PROFILER
 	if (!graph_conf.get_prof_file().empty())
@@ -489,6 +512,16 @@ FG_vector<vertex_id_t>::ptr compute_wcc(FG_graph::ptr fg)
 	return vec;
 }
 
+FG_vector<vertex_id_t>::ptr compute_wcc(FG_graph::ptr fg)
+{
+	return run_wcc(fg, false);
+}
+
+FG_vector<vertex_id_t>::ptr compute_async_wcc(FG_graph::ptr fg)
+{
+	return run_wcc(fg, true);
+}
+
 FG_vector<vertex_id_t>::ptr compute_sync_wcc(FG_graph::ptr fg)
 {
 	bool directed = fg->get_graph_header().is_directed_graph();
@@ -577,4 +610,98 @@ FG_vector<vertex_id_t>::ptr compute_ts_wcc(FG_graph::ptr fg,
 	return vec;
 }
 
+/*
+ * A component ID is the smallest vertex ID in the component. Adding edges
+ * only merges components, so the vertices in the old components keep their
+ * IDs and only the endpoints of the added edges send their IDs to start
+ * merging. Deleting an edge may split a component, so all vertices in
+ * the components with deleted edges restart from their own vertex IDs.
+ * It runs with wcc_vertex on a directed graph and with cc_vertex on
+ * an undirected graph.
+ */
+template<class vertex_type, class creater_type>
+static FG_vector<vertex_id_t>::ptr run_incremental_wcc(FG_graph::ptr fg,
+		FG_vector<vertex_id_t>::ptr prev, const edge_list_t &added,
+		const edge_list_t &deleted)
+{
+	size_t num_vertices = fg->get_graph_header().get_num_vertices();
+	assert(prev->get_size() == num_vertices);
+
+	graph_index::ptr index = NUMA_graph_index<vertex_type>::create(
+			fg->get_graph_header());
+	graph_engine::ptr graph = fg->create_engine(index);
+	BOOST_LOG_TRIVIAL(info) << "incremental weakly connected components starts";
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	std::unordered_set<vertex_id_t> split_comps;
+	for (size_t i = 0; i < deleted.size(); i++) {
+		split_comps.insert(prev->get(deleted[i].first));
+		split_comps.insert(prev->get(deleted[i].second));
+	}
+	split_comps.erase(INVALID_VERTEX_ID);
+
+	std::vector<vertex_id_t> start_vertices;
+	for (size_t i = 0; i < added.size(); i++) {
+		start_vertices.push_back(added[i].first);
+		start_vertices.push_back(added[i].second);
+	}
+#pragma omp parallel for
+	for (vertex_id_t id = 0; id < num_vertices; id++) {
+		vertex_id_t comp_id = prev->get(id);
+		vertex_type &v = (vertex_type &) graph->get_vertex(id);
+		if (comp_id == INVALID_VERTEX_ID)
+			v.init(id, true, true);
+		else if (split_comps.find(comp_id) != split_comps.end())
+			v.init(id, false, true);
+		else
+			v.init(comp_id, false, false);
+	}
+	if (!split_comps.empty()) {
+		for (vertex_id_t id = 0; id < num_vertices; id++)
+			if (split_comps.find(prev->get(id)) != split_comps.end())
+				start_vertices.push_back(id);
+	}
+	std::sort(start_vertices.begin(), start_vertices.end());
+	start_vertices.erase(std::unique(start_vertices.begin(),
+				start_vertices.end()), start_vertices.end());
+	// The endpoints of the added edges in the old components keep their
+	// component IDs, but they have to send them.
+	for (size_t i = 0; i < start_vertices.size(); i++) {
+		vertex_type &v = (vertex_type &) graph->get_vertex(start_vertices[i]);
+		v.init(v.get_component_id(), v.is_empty(*graph), true);
+	}
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("%1% components are split, %2% vertices start")
+		% split_comps.size() % start_vertices.size();
+
+	graph->start(start_vertices.data(), start_vertices.size(),
+			vertex_initializer::ptr(),
+			vertex_program_creater::ptr(new creater_type()));
+	graph->wait4complete();
+	gettimeofday(&end, NULL);
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("Incremental WCC takes %1% seconds in total")
+		% time_diff(start, end);
+
+	FG_vector<vertex_id_t>::ptr vec = FG_vector<vertex_id_t>::create(graph);
+	graph->query_on_all(vertex_query::ptr(
+				new save_query<vertex_id_t, vertex_type>(vec)));
+	return vec;
+}
+
+FG_vector<vertex_id_t>::ptr compute_incremental_wcc(FG_graph::ptr fg,
+		FG_vector<vertex_id_t>::ptr prev, const edge_list_t &added,
+		const edge_list_t &deleted)
+{
+	if (fg->get_graph_header().is_directed_graph())
+		return run_incremental_wcc<wcc_vertex,
+			   wcc_vertex_program_creater<wcc_vertex> >(fg, prev, added,
+					   deleted);
+	else
+		return run_incremental_wcc<cc_vertex,
+			   cc_vertex_program_creater<cc_vertex> >(fg, prev, added,
+					   deleted);
+}
+
 }
@@ -27,7 +27,6 @@ namespace fg
 load_balancer::load_balancer(graph_engine &_graph,
 		worker_thread &_owner): owner(_owner), graph(_graph)
 {
-	steal_thread_id = (owner.get_worker_id() + 1) % graph.get_num_threads();
 	// TODO can I have a better way to do it?
 	completed_stolen_vertices = (fifo_queue<vertex_id_t> *) malloc(
 			graph.get_num_threads() * sizeof(fifo_queue<vertex_id_t>));
@@ -36,6 +35,12 @@ load_balancer::load_balancer(graph_engine &_graph,
 				_owner.get_node_id(), 4096, true);
 	}
 	num_completed_stolen_vertices = 0;
+	seed = owner.get_worker_id();
+	num_steal_attempts = 0;
+	num_steals = 0;
+	num_stolen_vertices = 0;
+	in_tail = false;
+	tot_tail_time = 0;
 }
 
 load_balancer::~load_balancer()
@@ -45,6 +50,51 @@ load_balancer::~load_balancer()
 	free(completed_stolen_vertices);
 }
 
+/*
+ * Not all worker threads exist when the load balancer is created,
+ * so we find the threads to steal from when we steal for the first time.
+ */
+void load_balancer::init_steal_threads()
+{
+	for (int i = 0; i < graph.get_num_threads(); i++) {
+		if (i == owner.get_worker_id())
+			continue;
+		if (graph.get_thread(i)->get_node_id() == owner.get_node_id())
+			local_threads.push_back(i);
+		else
+			remote_threads.push_back(i);
+	}
+}
+
+/*
+ * Try the threads in the list, starting from a random one, so that
+ * the threads that run out of work don't all go after the same thread.
+ */
+int load_balancer::steal_from(const std::vector<int> &threads,
+		compute_vertex_pointer vertex_buf[], int buf_size)
+{
+	if (threads.empty())
+		return 0;
+
+	size_t start = rand_r(&seed) % threads.size();
+	for (size_t i = 0; i < threads.size(); i++) {
+		int steal_thread_id = threads[(start + i) % threads.size()];
+		worker_thread *t = graph.get_thread(steal_thread_id);
+		num_steal_attempts++;
+		int num = t->steal_activated_vertices(vertex_buf, buf_size);
+		if (num > 0) {
+			num_steals++;
+			num_stolen_vertices += num;
+			// Record the owner thread of the stolen vertices.
+			for (int j = 0; j < num; j++)
+				stolen_vertex_map.insert(vertex_map_t::value_type(
+							vertex_buf[j].get(), steal_thread_id));
+			return num;
+		}
+	}
+	return 0;
+}
+
 /**
  * This steals vertices from other threads. It tries to steal more vertices
  * than it can process, and the remaining vertices will be placed in its
@@ -53,27 +103,18 @@ load_balancer::~load_balancer()
 int load_balancer::steal_activated_vertices(compute_vertex_pointer vertex_buf[],
 		int buf_size)
 {
-	if (steal_thread_id == owner.get_worker_id())
-		steal_thread_id = (steal_thread_id + 1) % graph.get_num_threads();
-	int num_tries = 0;
-	int num;
-	do {
-		worker_thread *t = graph.get_thread(steal_thread_id);
-		num_tries++;
-
-		num = t->steal_activated_vertices(vertex_buf, buf_size);
-		// If we can't steal vertices from the thread, we should move
-		// to the next thread.
-		if (num == 0)
-			steal_thread_id = (steal_thread_id + 1) % graph.get_num_threads();
-		// If we have tried to steal vertices from all threads.
-	} while (num == 0 && num_tries < graph.get_num_threads());
-
-	// Record the owner thread of the stolen vertices.
-	for (int i = 0; i < num; i++)
-		stolen_vertex_map.insert(vertex_map_t::value_type(
-					vertex_buf[i].get(), steal_thread_id));
+	// We only get here when the owner thread has run out of its own
+	// activated vertices.
+	if (!in_tail) {
+		in_tail = true;
+		gettimeofday(&tail_start, NULL);
+	}
+	if (local_threads.empty() && remote_threads.empty())
+		init_steal_threads();
 
+	int num = steal_from(local_threads, vertex_buf, buf_size);
+	if (num == 0)
+		num = steal_from(remote_threads, vertex_buf, buf_size);
 	return num;
 }
 
@@ -132,6 +173,27 @@ void load_balancer::reset()
 	assert(num_completed_stolen_vertices == 0);
 }
 
+double load_balancer::end_level()
+{
+	double tail_time = 0;
+	if (in_tail) {
+		struct timeval curr;
+		gettimeofday(&curr, NULL);
+		tail_time = time_diff(tail_start, curr);
+		tot_tail_time += tail_time;
+	}
+	in_tail = false;
+	return tail_time;
+}
+
+void load_balancer::print_stat() const
+{
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("worker %1%: steal vertices %2% times in %3% attempts and get %4% vertices, %5% seconds in the tails of levels")
+		% owner.get_worker_id() % num_steals % num_steal_attempts
+		% num_stolen_vertices % tot_tail_time;
+}
+
 int load_balancer::get_stolen_vertex_part(const compute_vertex &v) const
 {
 	vertex_map_t::const_iterator it = stolen_vertex_map.find(&v);
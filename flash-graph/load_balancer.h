@@ -20,7 +20,10 @@
  * limitations under the License.
  */
 
+#include <sys/time.h>
+
 #include <unordered_map>
+#include <vector>
 
 #include "container.h"
 #include "vertex.h"
@@ -53,8 +56,25 @@ class load_balancer
 	// All vertices here need to be returned to their owner threads.
 	fifo_queue<vertex_id_t> *completed_stolen_vertices;
 	int num_completed_stolen_vertices;
-	// The thread where we should steal activated vertices from.
-	int steal_thread_id;
+	// The threads we can steal activated vertices from. We prefer
+	// the threads on the same NUMA node.
+	std::vector<int> local_threads;
+	std::vector<int> remote_threads;
+	unsigned int seed;
+
+	// The statistics of stealing.
+	size_t num_steal_attempts;
+	size_t num_steals;
+	size_t num_stolen_vertices;
+	// The tail of a level starts when the owner thread runs out of its own
+	// activated vertices.
+	bool in_tail;
+	struct timeval tail_start;
+	double tot_tail_time;
+
+	void init_steal_threads();
+	int steal_from(const std::vector<int> &threads,
+			compute_vertex_pointer vertices[], int num);
 public:
 	load_balancer(graph_engine &_graph, worker_thread &_owner);
 
@@ -74,6 +94,13 @@ public:
 	void process_completed_stolen_vertices();
 
 	void reset();
+
+	/*
+	 * This is invoked at the end of a level. It returns the length of
+	 * the tail of the level in seconds.
+	 */
+	double end_level();
+	void print_stat() const;
 };
 
 }
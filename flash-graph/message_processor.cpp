@@ -34,6 +34,9 @@ message_processor::message_processor(graph_engine &_graph,
 	if (graph_conf.use_serial_run())
 		steal_state = std::unique_ptr<steal_state_t>(new steal_state_t(graph, owner));
 	this->msg_alloc = msg_alloc;
+	num_recv_msgs = 0;
+	num_recv_bytes = 0;
+	num_delivered_msgs = 0;
 }
 
 void message_processor::buf_msg(vertex_message &vmsg)
@@ -104,6 +107,7 @@ void message_processor::process_multicast_msg(multicast_message &mmsg,
 	}
 
 	if (!check_steal) {
+		num_delivered_msgs += num_dests;
 		curr_vprog.run_on_multicast_message(mmsg);
 		if (mmsg.is_activate())
 			owner.activate_vertices(dest_list.get_dests(), num_dests);
@@ -118,6 +122,7 @@ void message_processor::process_multicast_msg(multicast_message &mmsg,
 		else {
 			compute_vertex &info = graph.get_vertex(owner.get_worker_id(), id);
 			curr_vprog.run_on_message(info, mmsg);
+			num_delivered_msgs++;
 		}
 		if (mmsg.is_activate())
 			owner.activate_vertex(id);
@@ -140,6 +145,7 @@ void message_processor::process_msg(message &msg, bool check_steal)
 		// We only need to check the first message. All messages are
 		// of the same type.
 		if (!check_steal && !v_msgs[0]->is_multicast()) {
+			num_delivered_msgs += num;
 			curr_vprog.run_on_messages((const vertex_message **) v_msgs, num);
 			for (int i = 0; i < num; i++) {
 				local_vid_t id = v_msgs[i]->get_dest();
@@ -166,6 +172,7 @@ void message_processor::process_msg(message &msg, bool check_steal)
 			else {
 				compute_vertex &info = graph.get_vertex(owner.get_worker_id(), id);
 				curr_vprog.run_on_message(info, *v_msgs[i]);
+				num_delivered_msgs++;
 			}
 			if (v_msgs[i]->is_activate())
 				owner.activate_vertex(id);
@@ -173,6 +180,133 @@ void message_processor::process_msg(message &msg, bool check_steal)
 	}
 }
 
+/*
+ * This merges the point-to-point messages to the same vertex in
+ * the combined buffer. Multicast messages are already compact, so they
+ * are delivered to vertices directly.
+ */
+void message_processor::combine_msg(message &msg,
+		const message_combiner &combiner)
+{
+	const int VMSG_BUF_SIZE = 128;
+	vertex_message *v_msgs[VMSG_BUF_SIZE];
+	while (!msg.is_empty()) {
+		int num = msg.get_next(v_msgs, VMSG_BUF_SIZE);
+		assert(num > 0);
+		if (v_msgs[0]->is_multicast()) {
+			for (int i = 0; i < num; i++)
+				process_multicast_msg(*multicast_message::cast2multicast(
+							v_msgs[i]), false);
+			continue;
+		}
+
+		for (int i = 0; i < num; i++) {
+			vertex_message &vmsg = *v_msgs[i];
+			assert(vmsg.get_serialized_size() == combiner.get_msg_size());
+			local_id_t dest = vmsg.get_dest().id;
+			auto it = combined_locs.find(dest);
+			if (it != combined_locs.end()) {
+				vertex_message &combined
+					= *(vertex_message *) &combined_buf[it->second];
+				if (combined.is_activate() == vmsg.is_activate()) {
+					combiner.combine(combined, vmsg);
+					continue;
+				}
+			}
+			size_t off = combined_buf.size();
+			combined_buf.resize(off + vmsg.get_serialized_size());
+			vmsg.serialize(&combined_buf[off], vmsg.get_serialized_size());
+			combined_locs[dest] = off;
+		}
+	}
+}
+
+void message_processor::deliver_combined_msgs()
+{
+	for (size_t off = 0; off < combined_buf.size();) {
+		const vertex_message *vmsg = (const vertex_message *) &combined_buf[off];
+		p2p_msgs.push_back(vmsg);
+		off += vmsg->get_serialized_size();
+	}
+	deliver_p2p_msgs();
+	combined_locs.clear();
+	combined_buf.clear();
+}
+
+/*
+ * This collects the point-to-point messages in a message buffer, so they
+ * can be delivered together with the messages in other buffers.
+ * Multicast messages are delivered directly because their destinations
+ * are already sorted.
+ */
+void message_processor::collect_msg(message &msg)
+{
+	const int VMSG_BUF_SIZE = 128;
+	vertex_message *v_msgs[VMSG_BUF_SIZE];
+	while (!msg.is_empty()) {
+		int num = msg.get_next(v_msgs, VMSG_BUF_SIZE);
+		assert(num > 0);
+		if (v_msgs[0]->is_multicast()) {
+			for (int i = 0; i < num; i++)
+				process_multicast_msg(*multicast_message::cast2multicast(
+							v_msgs[i]), false);
+			continue;
+		}
+		p2p_msgs.insert(p2p_msgs.end(), v_msgs, v_msgs + num);
+	}
+}
+
+/*
+ * Messages arrive in random order of their destinations. We group them
+ * by the blocks of their destination vertices with a counting sort, so
+ * a block of vertex state stays in the CPU cache while its messages are
+ * delivered.
+ */
+void message_processor::sort_msgs_by_block()
+{
+	int block_size_log = graph_conf.get_msg_block_size_log();
+	block_offs.clear();
+	for (size_t i = 0; i < p2p_msgs.size(); i++) {
+		size_t block_id = ((size_t) p2p_msgs[i]->get_dest().id) >> block_size_log;
+		if (block_id >= block_offs.size())
+			block_offs.resize(block_id + 1);
+		block_offs[block_id]++;
+	}
+	// All messages are in the same block.
+	if (block_offs.size() <= 1)
+		return;
+
+	size_t off = 0;
+	for (size_t i = 0; i < block_offs.size(); i++) {
+		size_t num = block_offs[i];
+		block_offs[i] = off;
+		off += num;
+	}
+	sorted_msgs.resize(p2p_msgs.size());
+	for (size_t i = 0; i < p2p_msgs.size(); i++) {
+		size_t block_id = ((size_t) p2p_msgs[i]->get_dest().id) >> block_size_log;
+		sorted_msgs[block_offs[block_id]++] = p2p_msgs[i];
+	}
+	p2p_msgs.swap(sorted_msgs);
+}
+
+void message_processor::deliver_p2p_msgs()
+{
+	if (p2p_msgs.empty())
+		return;
+
+	worker_thread *t = (worker_thread *) thread::get_curr_thread();
+	vertex_program &curr_vprog = t->get_vertex_program(false);
+	sort_msgs_by_block();
+	curr_vprog.run_on_messages(p2p_msgs.data(), p2p_msgs.size());
+	for (size_t i = 0; i < p2p_msgs.size(); i++) {
+		if (p2p_msgs[i]->is_activate())
+			owner.activate_vertex(p2p_msgs[i]->get_dest());
+	}
+	num_delivered_msgs += p2p_msgs.size();
+	p2p_msgs.clear();
+}
+
 void message_processor::process_msgs()
 {
 	if (steal_state && steal_state->get_num_returned() > 0 && !stolenv_msgs.is_empty()) {
@@ -189,18 +323,39 @@ void message_processor::process_msgs()
 			process_msg(msgs[i], true);
 	}
 
-	const int MSG_BUF_SIZE = 16;
+	// We fetch more message buffers at once, so there are more messages
+	// to each block of vertices when they are delivered.
+	const int MSG_BUF_SIZE = 64;
 	message msgs[MSG_BUF_SIZE];
 	bool check_steal = false;
 	if (steal_state) {
 		steal_state->guard_msg_processing();
 		check_steal = steal_state->steal_mode_enabled();
 	}
+	// We can only merge messages when no vertices are stolen. Otherwise,
+	// some messages have to be buffered for the stolen vertices.
+	const message_combiner *combiner = owner.get_vertex_program(
+			false).get_message_combiner();
+	if (check_steal)
+		combiner = NULL;
 	while (!msg_q.is_empty()) {
 		int num_fetched = msg_q.fetch(msgs, MSG_BUF_SIZE);
-		for (int i = 0; i < num_fetched; i++)
-			process_msg(msgs[i], check_steal);
+		for (int i = 0; i < num_fetched; i++) {
+			num_recv_msgs += msgs[i].get_num_objs();
+			num_recv_bytes += msgs[i].get_data_size();
+			if (combiner)
+				combine_msg(msgs[i], *combiner);
+			else if (!check_steal)
+				collect_msg(msgs[i]);
+			else
+				process_msg(msgs[i], check_steal);
+		}
+		// The collected messages point to the fetched message buffers, so
+		// we have to deliver them before fetching more.
+		deliver_p2p_msgs();
 	}
+	if (combiner)
+		deliver_combined_msgs();
 	if (steal_state)
 		steal_state->unguard_msg_processing();
 }
@@ -219,6 +374,17 @@ void message_processor::reset()
 	assert(stolenv_msgs.is_empty());
 }
 
+void message_processor::get_msg_stat(size_t &num_recv_msgs,
+		size_t &num_recv_bytes, size_t &num_delivered_msgs)
+{
+	num_recv_msgs = this->num_recv_msgs;
+	num_recv_bytes = this->num_recv_bytes;
+	num_delivered_msgs = this->num_delivered_msgs;
+	this->num_recv_msgs = 0;
+	this->num_recv_bytes = 0;
+	this->num_delivered_msgs = 0;
+}
+
 void message_processor::return_vertices(vertex_id_t ids[], int num)
 {
 	if (steal_state)
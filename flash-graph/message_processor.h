@@ -21,6 +21,8 @@
  */
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "container.h"
 
@@ -59,11 +61,33 @@ class message_processor
 	// have been stolen by other threads.
 	fifo_queue<message> stolenv_msgs;
 
+	// The point-to-point messages merged by the combiner of the vertex
+	// program before they are delivered to vertices. The map locates
+	// the message of a vertex in the buffer.
+	std::vector<char> combined_buf;
+	std::unordered_map<local_id_t, size_t> combined_locs;
+
+	// The point-to-point messages to be delivered to vertices. They are
+	// grouped by the blocks of their destination vertices first.
+	std::vector<const vertex_message *> p2p_msgs;
+	std::vector<const vertex_message *> sorted_msgs;
+	std::vector<size_t> block_offs;
+
+	// The statistics of messaging.
+	size_t num_recv_msgs;
+	size_t num_recv_bytes;
+	size_t num_delivered_msgs;
+
 	void buf_msg(vertex_message &msg);
 	void buf_mmsg(local_vid_t id, multicast_message &mmsg);
 
 	void process_msg(message &msg, bool check_steal);
 	void process_multicast_msg(multicast_message &mmsg, bool check_steal);
+	void combine_msg(message &msg, const message_combiner &combiner);
+	void deliver_combined_msgs();
+	void collect_msg(message &msg);
+	void sort_msgs_by_block();
+	void deliver_p2p_msgs();
 
 public:
 	message_processor(graph_engine &_graph, worker_thread &_owner,
@@ -79,6 +103,14 @@ public:
 	}
 
 	void reset();
+
+	/*
+	 * This gets the number of messages and bytes received by the thread and
+	 * the number of messages delivered to vertices since it was invoked
+	 * last time.
+	 */
+	void get_msg_stat(size_t &num_recv_msgs, size_t &num_recv_bytes,
+			size_t &num_delivered_msgs);
 };
 
 }
@@ -22,6 +22,34 @@
 namespace fg
 {
 
+int simple_msg_sender::send_combined(vertex_message &msg)
+{
+	assert(combiner);
+	assert(!msg.is_multicast());
+	// Messages don't carry their type. We can only check that the message
+	// has the size of the combiner's message type.
+	assert(msg.get_serialized_size() == combiner->get_msg_size());
+	local_id_t dest = msg.get_dest().id;
+	auto it = combined_msgs.find(dest);
+	// Messages that also activate the destination are only merged with
+	// each other.
+	if (it != combined_msgs.end()
+			&& it->second->is_activate() == msg.is_activate()) {
+		combiner->combine(*it->second, msg);
+		return 1;
+	}
+
+	num_objs++;
+	vertex_message *ret = buf.add(msg);
+	if (ret == NULL) {
+		flush();
+		ret = buf.add(msg);
+		assert(ret != NULL);
+	}
+	combined_msgs[dest] = ret;
+	return 1;
+}
+
 int multicast_msg_sender::flush()
 {
 	if (buf.is_empty()) {
@@ -20,6 +20,8 @@
  * limitations under the License.
  */
 
+#include <unordered_map>
+
 #include "slab_allocator.h"
 
 #include "vertex.h"
@@ -108,6 +110,13 @@ public:
 		return size() - curr_add_off;
 	}
 
+	/**
+	 * The number of bytes of the remaining objects in the message.
+	 */
+	int get_data_size() const {
+		return curr_add_off - curr_get_off;
+	}
+
 	template<class T>
 	int get_next(T *objs[], int num) {
 		int i;
@@ -218,12 +227,19 @@ public:
 	}
 };
 
+class vertex_message;
+class message_combiner;
+
 class simple_msg_sender
 {
 	std::shared_ptr<slab_allocator> alloc;
 	message buf;
 	msg_queue *queue;
 	int num_objs;
+	// If a combiner is set, the messages to the same vertex are merged in
+	// the buffer. The map locates the message of a vertex in the buffer.
+	const message_combiner *combiner;
+	std::unordered_map<local_id_t, vertex_message *> combined_msgs;
 
 protected:
 	/**
@@ -234,6 +250,7 @@ protected:
 		this->alloc = alloc;
 		this->queue = queue;
 		num_objs = 0;
+		combiner = NULL;
 	}
 
 public:
@@ -249,6 +266,7 @@ public:
 
 	int flush() {
 		num_objs = 0;
+		combined_msgs.clear();
 		if (buf.is_empty()) {
 			return 0;
 		}
@@ -280,6 +298,17 @@ public:
 		return 1;
 	}
 
+	void set_combiner(const message_combiner *combiner) {
+		this->combiner = combiner;
+		combined_msgs.clear();
+	}
+
+	/**
+	 * This sends a vertex message and merges it with the message to
+	 * the same vertex in the buffer if there is one.
+	 */
+	int send_combined(vertex_message &msg);
+
 	msg_queue *get_queue() const {
 		return queue;
 	}
@@ -301,7 +330,7 @@ protected:
 	unsigned flush: 1;
 	unsigned size: 28;
 	union {
-		vertex_id_t dest;
+		local_id_t dest;
 		int num_dests;
 	} u;
 public:
@@ -369,7 +398,7 @@ class multicast_message;
 class multicast_dest_list
 {
 	multicast_message *msg;
-	vertex_id_t *dest_list;
+	local_id_t *dest_list;
 public:
 	multicast_dest_list() {
 		msg = NULL;
@@ -393,16 +422,16 @@ public:
 
 class multicast_message: public vertex_message
 {
-	const vertex_id_t *get_dest_begin() const {
-		return (vertex_id_t *) (((char *) this) + get_orig_msg_size());
+	const local_id_t *get_dest_begin() const {
+		return (local_id_t *) (((char *) this) + get_orig_msg_size());
 	}
 
-	vertex_id_t *get_dest_begin() {
-		return (vertex_id_t *) (((char *) this) + get_orig_msg_size());
+	local_id_t *get_dest_begin() {
+		return (local_id_t *) (((char *) this) + get_orig_msg_size());
 	}
 
 	int get_orig_msg_size() const {
-		return size - u.num_dests * sizeof(vertex_id_t);
+		return size - u.num_dests * sizeof(local_id_t);
 	}
 public:
 	static multicast_message *convert2multicast(vertex_message *msg) {
@@ -450,7 +479,7 @@ public:
 	 * of vertex_message.
 	 */
 	int get_body_size() const {
-		return get_serialized_size() - get_num_dests() * sizeof(vertex_id_t);
+		return get_serialized_size() - get_num_dests() * sizeof(local_id_t);
 	}
 
 	friend class multicast_dest_list;
@@ -464,6 +493,117 @@ public:
 	}
 };
 
+/**
+ * \brief A message combiner merges the messages sent to the same vertex
+ * into a single message, so fewer messages are buffered, sent and
+ * processed. It can only be used if a vertex only needs the combined value
+ * of the messages it receives in an iteration, e.g., the sum of PageRank
+ * contributions or the minimal distance in SSSP.
+ *
+ * A combiner works on a single message type. Messages don't carry their
+ * type, so the graph engine can't tell apart two message types of the same
+ * size. A vertex program with a combiner must send only messages of
+ * the combiner's type with point-to-point messaging.
+ */
+class message_combiner
+{
+public:
+	typedef std::shared_ptr<message_combiner> ptr;
+
+	virtual ~message_combiner() {
+	}
+
+	/**
+	 * \brief Merge a message into another one. Both messages are sent to
+	 * the same vertex and have the same type.
+	 * \param combined The message that keeps the combined value.
+	 * \param msg The message to be merged.
+	 */
+	virtual void combine(vertex_message &combined,
+			const vertex_message &msg) const = 0;
+
+	/**
+	 * \brief Get the size of the message type that the combiner merges.
+	 * \return The size of a message in bytes.
+	 */
+	virtual int get_msg_size() const = 0;
+};
+
+/**
+ * \brief The combiner implementation for a message type. `Op' merges two
+ * messages of the type, so users can define a custom combiner with their
+ * own `Op'.
+ */
+template<class MessageType, class Op>
+class message_combiner_impl: public message_combiner
+{
+	Op op;
+public:
+	virtual void combine(vertex_message &combined,
+			const vertex_message &msg) const {
+		op((MessageType &) combined, (const MessageType &) msg);
+	}
+
+	virtual int get_msg_size() const {
+		return sizeof(MessageType);
+	}
+};
+
+/*
+ * The common combine operations. They require the message type to have
+ * get_value() and set_value().
+ */
+
+template<class MessageType>
+struct sum_combine
+{
+	void operator()(MessageType &combined, const MessageType &msg) const {
+		combined.set_value(combined.get_value() + msg.get_value());
+	}
+};
+
+template<class MessageType>
+struct min_combine
+{
+	void operator()(MessageType &combined, const MessageType &msg) const {
+		if (msg.get_value() < combined.get_value())
+			combined.set_value(msg.get_value());
+	}
+};
+
+template<class MessageType>
+struct max_combine
+{
+	void operator()(MessageType &combined, const MessageType &msg) const {
+		if (msg.get_value() > combined.get_value())
+			combined.set_value(msg.get_value());
+	}
+};
+
+template<class MessageType, class Op>
+message_combiner::ptr create_message_combiner()
+{
+	return message_combiner::ptr(new message_combiner_impl<MessageType, Op>());
+}
+
+template<class MessageType>
+message_combiner::ptr create_sum_combiner()
+{
+	return create_message_combiner<MessageType, sum_combine<MessageType> >();
+}
+
+template<class MessageType>
+message_combiner::ptr create_min_combiner()
+{
+	return create_message_combiner<MessageType, min_combine<MessageType> >();
+}
+
+template<class MessageType>
+message_combiner::ptr create_max_combiner()
+{
+	return create_message_combiner<MessageType, max_combine<MessageType> >();
+}
+
 inline multicast_dest_list::multicast_dest_list(multicast_message *msg)
 {
 	this->msg = msg;
@@ -549,6 +689,13 @@ public:
 
 	bool add_dest(local_vid_t id);
 
+	/*
+	 * The number of destinations of the multicast message in the buffer.
+	 */
+	int get_num_dests() const {
+		return num_dests;
+	}
+
 	void end_multicast() {
 		if (num_dests == 0) {
 			multicast_message *mmsg_template
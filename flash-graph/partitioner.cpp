@@ -17,8 +17,15 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <boost/format.hpp>
+
 #include "partitioner.h"
 #include "graph_config.h"
+#include "graph_exception.h"
 
 namespace fg
 {
@@ -154,4 +161,131 @@ size_t range_graph_partitioner::map2loc(edge_seq_iterator &it,
 	return ret;
 }
 
+namespace
+{
+
+const int64_t PART_MAGIC_NUMBER = 0x7061727469746e31L;
+
+/*
+ * The header of a partition file. It's followed by the partition ID of
+ * each vertex in 32 bits.
+ */
+struct part_header
+{
+	int64_t magic_number;
+	uint32_t num_parts;
+	uint32_t unused;
+	uint64_t num_vertices;
+};
+
+}
+
+map_graph_partitioner::map_graph_partitioner(const std::vector<int> &part_ids,
+		int num_parts)
+{
+	this->num_parts = num_parts;
+	locs.resize(part_ids.size());
+	part_vertices.resize(num_parts);
+	for (size_t id = 0; id < part_ids.size(); id++) {
+		int part_id = part_ids[id];
+		if (part_id < 0 || part_id >= num_parts)
+			throw wrong_format(boost::str(boost::format(
+							"vertex %1% is in an invalid partition %2%")
+						% id % part_id));
+		// Local IDs are 32 bits.
+		if (part_vertices[part_id].size() >= MAX_LOCAL_ID)
+			throw wrong_format(boost::str(boost::format(
+							"partition %1% has too many vertices") % part_id));
+		locs[id] = vertex_loc_t(part_id,
+				local_vid_t(part_vertices[part_id].size()));
+		part_vertices[part_id].push_back(id);
+	}
+}
+
+map_graph_partitioner::ptr map_graph_partitioner::load(
+		const std::string &file)
+{
+	FILE *f = fopen(file.c_str(), "r");
+	if (f == NULL)
+		throw wrong_format(boost::str(boost::format("can't open %1%")
+					% file));
+	part_header header;
+	if (fread(&header, sizeof(header), 1, f) != 1
+			|| header.magic_number != PART_MAGIC_NUMBER) {
+		fclose(f);
+		throw wrong_format(boost::str(boost::format(
+						"%1% isn't a partition file") % file));
+	}
+	std::vector<uint32_t> buf(header.num_vertices);
+	size_t ret = fread(buf.data(), sizeof(buf[0]), buf.size(), f);
+	fclose(f);
+	if (ret != buf.size())
+		throw wrong_format(boost::str(boost::format(
+						"%1% is truncated") % file));
+	std::vector<int> part_ids(buf.begin(), buf.end());
+	return ptr(new map_graph_partitioner(part_ids, header.num_parts));
+}
+
+void map_graph_partitioner::dump(const std::string &file) const
+{
+	part_header header;
+	header.magic_number = PART_MAGIC_NUMBER;
+	header.num_parts = num_parts;
+	header.unused = 0;
+	header.num_vertices = locs.size();
+	std::vector<uint32_t> buf(locs.size());
+	for (size_t i = 0; i < locs.size(); i++)
+		buf[i] = locs[i].first;
+	FILE *f = fopen(file.c_str(), "w");
+	if (f == NULL)
+		ABORT_MSG(boost::format("fail to open %1%: %2%")
+				% file % strerror(errno));
+	BOOST_VERIFY(fwrite(&header, sizeof(header), 1, f) == 1);
+	BOOST_VERIFY(fwrite(buf.data(), sizeof(buf[0]), buf.size(), f)
+			== buf.size());
+	fclose(f);
+}
+
+size_t map_graph_partitioner::get_all_vertices_in_part(int part_id,
+		size_t tot_num_vertices, std::vector<vertex_id_t> &ids) const
+{
+	assert(tot_num_vertices == locs.size());
+	ids.insert(ids.end(), part_vertices[part_id].begin(),
+			part_vertices[part_id].end());
+	return ids.size();
+}
+
+void map_graph_partitioner::map2loc(vertex_id_t ids[], int num,
+		std::vector<local_vid_t> locs[], int num_parts) const
+{
+	assert(num_parts <= this->num_parts);
+	for (int i = 0; i < num; i++) {
+		const vertex_loc_t &loc = this->locs[ids[i]];
+		locs[loc.first].push_back(loc.second);
+	}
+}
+
+void map_graph_partitioner::map2loc(edge_seq_iterator &it,
+		std::vector<local_vid_t> locs[], int num_parts) const
+{
+	assert(num_parts <= this->num_parts);
+	PAGE_FOREACH(vertex_id_t, id, it) {
+		const vertex_loc_t &loc = this->locs[id];
+		locs[loc.first].push_back(loc.second);
+	} PAGE_FOREACH_END
+}
+
+size_t map_graph_partitioner::map2loc(edge_seq_iterator &it,
+		vertex_loc_t locs[], size_t num) const
+{
+	size_t ret = 0;
+	PAGE_FOREACH(vertex_id_t, id, it) {
+		if ((size_t) page_foreach_idx == num)
+			break;
+		locs[page_foreach_idx] = this->locs[id];
+		ret++;
+	} PAGE_FOREACH_END
+	return ret;
+}
+
 }
@@ -22,27 +22,45 @@
 
 #include <math.h>
 
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "vertex.h"
 
 namespace fg
 {
 
+/*
+ * A local vertex ID is always 32 bits, even if FlashGraph is compiled with
+ * 64-bit vertex IDs. Local IDs are what vertex messages and multicast
+ * destination lists carry, so messages don't grow with the vertex ID size.
+ * As a result, a partition can have at most MAX_LOCAL_ID vertices.
+ */
+typedef uint32_t local_id_t;
+const local_id_t MAX_LOCAL_ID = UINT32_MAX;
+const local_id_t INVALID_LOCAL_ID = -1;
+
 /**
  * This data structure represents the local Id of a vertex used
  * in its own partition.
  */
 struct local_vid_t
 {
-	vertex_id_t id;
+	local_id_t id;
 
 	local_vid_t() {
-		id = INVALID_VERTEX_ID;
+		id = INVALID_LOCAL_ID;
 	}
 
 	explicit local_vid_t(vertex_id_t id) {
 		this->id = id;
+		assert(id == INVALID_VERTEX_ID || this->id == id);
+	}
+
+	bool is_valid() const {
+		return id != INVALID_LOCAL_ID;
 	}
 };
 
@@ -176,6 +194,74 @@ public:
 	}
 };
 
+/*
+ * This partitioner assigns vertices to partitions with an explicit mapping,
+ * which is computed by `partition-graph' to reduce the number of edges
+ * between partitions. The vertices in a partition are ordered by their IDs,
+ * so a worker thread still accesses its vertices in the order in which
+ * they are stored.
+ */
+class map_graph_partitioner: public graph_partitioner
+{
+	int num_parts;
+	// The partition and the location in the partition of each vertex.
+	std::vector<vertex_loc_t> locs;
+	// The vertices in each partition.
+	std::vector<std::vector<vertex_id_t> > part_vertices;
+public:
+	typedef std::unique_ptr<map_graph_partitioner> ptr;
+
+	/*
+	 * `part_ids' contains the partition of each vertex.
+	 */
+	map_graph_partitioner(const std::vector<int> &part_ids, int num_parts);
+
+	/*
+	 * Load the mapping from a file in the Linux filesystem.
+	 */
+	static ptr load(const std::string &file);
+	/*
+	 * Write the mapping to a file in the Linux filesystem.
+	 */
+	void dump(const std::string &file) const;
+
+	size_t get_num_vertices() const {
+		return locs.size();
+	}
+
+	int get_num_partitions() const {
+		return num_parts;
+	}
+
+	virtual int map(vertex_id_t id) const {
+		return locs[id].first;
+	}
+
+	virtual void map2loc(vertex_id_t id, int &part_id, off_t &off) const {
+		part_id = locs[id].first;
+		off = locs[id].second.id;
+	}
+
+	virtual void map2loc(vertex_id_t ids[], int num,
+			std::vector<local_vid_t> locs[], int num_parts) const;
+	virtual void map2loc(edge_seq_iterator &, std::vector<local_vid_t> locs[],
+			int num_parts) const;
+	virtual size_t map2loc(edge_seq_iterator &,
+			vertex_loc_t locs[], size_t num) const;
+
+	virtual void loc2map(int part_id, off_t off, vertex_id_t &id) const {
+		id = part_vertices[part_id][off];
+	}
+
+	virtual size_t get_all_vertices_in_part(int part_id,
+			size_t tot_num_vertices, std::vector<vertex_id_t> &ids) const;
+
+	virtual size_t get_part_size(int part_id, size_t num_vertices) const {
+		assert(num_vertices == locs.size());
+		return part_vertices[part_id].size();
+	}
+};
+
 }
 
 #endif
@@ -0,0 +1,38 @@
+#!/bin/sh
+
+# Compare the level-synchronous graph engine with the async mode on WCC
+# and PageRank. WCC should find the same components in both modes.
+# The script reports the time to convergence of each run.
+#
+# usage: run_async_test.sh conf_file adj_file index_file
+
+if [ $# -lt 3 ]; then
+	echo "usage: run_async_test.sh conf_file adj_file index_file"
+	exit 1
+fi
+
+conf=$1
+adj=$2
+index=$3
+
+run()
+{
+	start=$(date +%s.%N)
+	out=$(../test-algs/test_algs $conf $adj $index "$@") || exit 1
+	end=$(date +%s.%N)
+	echo "$out"
+	awk "BEGIN { printf \"%s: %.3f seconds\\n\", \"$*\", $end - $start }" >&2
+}
+
+sync_wcc=$(run wcc) || exit 1
+async_wcc=$(run wcc -a) || exit 1
+if [ "$sync_wcc" != "$async_wcc" ]; then
+	echo "WCC finds different components in the async mode"
+	exit 1
+fi
+
+run pagerank2 -i 1000 > /dev/null || exit 1
+run pagerank2 -a > /dev/null || exit 1
+
+# Run the async mode twice on the same graph engine.
+../test/test_async $conf $adj $index || exit 1
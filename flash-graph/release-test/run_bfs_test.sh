@@ -0,0 +1,31 @@
+#!/bin/sh
+
+# Compare the top-down BFS with the direction-optimizing BFS.
+# Both searches should visit the same number of vertices.
+#
+# usage: run_bfs_test.sh conf_file adj_file index_file [start_vertex ...]
+# EDGE sets the type of edges to follow (OUT by default).
+
+if [ $# -lt 3 ]; then
+	echo "usage: run_bfs_test.sh conf_file adj_file index_file [start_vertex ...]"
+	exit 1
+fi
+
+conf=$1
+adj=$2
+index=$3
+shift 3
+vertices=${*:-0}
+edge=${EDGE:-OUT}
+
+for v in $vertices
+do
+	td=$(../test-algs/test_algs $conf $adj $index bfs -s $v -e $edge) || exit 1
+	dob=$(../test-algs/test_algs $conf $adj $index bfs -s $v -e $edge -d) || exit 1
+	echo "top-down: $td"
+	echo "direction-optimizing: $dob"
+	if [ "$(echo "$td" | grep traverses)" != "$(echo "$dob" | grep traverses)" ]; then
+		echo "BFS from v$v visits different vertices"
+		exit 1
+	fi
+done
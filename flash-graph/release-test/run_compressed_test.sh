@@ -0,0 +1,36 @@
+#!/bin/sh
+
+# Compare the performance of FlashGraph on a graph with the original
+# edge lists and on the same graph with compressed edge lists.
+#
+# usage: run_compressed_test.sh conf_file adj_file index_file
+# ALGS sets the algorithms to run (bfs, pagerank and wcc by default).
+
+if [ $# -lt 3 ]; then
+	echo "usage: run_compressed_test.sh conf_file adj_file index_file"
+	exit 1
+fi
+
+conf=$1
+adj=$2
+index=$3
+algs=${ALGS:-"bfs pagerank wcc"}
+cadj=${adj%.adj}-c.adj
+cindex=${index%.index}-c.index
+
+../tools/compress-graph $adj $index $cadj $cindex || exit 1
+echo "$adj: $(stat -c %s $adj) bytes, $cadj: $(stat -c %s $cadj) bytes"
+
+for alg in $algs
+do
+	for graph in "$adj $index" "$cadj $cindex"
+	do
+		set -- $graph
+		start=$(date +%s.%N)
+		../test-algs/test_algs $conf $1 $2 $alg
+		end=$(date +%s.%N)
+		echo "$alg on $1 takes $(echo "$end - $start" | bc) seconds"
+	done
+done
+
+rm $cadj $cindex
@@ -0,0 +1,44 @@
+#!/bin/sh
+
+# Test the scalability of FlashGraph on RMAT graphs of increasing sizes.
+# A graph with 2^32 vertices or more requires FlashGraph and FlashMatrix
+# to be compiled with 64-bit vertex IDs (VERTEX_ID_64=1 in Makefile.common
+# or -DVERTEX_ID_64=ON in cmake).
+#
+# usage: run_scale_test.sh conf_file [log2(#vertices) ...]
+# DEGREE sets the average degree of the generated graphs (16 by default).
+# ALGS sets the algorithms to run (wcc and bfs by default).
+
+if [ $# -lt 1 ]; then
+	echo "usage: run_scale_test.sh conf_file [log2(#vertices) ...]"
+	exit 1
+fi
+
+conf=$1
+shift
+if [ $# -eq 0 ]; then
+	set -- 30 31 32 33
+fi
+degree=${DEGREE:-16}
+algs=${ALGS:-"wcc bfs"}
+
+for scale in "$@"
+do
+	num_vertices=$((1 << scale))
+	num_edges=$((num_vertices * degree))
+	name=rmat-$scale
+
+	echo "generate $name with $num_vertices vertices and $num_edges edges"
+	../tools/rmat-gen $num_vertices $num_edges $name.txt
+	../../matrix/utils/el2fg -e $conf $name.txt $name
+	rm $name.txt
+
+	for alg in $algs
+	do
+		echo "run $alg on $name"
+		start=$(date +%s.%N)
+		../test-algs/test_algs $conf $name.adj $name.index $alg
+		end=$(date +%s.%N)
+		echo "$alg on $name takes $(echo "$end - $start" | bc) seconds"
+	done
+done
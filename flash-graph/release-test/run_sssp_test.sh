@@ -0,0 +1,35 @@
+#!/bin/sh
+
+# Compare SSSP on unit weights with BFS and the BFS-based diameter
+# estimation. SSSP should reach the same vertices as BFS.
+#
+# usage: run_sssp_test.sh conf_file adj_file index_file [start_vertex ...]
+# EDGE sets the type of edges to follow (OUT by default) and DELTA sets
+# the width of the buckets in SSSP (1 by default). DIAMETER_OPTS passes
+# options to the diameter estimation, e.g., -d for directed graphs.
+
+if [ $# -lt 3 ]; then
+	echo "usage: run_sssp_test.sh conf_file adj_file index_file [start_vertex ...]"
+	exit 1
+fi
+
+conf=$1
+adj=$2
+index=$3
+shift 3
+vertices=${*:-0}
+edge=${EDGE:-OUT}
+delta=${DELTA:-1}
+
+for v in $vertices
+do
+	sp=$(../test-algs/test_algs $conf $adj $index sssp -s $v -e $edge -D $delta) || exit 1
+	bfs=$(../test-algs/test_algs $conf $adj $index bfs -s $v -e $edge -d) || exit 1
+	echo "SSSP: $sp"
+	echo "BFS: $bfs"
+	if [ "$(echo "$sp" | grep -o 'reaches [0-9]*')" != "$(echo "$bfs" | grep -o 'traverses [0-9]*' | sed 's/traverses/reaches/')" ]; then
+		echo "SSSP from v$v reaches different vertices from BFS"
+		exit 1
+	fi
+done
+../test-algs/test_algs $conf $adj $index diameter $DIAMETER_OPTS
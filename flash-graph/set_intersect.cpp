@@ -0,0 +1,351 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "set_intersect.h"
+
+namespace fg
+{
+
+namespace
+{
+
+/*
+ * The common vertices found by the SIMD code may be found again when
+ * the second list has duplicates, so a location is only written if it's
+ * after the previous one.
+ */
+class match_writer
+{
+	uint32_t *idxs;
+	size_t num;
+	size_t next;
+public:
+	match_writer(uint32_t idxs[]) {
+		this->idxs = idxs;
+		num = 0;
+		next = 0;
+	}
+
+	void add(size_t idx) {
+		if (idx >= next) {
+			if (idxs)
+				idxs[num] = idx;
+			num++;
+			next = idx + 1;
+		}
+	}
+
+	/*
+	 * Add the matches in a block of the first list. Bit i in the mask
+	 * indicates the element at `start + i'.
+	 */
+	void add_mask(size_t start, uint32_t mask) {
+		while (mask) {
+			add(start + __builtin_ctz(mask));
+			mask &= mask - 1;
+		}
+	}
+
+	size_t get_num() const {
+		return num;
+	}
+};
+
+void merge_scalar(const vertex_id_t a[], size_t i, size_t num_a,
+		const vertex_id_t b[], size_t j, size_t num_b, match_writer &writer)
+{
+	while (i < num_a && j < num_b) {
+		if (a[i] < b[j])
+			i++;
+		else if (b[j] < a[i])
+			j++;
+		else {
+			writer.add(i);
+			i++;
+			j++;
+		}
+	}
+}
+
+#ifdef __x86_64__
+
+/*
+ * A block of W elements in the first list is compared with a block of W
+ * elements in the second list by comparing it with all rotations of
+ * the second block. The rotations are independent shuffles within 128-bit
+ * lanes and across lanes, so they don't wait for each other.
+ * Then we move to the next block in the list whose last element in
+ * the current block is smaller, or both if they are the same. A block in
+ * the first list may be compared with multiple blocks in the second list,
+ * so its matches are collected in a mask and written when we move to
+ * the next block.
+ */
+
+#ifdef VERTEX_ID_64
+
+__attribute__((target("avx2")))
+uint32_t block_match_avx2(__m256i va, __m256i vb)
+{
+	__m256i m1 = _mm256_cmpeq_epi64(va, vb);
+	__m256i m2 = _mm256_cmpeq_epi64(va,
+			_mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1)));
+	__m256i m3 = _mm256_cmpeq_epi64(va,
+			_mm256_permute4x64_epi64(vb, _MM_SHUFFLE(1, 0, 3, 2)));
+	__m256i m4 = _mm256_cmpeq_epi64(va,
+			_mm256_permute4x64_epi64(vb, _MM_SHUFFLE(2, 1, 0, 3)));
+	__m256i m = _mm256_or_si256(_mm256_or_si256(m1, m2),
+			_mm256_or_si256(m3, m4));
+	return _mm256_movemask_pd(_mm256_castsi256_pd(m));
+}
+
+__attribute__((target("avx512f")))
+static inline __mmask8 lane_match_avx512(__m512i va, __m512i vb)
+{
+	// Swap the two elements in each 128-bit lane.
+	return _mm512_cmpeq_epi64_mask(va, vb) | _mm512_cmpeq_epi64_mask(va,
+			_mm512_shuffle_epi32(vb, (_MM_PERM_ENUM) _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+__attribute__((target("avx512f")))
+uint32_t block_match_avx512(__m512i va, __m512i vb)
+{
+	return lane_match_avx512(va, vb)
+		| lane_match_avx512(va, _mm512_shuffle_i64x2(vb, vb,
+					_MM_SHUFFLE(0, 3, 2, 1)))
+		| lane_match_avx512(va, _mm512_shuffle_i64x2(vb, vb,
+					_MM_SHUFFLE(1, 0, 3, 2)))
+		| lane_match_avx512(va, _mm512_shuffle_i64x2(vb, vb,
+					_MM_SHUFFLE(2, 1, 0, 3)));
+}
+
+#else
+
+__attribute__((target("avx2")))
+static inline __m256i lane_match_avx2(__m256i va, __m256i vb)
+{
+	// Rotate the four elements in each 128-bit lane.
+	__m256i m1 = _mm256_cmpeq_epi32(va, vb);
+	__m256i m2 = _mm256_cmpeq_epi32(va,
+			_mm256_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)));
+	__m256i m3 = _mm256_cmpeq_epi32(va,
+			_mm256_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)));
+	__m256i m4 = _mm256_cmpeq_epi32(va,
+			_mm256_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)));
+	return _mm256_or_si256(_mm256_or_si256(m1, m2), _mm256_or_si256(m3, m4));
+}
+
+__attribute__((target("avx2")))
+uint32_t block_match_avx2(__m256i va, __m256i vb)
+{
+	__m256i m = _mm256_or_si256(lane_match_avx2(va, vb),
+			lane_match_avx2(va, _mm256_permute2x128_si256(vb, vb, 1)));
+	return _mm256_movemask_ps(_mm256_castsi256_ps(m));
+}
+
+__attribute__((target("avx512f")))
+static inline __mmask16 lane_match_avx512(__m512i va, __m512i vb)
+{
+	// Rotate the four elements in each 128-bit lane.
+	return _mm512_cmpeq_epi32_mask(va, vb)
+		| _mm512_cmpeq_epi32_mask(va, _mm512_shuffle_epi32(vb,
+					(_MM_PERM_ENUM) _MM_SHUFFLE(0, 3, 2, 1)))
+		| _mm512_cmpeq_epi32_mask(va, _mm512_shuffle_epi32(vb,
+					(_MM_PERM_ENUM) _MM_SHUFFLE(1, 0, 3, 2)))
+		| _mm512_cmpeq_epi32_mask(va, _mm512_shuffle_epi32(vb,
+					(_MM_PERM_ENUM) _MM_SHUFFLE(2, 1, 0, 3)));
+}
+
+__attribute__((target("avx512f")))
+uint32_t block_match_avx512(__m512i va, __m512i vb)
+{
+	return lane_match_avx512(va, vb)
+		| lane_match_avx512(va, _mm512_shuffle_i32x4(vb, vb,
+					_MM_SHUFFLE(0, 3, 2, 1)))
+		| lane_match_avx512(va, _mm512_shuffle_i32x4(vb, vb,
+					_MM_SHUFFLE(1, 0, 3, 2)))
+		| lane_match_avx512(va, _mm512_shuffle_i32x4(vb, vb,
+					_MM_SHUFFLE(2, 1, 0, 3)));
+}
+
+#endif
+
+__attribute__((target("avx2")))
+size_t merge_avx2(const vertex_id_t a[], size_t num_a, const vertex_id_t b[],
+		size_t num_b, match_writer &writer)
+{
+	const size_t W = sizeof(__m256i) / sizeof(vertex_id_t);
+	size_t i = 0;
+	size_t j = 0;
+	uint32_t mask = 0;
+	while (i + W <= num_a && j + W <= num_b) {
+		__m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+		__m256i vb = _mm256_loadu_si256((const __m256i *) (b + j));
+		mask |= block_match_avx2(va, vb);
+		vertex_id_t a_max = a[i + W - 1];
+		vertex_id_t b_max = b[j + W - 1];
+		if (a_max <= b_max) {
+			writer.add_mask(i, mask);
+			mask = 0;
+			i += W;
+		}
+		if (b_max <= a_max)
+			j += W;
+	}
+	writer.add_mask(i, mask);
+	merge_scalar(a, i, num_a, b, j, num_b, writer);
+	return writer.get_num();
+}
+
+__attribute__((target("avx512f")))
+size_t merge_avx512(const vertex_id_t a[], size_t num_a, const vertex_id_t b[],
+		size_t num_b, match_writer &writer)
+{
+	const size_t W = sizeof(__m512i) / sizeof(vertex_id_t);
+	size_t i = 0;
+	size_t j = 0;
+	uint32_t mask = 0;
+	while (i + W <= num_a && j + W <= num_b) {
+		__m512i va = _mm512_loadu_si512((const void *) (a + i));
+		__m512i vb = _mm512_loadu_si512((const void *) (b + j));
+		mask |= block_match_avx512(va, vb);
+		vertex_id_t a_max = a[i + W - 1];
+		vertex_id_t b_max = b[j + W - 1];
+		if (a_max <= b_max) {
+			writer.add_mask(i, mask);
+			mask = 0;
+			i += W;
+		}
+		if (b_max <= a_max)
+			j += W;
+	}
+	writer.add_mask(i, mask);
+	merge_scalar(a, i, num_a, b, j, num_b, writer);
+	return writer.get_num();
+}
+
+simd_level detect_simd_level()
+{
+	if (__builtin_cpu_supports("avx512f"))
+		return simd_level::AVX512;
+	else if (__builtin_cpu_supports("avx2"))
+		return simd_level::AVX2;
+	else
+		return simd_level::NONE;
+}
+
+const simd_level cpu_simd_level = detect_simd_level();
+
+const size_t MIN_AVX512_MERGE_LEN = 64;
+
+#else
+
+const simd_level cpu_simd_level = simd_level::NONE;
+
+const size_t MIN_AVX512_MERGE_LEN = 0;
+
+#endif
+
+}
+
+simd_level get_simd_level()
+{
+	return cpu_simd_level;
+}
+
+size_t intersect_merge(const vertex_id_t a[], size_t num_a,
+		const vertex_id_t b[], size_t num_b, uint32_t idxs[], simd_level level)
+{
+	assert(level <= cpu_simd_level);
+	match_writer writer(idxs);
+#ifdef __x86_64__
+	if (level == simd_level::AVX512)
+		return merge_avx512(a, num_a, b, num_b, writer);
+	else if (level == simd_level::AVX2)
+		return merge_avx2(a, num_a, b, num_b, writer);
+#endif
+	merge_scalar(a, 0, num_a, b, 0, num_b, writer);
+	return writer.get_num();
+}
+
+size_t intersect_sorted(const vertex_id_t a[], size_t num_a,
+		const vertex_id_t b[], size_t num_b, uint32_t idxs[])
+{
+	if (num_a == 0 || num_b == 0)
+		return 0;
+
+	if (num_a * GALLOP_RATIO < num_b) {
+		match_writer writer(idxs);
+		gallop_intersect(a, a + num_a, b, b + num_b,
+				[&writer](size_t i, size_t j) {
+					writer.add(i);
+				});
+		return writer.get_num();
+	}
+	else if (num_b * GALLOP_RATIO < num_a) {
+		// The duplicates in `b' are found at the same location in `a'.
+		match_writer writer(idxs);
+		gallop_intersect(b, b + num_b, a, a + num_a,
+				[&writer](size_t i, size_t j) {
+					writer.add(j);
+				});
+		return writer.get_num();
+	}
+	// A 512-bit block is too large for short lists, whose most elements
+	// end up in the scalar tail.
+	simd_level level = get_simd_level();
+	if (level == simd_level::AVX512
+			&& std::min(num_a, num_b) < MIN_AVX512_MERGE_LEN)
+		level = simd_level::AVX2;
+	return intersect_merge(a, num_a, b, num_b, idxs, level);
+}
+
+bool rank_bitmap::init(const vertex_id_t ids[], size_t num)
+{
+	if (num == 0)
+		return false;
+	size_t range = ids[num - 1] - ids[0] + 1;
+	if (range > num * MAX_BITS_PER_ELEMENT)
+		return false;
+
+	std::vector<uint64_t> words((range + 63) / 64);
+	for (size_t i = 0; i < num; i++) {
+		if (i > 0 && ids[i] == ids[i - 1])
+			return false;
+		size_t off = ids[i] - ids[0];
+		words[off / 64] |= 1ULL << (off % 64);
+	}
+	this->ranks.resize(words.size());
+	uint32_t rank = 0;
+	for (size_t i = 0; i < words.size(); i++) {
+		this->ranks[i] = rank;
+		rank += __builtin_popcountll(words[i]);
+	}
+	this->words.swap(words);
+	this->min_id = ids[0];
+	this->range = range;
+	return true;
+}
+
+}
@@ -0,0 +1,189 @@
+#ifndef __SET_INTERSECT_H__
+#define __SET_INTERSECT_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "FG_basic_types.h"
+
+namespace fg
+{
+
+/*
+ * These functions intersect two sorted lists of vertex IDs, which is
+ * the core of triangle counting and scan statistics. The first list
+ * shouldn't have duplicates, while the second list may have. They write
+ * the locations of the common vertices in the first list to `idxs' in
+ * increasing order and return the number of common vertices. `idxs' can
+ * be NULL if only the number is needed.
+ */
+
+/*
+ * The instruction sets used by the merge-based intersection.
+ */
+enum class simd_level
+{
+	NONE,
+	AVX2,
+	AVX512,
+};
+
+/*
+ * The best instruction set that the CPU supports.
+ */
+simd_level get_simd_level();
+
+/*
+ * If one list is longer than the other one by this ratio, we search
+ * the elements of the short list in the long list with galloping
+ * instead of merging the two lists.
+ */
+const size_t GALLOP_RATIO = 32;
+
+/*
+ * Merge two lists. It compares a block of elements in a list with a block
+ * of elements in the other list with SIMD instructions, so it doesn't
+ * have a branch on each element.
+ */
+size_t intersect_merge(const vertex_id_t a[], size_t num_a,
+		const vertex_id_t b[], size_t num_b, uint32_t idxs[], simd_level level);
+
+static inline size_t intersect_merge(const vertex_id_t a[], size_t num_a,
+		const vertex_id_t b[], size_t num_b, uint32_t idxs[])
+{
+	return intersect_merge(a, num_a, b, num_b, idxs, get_simd_level());
+}
+
+/*
+ * Search the elements of a short sorted list in a long sorted list.
+ * The search of an element starts from the location of the previous one
+ * and doubles its step until it passes the element, so its cost is
+ * logarithmic to the distance between two elements instead of the length
+ * of the long list. `found(i, j)' is called when the element at `i' in
+ * the short list is found at `j' in the long list. The long list can be
+ * accessed with any random access iterator, such as `edge_iterator',
+ * so it doesn't need to be copied. It returns the number of elements found.
+ */
+template<class ShortIterator, class LongIterator, class Func>
+size_t gallop_intersect(ShortIterator short_it, ShortIterator short_end,
+		LongIterator long_it, LongIterator long_end, Func found)
+{
+	LongIterator long_begin = long_it;
+	size_t num_found = 0;
+	for (size_t i = 0; short_it != short_end; ++short_it, i++) {
+		vertex_id_t id = *short_it;
+		size_t remain = long_end - long_it;
+		if (remain == 0)
+			break;
+		if (*long_it < id) {
+			// The first element >= id is in (lo, hi].
+			size_t lo = 0;
+			size_t hi = 1;
+			while (hi < remain && *(long_it + hi) < id) {
+				lo = hi;
+				hi *= 2;
+			}
+			if (hi > remain)
+				hi = remain;
+			long_it = std::lower_bound(long_it + (lo + 1), long_it + hi, id);
+			if (long_it == long_end)
+				break;
+		}
+		if (*long_it == id) {
+			found(i, (size_t) (long_it - long_begin));
+			num_found++;
+		}
+	}
+	return num_found;
+}
+
+/*
+ * Pick the algorithm by the lengths of the lists: galloping if one list
+ * is much longer than the other one, merging otherwise.
+ */
+size_t intersect_sorted(const vertex_id_t a[], size_t num_a,
+		const vertex_id_t b[], size_t num_b, uint32_t idxs[]);
+
+/*
+ * A bitmap over the range of the vertex IDs in a sorted list without
+ * duplicates. It finds the location of a vertex in the list in constant
+ * time by counting the bits before it, so it replaces a hash table for
+ * the neighbors of a hub vertex, which are searched by many small
+ * neighbor lists. The bitmap is only built if the list is dense in its
+ * range.
+ */
+class rank_bitmap
+{
+	vertex_id_t min_id;
+	size_t range;
+	std::vector<uint64_t> words;
+	// The number of bits set before each word.
+	std::vector<uint32_t> ranks;
+public:
+	// A bitmap uses at most this number of bits for an element in a list.
+	static const size_t MAX_BITS_PER_ELEMENT = 64;
+
+	rank_bitmap() {
+		min_id = 0;
+		range = 0;
+	}
+
+	/*
+	 * It returns false if the list is too sparse or has duplicates,
+	 * and the bitmap stays empty.
+	 */
+	bool init(const vertex_id_t ids[], size_t num);
+
+	bool empty() const {
+		return range == 0;
+	}
+
+	/*
+	 * The location of a vertex in the list, or -1 if it isn't in the list.
+	 */
+	off_t find(vertex_id_t id) const {
+		if (id < min_id || id - min_id >= range)
+			return -1;
+		size_t off = id - min_id;
+		uint64_t word = words[off / 64];
+		uint64_t bit = 1ULL << (off % 64);
+		if ((word & bit) == 0)
+			return -1;
+		return ranks[off / 64] + __builtin_popcountll(word & (bit - 1));
+	}
+
+	bool contains(vertex_id_t id) const {
+		return find(id) >= 0;
+	}
+
+	size_t get_mem_size() const {
+		return words.size() * sizeof(words[0]) + ranks.size() * sizeof(ranks[0]);
+	}
+};
+
+}
+
+#endif
@@ -135,7 +135,7 @@ void run_topK_scan(FG_graph::ptr graph, int argc, char *argv[])
 	if (scan) {
 		printf("The top %d scans:\n", topK);
 		for (int i = 0; i < topK; i++)
-			printf("%u\t%ld\n", scan->get(i).first, scan->get(i).second);
+			printf("%ld\t%ld\n", (size_t) scan->get(i).first, scan->get(i).second);
 	}
 }
 
@@ -165,13 +165,17 @@ void run_wcc(FG_graph::ptr graph, int argc, char *argv[])
 	int opt;
 	int num_opts = 0;
 	bool sync = false;
+	bool async = false;
 	std::string output_file;
-	while ((opt = getopt(argc, argv, "so:")) != -1) {
+	while ((opt = getopt(argc, argv, "sao:")) != -1) {
 		num_opts++;
 		switch (opt) {
 			case 's':
 				sync = true;
 				break;
+			case 'a':
+				async = true;
+				break;
 			case 'o':
 				output_file = optarg;
 				num_opts++;
@@ -184,6 +188,8 @@ void run_wcc(FG_graph::ptr graph, int argc, char *argv[])
 	FG_vector<vertex_id_t>::ptr comp_ids;
 	if (sync)
 		comp_ids = compute_sync_wcc(graph);
+	else if (async)
+		comp_ids = compute_async_wcc(graph);
 	else
 		comp_ids = compute_wcc(graph);
 	if (comp_ids == NULL)
@@ -250,10 +256,14 @@ void run_pagerank(FG_graph::ptr graph, int argc, char *argv[], int version)
 
 	int num_iters = 30;
 	float damping_factor = 0.85;
+	bool async = false;
 
-	while ((opt = getopt(argc, argv, "i:D:")) != -1) {
+	while ((opt = getopt(argc, argv, "i:D:a")) != -1) {
 		num_opts++;
 		switch (opt) {
+			case 'a':
+				async = true;
+				break;
 			case 'i':
 				num_iters = atoi(optarg);
 				num_opts++;
@@ -274,7 +284,10 @@ void run_pagerank(FG_graph::ptr graph, int argc, char *argv[], int version)
 			pr = compute_pagerank(graph, num_iters, damping_factor);
 			break;
 		case 2:
-			pr = compute_pagerank2(graph, num_iters, damping_factor);
+			if (async)
+				pr = compute_async_pagerank(graph, damping_factor);
+			else
+				pr = compute_pagerank2(graph, num_iters, damping_factor);
 			break;
 		default:
 			abort();
@@ -520,6 +533,53 @@ void run_betweenness_centrality(FG_graph::ptr graph, int argc, char* argv[])
 		btwn_v->to_file(write_out);
 }
 
+void run_sampled_centrality(FG_graph::ptr graph, int argc, char* argv[])
+{
+	int opt;
+	int num_opts = 0;
+	std::string btwn_out;
+	std::string closeness_out;
+	size_t num_samples = 0;
+	unsigned seed = 0;
+	int batch_size = 64;
+
+	while ((opt = getopt(argc, argv, "w:c:n:r:b:")) != -1) {
+		num_opts++;
+		switch (opt) {
+			case 'w':
+				btwn_out = optarg;
+				break;
+			case 'c':
+				closeness_out = optarg;
+				break;
+			case 'n':
+				num_samples = atol(optarg);
+				break;
+			case 'r':
+				seed = atoi(optarg);
+				break;
+			case 'b':
+				batch_size = atoi(optarg);
+				break;
+			default:
+				print_usage();
+				assert(0);
+		}
+	}
+
+	FG_vector<float>::ptr btwn_v;
+	FG_vector<float>::ptr closeness_v;
+	compute_sampled_centrality(graph, num_samples, btwn_v, closeness_v, seed,
+			batch_size);
+	if (btwn_v == NULL)
+		return;
+	printf("The max betweenness: %f\n", btwn_v->max());
+	if (!btwn_out.empty())
+		btwn_v->to_file(btwn_out);
+	if (!closeness_out.empty())
+		closeness_v->to_file(closeness_out);
+}
+
 int read_vertices(const std::string &file, std::vector<vertex_id_t> &vertices)
 {
 	FILE *f = fopen(file.c_str(), "r");
@@ -531,7 +591,7 @@ int read_vertices(const std::string &file, std::vector<vertex_id_t> &vertices)
 		if (line[ret - 1] == '\n')
 			line[ret - 1] = 0;
 		vertex_id_t id = atol(line);
-		printf("%u\n", id);
+		printf("%ld\n", (size_t) id);
 		vertices.push_back(id);
 	}
 	fclose(f);
@@ -586,8 +646,8 @@ void run_overlap(FG_graph::ptr graph, int argc, char* argv[])
 			for (size_t j = 0; j < num_vertices; j++) {
 				double overlap = overlaps[i][j];
 				if (overlap >= threshold)
-					fprintf(fout, "%u %u %f\n", overlap_vertices[i],
-							overlap_vertices[j], overlap);
+					fprintf(fout, "%ld %ld %f\n", (size_t) overlap_vertices[i],
+							(size_t) overlap_vertices[j], overlap);
 			}
 		}
 		fclose(fout);
@@ -600,9 +660,10 @@ void run_bfs(FG_graph::ptr graph, int argc, char* argv[])
 	int num_opts = 0;
 	edge_type edge = edge_type::OUT_EDGE;
 	vertex_id_t start_vertex = 0;
+	bool direction_opt = false;
 
 	std::string edge_type_str;
-	while ((opt = getopt(argc, argv, "e:s:")) != -1) {
+	while ((opt = getopt(argc, argv, "e:s:d")) != -1) {
 		num_opts++;
 		switch (opt) {
 			case 'e':
@@ -613,6 +674,75 @@ void run_bfs(FG_graph::ptr graph, int argc, char* argv[])
 				start_vertex = atol(optarg);
 				num_opts++;
 				break;
+			case 'd':
+				direction_opt = true;
+				break;
+			default:
+				print_usage();
+				abort();
+		}
+	}
+	if (!edge_type_str.empty()) {
+		if (edge_type_str == "IN")
+			edge = edge_type::IN_EDGE;
+		else if (edge_type_str == "OUT")
+			edge = edge_type::OUT_EDGE;
+		else if (edge_type_str == "BOTH")
+			edge = edge_type::BOTH_EDGES;
+		else {
+			fprintf(stderr, "wrong edge type");
+			exit(1);
+		}
+	}
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	size_t num_vertices = 0;
+	if (direction_opt) {
+		FG_vector<int>::ptr levels = compute_do_bfs(graph, start_vertex, edge);
+		if (levels == NULL)
+			return;
+		for (size_t i = 0; i < levels->get_size(); i++)
+			if (levels->get(i) >= 0)
+				num_vertices++;
+	}
+	else
+		num_vertices = bfs(graph, start_vertex, edge);
+	gettimeofday(&end, NULL);
+	printf("BFS from v%ld traverses %ld vertices on edge type %d\n",
+			(size_t) start_vertex, num_vertices, edge);
+	printf("BFS takes %.3f seconds\n", time_diff(start, end));
+}
+
+void run_sssp(FG_graph::ptr graph, int argc, char* argv[])
+{
+	int opt;
+	int num_opts = 0;
+	edge_type edge = edge_type::OUT_EDGE;
+	vertex_id_t source = 0;
+	double delta = 1;
+	std::string weight_type;
+
+	std::string edge_type_str;
+	while ((opt = getopt(argc, argv, "e:s:D:w:")) != -1) {
+		num_opts++;
+		switch (opt) {
+			case 'e':
+				edge_type_str = optarg;
+				num_opts++;
+				break;
+			case 's':
+				source = atol(optarg);
+				num_opts++;
+				break;
+			case 'D':
+				delta = atof(optarg);
+				num_opts++;
+				break;
+			case 'w':
+				weight_type = optarg;
+				num_opts++;
+				break;
 			default:
 				print_usage();
 				abort();
@@ -631,10 +761,25 @@ void run_bfs(FG_graph::ptr graph, int argc, char* argv[])
 		}
 	}
 
-	size_t bfs(FG_graph::ptr fg, vertex_id_t start_vertex, edge_type);
-	size_t num_vertices = bfs(graph, start_vertex, edge);
-	printf("BFS from v%u traverses %ld vertices on edge type %d\n",
-			start_vertex, num_vertices, edge);
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	FG_vector<double>::ptr dists = compute_sssp(graph, source, edge, delta,
+			weight_type);
+	gettimeofday(&end, NULL);
+	if (dists == NULL)
+		return;
+	size_t num_reached = 0;
+	double max_dist = 0;
+	for (size_t i = 0; i < dists->get_size(); i++) {
+		if (dists->get(i) < std::numeric_limits<double>::infinity()) {
+			num_reached++;
+			max_dist = std::max(max_dist, dists->get(i));
+		}
+	}
+	printf("SSSP from v%ld reaches %ld vertices on edge type %d\n",
+			(size_t) source, num_reached, edge);
+	printf("The longest distance is %g\n", max_dist);
+	printf("SSSP takes %.3f seconds\n", time_diff(start, end));
 }
 
 void run_spmv(FG_graph::ptr graph, int argc, char* argv[])
@@ -732,8 +877,10 @@ std::string supported_algs[] = {
 	"ts_wcc",
 	"kcore",
 	"betweenness",
+	"centrality",
 	"overlap",
 	"bfs",
+	"sssp",
 	"spmv",
 	"louvain",
     "sem_kmeans"
@@ -758,6 +905,7 @@ void print_usage()
 	fprintf(stderr, "pagerank\n");
 	fprintf(stderr, "-i num: the maximum number of iterations\n");
 	fprintf(stderr, "-D v: damping factor\n");
+	fprintf(stderr, "-a: run pagerank2 asynchronously without iterations\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "sstsg\n");
 	fprintf(stderr, "-n num: the number of time intervals\n");
@@ -780,11 +928,19 @@ void print_usage()
 	fprintf(stderr, "-w output: the file name for a vector written to file\n");
 	fprintf(stderr, "-s vertex id: the vertex where BC starts. (Default runs all)\n");
 	fprintf(stderr, "\n");
+	fprintf(stderr, "centrality\n");
+	fprintf(stderr, "-n num: the number of sampled sources. (Default uses all)\n");
+	fprintf(stderr, "-r seed: the seed for sampling sources\n");
+	fprintf(stderr, "-b size: the max number of sources in a batch (Default 64)\n");
+	fprintf(stderr, "-w output: the file for the betweenness vector\n");
+	fprintf(stderr, "-c output: the file for the closeness vector\n");
+	fprintf(stderr, "\n");
 	fprintf(stderr, "cycle_triangle\n");
 	fprintf(stderr, "-f: run the fast implementation\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "wcc\n");
 	fprintf(stderr, "-s: run wcc synchronously\n");
+	fprintf(stderr, "-a: run wcc without level barriers\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "overlap vertex_file\n");
 	fprintf(stderr, "-o output: the output file\n");
@@ -793,6 +949,13 @@ void print_usage()
 	fprintf(stderr, "bfs\n");
 	fprintf(stderr, "-e edge type: the type of edge to traverse (IN, OUT, BOTH)\n");
 	fprintf(stderr, "-s vertex id: the vertex where the BFS starts\n");
+	fprintf(stderr, "-d: switch to the bottom-up search when the frontier is large\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "sssp\n");
+	fprintf(stderr, "-e edge type: the type of edge to traverse (IN, OUT, BOTH)\n");
+	fprintf(stderr, "-s vertex id: the vertex where the paths start\n");
+	fprintf(stderr, "-D delta: the width of a bucket in delta-stepping (default: 1)\n");
+	fprintf(stderr, "-w type: the type of edge weights (I, L, F, D). All weights are 1 by default\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "spmv\n");
 	fprintf(stderr, "-t: transpose the sparse matrix.\n");
@@ -888,12 +1051,18 @@ int main(int argc, char *argv[])
 	else if (alg == "betweenness") {
 		run_betweenness_centrality(graph, argc, argv);
 	}
+	else if (alg == "centrality") {
+		run_sampled_centrality(graph, argc, argv);
+	}
 	else if (alg == "overlap") {
 		run_overlap(graph, argc, argv);
 	}
 	else if (alg == "bfs") {
 		run_bfs(graph, argc, argv);
 	}
+	else if (alg == "sssp") {
+		run_sssp(graph, argc, argv);
+	}
 	else if (alg == "spmv") {
 		run_spmv(graph, argc, argv);
 	}
@@ -0,0 +1,105 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This measures the compression ratio of neighbor lists and the speed of
+ * decoding them. The neighbors of a vertex are chosen uniformly at random
+ * from all vertices, which is the worst case for delta encoding.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "common.h"
+#include "edge_codec.h"
+
+using namespace fg;
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		fprintf(stderr,
+				"edge_codec_bench num_vertices degree [num_lists] [num_runs]\n");
+		return -1;
+	}
+	size_t num_vertices = atol(argv[1]);
+	size_t degree = atol(argv[2]);
+	size_t num_lists = 10000;
+	if (argc >= 4)
+		num_lists = atol(argv[3]);
+	int num_runs = 10;
+	if (argc >= 5)
+		num_runs = atoi(argv[4]);
+
+	std::vector<std::vector<vertex_id_t> > lists(num_lists);
+	std::vector<std::vector<uint8_t> > encoded(num_lists);
+	std::vector<bool> wides(num_lists);
+	size_t raw_size = 0;
+	size_t encoded_size = 0;
+	for (size_t i = 0; i < num_lists; i++) {
+		lists[i].resize(degree);
+		for (size_t j = 0; j < degree; j++)
+			lists[i][j] = (((size_t) random()) * RAND_MAX + random())
+				% num_vertices;
+		std::sort(lists[i].begin(), lists[i].end());
+		encoded[i].resize(max_encoded_neighbors_size(degree));
+		bool wide;
+		size_t size = encode_neighbors(lists[i].data(), degree,
+				encoded[i].data(), wide);
+		encoded[i].resize(size);
+		wides[i] = wide;
+		raw_size += degree * sizeof(vertex_id_t);
+		encoded_size += size;
+	}
+	printf("%ld neighbor lists use %ld bytes, and %ld bytes after compression (%.2f bytes per edge)\n",
+			num_lists, raw_size, encoded_size,
+			((double) encoded_size) / num_lists / degree);
+
+	std::vector<vertex_id_t> out(degree);
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	for (int k = 0; k < num_runs; k++)
+		for (size_t i = 0; i < num_lists; i++)
+			decode_neighbors(encoded[i].data(), encoded[i].size(), degree,
+					wides[i], out.data());
+	gettimeofday(&end, NULL);
+	double decode_time = time_diff(start, end);
+	assert(out == lists[num_lists - 1]);
+
+	gettimeofday(&start, NULL);
+	for (int k = 0; k < num_runs; k++)
+		for (size_t i = 0; i < num_lists; i++)
+			memcpy(out.data(), lists[i].data(), degree * sizeof(vertex_id_t));
+	gettimeofday(&end, NULL);
+	double copy_time = time_diff(start, end);
+	assert(out == lists[num_lists - 1]);
+
+	size_t tot_edges = num_lists * degree * num_runs;
+	printf("decode: %.3f seconds, %.2f M edges/s, %.2f GB/s of vertex IDs\n",
+			decode_time, tot_edges / decode_time / 1000000,
+			tot_edges * sizeof(vertex_id_t) / decode_time / 1e9);
+	printf("memcpy: %.3f seconds, %.2f M edges/s, %.2f GB/s of vertex IDs\n",
+			copy_time, tot_edges / copy_time / 1000000,
+			tot_edges * sizeof(vertex_id_t) / copy_time / 1e9);
+	return 0;
+}
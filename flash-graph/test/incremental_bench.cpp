@@ -0,0 +1,153 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This compares incremental PageRank and WCC with recomputing them after
+ * a graph is updated. The updates are applied through a delta store in
+ * two rounds: the first round adds random edges, and the second round
+ * deletes half of them and adds new random edges, so the deleted edges
+ * are always in the graph. Random edges are almost never in a sparse
+ * graph already. Incremental PageRank only runs on a directed graph,
+ * so only WCC is compared on an undirected graph.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <cmath>
+#include <climits>
+
+#include "FGlib.h"
+#include "graph_delta.h"
+
+using namespace fg;
+
+const float DAMPING_FACTOR = 0.85;
+
+void add_random_edges(graph_delta &delta, size_t num_vertices, size_t num,
+		edge_list_t &added)
+{
+	for (size_t i = 0; i < num; i++) {
+		vertex_id_t from = random() % num_vertices;
+		vertex_id_t to = random() % num_vertices;
+		if (from == to)
+			continue;
+		delta.add_edge(from, to);
+		added.push_back(std::pair<vertex_id_t, vertex_id_t>(from, to));
+	}
+}
+
+void compare(FG_graph::ptr graph, FG_vector<vertex_id_t>::ptr &wcc,
+		FG_vector<float>::ptr &pr, const edge_list_t &added,
+		const edge_list_t &deleted)
+{
+	bool directed = graph->get_graph_header().is_directed_graph();
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	FG_vector<vertex_id_t>::ptr inc_wcc = compute_incremental_wcc(graph, wcc,
+			added, deleted);
+	gettimeofday(&end, NULL);
+	double inc_wcc_time = time_diff(start, end);
+
+	start = end;
+	FG_vector<vertex_id_t>::ptr full_wcc = directed ? compute_wcc(graph)
+		: compute_cc(graph);
+	gettimeofday(&end, NULL);
+	double wcc_time = time_diff(start, end);
+
+	size_t num_diffs = 0;
+	for (size_t i = 0; i < full_wcc->get_size(); i++)
+		if (inc_wcc->get(i) != full_wcc->get(i))
+			num_diffs++;
+	printf("%ld edges added, %ld edges deleted\n", added.size(),
+			deleted.size());
+	printf("WCC: incremental %.3fs, full %.3fs, %ld vertices differ\n",
+			inc_wcc_time, wcc_time, num_diffs);
+	wcc = inc_wcc;
+	if (!directed)
+		return;
+
+	start = end;
+	FG_vector<float>::ptr inc_pr = compute_incremental_pagerank(graph, pr,
+			added, deleted, DAMPING_FACTOR);
+	gettimeofday(&end, NULL);
+	double inc_pr_time = time_diff(start, end);
+
+	start = end;
+	FG_vector<float>::ptr full_pr = compute_pagerank2(graph, INT_MAX,
+			DAMPING_FACTOR);
+	gettimeofday(&end, NULL);
+	double pr_time = time_diff(start, end);
+
+	float max_diff = 0;
+	for (size_t i = 0; i < full_pr->get_size(); i++)
+		max_diff = std::max(max_diff, std::fabs(inc_pr->get(i)
+					- full_pr->get(i)));
+	printf("PageRank: incremental %.3fs, full %.3fs, max diff %f\n",
+			inc_pr_time, pr_time, max_diff);
+	pr = inc_pr;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		fprintf(stderr,
+				"incremental_bench conf_file graph_file index_file [num_updates]\n");
+		return -1;
+	}
+	std::string conf_file = argv[1];
+	std::string graph_file = argv[2];
+	std::string index_file = argv[3];
+	size_t num_updates = 1000;
+	if (argc >= 5)
+		num_updates = atol(argv[4]);
+
+	config_map::ptr configs = config_map::create(conf_file);
+	graph_engine::init_flash_graph(configs);
+	FG_graph::ptr graph = FG_graph::create(graph_file, index_file, configs);
+	bool directed = graph->get_graph_header().is_directed_graph();
+	size_t num_vertices = graph->get_graph_header().get_num_vertices();
+
+	FG_vector<vertex_id_t>::ptr wcc;
+	FG_vector<float>::ptr pr;
+	if (directed) {
+		wcc = compute_wcc(graph);
+		pr = compute_pagerank2(graph, INT_MAX, DAMPING_FACTOR);
+	}
+	else
+		wcc = compute_cc(graph);
+
+	graph_delta::ptr delta = graph_delta::create(graph->get_graph_header());
+	graph->set_delta_store(delta);
+	edge_list_t added;
+	edge_list_t deleted;
+	add_random_edges(*delta, num_vertices, num_updates, added);
+	compare(graph, wcc, pr, added, deleted);
+
+	for (size_t i = 0; i < added.size(); i += 2) {
+		delta->delete_edge(added[i].first, added[i].second);
+		deleted.push_back(added[i]);
+	}
+	added.clear();
+	add_random_edges(*delta, num_vertices, num_updates / 2, added);
+	compare(graph, wcc, pr, added, deleted);
+
+	graph_engine::destroy_flash_graph();
+}
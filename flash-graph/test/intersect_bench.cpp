@@ -0,0 +1,184 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This measures the speed of intersecting neighbor lists with different
+ * algorithms. The degrees of the two lists in a pair follow a power-law
+ * distribution as in a real-world graph, so most pairs have similar small
+ * degrees and some pairs have a hub. The pairs are split into balanced
+ * pairs and skewed pairs, whose degrees differ by more than GALLOP_RATIO.
+ * The neighbors are drawn from a small range, so the lists have common
+ * vertices and the bitmap can be built on most lists.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "common.h"
+#include "set_intersect.h"
+
+using namespace fg;
+
+struct list_pair
+{
+	std::vector<vertex_id_t> a;
+	std::vector<vertex_id_t> b;
+	rank_bitmap a_bitmap;
+};
+
+/*
+ * Draw a degree from a Pareto distribution with the exponent `alpha'.
+ */
+size_t rand_degree(double alpha, size_t min_degree, size_t max_degree)
+{
+	double u = (random() + 1.0) / ((double) RAND_MAX + 2);
+	size_t degree = min_degree * pow(u, -1 / (alpha - 1));
+	return std::min(degree, max_degree);
+}
+
+std::vector<vertex_id_t> rand_list(size_t degree, size_t range)
+{
+	std::vector<vertex_id_t> list(degree);
+	for (size_t i = 0; i < degree; i++)
+		list[i] = random() % range;
+	std::sort(list.begin(), list.end());
+	list.resize(std::unique(list.begin(), list.end()) - list.begin());
+	return list;
+}
+
+template<class Func>
+void run(const char *name, const std::vector<list_pair> &pairs, int num_runs,
+		Func intersect)
+{
+	size_t num_edges = 0;
+	size_t num_common = 0;
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	for (int k = 0; k < num_runs; k++) {
+		for (size_t i = 0; i < pairs.size(); i++) {
+			num_common += intersect(pairs[i]);
+			num_edges += pairs[i].a.size() + pairs[i].b.size();
+		}
+	}
+	gettimeofday(&end, NULL);
+	double secs = time_diff(start, end);
+	printf("%-12s %.3f seconds, %.2f M edges/s, %ld common vertices\n",
+			name, secs, num_edges / secs / 1000000, num_common / num_runs);
+}
+
+void bench(const char *desc, const std::vector<list_pair> &pairs,
+		int num_runs)
+{
+	printf("%s: %ld pairs\n", desc, pairs.size());
+	if (pairs.empty())
+		return;
+	size_t max_len = 0;
+	for (size_t i = 0; i < pairs.size(); i++)
+		max_len = std::max(max_len, pairs[i].a.size());
+	std::vector<uint32_t> idxs(max_len);
+
+	const char *level_names[] = {"scalar", "avx2", "avx512"};
+	for (int level = (int) simd_level::NONE;
+			level <= (int) get_simd_level(); level++) {
+		run(level_names[level], pairs, num_runs, [&](const list_pair &p) {
+					return intersect_merge(p.a.data(), p.a.size(), p.b.data(),
+							p.b.size(), idxs.data(), (simd_level) level);
+				});
+	}
+	run("gallop", pairs, num_runs, [&](const list_pair &p) {
+				uint32_t *out = idxs.data();
+				if (p.a.size() <= p.b.size())
+					return gallop_intersect(p.a.begin(), p.a.end(), p.b.begin(),
+							p.b.end(), [out](size_t i, size_t j) {
+								out[i] = i;
+							});
+				else
+					return gallop_intersect(p.b.begin(), p.b.end(), p.a.begin(),
+							p.a.end(), [out](size_t i, size_t j) {
+								out[j] = j;
+							});
+			});
+	run("bitmap", pairs, num_runs, [&](const list_pair &p) {
+				if (p.a_bitmap.empty())
+					return intersect_sorted(p.a.data(), p.a.size(), p.b.data(),
+							p.b.size(), idxs.data());
+				size_t num = 0;
+				for (size_t j = 0; j < p.b.size(); j++) {
+					off_t idx = p.a_bitmap.find(p.b[j]);
+					if (idx >= 0)
+						idxs[num++] = idx;
+				}
+				return num;
+			});
+	run("dispatch", pairs, num_runs, [&](const list_pair &p) {
+				return intersect_sorted(p.a.data(), p.a.size(), p.b.data(),
+						p.b.size(), idxs.data());
+			});
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		fprintf(stderr,
+				"intersect_bench num_pairs [alpha] [min_degree] [max_degree] [num_runs]\n");
+		return -1;
+	}
+	size_t num_pairs = atol(argv[1]);
+	double alpha = 2.1;
+	if (argc >= 3)
+		alpha = atof(argv[2]);
+	size_t min_degree = 16;
+	if (argc >= 4)
+		min_degree = atol(argv[3]);
+	size_t max_degree = 100000;
+	if (argc >= 5)
+		max_degree = atol(argv[4]);
+	int num_runs = 10;
+	if (argc >= 6)
+		num_runs = atoi(argv[5]);
+	printf("SIMD level: %d\n", (int) get_simd_level());
+
+	std::vector<list_pair> balanced;
+	std::vector<list_pair> skewed;
+	for (size_t i = 0; i < num_pairs; i++) {
+		// The neighbors of a vertex are in a range a few times larger
+		// than its degree, so the two lists have common vertices.
+		size_t a_degree = rand_degree(alpha, min_degree, max_degree);
+		size_t b_degree = rand_degree(alpha, min_degree, max_degree);
+		size_t range = std::max(a_degree, b_degree) * 4;
+		list_pair p;
+		p.a = rand_list(a_degree, range);
+		p.b = rand_list(b_degree, range);
+		p.a_bitmap.init(p.a.data(), p.a.size());
+		size_t min_len = std::min(p.a.size(), p.b.size());
+		size_t max_len = std::max(p.a.size(), p.b.size());
+		if (max_len > GALLOP_RATIO * min_len)
+			skewed.push_back(p);
+		else
+			balanced.push_back(p);
+	}
+	bench("balanced pairs", balanced, num_runs);
+	bench("skewed pairs", skewed, num_runs);
+	return 0;
+}
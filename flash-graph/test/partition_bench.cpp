@@ -0,0 +1,91 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This measures the runtime of PageRank and BFS and the number of
+ * messages they send to the vertices in other partitions. The vertices
+ * are assigned to worker threads by range partitioning, or by the
+ * partition file created by `partition-graph' if it's given. PageRank
+ * only runs on a directed graph.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "FGlib.h"
+
+using namespace fg;
+
+const float DAMPING_FACTOR = 0.85;
+
+class measure
+{
+	struct timeval start;
+	size_t start_msgs;
+public:
+	measure() {
+		start_msgs = graph_engine::get_num_remote_msgs();
+		gettimeofday(&start, NULL);
+	}
+
+	void print(const char *name) {
+		struct timeval end;
+		gettimeofday(&end, NULL);
+		printf("%s: %.3f seconds, %ld messages to other partitions\n", name,
+				time_diff(start, end),
+				graph_engine::get_num_remote_msgs() - start_msgs);
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		fprintf(stderr,
+				"partition_bench conf_file graph_file index_file [part_file] [start_vertex]\n");
+		return -1;
+	}
+	std::string conf_file = argv[1];
+	config_map::ptr configs = config_map::create(conf_file);
+	if (argc >= 5)
+		configs->add_options(std::string("part_file=") + argv[4]);
+	vertex_id_t start_vertex = 0;
+	if (argc >= 6)
+		start_vertex = atol(argv[5]);
+	graph_engine::init_flash_graph(configs);
+
+	FG_graph::ptr graph = FG_graph::create(argv[2], argv[3], configs);
+	printf("vertices are partitioned by %s\n",
+			argc >= 5 ? argv[4] : "ranges");
+	if (graph->get_graph_header().is_directed_graph()) {
+		measure m;
+		compute_pagerank2(graph, 30, DAMPING_FACTOR);
+		m.print("PageRank");
+	}
+	{
+		measure m;
+		size_t num_visited = bfs(graph, start_vertex, edge_type::OUT_EDGE);
+		m.print("BFS");
+		printf("BFS visits %ld vertices\n", num_visited);
+	}
+	graph = NULL;
+
+	graph_engine::destroy_flash_graph();
+	return 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This compares the runtime and the I/O of WCC (CC on an undirected
+ * graph), PageRank and triangle counting on a graph and on the graph
+ * relabeled by `relabel-graph'. PageRank only runs on a directed graph.
+ * The results on the relabeled graph are mapped back to the original
+ * vertex IDs and checked against the results on the original graph.
+ * The I/O is the number of bytes the process reads from the storage,
+ * so the SAFS cache should be smaller than the graph to measure it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <cmath>
+#include <climits>
+#include <unordered_map>
+
+#include "FGlib.h"
+#include "vertex_permutation.h"
+
+using namespace fg;
+
+const float DAMPING_FACTOR = 0.85;
+
+size_t get_read_bytes()
+{
+	FILE *f = fopen("/proc/self/io", "r");
+	if (f == NULL)
+		return 0;
+	char line[256];
+	size_t bytes = 0;
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "read_bytes: %zu", &bytes) == 1)
+			break;
+	}
+	fclose(f);
+	return bytes;
+}
+
+class measure
+{
+	struct timeval start;
+	size_t start_bytes;
+public:
+	measure() {
+		start_bytes = get_read_bytes();
+		gettimeofday(&start, NULL);
+	}
+
+	void print(const char *name) {
+		struct timeval end;
+		gettimeofday(&end, NULL);
+		printf("%s: %.3f seconds, %zu MB read\n", name,
+				time_diff(start, end),
+				(get_read_bytes() - start_bytes) / 1024 / 1024);
+	}
+};
+
+struct results
+{
+	FG_vector<vertex_id_t>::ptr wcc;
+	FG_vector<float>::ptr pr;
+	FG_vector<size_t>::ptr triangles;
+};
+
+results run_algs(FG_graph::ptr graph, const char *desc)
+{
+	results res;
+	printf("%s\n", desc);
+	if (graph->get_graph_header().is_directed_graph()) {
+		measure m;
+		res.wcc = compute_wcc(graph);
+		m.print("WCC");
+	}
+	else {
+		measure m;
+		res.wcc = compute_cc(graph);
+		m.print("CC");
+	}
+	// PageRank only runs on directed graphs.
+	if (graph->get_graph_header().is_directed_graph()) {
+		measure m;
+		res.pr = compute_pagerank2(graph, 30, DAMPING_FACTOR);
+		m.print("PageRank");
+	}
+	{
+		measure m;
+		if (graph->get_graph_header().is_directed_graph())
+			res.triangles = compute_directed_triangles_fast(graph,
+					directed_triangle_type::CYCLE);
+		else
+			res.triangles = compute_undirected_triangles(graph);
+		m.print("triangles");
+	}
+	return res;
+}
+
+/*
+ * The component IDs are vertex IDs in the components, which change with
+ * the vertex IDs, so we only check that both vectors partition
+ * the vertices in the same way.
+ */
+bool same_partition(FG_vector<vertex_id_t>::ptr v1,
+		FG_vector<vertex_id_t>::ptr v2)
+{
+	std::unordered_map<vertex_id_t, vertex_id_t> map12;
+	std::unordered_map<vertex_id_t, vertex_id_t> map21;
+	for (size_t i = 0; i < v1->get_size(); i++) {
+		auto ret1 = map12.insert(std::pair<vertex_id_t, vertex_id_t>(
+					v1->get(i), v2->get(i)));
+		auto ret2 = map21.insert(std::pair<vertex_id_t, vertex_id_t>(
+					v2->get(i), v1->get(i)));
+		if (ret1.first->second != v2->get(i) || ret2.first->second != v1->get(i))
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 7) {
+		fprintf(stderr,
+				"relabel_bench conf_file graph_file index_file new_graph_file new_index_file perm_file\n");
+		return -1;
+	}
+	std::string conf_file = argv[1];
+	config_map::ptr configs = config_map::create(conf_file);
+	graph_engine::init_flash_graph(configs);
+
+	FG_graph::ptr graph = FG_graph::create(argv[2], argv[3], configs);
+	results orig = run_algs(graph, "original graph");
+	graph = NULL;
+
+	FG_graph::ptr new_graph = FG_graph::create(argv[4], argv[5], configs);
+	results relabeled = run_algs(new_graph, "relabeled graph");
+	new_graph = NULL;
+
+	vertex_permutation::ptr perm = vertex_permutation::load(argv[6]);
+	FG_vector<vertex_id_t>::ptr wcc = perm->ids_to_orig(relabeled.wcc);
+	printf("components: %s\n", same_partition(wcc, orig.wcc)
+			? "same components" : "different components");
+	if (relabeled.pr) {
+		FG_vector<float>::ptr pr = perm->to_orig<float>(relabeled.pr);
+		float max_diff = 0;
+		for (size_t i = 0; i < pr->get_size(); i++)
+			max_diff = std::max(max_diff, std::fabs(pr->get(i)
+						- orig.pr->get(i)));
+		printf("PageRank: max diff %f\n", max_diff);
+	}
+	FG_vector<size_t>::ptr triangles = perm->to_orig<size_t>(
+			relabeled.triangles);
+	size_t num_diffs = 0;
+	for (size_t i = 0; i < triangles->get_size(); i++)
+		if (triangles->get(i) != orig.triangles->get(i))
+			num_diffs++;
+	printf("triangles: %ld vertices differ\n", num_diffs);
+
+	graph_engine::destroy_flash_graph();
+	return 0;
+}
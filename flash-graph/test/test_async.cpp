@@ -0,0 +1,160 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "graph_engine.h"
+#include "graph_config.h"
+#include "FGlib.h"
+
+using namespace safs;
+using namespace fg;
+
+/*
+ * This test runs BFS several times on the same graph engine, first in
+ * the level-synchronous mode and then twice in the async mode. All runs
+ * should reach the same vertices from the start vertex.
+ */
+
+class reach_vertex: public compute_vertex
+{
+	bool visited;
+public:
+	reach_vertex(vertex_id_t id): compute_vertex(id) {
+		visited = false;
+	}
+
+	bool has_visited() const {
+		return visited;
+	}
+
+	void reset() {
+		visited = false;
+	}
+
+	void run(vertex_program &prog) {
+		if (!has_visited()) {
+			vertex_id_t id = prog.get_vertex_id(*this);
+			request_vertices(&id, 1);
+		}
+	}
+
+	void run(vertex_program &prog, const page_vertex &vertex) {
+		if (has_visited())
+			return;
+		visited = true;
+		int num_dests = vertex.get_num_edges(edge_type::BOTH_EDGES);
+		if (num_dests == 0)
+			return;
+		if (prog.get_graph().is_directed()) {
+			edge_seq_iterator it = vertex.get_neigh_seq_it(
+					edge_type::IN_EDGE, 0,
+					vertex.get_num_edges(edge_type::IN_EDGE));
+			prog.activate_vertices(it);
+			it = vertex.get_neigh_seq_it(edge_type::OUT_EDGE, 0,
+					vertex.get_num_edges(edge_type::OUT_EDGE));
+			prog.activate_vertices(it);
+		}
+		else {
+			edge_seq_iterator it = vertex.get_neigh_seq_it(
+					edge_type::BOTH_EDGES, 0, num_dests);
+			prog.activate_vertices(it);
+		}
+	}
+
+	void run_on_message(vertex_program &, const vertex_message &) {
+	}
+};
+
+class reset_initializer: public vertex_initializer
+{
+public:
+	virtual void init(compute_vertex &v) {
+		((reach_vertex &) v).reset();
+	}
+};
+
+class count_query: public vertex_query
+{
+	size_t num_visited;
+public:
+	count_query() {
+		num_visited = 0;
+	}
+
+	virtual void run(graph_engine &graph, compute_vertex &v) {
+		if (((reach_vertex &) v).has_visited())
+			num_visited++;
+	}
+
+	virtual void merge(graph_engine &graph, vertex_query::ptr q) {
+		num_visited += ((count_query &) *q).num_visited;
+	}
+
+	virtual ptr clone() {
+		return vertex_query::ptr(new count_query());
+	}
+
+	size_t get_num_visited() const {
+		return num_visited;
+	}
+};
+
+size_t run_bfs(graph_engine::ptr graph, vertex_id_t start, bool async)
+{
+	graph->init_all_vertices(vertex_initializer::ptr(new reset_initializer()));
+	graph->set_async(async);
+	graph->start(&start, 1);
+	graph->wait4complete();
+
+	vertex_query::ptr cq(new count_query());
+	graph->query_on_all(cq);
+	size_t num_visited = ((count_query &) *cq).get_num_visited();
+	printf("%s BFS visits %ld vertices\n", async ? "async" : "sync",
+			num_visited);
+	return num_visited;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		fprintf(stderr, "test_async conf_file graph_file index_file\n");
+		exit(-1);
+	}
+
+	std::string conf_file = argv[1];
+	std::string graph_file = argv[2];
+	std::string index_file = argv[3];
+
+	config_map::ptr configs = config_map::create(conf_file);
+
+	FG_graph::ptr fg = FG_graph::create(graph_file, index_file, configs);
+	graph_index::ptr index = NUMA_graph_index<reach_vertex>::create(
+			fg->get_graph_header());
+	graph_engine::ptr graph = fg->create_engine(index);
+
+	size_t num_sync = run_bfs(graph, 0, false);
+	// The second async run starts after the first one has completed on
+	// the same engine. It has to reach the same vertices.
+	size_t num_async1 = run_bfs(graph, 0, true);
+	size_t num_async2 = run_bfs(graph, 0, true);
+	assert(num_sync == num_async1);
+	assert(num_sync == num_async2);
+	printf("test_async passes\n");
+}
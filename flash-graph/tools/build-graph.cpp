@@ -0,0 +1,1003 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This builds a graph image in the Linux filesystem from edge lists in
+ * text files without keeping the edges in memory, so it works on graphs
+ * much larger than memory. Each line of the edge lists has the source
+ * and the destination vertex of an edge, and the lines that start with
+ * `#' or `%' are comments. The graph is built in three steps:
+ *
+ * parse: threads parse the files in ranges of lines and write the edges
+ * in binary to temporary files.
+ *
+ * distribute: threads scatter the edges to bucket files by the highest
+ * bits of their sort keys. The key of an edge in the out-edge list of
+ * a vertex is (src, dst) and in the in-edge list is (dst, src), and
+ * a directed graph has a set of buckets for each type of edge lists.
+ * An undirected graph has a single set with both keys of each edge.
+ *
+ * sort: the buckets are processed in the order of the keys. A bucket
+ * larger than its share of memory is split by the next bits of the keys
+ * in parallel.
+ * Threads sort a bucket each, and the sorted edges are written as vertices
+ * to the adjacency list file while the offsets of the vertices are
+ * written to the index file. All in-edge lists are written in front of
+ * all out-edge lists.
+ *
+ * Except small buffers for reading and writing files, the memory usage
+ * is bounded by the memory size given in the command line.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <omp.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "native_file.h"
+
+#include "common.h"
+#include "vertex.h"
+#include "vertex_index.h"
+
+using namespace fg;
+
+const size_t PARSE_RANGE_SIZE = 64 * 1024 * 1024;
+const size_t PARSE_BUF_SIZE = 4 * 1024 * 1024;
+const size_t READ_BUF_SIZE = 1024 * 1024;
+const size_t WRITE_BUF_SIZE = 4 * 1024 * 1024;
+// The number of bits of the keys used to split a bucket.
+const int DIGIT_BITS = 8;
+const int NUM_DIGITS = 1 << DIGIT_BITS;
+
+struct edge_key
+{
+	// The vertex whose edge list has the edge.
+	vertex_id_t first;
+	vertex_id_t second;
+
+	edge_key() {
+		first = 0;
+		second = 0;
+	}
+
+	edge_key(vertex_id_t first, vertex_id_t second) {
+		this->first = first;
+		this->second = second;
+	}
+
+	bool operator<(const edge_key &e) const {
+		if (first != e.first)
+			return first < e.first;
+		return second < e.second;
+	}
+
+	bool operator==(const edge_key &e) const {
+		return first == e.first && second == e.second;
+	}
+};
+
+const int ID_BITS = sizeof(vertex_id_t) * 8;
+
+/*
+ * Bits [lo, lo + nbits) of a key, where `first' has the highest bits.
+ */
+static inline size_t get_digit(const edge_key &e, int lo, int nbits)
+{
+	size_t mask = (1UL << nbits) - 1;
+	if (lo >= ID_BITS)
+		return (e.first >> (lo - ID_BITS)) & mask;
+	else if (lo + nbits <= ID_BITS)
+		return (e.second >> lo) & mask;
+	else
+		return ((e.second >> lo) | (((size_t) e.first) << (ID_BITS - lo)))
+			& mask;
+}
+
+static void write_all(int fd, const void *buf, size_t size, off_t off)
+{
+	const char *p = (const char *) buf;
+	while (size > 0) {
+		ssize_t ret = pwrite(fd, p, size, off);
+		if (ret < 0) {
+			perror("pwrite");
+			exit(1);
+		}
+		p += ret;
+		size -= ret;
+		off += ret;
+	}
+}
+
+static void read_all(int fd, void *buf, size_t size, off_t off)
+{
+	char *p = (char *) buf;
+	while (size > 0) {
+		ssize_t ret = pread(fd, p, size, off);
+		if (ret <= 0) {
+			perror("pread");
+			exit(1);
+		}
+		p += ret;
+		size -= ret;
+		off += ret;
+	}
+}
+
+/*
+ * A temporary file that is deleted when it's destroyed. Multiple threads
+ * can append data to it.
+ */
+class tmp_file
+{
+	std::string name;
+	int fd;
+	std::atomic<size_t> size;
+public:
+	typedef std::shared_ptr<tmp_file> ptr;
+
+	tmp_file(const std::string &name) {
+		this->name = name;
+		fd = open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+		if (fd < 0) {
+			fprintf(stderr, "can't create %s: %s\n", name.c_str(),
+					strerror(errno));
+			exit(1);
+		}
+		size = 0;
+	}
+
+	~tmp_file() {
+		close(fd);
+		unlink(name.c_str());
+	}
+
+	const std::string &get_name() const {
+		return name;
+	}
+
+	int get_fd() const {
+		return fd;
+	}
+
+	size_t get_size() const {
+		return size;
+	}
+
+	void append(const void *buf, size_t size) {
+		off_t off = this->size.fetch_add(size);
+		write_all(fd, buf, size, off);
+	}
+
+	void read(void *buf, size_t size, off_t off) const {
+		read_all(fd, buf, size, off);
+	}
+
+	/*
+	 * The file is written through its file descriptor by a writer,
+	 * which sets the size when it's done.
+	 */
+	void set_size(size_t size) {
+		this->size = size;
+	}
+};
+
+/*
+ * This writes data to a file sequentially through a buffer, and can
+ * overwrite the data written before.
+ */
+class out_file
+{
+	int fd;
+	// The location in the file of the first byte in the buffer.
+	off_t buf_off;
+	std::vector<char> buf;
+public:
+	out_file(int fd, off_t off) {
+		this->fd = fd;
+		buf_off = off;
+		buf.reserve(WRITE_BUF_SIZE);
+	}
+
+	~out_file() {
+		flush();
+	}
+
+	off_t get_off() const {
+		return buf_off + buf.size();
+	}
+
+	void write(const void *data, size_t size) {
+		if (buf.size() + size > WRITE_BUF_SIZE)
+			flush();
+		if (size > WRITE_BUF_SIZE) {
+			write_all(fd, data, size, buf_off);
+			buf_off += size;
+		}
+		else
+			buf.insert(buf.end(), (const char *) data,
+					(const char *) data + size);
+	}
+
+	void overwrite(const void *data, size_t size, off_t off) {
+		assert(off + size <= (size_t) get_off());
+		const char *p = (const char *) data;
+		// The part that has been written to the file.
+		if (off < buf_off) {
+			size_t len = std::min(size, (size_t) (buf_off - off));
+			write_all(fd, p, len, off);
+			p += len;
+			off += len;
+			size -= len;
+		}
+		if (size > 0)
+			memcpy(buf.data() + (off - buf_off), p, size);
+	}
+
+	void flush() {
+		write_all(fd, buf.data(), buf.size(), buf_off);
+		buf_off += buf.size();
+		buf.clear();
+	}
+};
+
+/*
+ * This writes the sorted edges of a type as vertices, and writes
+ * the offset of each vertex to a temporary file. A vertex without edges
+ * still has a vertex with an empty edge list.
+ */
+class vertex_writer
+{
+	out_file &adj;
+	tmp_file::ptr offs_file;
+	out_file offs;
+	bool unique;
+
+	// The next vertex that hasn't been written.
+	vertex_id_t next_id;
+	// The location of the vertex being written.
+	off_t curr_off;
+	size_t curr_num_edges;
+	edge_key last;
+	size_t num_edges;
+
+	void start_vertex(vertex_id_t id) {
+		off_t off = adj.get_off();
+		offs.write(&off, sizeof(off));
+		ext_mem_undirected_vertex v(id, 0, 0);
+		adj.write(&v, ext_mem_undirected_vertex::get_header_size());
+	}
+
+	void end_vertex(vertex_id_t id) {
+		if (curr_num_edges > std::numeric_limits<vsize_t>::max()) {
+			fprintf(stderr, "vertex %ld has too many edges\n", (size_t) id);
+			exit(1);
+		}
+		ext_mem_undirected_vertex v(id, curr_num_edges, 0);
+		adj.overwrite(&v, ext_mem_undirected_vertex::get_header_size(),
+				curr_off);
+	}
+
+	void fill_empty(vertex_id_t end) {
+		for (; next_id < end; next_id++)
+			start_vertex(next_id);
+	}
+public:
+	vertex_writer(out_file &_adj, tmp_file::ptr offs_file,
+			bool unique): adj(_adj), offs(offs_file->get_fd(), 0) {
+		this->offs_file = offs_file;
+		this->unique = unique;
+		next_id = 0;
+		curr_off = 0;
+		curr_num_edges = 0;
+		num_edges = 0;
+	}
+
+	size_t get_num_edges() const {
+		return num_edges;
+	}
+
+	void add(const edge_key &e) {
+		if (next_id > 0 && e.first == next_id - 1) {
+			if (unique && curr_num_edges > 0 && e == last)
+				return;
+		}
+		else {
+			if (next_id > 0)
+				end_vertex(next_id - 1);
+			fill_empty(e.first);
+			curr_off = adj.get_off();
+			start_vertex(e.first);
+			next_id = e.first + 1;
+			curr_num_edges = 0;
+		}
+		adj.write(&e.second, sizeof(e.second));
+		curr_num_edges++;
+		num_edges++;
+		last = e;
+	}
+
+	void finish(size_t num_vertices) {
+		if (next_id > 0)
+			end_vertex(next_id - 1);
+		fill_empty(num_vertices);
+		off_t off = adj.get_off();
+		offs.write(&off, sizeof(off));
+		offs.flush();
+		offs_file->set_size(offs.get_off());
+	}
+};
+
+struct input_range
+{
+	std::string file;
+	off_t start;
+	off_t end;
+};
+
+enum class line_type
+{
+	EDGE,
+	// An empty line or a comment.
+	SKIP,
+	BAD,
+	// A vertex ID doesn't fit in vertex_id_t.
+	TOO_LARGE_ID,
+};
+
+/*
+ * Parse the digits of a vertex ID. It returns false if the ID is larger
+ * than the largest valid vertex ID. INVALID_VERTEX_ID is the largest
+ * value of vertex_id_t, so it isn't a valid ID either.
+ */
+static inline bool parse_id(const char *&p, const char *end, vertex_id_t &id)
+{
+	id = 0;
+	for (; p < end && isdigit(*p); p++) {
+		vertex_id_t digit = *p - '0';
+		if (id > (MAX_VERTEX_ID - 1 - digit) / 10)
+			return false;
+		id = id * 10 + digit;
+	}
+	return true;
+}
+
+/*
+ * Parse a line with two vertex IDs separated by spaces, tabs or commas.
+ * Anything behind the second ID is ignored.
+ */
+static inline line_type parse_line(const char *p, const char *end,
+		vertex_id_t &src, vertex_id_t &dst)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		p++;
+	if (p == end || *p == '#' || *p == '%')
+		return line_type::SKIP;
+	if (!isdigit(*p))
+		return line_type::BAD;
+	if (!parse_id(p, end, src))
+		return line_type::TOO_LARGE_ID;
+	if (p == end || (*p != ' ' && *p != '\t' && *p != ','))
+		return line_type::BAD;
+	while (p < end && (*p == ' ' || *p == '\t' || *p == ','))
+		p++;
+	if (p == end || !isdigit(*p))
+		return line_type::BAD;
+	if (!parse_id(p, end, dst))
+		return line_type::TOO_LARGE_ID;
+	return line_type::EDGE;
+}
+
+/*
+ * Parse the lines that start in the range and pass the edges to
+ * `add_edge'. It returns the number of lines that aren't edges or comments.
+ */
+template<class add_edge_func>
+size_t parse_range(const input_range &r, add_edge_func &add_edge)
+{
+	int fd = open(r.file.c_str(), O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "can't open %s: %s\n", r.file.c_str(),
+				strerror(errno));
+		exit(1);
+	}
+	std::vector<char> buf(PARSE_BUF_SIZE);
+	// The first line belongs to the previous range unless the range
+	// starts behind a new line.
+	off_t buf_off = r.start > 0 ? r.start - 1 : 0;
+	bool skip_line = r.start > 0;
+	size_t len = 0;
+	size_t num_bad = 0;
+	bool done = false;
+	while (!done) {
+		ssize_t ret = pread(fd, buf.data() + len, buf.size() - len,
+				buf_off + len);
+		if (ret < 0) {
+			perror("pread");
+			exit(1);
+		}
+		bool eof = ret == 0;
+		len += ret;
+		const char *p = buf.data();
+		const char *end = p + len;
+		if (skip_line) {
+			const char *nl = (const char *) memchr(p, '\n', end - p);
+			if (nl == NULL)
+				p = end;
+			else {
+				p = nl + 1;
+				skip_line = false;
+			}
+		}
+		while (!skip_line) {
+			if (buf_off + (p - buf.data()) >= r.end) {
+				done = true;
+				break;
+			}
+			const char *nl = (const char *) memchr(p, '\n', end - p);
+			if (nl == NULL && !eof)
+				break;
+			const char *line_end = nl ? nl : end;
+			vertex_id_t src, dst;
+			line_type type = parse_line(p, line_end, src, dst);
+			if (type == line_type::EDGE)
+				add_edge(src, dst);
+			else if (type == line_type::BAD)
+				num_bad++;
+			else if (type == line_type::TOO_LARGE_ID) {
+				fprintf(stderr,
+						"a vertex ID at offset %ld of %s is larger than %ld\n",
+						buf_off + (p - buf.data()), r.file.c_str(),
+						(size_t) MAX_VERTEX_ID - 1);
+				exit(1);
+			}
+			p = nl ? nl + 1 : end;
+			if (p == end && eof)
+				break;
+		}
+		if (eof)
+			break;
+		size_t left = end - p;
+		if (left == buf.size()) {
+			fprintf(stderr, "a line in %s is too long\n", r.file.c_str());
+			exit(1);
+		}
+		memmove(buf.data(), p, left);
+		buf_off += p - buf.data();
+		len = left;
+	}
+	close(fd);
+	return num_bad;
+}
+
+/*
+ * The edges parsed by a thread are written to its own file.
+ */
+class edge_run
+{
+	tmp_file::ptr file;
+	std::vector<edge_key> buf;
+	size_t num_edges;
+	vertex_id_t max_id;
+public:
+	edge_run(const std::string &name) {
+		file = tmp_file::ptr(new tmp_file(name));
+		buf.reserve(READ_BUF_SIZE / sizeof(edge_key));
+		num_edges = 0;
+		max_id = 0;
+	}
+
+	void operator()(vertex_id_t src, vertex_id_t dst) {
+		buf.push_back(edge_key(src, dst));
+		max_id = std::max(max_id, std::max(src, dst));
+		num_edges++;
+		if (buf.size() == buf.capacity())
+			flush();
+	}
+
+	void flush() {
+		file->append(buf.data(), buf.size() * sizeof(edge_key));
+		buf.clear();
+	}
+
+	tmp_file::ptr get_file() const {
+		return file;
+	}
+
+	size_t get_num_edges() const {
+		return num_edges;
+	}
+
+	vertex_id_t get_max_id() const {
+		return max_id;
+	}
+};
+
+/*
+ * A set of buckets split from a range of keys by the digit at `lo'.
+ * The keys in a bucket share all bits above `lo'.
+ */
+struct bucket_set
+{
+	int lo;
+	int nbits;
+	std::vector<tmp_file::ptr> buckets;
+
+	bucket_set(const std::string &prefix, int lo) {
+		this->nbits = std::min(lo, DIGIT_BITS);
+		this->lo = lo - nbits;
+		buckets.resize(1 << nbits);
+		for (size_t i = 0; i < buckets.size(); i++)
+			buckets[i] = tmp_file::ptr(new tmp_file(prefix + "-"
+						+ std::to_string(i)));
+	}
+};
+
+/*
+ * The buffers of a thread to scatter edges to a set of buckets.
+ */
+class scatter_buf
+{
+	bucket_set &set;
+	size_t buf_size;
+	std::vector<std::vector<edge_key> > bufs;
+public:
+	scatter_buf(bucket_set &_set, size_t buf_size): set(_set) {
+		this->buf_size = buf_size;
+		bufs.resize(set.buckets.size());
+		for (size_t i = 0; i < bufs.size(); i++)
+			bufs[i].reserve(buf_size);
+	}
+
+	~scatter_buf() {
+		for (size_t i = 0; i < bufs.size(); i++)
+			flush(i);
+	}
+
+	void add(const edge_key &e) {
+		size_t d = get_digit(e, set.lo, set.nbits);
+		bufs[d].push_back(e);
+		if (bufs[d].size() >= buf_size)
+			flush(d);
+	}
+
+	void flush(size_t d) {
+		if (bufs[d].empty())
+			return;
+		set.buckets[d]->append(bufs[d].data(), bufs[d].size() * sizeof(edge_key));
+		bufs[d].clear();
+	}
+};
+
+struct bucket
+{
+	tmp_file::ptr file;
+	// All keys in the bucket share the bits above `lo'.
+	int lo;
+
+	size_t get_num_edges() const {
+		return file->get_size() / sizeof(edge_key);
+	}
+};
+
+class graph_builder
+{
+	std::string tmp_prefix;
+	size_t mem_size;
+	int num_threads;
+	bool directed;
+	bool unique;
+	size_t num_tmp_files;
+
+	std::string get_tmp_name(const std::string &name) {
+		return tmp_prefix + name + "-" + std::to_string(num_tmp_files++);
+	}
+
+	std::vector<bucket> split(const bucket &b);
+	void sort_write(std::vector<bucket> &buckets, vertex_writer &writer);
+public:
+	graph_builder(const std::string &tmp_dir, size_t mem_size,
+			int num_threads, bool directed, bool unique) {
+		this->tmp_prefix = tmp_dir + "/build-graph-"
+			+ std::to_string(getpid()) + "-";
+		this->mem_size = mem_size;
+		this->num_threads = num_threads;
+		this->directed = directed;
+		this->unique = unique;
+		num_tmp_files = 0;
+	}
+
+	void build(const std::vector<std::string> &files,
+			const std::string &adj_file, const std::string &index_file);
+};
+
+/*
+ * Split a bucket by the next digit of the keys. As in the distribute step,
+ * threads read the bucket in chunks and scatter the edges with their own
+ * buffers, so a large bucket is split in parallel.
+ */
+std::vector<bucket> graph_builder::split(const bucket &b)
+{
+	bucket_set set(get_tmp_name("split"), b.lo);
+	size_t buf_size = std::max(mem_size / num_threads / set.buckets.size()
+			/ sizeof(edge_key), 1UL);
+	size_t read_size = READ_BUF_SIZE / sizeof(edge_key);
+	size_t num_edges = b.get_num_edges();
+#pragma omp parallel
+	{
+		scatter_buf buf(set, buf_size);
+		std::vector<edge_key> edges(read_size);
+#pragma omp for schedule(dynamic, 1)
+		for (size_t i = 0; i < num_edges; i += read_size) {
+			size_t num = std::min(read_size, num_edges - i);
+			b.file->read(edges.data(), num * sizeof(edge_key),
+					i * sizeof(edge_key));
+			for (size_t j = 0; j < num; j++)
+				buf.add(edges[j]);
+		}
+	}
+	std::vector<bucket> ret(set.buckets.size());
+	for (size_t i = 0; i < ret.size(); i++) {
+		ret[i].file = set.buckets[i];
+		ret[i].lo = set.lo;
+	}
+	return ret;
+}
+
+/*
+ * Sort the buckets in the order of the keys and write the edges.
+ * Each thread sorts a bucket, and a bucket can use 1/num_threads of
+ * the memory.
+ */
+void graph_builder::sort_write(std::vector<bucket> &buckets,
+		vertex_writer &writer)
+{
+	size_t max_bucket_edges = std::max(mem_size / num_threads
+			/ sizeof(edge_key), 1UL);
+	std::deque<bucket> pending(buckets.begin(), buckets.end());
+	buckets.clear();
+	size_t num_splits = 0;
+	while (!pending.empty()) {
+		std::vector<bucket> wave;
+		while (!pending.empty() && wave.size() < (size_t) num_threads) {
+			bucket b = pending.front();
+			pending.pop_front();
+			if (b.get_num_edges() == 0)
+				continue;
+			// If there aren't bits left below the bucket, all keys
+			// in the bucket are the same and it doesn't need to be sorted.
+			if (b.get_num_edges() > max_bucket_edges && b.lo > 0) {
+				std::vector<bucket> parts = split(b);
+				pending.insert(pending.begin(), parts.begin(), parts.end());
+				num_splits++;
+				continue;
+			}
+			wave.push_back(b);
+		}
+
+		std::vector<std::vector<edge_key> > sorted(wave.size());
+#pragma omp parallel for schedule(dynamic, 1)
+		for (size_t i = 0; i < wave.size(); i++) {
+			size_t num_edges = wave[i].get_num_edges();
+			if (num_edges > max_bucket_edges)
+				continue;
+			sorted[i].resize(num_edges);
+			wave[i].file->read(sorted[i].data(), num_edges * sizeof(edge_key), 0);
+			std::sort(sorted[i].begin(), sorted[i].end());
+		}
+		for (size_t i = 0; i < wave.size(); i++) {
+			if (sorted[i].empty()) {
+				edge_key e;
+				wave[i].file->read(&e, sizeof(e), 0);
+				for (size_t j = 0; j < wave[i].get_num_edges(); j++)
+					writer.add(e);
+			}
+			for (size_t j = 0; j < sorted[i].size(); j++)
+				writer.add(sorted[i][j]);
+			sorted[i] = std::vector<edge_key>();
+			wave[i].file = NULL;
+		}
+	}
+	if (num_splits > 0)
+		printf("%ld buckets are larger than memory and are split\n",
+				num_splits);
+}
+
+static size_t get_peak_rss()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss * 1024;
+}
+
+void graph_builder::build(const std::vector<std::string> &files,
+		const std::string &adj_file, const std::string &index_file)
+{
+	struct timeval start, end, build_start;
+	gettimeofday(&start, NULL);
+	build_start = start;
+
+	std::vector<input_range> ranges;
+	for (size_t i = 0; i < files.size(); i++) {
+		off_t size = safs::native_file(files[i]).get_size();
+		if (size < 0)
+			exit(1);
+		for (off_t off = 0; off < size; off += PARSE_RANGE_SIZE) {
+			input_range r;
+			r.file = files[i];
+			r.start = off;
+			r.end = std::min(off + (off_t) PARSE_RANGE_SIZE, size);
+			ranges.push_back(r);
+		}
+	}
+	std::vector<std::unique_ptr<edge_run> > runs(num_threads);
+	for (int i = 0; i < num_threads; i++)
+		runs[i] = std::unique_ptr<edge_run>(new edge_run(get_tmp_name("run")));
+	std::atomic<size_t> num_bad(0);
+#pragma omp parallel for schedule(dynamic, 1)
+	for (size_t i = 0; i < ranges.size(); i++)
+		num_bad += parse_range(ranges[i], *runs[omp_get_thread_num()]);
+	size_t num_input_edges = 0;
+	vertex_id_t max_id = 0;
+	for (int i = 0; i < num_threads; i++) {
+		runs[i]->flush();
+		num_input_edges += runs[i]->get_num_edges();
+		max_id = std::max(max_id, runs[i]->get_max_id());
+	}
+	gettimeofday(&end, NULL);
+	if (num_bad > 0)
+		fprintf(stderr, "%ld lines aren't edges and are skipped\n",
+				num_bad.load());
+	if (num_input_edges == 0) {
+		fprintf(stderr, "there aren't edges in the input files\n");
+		exit(1);
+	}
+	size_t num_vertices = ((size_t) max_id) + 1;
+	printf("It takes %.3f seconds to parse %ld edges of %ld vertices (%.0f edges/s)\n",
+			time_diff(start, end), num_input_edges, num_vertices,
+			num_input_edges / time_diff(start, end));
+
+	// The first digit has the highest bits of the largest vertex ID.
+	start = end;
+	int id_bits = 1;
+	while (id_bits < ID_BITS && (max_id >> id_bits) > 0)
+		id_bits++;
+	int top_lo = ID_BITS + id_bits;
+	std::unique_ptr<bucket_set> in_set;
+	if (directed)
+		in_set = std::unique_ptr<bucket_set>(new bucket_set(
+					get_tmp_name("in"), top_lo));
+	bucket_set out_set(get_tmp_name("out"), top_lo);
+	int num_sets = directed ? 2 : 1;
+	size_t scatter_buf_size = std::max(mem_size / num_threads / num_sets
+			/ NUM_DIGITS / sizeof(edge_key), 1UL);
+	size_t read_size = READ_BUF_SIZE / sizeof(edge_key);
+	std::vector<std::pair<size_t, size_t> > chunks;
+	for (int i = 0; i < num_threads; i++)
+		for (size_t j = 0; j < runs[i]->get_num_edges(); j += read_size)
+			chunks.push_back(std::pair<size_t, size_t>(i, j));
+#pragma omp parallel
+	{
+		scatter_buf out_buf(out_set, scatter_buf_size);
+		std::unique_ptr<scatter_buf> in_buf;
+		if (directed)
+			in_buf = std::unique_ptr<scatter_buf>(new scatter_buf(*in_set,
+						scatter_buf_size));
+		std::vector<edge_key> edges(read_size);
+#pragma omp for schedule(dynamic, 1)
+		for (size_t i = 0; i < chunks.size(); i++) {
+			const edge_run &run = *runs[chunks[i].first];
+			size_t num = std::min(read_size,
+					run.get_num_edges() - chunks[i].second);
+			run.get_file()->read(edges.data(), num * sizeof(edge_key),
+					chunks[i].second * sizeof(edge_key));
+			for (size_t j = 0; j < num; j++) {
+				edge_key reversed(edges[j].second, edges[j].first);
+				out_buf.add(edges[j]);
+				if (directed)
+					in_buf->add(reversed);
+				// An undirected edge is in the edge lists of both vertices.
+				else
+					out_buf.add(reversed);
+			}
+		}
+	}
+	runs.clear();
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to distribute edges to %ld buckets\n",
+			time_diff(start, end), out_set.buckets.size() * num_sets);
+
+	start = end;
+	FILE *f = fopen(adj_file.c_str(), "w");
+	if (f == NULL)
+		ABORT_MSG(boost::format("fail to open %1%: %2%")
+				% adj_file % strerror(errno));
+	graph_header header;
+	BOOST_VERIFY(fwrite(&header, sizeof(header), 1, f) == 1);
+	fflush(f);
+	size_t num_edges = 0;
+	off_t out_part_loc = 0;
+	tmp_file::ptr in_offs;
+	tmp_file::ptr out_offs(new tmp_file(get_tmp_name("out-offs")));
+	{
+		out_file adj(fileno(f), sizeof(header));
+		std::vector<bucket> buckets(out_set.buckets.size());
+		if (directed) {
+			in_offs = tmp_file::ptr(new tmp_file(get_tmp_name("in-offs")));
+			vertex_writer writer(adj, in_offs, unique);
+			for (size_t i = 0; i < buckets.size(); i++) {
+				buckets[i].file = in_set->buckets[i];
+				buckets[i].lo = in_set->lo;
+			}
+			in_set = NULL;
+			sort_write(buckets, writer);
+			writer.finish(num_vertices);
+			out_part_loc = adj.get_off();
+		}
+		vertex_writer writer(adj, out_offs, unique);
+		buckets.resize(out_set.buckets.size());
+		for (size_t i = 0; i < buckets.size(); i++) {
+			buckets[i].file = out_set.buckets[i];
+			buckets[i].lo = out_set.lo;
+		}
+		out_set.buckets.clear();
+		sort_write(buckets, writer);
+		writer.finish(num_vertices);
+		num_edges = writer.get_num_edges();
+		// An undirected edge is counted in both of its vertices.
+		if (!directed)
+			num_edges /= 2;
+	}
+	header = graph_header(directed ? graph_type::DIRECTED
+			: graph_type::UNDIRECTED, num_vertices, num_edges, 0);
+	write_all(fileno(f), &header, sizeof(header), 0);
+	fclose(f);
+
+	f = fopen(index_file.c_str(), "w");
+	if (f == NULL)
+		ABORT_MSG(boost::format("fail to open %1%: %2%")
+				% index_file % strerror(errno));
+	if (directed)
+		directed_vertex_index::dump_header(f, header, out_part_loc);
+	else
+		undirected_vertex_index::dump_header(f, header);
+	std::vector<off_t> in_buf(read_size);
+	std::vector<off_t> out_buf(read_size);
+	std::vector<directed_vertex_entry> entries;
+	for (size_t i = 0; i <= num_vertices; i += read_size) {
+		size_t num = std::min(read_size, num_vertices + 1 - i);
+		out_offs->read(out_buf.data(), num * sizeof(off_t), i * sizeof(off_t));
+		if (directed) {
+			in_offs->read(in_buf.data(), num * sizeof(off_t), i * sizeof(off_t));
+			entries.resize(num);
+			for (size_t j = 0; j < num; j++)
+				entries[j] = directed_vertex_entry(in_buf[j], out_buf[j]);
+			BOOST_VERIFY(fwrite(entries.data(), sizeof(entries[0]), num, f)
+					== num);
+		}
+		else {
+			assert(sizeof(vertex_offset) == sizeof(off_t));
+			BOOST_VERIFY(fwrite(out_buf.data(), sizeof(off_t), num, f) == num);
+		}
+	}
+	fclose(f);
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to sort and write %ld edges\n",
+			time_diff(start, end), num_edges);
+	printf("build a graph with %ld vertices and %ld edges in %.3f seconds: %.0f edges/s, peak RSS: %ld MB\n",
+			num_vertices, num_edges, time_diff(build_start, end),
+			num_input_edges / time_diff(build_start, end),
+			get_peak_rss() / 1024 / 1024);
+}
+
+void print_usage()
+{
+	fprintf(stderr,
+			"build-graph [options] edge_file adj_file index_file\n");
+	fprintf(stderr, "edge_file: a file or a directory of edge lists\n");
+	fprintf(stderr, "-u: undirected graph\n");
+	fprintf(stderr, "-U: unique edges\n");
+	fprintf(stderr, "-m size: the memory size in MB (default: 1024)\n");
+	fprintf(stderr, "-T num: the number of threads (default: the number of CPUs)\n");
+	fprintf(stderr, "-d dir: the directory of temporary files (default: .)\n");
+}
+
+int main(int argc, char *argv[])
+{
+	bool directed = true;
+	bool unique = false;
+	size_t mem_size = 1024UL * 1024 * 1024;
+	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	std::string tmp_dir = ".";
+	int opt;
+	int num_opts = 0;
+	while ((opt = getopt(argc, argv, "uUm:T:d:")) != -1) {
+		num_opts++;
+		switch (opt) {
+			case 'u':
+				directed = false;
+				break;
+			case 'U':
+				unique = true;
+				break;
+			case 'm':
+				mem_size = atol(optarg) * 1024 * 1024;
+				num_opts++;
+				break;
+			case 'T':
+				num_threads = atoi(optarg);
+				num_opts++;
+				break;
+			case 'd':
+				tmp_dir = optarg;
+				num_opts++;
+				break;
+			default:
+				print_usage();
+				return -1;
+		}
+	}
+	argv += 1 + num_opts;
+	argc -= 1 + num_opts;
+	if (argc < 3) {
+		print_usage();
+		return -1;
+	}
+	if (mem_size == 0 || num_threads <= 0) {
+		fprintf(stderr, "the memory size and the number of threads have to be positive\n");
+		return -1;
+	}
+
+	std::string edge_file = argv[0];
+	std::string adj_file = argv[1];
+	std::string index_file = argv[2];
+	std::vector<std::string> files;
+	safs::native_file f(edge_file);
+	if (f.exist() && !f.is_dir())
+		files.push_back(edge_file);
+	else if (f.exist() && f.is_dir()) {
+		safs::native_dir d(edge_file);
+		d.read_all_files(files);
+		std::sort(files.begin(), files.end());
+		for (size_t i = 0; i < files.size(); i++)
+			files[i] = edge_file + "/" + files[i];
+	}
+	else {
+		fprintf(stderr, "The input file %s doesn't exist\n", edge_file.c_str());
+		return -1;
+	}
+	printf("read edges from %ld files with %d threads and %ld MB memory\n",
+			files.size(), num_threads, mem_size / 1024 / 1024);
+
+	omp_set_num_threads(num_threads);
+	graph_builder builder(tmp_dir, mem_size, num_threads, directed, unique);
+	builder.build(files, adj_file, index_file);
+	return 0;
+}
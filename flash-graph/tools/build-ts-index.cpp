@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This builds the timestamp index of a directed time-series graph in
+ * the Linux filesystem. The time is split into intervals from the start
+ * time, and time-series algorithms only read the edges in the time
+ * intervals they need when `ts_index_file' in the configuration points
+ * to the index and their time ranges are aligned to the intervals.
+ *
+ * An edge list that fits in a page is read in one I/O anyway, so by default
+ * only the edge lists that take more than a page are indexed, which keeps
+ * the index small when the time intervals are short. Algorithms that
+ * compute on the index alone, such as the timestamp degree, need all edge
+ * lists indexed with min_edges of 0.
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+
+#include <string>
+
+#include "common.h"
+#include "native_file.h"
+#include "ts_graph.h"
+
+using namespace fg;
+
+int main(int argc, char *argv[])
+{
+	if (argc < 6) {
+		fprintf(stderr,
+				"build-ts-index adj_file index_file ts_index_file start_time interval [unit] [min_edges]\n");
+		fprintf(stderr, "start_time: the time in seconds or in the format of YYYY-MM-DD\n");
+		fprintf(stderr, "unit: second, hour, day, month (default: second)\n");
+		fprintf(stderr, "min_edges: the min number of edges in an indexed edge list (default: a page of edges)\n");
+		return -1;
+	}
+
+	const std::string adj_file = argv[1];
+	const std::string index_file = argv[2];
+	const std::string ts_index_file = argv[3];
+	std::string start_time_str = argv[4];
+	time_t start_time;
+	if (is_time_str(start_time_str))
+		start_time = conv_str_to_time(start_time_str);
+	else
+		start_time = atol(start_time_str.c_str());
+	time_t interval = atol(argv[5]);
+	std::string unit = "second";
+	if (argc >= 7)
+		unit = argv[6];
+	if (unit == "hour")
+		interval *= HOUR_SECS;
+	else if (unit == "day")
+		interval *= DAY_SECS;
+	else if (unit == "month")
+		interval *= MONTH_SECS;
+	else if (unit != "second") {
+		fprintf(stderr, "unknown time unit %s\n", unit.c_str());
+		return -1;
+	}
+	size_t min_num_edges = safs::PAGE_SIZE / (sizeof(vertex_id_t)
+			+ sizeof(ts_edge_data));
+	if (argc >= 8)
+		min_num_edges = atol(argv[7]);
+	if (interval <= 0) {
+		fprintf(stderr, "the interval has to be positive\n");
+		return -1;
+	}
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	ts_edge_index::ptr ts_index = ts_edge_index::create(adj_file, index_file,
+			start_time, interval, min_num_edges);
+	ts_index->dump(ts_index_file);
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to index %ld vertices\n",
+			time_diff(start, end), ts_index->get_num_vertices());
+	printf("the index has %ld bytes, the graph has %ld bytes\n",
+			safs::native_file(ts_index_file).get_size(),
+			safs::native_file(adj_file).get_size());
+	return 0;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This converts a graph in the Linux filesystem to the format with
+ * compressed edge lists. Each neighbor list is sorted, delta-encoded and
+ * stored with StreamVByte. The edge data isn't compressed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "common.h"
+#include "vertex.h"
+#include "vertex_index.h"
+
+using namespace fg;
+
+class adj_reader
+{
+	FILE *f;
+	off_t curr_off;
+	std::vector<char> buf;
+public:
+	adj_reader(const std::string &file) {
+		f = fopen(file.c_str(), "r");
+		if (f == NULL) {
+			perror("fopen");
+			exit(1);
+		}
+		curr_off = 0;
+	}
+
+	~adj_reader() {
+		fclose(f);
+	}
+
+	ext_mem_undirected_vertex *read(off_t off, size_t size) {
+		if (off != curr_off) {
+			BOOST_VERIFY(fseeko(f, off, SEEK_SET) == 0);
+			curr_off = off;
+		}
+		if (buf.size() < size)
+			buf.resize(size);
+		if (fread(buf.data(), size, 1, f) != 1) {
+			fprintf(stderr, "can't read %ld bytes at %ld\n", size, off);
+			exit(1);
+		}
+		curr_off += size;
+		return ext_mem_undirected_vertex::deserialize(buf.data(), size);
+	}
+};
+
+struct neighbor_less
+{
+	bool operator()(const std::pair<vertex_id_t, size_t> &p1,
+			const std::pair<vertex_id_t, size_t> &p2) const {
+		return p1.first < p2.first;
+	}
+};
+
+/*
+ * Sort the neighbor list of a vertex. The edge data moves with the neighbors.
+ */
+void sort_neighbors(ext_mem_undirected_vertex &v)
+{
+	size_t num_edges = v.get_num_edges();
+	bool sorted = true;
+	for (size_t i = 1; i < num_edges && sorted; i++)
+		sorted = v.get_neighbor(i - 1) <= v.get_neighbor(i);
+	if (sorted)
+		return;
+
+	std::vector<std::pair<vertex_id_t, size_t> > neighs(num_edges);
+	for (size_t i = 0; i < num_edges; i++)
+		neighs[i] = std::pair<vertex_id_t, size_t>(v.get_neighbor(i), i);
+	std::stable_sort(neighs.begin(), neighs.end(), neighbor_less());
+
+	size_t edge_data_size = v.get_edge_data_size();
+	std::vector<char> data;
+	if (v.has_edge_data())
+		data.assign(v.get_raw_edge_data(0),
+				v.get_raw_edge_data(0) + num_edges * edge_data_size);
+	for (size_t i = 0; i < num_edges; i++) {
+		v.set_neighbor(i, neighs[i].first);
+		if (v.has_edge_data())
+			memcpy(v.get_raw_edge_data(i),
+					data.data() + neighs[i].second * edge_data_size,
+					edge_data_size);
+	}
+}
+
+class compressor
+{
+	adj_reader reader;
+	FILE *out;
+	off_t out_off;
+	std::vector<char> buf;
+	size_t orig_size;
+public:
+	compressor(const std::string &adj_file, const std::string &out_file,
+			const graph_header &header): reader(adj_file) {
+		out = fopen(out_file.c_str(), "w");
+		if (out == NULL) {
+			perror("fopen");
+			exit(1);
+		}
+		BOOST_VERIFY(fwrite(&header, sizeof(header), 1, out) == 1);
+		out_off = sizeof(header);
+		orig_size = sizeof(header);
+	}
+
+	~compressor() {
+		fclose(out);
+	}
+
+	off_t get_out_off() const {
+		return out_off;
+	}
+
+	size_t get_orig_size() const {
+		return orig_size;
+	}
+
+	/*
+	 * Compress a vertex and return the number of edges of the vertex.
+	 */
+	vsize_t compress(const ext_mem_vertex_info &info) {
+		ext_mem_undirected_vertex *v = reader.read(info.get_off(),
+				info.get_size());
+		assert(v->get_id() == info.get_id());
+		if (v->is_compressed()) {
+			fprintf(stderr, "the graph is already compressed\n");
+			exit(1);
+		}
+		sort_neighbors(*v);
+		size_t max_size = ext_mem_compressed_vertex::get_max_size(
+				v->get_num_edges(), v->get_edge_data_size());
+		if (buf.size() < max_size)
+			buf.resize(max_size);
+		size_t size = ext_mem_compressed_vertex::serialize(*v, buf.data(),
+				buf.size());
+		BOOST_VERIFY(fwrite(buf.data(), size, 1, out) == 1);
+		out_off += size;
+		orig_size += info.get_size();
+		return v->get_num_edges();
+	}
+};
+
+void compress_undirected(vertex_index::ptr index, const std::string &adj_file,
+		const std::string &out_adj_file, const std::string &out_index_file)
+{
+	undirected_vertex_index::ptr uindex = undirected_vertex_index::cast(index);
+	graph_header header = index->get_graph_header();
+	header.set_compressed_edges(true);
+	size_t num_vertices = header.get_num_vertices();
+
+	compressor comp(adj_file, out_adj_file, header);
+	std::vector<vertex_offset> entries(num_vertices + 1);
+	std::vector<vsize_t> degrees(num_vertices);
+	for (size_t i = 0; i < num_vertices; i++) {
+		entries[i] = vertex_offset(comp.get_out_off());
+		degrees[i] = comp.compress(uindex->get_vertex_info(i));
+	}
+	entries[num_vertices] = vertex_offset(comp.get_out_off());
+	undirected_vertex_index::dump(out_index_file, header, entries, degrees);
+	printf("compress the adjacency lists from %ld bytes to %ld bytes\n",
+			comp.get_orig_size(), comp.get_out_off());
+}
+
+void compress_directed(vertex_index::ptr index, const std::string &adj_file,
+		const std::string &out_adj_file, const std::string &out_index_file)
+{
+	directed_vertex_index::ptr dindex = directed_vertex_index::cast(index);
+	graph_header header = index->get_graph_header();
+	header.set_compressed_edges(true);
+	size_t num_vertices = header.get_num_vertices();
+
+	compressor comp(adj_file, out_adj_file, header);
+	// All in-parts of vertices are stored in front of all out-parts.
+	std::vector<off_t> in_offs(num_vertices + 1);
+	std::vector<off_t> out_offs(num_vertices + 1);
+	std::vector<vsize_t> degrees(num_vertices * 2);
+	for (size_t i = 0; i < num_vertices; i++) {
+		in_offs[i] = comp.get_out_off();
+		degrees[i] = comp.compress(dindex->get_vertex_info_in(i));
+	}
+	in_offs[num_vertices] = comp.get_out_off();
+	for (size_t i = 0; i < num_vertices; i++) {
+		out_offs[i] = comp.get_out_off();
+		degrees[num_vertices + i] = comp.compress(
+				dindex->get_vertex_info_out(i));
+	}
+	out_offs[num_vertices] = comp.get_out_off();
+
+	std::vector<directed_vertex_entry> entries(num_vertices + 1);
+	for (size_t i = 0; i <= num_vertices; i++)
+		entries[i] = directed_vertex_entry(in_offs[i], out_offs[i]);
+	directed_vertex_index::dump(out_index_file, header, entries, degrees);
+	printf("compress the adjacency lists from %ld bytes to %ld bytes\n",
+			comp.get_orig_size(), comp.get_out_off());
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 5) {
+		fprintf(stderr,
+				"compress-graph adj_file index_file out_adj_file out_index_file\n");
+		return -1;
+	}
+
+	const std::string adj_file = argv[1];
+	const std::string index_file = argv[2];
+	const std::string out_adj_file = argv[3];
+	const std::string out_index_file = argv[4];
+
+	vertex_index::ptr index = vertex_index::load(index_file);
+	const graph_header &header = index->get_graph_header();
+	if (header.has_compressed_edges()) {
+		fprintf(stderr, "the graph is already compressed\n");
+		return -1;
+	}
+	if (index->is_compressed()) {
+		fprintf(stderr, "the graph needs the original vertex index\n");
+		return -1;
+	}
+	if (header.get_graph_type() == graph_type::TS_DIRECTED
+			|| header.get_graph_type() == graph_type::TS_UNDIRECTED) {
+		fprintf(stderr, "time-series graphs can't be compressed\n");
+		return -1;
+	}
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	if (header.is_directed_graph())
+		compress_directed(index, adj_file, out_adj_file, out_index_file);
+	else
+		compress_undirected(index, adj_file, out_adj_file, out_index_file);
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to compress the graph\n",
+			time_diff(start, end));
+	return 0;
+}
@@ -0,0 +1,329 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This assigns the vertices of a graph in the Linux filesystem to
+ * the partitions of worker threads, so that most edges connect vertices
+ * in the same partition and most messages stay in a thread. The graph
+ * engine uses the partitions when `part_file' in the configuration
+ * points to the output file, and the number of partitions has to be
+ * the number of worker threads.
+ *
+ * Vertices are streamed in the order of their IDs, and a vertex is placed
+ * in the partition where most of its placed neighbors are, with a penalty
+ * on large partitions. A partition can't have more than `balance' times
+ * the average number of vertices. There are two scoring functions:
+ *
+ * fennel: the number of neighbors minus alpha * gamma * size^(gamma - 1),
+ * where gamma is 1.5 and alpha is sqrt(k) * m / n^1.5.
+ *
+ * ldg: the number of neighbors times (1 - size / capacity).
+ *
+ * The vertices can be streamed a few times. In a later pass, a vertex
+ * sees the partitions of all of its neighbors, which reduces the edge cut.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+#include <limits>
+
+#include "common.h"
+#include "vertex.h"
+#include "vertex_index.h"
+#include "partitioner.h"
+
+using namespace fg;
+
+/*
+ * The neighbor lists of all vertices in an array.
+ */
+struct neighbor_lists
+{
+	std::vector<size_t> offs;
+	std::vector<vertex_id_t> neighs;
+
+	size_t get_num_vertices() const {
+		return offs.size() - 1;
+	}
+
+	const vertex_id_t *begin(vertex_id_t id) const {
+		return neighs.data() + offs[id];
+	}
+
+	const vertex_id_t *end(vertex_id_t id) const {
+		return neighs.data() + offs[id + 1];
+	}
+};
+
+/*
+ * Read the neighbors of vertices in both directions.
+ */
+void read_neighbors(const std::string &adj_file, vertex_index::ptr index,
+		neighbor_lists &all)
+{
+	FILE *f = fopen(adj_file.c_str(), "r");
+	if (f == NULL) {
+		perror("fopen");
+		exit(1);
+	}
+	BOOST_VERIFY(fseeko(f, 0, SEEK_END) == 0);
+	std::vector<char> adj(ftello(f));
+	BOOST_VERIFY(fseeko(f, 0, SEEK_SET) == 0);
+	if (fread(adj.data(), adj.size(), 1, f) != 1) {
+		fprintf(stderr, "can't read %s\n", adj_file.c_str());
+		exit(1);
+	}
+	fclose(f);
+
+	size_t num_vertices = index->get_graph_header().get_num_vertices();
+	bool directed = index->get_graph_header().is_directed_graph();
+	all.offs.resize(num_vertices + 1);
+	all.offs[0] = 0;
+	for (size_t i = 0; i < num_vertices; i++) {
+		std::vector<ext_mem_vertex_info> infos;
+		if (directed) {
+			directed_vertex_index::ptr dindex
+				= directed_vertex_index::cast(index);
+			infos.push_back(dindex->get_vertex_info_in(i));
+			infos.push_back(dindex->get_vertex_info_out(i));
+		}
+		else
+			infos.push_back(undirected_vertex_index::cast(
+						index)->get_vertex_info(i));
+		for (size_t j = 0; j < infos.size(); j++) {
+			ext_mem_undirected_vertex *v
+				= ext_mem_undirected_vertex::deserialize(
+						adj.data() + infos[j].get_off(), infos[j].get_size());
+			assert(v->get_id() == i);
+			for (size_t k = 0; k < v->get_num_edges(); k++)
+				all.neighs.push_back(v->get_neighbor(k));
+		}
+		all.offs[i + 1] = all.neighs.size();
+	}
+}
+
+enum class part_score
+{
+	FENNEL,
+	LDG,
+};
+
+class stream_partitioner
+{
+	const neighbor_lists &all;
+	part_score score;
+	int num_parts;
+	size_t capacity;
+	double alpha;
+	std::vector<int> part_ids;
+	std::vector<size_t> part_sizes;
+	// The number of the neighbors of the current vertex in each partition.
+	std::vector<size_t> num_neighs;
+	std::vector<int> touched_parts;
+
+	double get_score(int part_id) const {
+		double size = part_sizes[part_id];
+		if (score == part_score::FENNEL)
+			return num_neighs[part_id] - alpha * 1.5 * sqrt(size);
+		else
+			return num_neighs[part_id] * (1 - size / capacity);
+	}
+
+	int place(vertex_id_t id);
+public:
+	stream_partitioner(const neighbor_lists &_all, part_score score,
+			int num_parts, double balance): all(_all) {
+		size_t num_vertices = all.get_num_vertices();
+		this->score = score;
+		this->num_parts = num_parts;
+		capacity = ceil(balance * num_vertices / num_parts);
+		// The number of edges, which is counted twice in the neighbor lists.
+		double num_edges = all.neighs.size() / 2.0;
+		alpha = sqrt(num_parts) * num_edges / pow(num_vertices, 1.5);
+		part_ids.resize(num_vertices, -1);
+		part_sizes.resize(num_parts);
+		num_neighs.resize(num_parts);
+	}
+
+	void run_pass() {
+		for (size_t i = 0; i < part_ids.size(); i++) {
+			// Remove the vertex from its partition in the previous pass.
+			if (part_ids[i] >= 0)
+				part_sizes[part_ids[i]]--;
+			part_ids[i] = place(i);
+			part_sizes[part_ids[i]]++;
+		}
+	}
+
+	const std::vector<int> &get_part_ids() const {
+		return part_ids;
+	}
+
+	size_t get_max_part_size() const {
+		size_t max_size = 0;
+		for (int i = 0; i < num_parts; i++)
+			max_size = std::max(max_size, part_sizes[i]);
+		return max_size;
+	}
+};
+
+int stream_partitioner::place(vertex_id_t id)
+{
+	for (const vertex_id_t *it = all.begin(id); it != all.end(id); it++) {
+		int part_id = part_ids[*it];
+		if (part_id < 0 || *it == id)
+			continue;
+		if (num_neighs[part_id] == 0)
+			touched_parts.push_back(part_id);
+		num_neighs[part_id]++;
+	}
+
+	// Among the partitions with the best score, a vertex goes to
+	// the smallest one, so vertices without placed neighbors are spread
+	// evenly.
+	int best = -1;
+	double best_score = -std::numeric_limits<double>::max();
+	for (int i = 0; i < num_parts; i++) {
+		if (part_sizes[i] >= capacity)
+			continue;
+		double s = get_score(i);
+		if (best < 0 || s > best_score
+				|| (s == best_score && part_sizes[i] < part_sizes[best])) {
+			best = i;
+			best_score = s;
+		}
+	}
+	assert(best >= 0);
+
+	for (size_t i = 0; i < touched_parts.size(); i++)
+		num_neighs[touched_parts[i]] = 0;
+	touched_parts.clear();
+	return best;
+}
+
+/*
+ * The fraction of the edges whose two ends are in different partitions.
+ */
+double get_edge_cut(const neighbor_lists &all,
+		const graph_partitioner &partitioner)
+{
+	size_t num_cut = 0;
+	for (size_t i = 0; i < all.get_num_vertices(); i++) {
+		int part_id = partitioner.map(i);
+		for (const vertex_id_t *it = all.begin(i); it != all.end(i); it++)
+			if (partitioner.map(*it) != part_id)
+				num_cut++;
+	}
+	return all.neighs.empty() ? 0 : ((double) num_cut) / all.neighs.size();
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 5) {
+		fprintf(stderr,
+				"partition-graph adj_file index_file part_file num_parts [score] [balance] [num_passes]\n");
+		fprintf(stderr, "num_parts: the number of worker threads\n");
+		fprintf(stderr, "score: fennel, ldg (default: fennel)\n");
+		fprintf(stderr, "balance: the max partition size relative to the average (default: 1.05)\n");
+		fprintf(stderr, "num_passes: the number of times vertices are streamed (default: 1)\n");
+		return -1;
+	}
+
+	const std::string adj_file = argv[1];
+	const std::string index_file = argv[2];
+	const std::string part_file = argv[3];
+	int num_parts = atoi(argv[4]);
+	std::string score_name = "fennel";
+	if (argc >= 6)
+		score_name = argv[5];
+	double balance = 1.05;
+	if (argc >= 7)
+		balance = atof(argv[6]);
+	int num_passes = 1;
+	if (argc >= 8)
+		num_passes = atoi(argv[7]);
+
+	part_score score;
+	if (score_name == "fennel")
+		score = part_score::FENNEL;
+	else if (score_name == "ldg")
+		score = part_score::LDG;
+	else {
+		fprintf(stderr, "unknown score %s\n", score_name.c_str());
+		return -1;
+	}
+	if (num_parts <= 0 || !power2(num_parts)) {
+		fprintf(stderr, "the number of partitions has to be 2^n\n");
+		return -1;
+	}
+	if (balance < 1) {
+		fprintf(stderr, "the balance can't be smaller than 1\n");
+		return -1;
+	}
+
+	vertex_index::ptr index = vertex_index::load(index_file);
+	if (index->is_compressed()) {
+		fprintf(stderr, "the index can't be compressed\n");
+		return -1;
+	}
+	if (index->get_graph_header().has_compressed_edges()) {
+		fprintf(stderr, "the edges can't be compressed\n");
+		return -1;
+	}
+	if (index->get_graph_header().get_graph_type() == graph_type::TS_DIRECTED
+			|| index->get_graph_header().get_graph_type()
+			== graph_type::TS_UNDIRECTED) {
+		fprintf(stderr, "time-series graphs aren't supported\n");
+		return -1;
+	}
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	neighbor_lists all;
+	read_neighbors(adj_file, index, all);
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to read %ld vertices and %ld edges\n",
+			time_diff(start, end), all.get_num_vertices(),
+			all.neighs.size() / 2);
+
+	start = end;
+	stream_partitioner partitioner(all, score, num_parts, balance);
+	for (int i = 0; i < num_passes; i++)
+		partitioner.run_pass();
+	map_graph_partitioner map_partitioner(partitioner.get_part_ids(),
+			num_parts);
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to partition the graph with %s\n",
+			time_diff(start, end), score_name.c_str());
+
+	range_graph_partitioner range_partitioner(num_parts);
+	printf("edge cut: %.3f with range partitioning, %.3f with %s\n",
+			get_edge_cut(all, range_partitioner),
+			get_edge_cut(all, map_partitioner), score_name.c_str());
+	printf("the largest partition has %ld vertices, %.3f of the average\n",
+			partitioner.get_max_part_size(),
+			((double) partitioner.get_max_part_size()) * num_parts
+			/ all.get_num_vertices());
+	map_partitioner.dump(part_file);
+	return 0;
+}
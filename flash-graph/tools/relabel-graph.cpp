@@ -0,0 +1,529 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This relabels the vertices of a graph in the Linux filesystem and
+ * writes the graph with the new vertex IDs and the permutation that maps
+ * the new vertex IDs to the original ones. It supports three orders:
+ *
+ * degree: vertices are ordered by their degree in descending order.
+ * Triangle counting, k-core and scan statistics orient edges from
+ * a vertex with a larger degree, so the edge lists they intersect are
+ * short, and the hub vertices are stored together.
+ *
+ * rcm: the reverse Cuthill-McKee order. A BFS starts from a vertex with
+ * the smallest degree and visits neighbors in increasing degree order,
+ * so the neighbors of a vertex get close vertex IDs.
+ *
+ * gorder: vertices are placed one at a time, and the next vertex is
+ * the one with the most neighbors and siblings (vertices that share
+ * a neighbor) in the last few placed vertices, which approximates
+ * Gorder. The vertices accessed together are stored in the same pages.
+ *
+ * The tool keeps the graph in memory. The neighbor lists in the new graph
+ * are sorted, and the edge data moves with the neighbors.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "common.h"
+#include "vertex.h"
+#include "vertex_index.h"
+#include "vertex_permutation.h"
+
+using namespace fg;
+
+/*
+ * The neighbor lists of all vertices in an array.
+ */
+struct neighbor_lists
+{
+	std::vector<size_t> offs;
+	std::vector<vertex_id_t> neighs;
+
+	size_t get_degree(vertex_id_t id) const {
+		return offs[id + 1] - offs[id];
+	}
+
+	const vertex_id_t *begin(vertex_id_t id) const {
+		return neighs.data() + offs[id];
+	}
+
+	const vertex_id_t *end(vertex_id_t id) const {
+		return neighs.data() + offs[id + 1];
+	}
+};
+
+class graph_image
+{
+	std::vector<char> adj;
+	vertex_index::ptr index;
+	bool directed;
+public:
+	graph_image(const std::string &adj_file, vertex_index::ptr index) {
+		this->index = index;
+		directed = index->get_graph_header().is_directed_graph();
+		FILE *f = fopen(adj_file.c_str(), "r");
+		if (f == NULL) {
+			perror("fopen");
+			exit(1);
+		}
+		BOOST_VERIFY(fseeko(f, 0, SEEK_END) == 0);
+		adj.resize(ftello(f));
+		BOOST_VERIFY(fseeko(f, 0, SEEK_SET) == 0);
+		if (fread(adj.data(), adj.size(), 1, f) != 1) {
+			fprintf(stderr, "can't read %s\n", adj_file.c_str());
+			exit(1);
+		}
+		fclose(f);
+	}
+
+	size_t get_num_vertices() const {
+		return index->get_graph_header().get_num_vertices();
+	}
+
+	bool is_directed() const {
+		return directed;
+	}
+
+	/*
+	 * Get the in-part or the out-part of a vertex in a directed graph,
+	 * or a vertex in an undirected graph.
+	 */
+	ext_mem_undirected_vertex *get_vertex(vertex_id_t id, edge_type type) {
+		ext_mem_vertex_info info;
+		if (!directed)
+			info = undirected_vertex_index::cast(index)->get_vertex_info(id);
+		else if (type == edge_type::IN_EDGE)
+			info = directed_vertex_index::cast(index)->get_vertex_info_in(id);
+		else
+			info = directed_vertex_index::cast(index)->get_vertex_info_out(id);
+		ext_mem_undirected_vertex *v = ext_mem_undirected_vertex::deserialize(
+				adj.data() + info.get_off(), info.get_size());
+		assert(v->get_id() == id);
+		return v;
+	}
+
+	void get_neighbor_lists(edge_type type, neighbor_lists &lists) {
+		size_t num_vertices = get_num_vertices();
+		lists.offs.resize(num_vertices + 1);
+		lists.offs[0] = 0;
+		for (size_t i = 0; i < num_vertices; i++) {
+			ext_mem_undirected_vertex *v = get_vertex(i, type);
+			for (size_t j = 0; j < v->get_num_edges(); j++)
+				lists.neighs.push_back(v->get_neighbor(j));
+			lists.offs[i + 1] = lists.neighs.size();
+		}
+	}
+};
+
+/*
+ * Get the neighbors of vertices in both directions.
+ */
+void get_all_neighbors(graph_image &g, neighbor_lists &all)
+{
+	if (!g.is_directed()) {
+		g.get_neighbor_lists(edge_type::OUT_EDGE, all);
+		return;
+	}
+	neighbor_lists in;
+	neighbor_lists out;
+	g.get_neighbor_lists(edge_type::IN_EDGE, in);
+	g.get_neighbor_lists(edge_type::OUT_EDGE, out);
+	size_t num_vertices = g.get_num_vertices();
+	all.offs.resize(num_vertices + 1);
+	all.offs[0] = 0;
+	all.neighs.reserve(in.neighs.size() + out.neighs.size());
+	for (size_t i = 0; i < num_vertices; i++) {
+		all.neighs.insert(all.neighs.end(), in.begin(i), in.end(i));
+		all.neighs.insert(all.neighs.end(), out.begin(i), out.end(i));
+		all.offs[i + 1] = all.neighs.size();
+	}
+}
+
+std::vector<vertex_id_t> degree_order(const neighbor_lists &all)
+{
+	size_t num_vertices = all.offs.size() - 1;
+	std::vector<vertex_id_t> order(num_vertices);
+	for (size_t i = 0; i < num_vertices; i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(),
+			[&all](vertex_id_t id1, vertex_id_t id2) {
+				return all.get_degree(id1) > all.get_degree(id2);
+			});
+	return order;
+}
+
+std::vector<vertex_id_t> rcm_order(const neighbor_lists &all)
+{
+	size_t num_vertices = all.offs.size() - 1;
+	std::vector<vertex_id_t> starts = degree_order(all);
+	std::reverse(starts.begin(), starts.end());
+	std::vector<bool> visited(num_vertices);
+	std::vector<vertex_id_t> order;
+	order.reserve(num_vertices);
+	std::vector<vertex_id_t> neighs;
+	for (size_t i = 0; i < num_vertices; i++) {
+		if (visited[starts[i]])
+			continue;
+		// The order works as the queue of BFS.
+		size_t head = order.size();
+		order.push_back(starts[i]);
+		visited[starts[i]] = true;
+		for (; head < order.size(); head++) {
+			vertex_id_t id = order[head];
+			neighs.clear();
+			for (const vertex_id_t *it = all.begin(id); it != all.end(id); it++) {
+				if (!visited[*it]) {
+					visited[*it] = true;
+					neighs.push_back(*it);
+				}
+			}
+			std::stable_sort(neighs.begin(), neighs.end(),
+					[&all](vertex_id_t id1, vertex_id_t id2) {
+						return all.get_degree(id1) < all.get_degree(id2);
+					});
+			order.insert(order.end(), neighs.begin(), neighs.end());
+		}
+	}
+	std::reverse(order.begin(), order.end());
+	return order;
+}
+
+class gorder_scores
+{
+	const neighbor_lists &all;
+	// A vertex with more neighbors than this is a hub, and its neighbors
+	// aren't counted as siblings.
+	size_t max_sibling_degree;
+	std::vector<int> scores;
+	std::vector<bool> placed;
+	size_t num_placed;
+	/*
+	 * The vertices that aren't placed are kept in a list per score.
+	 * A score only changes by one at a time, so a vertex moves to
+	 * the next list in constant time.
+	 */
+	std::vector<vertex_id_t> heads;
+	std::vector<vertex_id_t> prevs;
+	std::vector<vertex_id_t> nexts;
+	size_t top;
+
+	void unlink(vertex_id_t id) {
+		if (prevs[id] == INVALID_VERTEX_ID)
+			heads[scores[id]] = nexts[id];
+		else
+			nexts[prevs[id]] = nexts[id];
+		if (nexts[id] != INVALID_VERTEX_ID)
+			prevs[nexts[id]] = prevs[id];
+	}
+
+	void link(vertex_id_t id) {
+		size_t score = scores[id];
+		if (score >= heads.size())
+			heads.resize(score + 1, INVALID_VERTEX_ID);
+		prevs[id] = INVALID_VERTEX_ID;
+		nexts[id] = heads[score];
+		if (heads[score] != INVALID_VERTEX_ID)
+			prevs[heads[score]] = id;
+		heads[score] = id;
+		top = std::max(top, score);
+	}
+
+	void add(vertex_id_t id, int delta) {
+		if (placed[id])
+			return;
+		unlink(id);
+		scores[id] += delta;
+		link(id);
+	}
+public:
+	gorder_scores(const neighbor_lists &_all): all(_all) {
+		size_t num_vertices = all.offs.size() - 1;
+		max_sibling_degree = sqrt(num_vertices);
+		scores.resize(num_vertices);
+		placed.resize(num_vertices);
+		num_placed = 0;
+		prevs.resize(num_vertices);
+		nexts.resize(num_vertices);
+		top = 0;
+		for (size_t i = num_vertices; i > 0; i--)
+			link(i - 1);
+	}
+
+	bool empty() const {
+		return num_placed == placed.size();
+	}
+
+	/*
+	 * Get a vertex with the highest score.
+	 */
+	vertex_id_t get_best() {
+		while (heads[top] == INVALID_VERTEX_ID)
+			top--;
+		return heads[top];
+	}
+
+	void place(vertex_id_t id) {
+		unlink(id);
+		placed[id] = true;
+		num_placed++;
+	}
+
+	/*
+	 * Add the relation with a vertex to the scores of its neighbors and
+	 * siblings when it enters the window, or remove the relation when
+	 * it leaves the window.
+	 */
+	void update(vertex_id_t id, int delta) {
+		for (const vertex_id_t *it = all.begin(id); it != all.end(id); it++) {
+			add(*it, delta);
+			if (all.get_degree(*it) > max_sibling_degree)
+				continue;
+			for (const vertex_id_t *it2 = all.begin(*it);
+					it2 != all.end(*it); it2++)
+				if (*it2 != id)
+					add(*it2, delta);
+		}
+	}
+};
+
+std::vector<vertex_id_t> gorder_order(const neighbor_lists &all,
+		size_t window)
+{
+	size_t num_vertices = all.offs.size() - 1;
+	std::vector<vertex_id_t> order;
+	order.reserve(num_vertices);
+	gorder_scores scores(all);
+	// Start with the vertex with the largest degree.
+	std::vector<vertex_id_t> by_degree = degree_order(all);
+	vertex_id_t next = num_vertices > 0 ? by_degree[0] : 0;
+	while (!scores.empty()) {
+		scores.place(next);
+		order.push_back(next);
+		scores.update(next, 1);
+		if (order.size() > window)
+			scores.update(order[order.size() - window - 1], -1);
+		if (!scores.empty())
+			next = scores.get_best();
+	}
+	return order;
+}
+
+struct neighbor_less
+{
+	bool operator()(const std::pair<vertex_id_t, size_t> &p1,
+			const std::pair<vertex_id_t, size_t> &p2) const {
+		return p1.first < p2.first;
+	}
+};
+
+class relabeler
+{
+	graph_image &g;
+	vertex_permutation::ptr perm;
+	FILE *out;
+	off_t out_off;
+	std::vector<char> buf;
+	std::vector<std::pair<vertex_id_t, size_t> > neighs;
+public:
+	relabeler(graph_image &_g, vertex_permutation::ptr perm,
+			const std::string &out_file, const graph_header &header): g(_g) {
+		this->perm = perm;
+		out = fopen(out_file.c_str(), "w");
+		if (out == NULL) {
+			perror("fopen");
+			exit(1);
+		}
+		BOOST_VERIFY(fwrite(&header, sizeof(header), 1, out) == 1);
+		out_off = sizeof(header);
+	}
+
+	~relabeler() {
+		fclose(out);
+	}
+
+	off_t get_out_off() const {
+		return out_off;
+	}
+
+	/*
+	 * Write the vertex with the new vertex ID.
+	 */
+	void write(vertex_id_t new_id, edge_type type) {
+		ext_mem_undirected_vertex *v = g.get_vertex(perm->get_orig_id(new_id),
+				type);
+		size_t num_edges = v->get_num_edges();
+		neighs.resize(num_edges);
+		for (size_t i = 0; i < num_edges; i++)
+			neighs[i] = std::pair<vertex_id_t, size_t>(
+					perm->get_new_id(v->get_neighbor(i)), i);
+		std::stable_sort(neighs.begin(), neighs.end(), neighbor_less());
+
+		size_t edge_data_size = v->get_edge_data_size();
+		size_t size = ext_mem_undirected_vertex::num_edges2vsize(num_edges,
+				edge_data_size);
+		buf.assign(size, 0);
+		ext_mem_undirected_vertex *new_v = new (buf.data())
+			ext_mem_undirected_vertex(new_id, num_edges, edge_data_size);
+		for (size_t i = 0; i < num_edges; i++) {
+			new_v->set_neighbor(i, neighs[i].first);
+			if (v->has_edge_data())
+				memcpy(new_v->get_raw_edge_data(i),
+						v->get_raw_edge_data(neighs[i].second), edge_data_size);
+		}
+		BOOST_VERIFY(fwrite(buf.data(), size, 1, out) == 1);
+		out_off += size;
+	}
+};
+
+void relabel_undirected(graph_image &g, vertex_permutation::ptr perm,
+		const graph_header &header, const std::string &out_adj_file,
+		const std::string &out_index_file)
+{
+	size_t num_vertices = header.get_num_vertices();
+	relabeler r(g, perm, out_adj_file, header);
+	std::vector<vertex_offset> entries(num_vertices + 1);
+	for (size_t i = 0; i < num_vertices; i++) {
+		entries[i] = vertex_offset(r.get_out_off());
+		r.write(i, edge_type::OUT_EDGE);
+	}
+	entries[num_vertices] = vertex_offset(r.get_out_off());
+	undirected_vertex_index::dump(out_index_file, header, entries);
+}
+
+void relabel_directed(graph_image &g, vertex_permutation::ptr perm,
+		const graph_header &header, const std::string &out_adj_file,
+		const std::string &out_index_file)
+{
+	size_t num_vertices = header.get_num_vertices();
+	relabeler r(g, perm, out_adj_file, header);
+	// All in-parts of vertices are stored in front of all out-parts.
+	std::vector<off_t> in_offs(num_vertices + 1);
+	std::vector<off_t> out_offs(num_vertices + 1);
+	for (size_t i = 0; i < num_vertices; i++) {
+		in_offs[i] = r.get_out_off();
+		r.write(i, edge_type::IN_EDGE);
+	}
+	in_offs[num_vertices] = r.get_out_off();
+	for (size_t i = 0; i < num_vertices; i++) {
+		out_offs[i] = r.get_out_off();
+		r.write(i, edge_type::OUT_EDGE);
+	}
+	out_offs[num_vertices] = r.get_out_off();
+
+	std::vector<directed_vertex_entry> entries(num_vertices + 1);
+	for (size_t i = 0; i <= num_vertices; i++)
+		entries[i] = directed_vertex_entry(in_offs[i], out_offs[i]);
+	directed_vertex_index::dump(out_index_file, header, entries);
+}
+
+/*
+ * The sum of the distances between the IDs of the two ends of edges,
+ * which is smaller when the neighbors of vertices are close to them.
+ */
+double avg_edge_gap(const neighbor_lists &all, vertex_permutation::ptr perm)
+{
+	size_t num_vertices = all.offs.size() - 1;
+	double tot_gap = 0;
+	for (size_t i = 0; i < num_vertices; i++) {
+		vertex_id_t new_id = perm ? perm->get_new_id(i) : i;
+		for (const vertex_id_t *it = all.begin(i); it != all.end(i); it++) {
+			vertex_id_t new_neigh = perm ? perm->get_new_id(*it) : *it;
+			tot_gap += fabs((double) new_id - (double) new_neigh);
+		}
+	}
+	return all.neighs.empty() ? 0 : tot_gap / all.neighs.size();
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 7) {
+		fprintf(stderr,
+				"relabel-graph adj_file index_file out_adj_file out_index_file perm_file order [window]\n");
+		fprintf(stderr, "order: degree, rcm, gorder\n");
+		fprintf(stderr, "window: the window size of gorder (default: 5)\n");
+		return -1;
+	}
+
+	const std::string adj_file = argv[1];
+	const std::string index_file = argv[2];
+	const std::string out_adj_file = argv[3];
+	const std::string out_index_file = argv[4];
+	const std::string perm_file = argv[5];
+	const std::string order_name = argv[6];
+	size_t window = 5;
+	if (argc >= 8)
+		window = atol(argv[7]);
+
+	vertex_index::ptr index = vertex_index::load(index_file);
+	const graph_header &header = index->get_graph_header();
+	if (header.has_compressed_edges() || index->is_compressed()) {
+		fprintf(stderr,
+				"a graph has to be relabeled before it's compressed\n");
+		return -1;
+	}
+	if (header.get_graph_type() == graph_type::TS_DIRECTED
+			|| header.get_graph_type() == graph_type::TS_UNDIRECTED) {
+		fprintf(stderr, "time-series graphs can't be relabeled\n");
+		return -1;
+	}
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	graph_image g(adj_file, index);
+	neighbor_lists all;
+	get_all_neighbors(g, all);
+	std::vector<vertex_id_t> order;
+	if (order_name == "degree")
+		order = degree_order(all);
+	else if (order_name == "rcm")
+		order = rcm_order(all);
+	else if (order_name == "gorder")
+		order = gorder_order(all, window);
+	else {
+		fprintf(stderr, "unknown order %s\n", order_name.c_str());
+		return -1;
+	}
+	vertex_permutation::ptr perm = vertex_permutation::create(order);
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to compute the %s order\n",
+			time_diff(start, end), order_name.c_str());
+	printf("the average ID gap of edges: %.1f -> %.1f\n",
+			avg_edge_gap(all, vertex_permutation::ptr()),
+			avg_edge_gap(all, perm));
+
+	start = end;
+	if (header.is_directed_graph())
+		relabel_directed(g, perm, header, out_adj_file, out_index_file);
+	else
+		relabel_undirected(g, perm, header, out_adj_file, out_index_file);
+	perm->dump(perm_file);
+	gettimeofday(&end, NULL);
+	printf("It takes %.3f seconds to write the relabeled graph\n",
+			time_diff(start, end));
+	return 0;
+}
@@ -17,7 +17,16 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
+
+#include <limits>
+
+#include "safs_exception.h"
+
 #include "ts_graph.h"
+#include "vertex_index.h"
+#include "graph_config.h"
+#include "graph_exception.h"
 
 namespace fg
 {
@@ -43,4 +52,225 @@ edge_seq_iterator get_ts_iterator(const page_directed_vertex &v,
 	return v.get_neigh_seq_it(type, start, end);
 }
 
+const int64_t TS_INDEX_MAGIC_NUMBER = 0x7473696e64657831L;
+
+/*
+ * The header of a timestamp index file. It's followed by the locations
+ * of the edge lists in the entries and the entries.
+ */
+struct ts_index_header
+{
+	int64_t magic_number;
+	int64_t start_time;
+	int64_t interval;
+	uint64_t min_num_edges;
+	uint64_t num_lists;
+	uint64_t num_entries;
+};
+
+void ts_edge_index::add_edge_list(const ts_edge_data timestamps[],
+		size_t num_edges)
+{
+	if (num_edges > 0 && num_edges < min_num_edges) {
+		list_offs.push_back(entries.size());
+		return;
+	}
+
+	for (size_t i = 0; i < num_edges; i++) {
+		time_t t = timestamps[i].get_timestamp();
+		if (i > 0 && t < timestamps[i - 1].get_timestamp())
+			throw wrong_format("the edges aren't sorted by timestamps");
+		// Round down for the time before `start_time'.
+		int64_t time_idx = t >= start_time ? (t - start_time) / interval
+			: -((start_time - t + interval - 1) / interval);
+		if (time_idx >= std::numeric_limits<int>::max()
+				|| time_idx < std::numeric_limits<int>::min())
+			throw wrong_format("there are too many time intervals");
+		if (i == 0 || time_idx != entries.back().time_idx) {
+			entry e;
+			e.time_idx = time_idx;
+			e.off = i;
+			entries.push_back(e);
+		}
+	}
+	entry last;
+	last.time_idx = std::numeric_limits<int>::max();
+	last.off = num_edges;
+	entries.push_back(last);
+	list_offs.push_back(entries.size());
+}
+
+const ts_edge_index::entry *ts_edge_index::lower_bound(size_t list_id,
+		int time_idx) const
+{
+	struct comp_entry {
+		bool operator()(const entry &e, int time_idx) const {
+			return e.time_idx < time_idx;
+		}
+	};
+	// The last entry of an edge list is larger than any interval.
+	return std::lower_bound(entries.data() + list_offs[list_id],
+			entries.data() + list_offs[list_id + 1] - 1, time_idx,
+			comp_entry());
+}
+
+std::pair<vsize_t, vsize_t> ts_edge_index::get_edge_range(vertex_id_t id,
+		edge_type type, time_t time_start, time_t time_interval) const
+{
+	assert(is_aligned(time_start, time_interval));
+	assert(is_indexed(id, type));
+	size_t list_id = get_list_id(id, type);
+	int64_t start_idx = (time_start - start_time) / interval;
+	int64_t end_idx = start_idx + time_interval / interval;
+	start_idx = std::max<int64_t>(start_idx, std::numeric_limits<int>::min());
+	end_idx = std::min<int64_t>(end_idx, std::numeric_limits<int>::max());
+	vsize_t start = lower_bound(list_id, start_idx)->off;
+	vsize_t end = lower_bound(list_id, end_idx)->off;
+	return std::pair<vsize_t, vsize_t>(start, end);
+}
+
+namespace
+{
+
+/*
+ * Read the edge lists in one part of the graph file sequentially.
+ */
+class edge_list_reader
+{
+	FILE *f;
+	std::string file;
+	std::vector<char> buf;
+public:
+	edge_list_reader(const std::string &file) {
+		this->file = file;
+		f = fopen(file.c_str(), "r");
+		if (f == NULL)
+			throw safs::io_exception(std::string("can't open ") + file);
+	}
+
+	~edge_list_reader() {
+		fclose(f);
+	}
+
+	const ext_mem_undirected_vertex *read(const ext_mem_vertex_info &info) {
+		if (ftello(f) != info.get_off())
+			BOOST_VERIFY(fseeko(f, info.get_off(), SEEK_SET) == 0);
+		buf.resize(info.get_size());
+		if (fread(buf.data(), buf.size(), 1, f) != 1)
+			throw safs::io_exception(std::string("can't read from ") + file);
+		return ext_mem_undirected_vertex::deserialize(buf.data(), buf.size());
+	}
+};
+
+void add_ts_edge_list(ts_edge_index &ts_index, const ext_mem_undirected_vertex &v)
+{
+	if (v.get_num_edges() > 0)
+		ts_index.add_edge_list(&v.get_edge_data<ts_edge_data>(0),
+				v.get_num_edges());
+	else
+		ts_index.add_edge_list(NULL, 0);
+}
+
+}
+
+ts_edge_index::ptr ts_edge_index::create(const std::string &adj_file,
+		const std::string &index_file, time_t start_time, time_t interval,
+		size_t min_num_edges)
+{
+	vertex_index::ptr index = vertex_index::load(index_file);
+	if (index->is_compressed()
+			|| index->get_graph_header().has_compressed_edges())
+		throw wrong_format("a compressed graph isn't supported");
+	if (index->get_graph_header().get_graph_type() != graph_type::DIRECTED
+			|| index->get_graph_header().get_edge_data_size()
+			!= sizeof(ts_edge_data))
+		throw wrong_format("it isn't a directed time-series graph");
+	directed_vertex_index::ptr dindex = directed_vertex_index::cast(index);
+
+	ts_edge_index::ptr ts_index = create(start_time, interval, min_num_edges);
+	edge_list_reader in_reader(adj_file);
+	edge_list_reader out_reader(adj_file);
+	size_t num_vertices = index->get_graph_header().get_num_vertices();
+	for (size_t i = 0; i < num_vertices; i++) {
+		const ext_mem_undirected_vertex *v = in_reader.read(
+				dindex->get_vertex_info_in(i));
+		assert(v->get_id() == i);
+		add_ts_edge_list(*ts_index, *v);
+		v = out_reader.read(dindex->get_vertex_info_out(i));
+		assert(v->get_id() == i);
+		add_ts_edge_list(*ts_index, *v);
+	}
+	return ts_index;
+}
+
+ts_edge_index::ptr ts_edge_index::load(const std::string &file)
+{
+	FILE *f = fopen(file.c_str(), "r");
+	if (f == NULL)
+		throw safs::io_exception(std::string("can't open ") + file);
+	ts_index_header header;
+	if (fread(&header, sizeof(header), 1, f) != 1
+			|| header.magic_number != TS_INDEX_MAGIC_NUMBER
+			|| header.interval <= 0 || header.num_lists % 2 != 0) {
+		fclose(f);
+		throw wrong_format(boost::str(boost::format(
+						"%1% isn't a timestamp index file") % file));
+	}
+	ts_edge_index::ptr ts_index = create(header.start_time, header.interval,
+			header.min_num_edges);
+	ts_index->list_offs.resize(header.num_lists + 1);
+	ts_index->entries.resize(header.num_entries);
+	size_t ret1 = fread(ts_index->list_offs.data(),
+			sizeof(ts_index->list_offs[0]), ts_index->list_offs.size(), f);
+	size_t ret2 = fread(ts_index->entries.data(),
+			sizeof(ts_index->entries[0]), ts_index->entries.size(), f);
+	fclose(f);
+	if (ret1 != ts_index->list_offs.size() || ret2 != ts_index->entries.size())
+		throw wrong_format(boost::str(boost::format("%1% is truncated")
+					% file));
+	return ts_index;
+}
+
+void ts_edge_index::dump(const std::string &file) const
+{
+	ts_index_header header;
+	header.magic_number = TS_INDEX_MAGIC_NUMBER;
+	header.start_time = start_time;
+	header.interval = interval;
+	header.min_num_edges = min_num_edges;
+	header.num_lists = list_offs.size() - 1;
+	header.num_entries = entries.size();
+	FILE *f = fopen(file.c_str(), "w");
+	if (f == NULL)
+		ABORT_MSG(boost::format("fail to open %1%: %2%")
+				% file % strerror(errno));
+	BOOST_VERIFY(fwrite(&header, sizeof(header), 1, f) == 1);
+	BOOST_VERIFY(fwrite(list_offs.data(), sizeof(list_offs[0]),
+				list_offs.size(), f) == list_offs.size());
+	BOOST_VERIFY(fwrite(entries.data(), sizeof(entries[0]),
+				entries.size(), f) == entries.size());
+	fclose(f);
+}
+
+ts_edge_index::ptr load_ts_index(const graph_header &header,
+		time_t time_start, time_t time_interval)
+{
+	if (graph_conf.get_ts_index_file().empty())
+		return ts_edge_index::ptr();
+
+	ts_edge_index::ptr ts_index = ts_edge_index::load(
+			graph_conf.get_ts_index_file());
+	if (ts_index->get_num_vertices() != header.get_num_vertices())
+		throw wrong_format(boost::str(boost::format(
+						"%1% isn't the timestamp index of the graph")
+					% graph_conf.get_ts_index_file()));
+	if (!ts_index->is_aligned(time_start, time_interval)) {
+		BOOST_LOG_TRIVIAL(info) << boost::format(
+				"the time range isn't aligned to the interval %1% of %2%")
+			% ts_index->get_interval() % graph_conf.get_ts_index_file();
+		return ts_edge_index::ptr();
+	}
+	return ts_index;
+}
+
 }
@@ -20,9 +20,14 @@
  * limitations under the License.
  */
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "vertex.h"
+#include "graph_file_header.h"
 
 namespace fg
 {
@@ -34,6 +39,126 @@ const int MONTH_SECS = DAY_SECS * 30;
 edge_seq_iterator get_ts_iterator(const page_directed_vertex &v,
 		edge_type type, time_t time_start, time_t time_interval);
 
+/*
+ * This is the per-vertex timestamp index of a directed time-series graph,
+ * whose edge lists are sorted by timestamps. The time is split into
+ * intervals of the same length from `start_time', and the index keeps
+ * the location of the first edge of each interval in every edge list
+ * that has edges in the interval. Time ranges aligned to the intervals
+ * are located in the index without reading the edge data, so only
+ * the neighbors in a time range need to be read from the graph file.
+ *
+ * An edge list with fewer than `min_num_edges' edges takes a page or two
+ * in the graph file, so it isn't indexed and is read entirely.
+ */
+class ts_edge_index
+{
+	struct entry
+	{
+		// The interval of the edge.
+		int time_idx;
+		// The location of the first edge of the interval in the edge list.
+		vsize_t off;
+	};
+
+	time_t start_time;
+	time_t interval;
+	size_t min_num_edges;
+	// The entries of edge list i are in [list_offs[i], list_offs[i + 1]).
+	// The in-edge list of vertex v is the edge list 2 * v and the out-edge
+	// list is 2 * v + 1. The last entry of an edge list has the number of
+	// edges in the list, and an edge list that isn't indexed doesn't have
+	// entries.
+	std::vector<size_t> list_offs;
+	std::vector<entry> entries;
+
+	ts_edge_index(time_t start_time, time_t interval, size_t min_num_edges) {
+		this->start_time = start_time;
+		this->interval = interval;
+		this->min_num_edges = min_num_edges;
+		list_offs.push_back(0);
+	}
+
+	static size_t get_list_id(vertex_id_t id, edge_type type) {
+		assert(type == edge_type::IN_EDGE || type == edge_type::OUT_EDGE);
+		return ((size_t) id) * 2 + (type == edge_type::OUT_EDGE);
+	}
+
+	const entry *lower_bound(size_t list_id, int time_idx) const;
+public:
+	typedef std::shared_ptr<ts_edge_index> ptr;
+
+	static ptr create(time_t start_time, time_t interval,
+			size_t min_num_edges = 0) {
+		assert(interval > 0);
+		return ptr(new ts_edge_index(start_time, interval, min_num_edges));
+	}
+
+	/*
+	 * Build the index from the graph in the Linux filesystem.
+	 */
+	static ptr create(const std::string &adj_file,
+			const std::string &index_file, time_t start_time,
+			time_t interval, size_t min_num_edges = 0);
+	static ptr load(const std::string &file);
+	void dump(const std::string &file) const;
+
+	/*
+	 * Add the next edge list in the order of the edge lists in the index.
+	 * The timestamps have to be sorted.
+	 */
+	void add_edge_list(const ts_edge_data timestamps[], size_t num_edges);
+
+	size_t get_num_vertices() const {
+		return (list_offs.size() - 1) / 2;
+	}
+
+	time_t get_start_time() const {
+		return start_time;
+	}
+
+	time_t get_interval() const {
+		return interval;
+	}
+
+	/*
+	 * Whether all edge lists are indexed.
+	 */
+	bool has_all_lists() const {
+		return min_num_edges <= 1;
+	}
+
+	bool is_indexed(vertex_id_t id, edge_type type) const {
+		size_t list_id = get_list_id(id, type);
+		return list_offs[list_id] < list_offs[list_id + 1];
+	}
+
+	/*
+	 * Whether the time range can be located by the index.
+	 */
+	bool is_aligned(time_t time_start, time_t time_interval) const {
+		return (time_start - start_time) % interval == 0
+			&& time_interval % interval == 0;
+	}
+
+	/*
+	 * Get the range of the edges in [time_start, time_start + time_interval)
+	 * in the in-edge or out-edge list of a vertex. The time range has to be
+	 * aligned to the intervals of the index, and the edge list has to be
+	 * indexed.
+	 */
+	std::pair<vsize_t, vsize_t> get_edge_range(vertex_id_t id,
+			edge_type type, time_t time_start, time_t time_interval) const;
+};
+
+/*
+ * Load the timestamp index in `ts_index_file' of the configuration.
+ * It returns NULL if there isn't an index for the graph or the index
+ * can't locate the time range.
+ */
+ts_edge_index::ptr load_ts_index(const graph_header &header,
+		time_t time_start, time_t time_interval);
+
 static inline bool is_time_str(const std::string &str)
 {
 	struct tm tm;
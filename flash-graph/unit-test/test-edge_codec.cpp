@@ -0,0 +1,202 @@
+#include <stdio.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "vertex.h"
+#include "edge_codec.h"
+
+using namespace fg;
+
+/*
+ * This byte array stores data in separate pages, so a vertex in the array
+ * can cross page boundaries as in the page cache.
+ */
+class test_byte_array: public safs::page_byte_array
+{
+	std::vector<std::vector<char> > pages;
+	off_t off_in_first_page;
+	size_t size;
+public:
+	test_byte_array(const char *data, size_t size, off_t off_in_first_page) {
+		this->off_in_first_page = off_in_first_page;
+		this->size = size;
+		size_t num_pages = ROUNDUP(off_in_first_page + size, safs::PAGE_SIZE)
+			/ safs::PAGE_SIZE;
+		pages.resize(num_pages);
+		for (size_t i = 0; i < num_pages; i++)
+			pages[i].resize(safs::PAGE_SIZE);
+		for (size_t i = 0; i < size; i++) {
+			size_t off = off_in_first_page + i;
+			pages[off / safs::PAGE_SIZE][off % safs::PAGE_SIZE] = data[i];
+		}
+	}
+
+	virtual void lock() {
+	}
+
+	virtual void unlock() {
+	}
+
+	virtual size_t get_size() const {
+		return size;
+	}
+
+	virtual page_byte_array *clone() {
+		return NULL;
+	}
+
+	virtual off_t get_offset() const {
+		return off_in_first_page;
+	}
+
+	virtual off_t get_offset_in_first_page() const {
+		return off_in_first_page;
+	}
+
+	virtual const char *get_page(int idx) const {
+		return pages[idx].data();
+	}
+};
+
+void test_svb()
+{
+	printf("test StreamVByte\n");
+	for (size_t num = 0; num < 200; num++) {
+		std::vector<uint32_t> vals(num);
+		for (size_t i = 0; i < num; i++) {
+			// Test integers of all lengths.
+			int nbits = (random() % 4 + 1) * 8;
+			vals[i] = ((((uint64_t) random()) << 16) ^ random())
+				& ((1ULL << nbits) - 1);
+		}
+		std::vector<uint8_t> buf(svb_max_encoded_size(num));
+		size_t size = svb_encode(vals.data(), num, buf.data());
+		assert(size <= buf.size());
+		std::vector<uint32_t> decoded(num);
+		assert(svb_decode(buf.data(), size, num, decoded.data()) == size);
+		assert(vals == decoded);
+	}
+}
+
+std::vector<vertex_id_t> gen_neighbors(size_t num, vertex_id_t max_id)
+{
+	std::vector<vertex_id_t> neighs(num);
+	for (size_t i = 0; i < num; i++)
+		neighs[i] = random() % max_id;
+	std::sort(neighs.begin(), neighs.end());
+	return neighs;
+}
+
+void test_neighbors(size_t num, vertex_id_t max_id)
+{
+	std::vector<vertex_id_t> neighs = gen_neighbors(num, max_id);
+	std::vector<uint8_t> buf(max_encoded_neighbors_size(num));
+	bool wide;
+	size_t size = encode_neighbors(neighs.data(), num, buf.data(), wide);
+	assert(size <= buf.size());
+	std::vector<vertex_id_t> decoded(num);
+	decode_neighbors(buf.data(), size, num, wide, decoded.data());
+	assert(neighs == decoded);
+}
+
+void test_neighbor_lists()
+{
+	printf("test neighbor lists\n");
+	for (size_t num = 0; num < 1000; num += 7)
+		test_neighbors(num, 1000000);
+	// Neighbor lists with many duplicated neighbors.
+	test_neighbors(3000, 10);
+#ifdef VERTEX_ID_64
+	// The deltas in the neighbor list need 64 bits.
+	std::vector<vertex_id_t> neighs;
+	neighs.push_back(1);
+	neighs.push_back(((vertex_id_t) 1) << 40);
+	neighs.push_back((((vertex_id_t) 1) << 40) + 3);
+	std::vector<uint8_t> buf(max_encoded_neighbors_size(neighs.size()));
+	bool wide;
+	size_t size = encode_neighbors(neighs.data(), neighs.size(), buf.data(),
+			wide);
+	assert(wide);
+	std::vector<vertex_id_t> decoded(neighs.size());
+	decode_neighbors(buf.data(), size, neighs.size(), wide, decoded.data());
+	assert(neighs == decoded);
+#endif
+}
+
+std::vector<char> compress_vertex(vertex_id_t id,
+		const std::vector<vertex_id_t> &neighs)
+{
+	in_mem_undirected_vertex<int> v(id, true);
+	for (size_t i = 0; i < neighs.size(); i++)
+		v.add_edge(edge<int>(id, neighs[i], neighs[i] * 2));
+	std::vector<char> buf(v.get_serialize_size(IN_EDGE));
+	ext_mem_undirected_vertex::serialize(v, buf.data(), buf.size(), IN_EDGE);
+	const ext_mem_undirected_vertex *ext_v
+		= (const ext_mem_undirected_vertex *) buf.data();
+
+	std::vector<char> cbuf(ext_mem_compressed_vertex::get_max_size(
+				ext_v->get_num_edges(), ext_v->get_edge_data_size()));
+	size_t size = ext_mem_compressed_vertex::serialize(*ext_v, cbuf.data(),
+			cbuf.size());
+	// The compressed vertex should be smaller than the original one.
+	if (neighs.size() > 10)
+		assert(size < buf.size());
+	cbuf.resize(size);
+	return cbuf;
+}
+
+template<class vertex_type>
+void check_vertex(const vertex_type &pg_v, edge_type type,
+		const std::vector<vertex_id_t> &neighs)
+{
+	assert(pg_v.get_num_edges(type) == neighs.size());
+	std::vector<vertex_id_t> edges(neighs.size());
+	assert(pg_v.read_edges(type, edges.data(), edges.size()) == neighs.size());
+	assert(edges == neighs);
+
+	edge_seq_iterator it = pg_v.get_neigh_seq_it(type);
+	for (size_t i = 0; i < neighs.size(); i++) {
+		assert(it.has_next());
+		assert(it.next() == neighs[i]);
+	}
+	assert(!it.has_next());
+}
+
+void test_page_vertex()
+{
+	printf("test page vertices\n");
+	std::vector<vertex_id_t> neighs = gen_neighbors(3000, 100000);
+	std::vector<char> cbuf = compress_vertex(10, neighs);
+
+	// The vertex is in a single page.
+	test_byte_array arr1(cbuf.data(), cbuf.size(), 0);
+	// The vertex crosses page boundaries.
+	test_byte_array arr2(cbuf.data(), cbuf.size(), safs::PAGE_SIZE - 20);
+	page_undirected_vertex v1(arr1);
+	page_undirected_vertex v2(arr2);
+	assert(v1.get_id() == 10 && v2.get_id() == 10);
+	assert(v1.get_size() == cbuf.size() && v2.get_size() == cbuf.size());
+	check_vertex(v1, IN_EDGE, neighs);
+	check_vertex(v2, IN_EDGE, neighs);
+	safs::page_byte_array::seq_const_iterator<int> data_it
+		= v2.get_data_seq_it<int>();
+	for (size_t i = 0; i < neighs.size(); i++)
+		assert(data_it.next() == (int) neighs[i] * 2);
+
+	std::vector<vertex_id_t> out_neighs = gen_neighbors(20, 100000);
+	std::vector<char> out_cbuf = compress_vertex(10, out_neighs);
+	test_byte_array out_arr(out_cbuf.data(), out_cbuf.size(), 100);
+	page_directed_vertex v3(arr2, out_arr);
+	assert(v3.get_in_size() == cbuf.size());
+	assert(v3.get_out_size() == out_cbuf.size());
+	check_vertex(v3, IN_EDGE, neighs);
+	check_vertex(v3, OUT_EDGE, out_neighs);
+}
+
+int main()
+{
+	test_svb();
+	test_neighbor_lists();
+	test_page_vertex();
+}
@@ -0,0 +1,352 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <set>
+#include <vector>
+
+#include "graph_delta.h"
+#include "vertex_index.h"
+#include "in_mem_storage.h"
+#include "graph_engine.h"
+#include "graph_index.h"
+#include "graph_config.h"
+#include "FGlib.h"
+
+using namespace fg;
+
+const size_t NUM_VERTICES = 1000;
+const size_t NUM_EDGES = 5000;
+const size_t NUM_UPDATES = 2000;
+
+typedef std::vector<std::multiset<vertex_id_t> > adj_lists_t;
+
+struct free_deleter
+{
+	void operator()(char *buf) const {
+		free(buf);
+	}
+};
+
+void append_vertex(std::vector<char> &buf, vertex_id_t id,
+		const std::multiset<vertex_id_t> &edges)
+{
+	size_t size = ext_mem_undirected_vertex::num_edges2vsize(edges.size(), 0);
+	size_t off = buf.size();
+	buf.resize(off + size);
+	ext_mem_undirected_vertex *v = new (buf.data() + off)
+		ext_mem_undirected_vertex(id, edges.size(), 0);
+	size_t i = 0;
+	for (auto it = edges.begin(); it != edges.end(); it++)
+		v->set_neighbor(i++, *it);
+}
+
+/*
+ * Create a graph image with the in-part of all vertices followed by
+ * the out-part of all vertices in a directed graph.
+ */
+in_mem_graph::ptr create_image(bool directed, const adj_lists_t &in_lists,
+		const adj_lists_t &out_lists)
+{
+	std::vector<char> buf(graph_header::get_header_size());
+	size_t num_edges = 0;
+	if (directed)
+		for (size_t i = 0; i < in_lists.size(); i++)
+			append_vertex(buf, i, in_lists[i]);
+	for (size_t i = 0; i < out_lists.size(); i++) {
+		append_vertex(buf, i, out_lists[i]);
+		num_edges += out_lists[i].size();
+	}
+	if (!directed)
+		num_edges /= 2;
+	graph_header header(directed ? graph_type::DIRECTED : graph_type::UNDIRECTED,
+			out_lists.size(), num_edges, 0);
+	memcpy(buf.data(), &header, graph_header::get_header_size());
+	char *data = (char *) malloc(buf.size());
+	memcpy(data, buf.data(), buf.size());
+	return in_mem_graph::create("test", std::shared_ptr<char>(data,
+				free_deleter()), buf.size());
+}
+
+std::multiset<vertex_id_t> read_vertex(in_mem_graph::ptr graph, off_t off,
+		vertex_id_t id)
+{
+	ext_mem_undirected_vertex header;
+	graph->copy_to((char *) &header,
+			ext_mem_undirected_vertex::get_header_size(), off);
+	assert(header.get_id() == id);
+	std::vector<vertex_id_t> edges(header.get_num_edges());
+	graph->copy_to((char *) edges.data(), edges.size() * sizeof(vertex_id_t),
+			off + ext_mem_undirected_vertex::get_header_size());
+	for (size_t i = 1; i < edges.size(); i++)
+		assert(edges[i - 1] <= edges[i]);
+	return std::multiset<vertex_id_t>(edges.begin(), edges.end());
+}
+
+void check_graph(bool directed, in_mem_graph::ptr graph,
+		vertex_index::ptr index, const adj_lists_t &in_lists,
+		const adj_lists_t &out_lists)
+{
+	size_t num_edges = 0;
+	for (size_t i = 0; i < out_lists.size(); i++)
+		num_edges += out_lists[i].size();
+	if (!directed)
+		num_edges /= 2;
+	assert(index->get_graph_header().get_num_edges() == num_edges);
+	if (directed) {
+		directed_vertex_index::ptr dindex = directed_vertex_index::cast(index);
+		assert(dindex->verify());
+		assert(dindex->get_graph_size() == graph->get_size());
+		for (vertex_id_t i = 0; i < out_lists.size(); i++) {
+			assert(read_vertex(graph, dindex->get_vertex(i).get_in_off(), i)
+					== in_lists[i]);
+			assert(read_vertex(graph, dindex->get_vertex(i).get_out_off(), i)
+					== out_lists[i]);
+		}
+	}
+	else {
+		undirected_vertex_index::ptr uindex
+			= undirected_vertex_index::cast(index);
+		assert(uindex->verify());
+		assert(uindex->get_graph_size() == graph->get_size());
+		for (vertex_id_t i = 0; i < out_lists.size(); i++)
+			assert(read_vertex(graph, uindex->get_vertex(i).get_off(), i)
+					== out_lists[i]);
+	}
+}
+
+/*
+ * Apply an update to the reference graph: an edge is either in the graph
+ * or not.
+ */
+void update_lists(std::multiset<vertex_id_t> &edges, vertex_id_t neigh,
+		bool deleted)
+{
+	if (deleted)
+		edges.erase(neigh);
+	else if (edges.find(neigh) == edges.end())
+		edges.insert(neigh);
+}
+
+void random_updates(graph_delta &delta, bool directed, adj_lists_t &in_lists,
+		adj_lists_t &out_lists, size_t num)
+{
+	for (size_t i = 0; i < num; i++) {
+		vertex_id_t from = random() % NUM_VERTICES;
+		vertex_id_t to = random() % NUM_VERTICES;
+		// Delete existing edges sometimes.
+		bool deleted = random() % 3 == 0;
+		if (deleted && !out_lists[from].empty() && random() % 2) {
+			auto it = out_lists[from].begin();
+			std::advance(it, random() % out_lists[from].size());
+			to = *it;
+		}
+		if (deleted)
+			delta.delete_edge(from, to);
+		else
+			delta.add_edge(from, to);
+		update_lists(out_lists[from], to, deleted);
+		if (directed)
+			update_lists(in_lists[to], from, deleted);
+		else
+			update_lists(out_lists[to], from, deleted);
+	}
+}
+
+void test_merge()
+{
+	printf("test merge\n");
+	std::vector<vertex_id_t> edges;
+	edges.push_back(1);
+	edges.push_back(3);
+	edges.push_back(3);
+	edges.push_back(5);
+	std::vector<graph_delta::update> updates;
+	graph_delta::update u;
+	// Add an existing edge, delete an edge with copies, add and then
+	// delete an edge, delete and then add an edge.
+	u.neigh = 1; u.deleted = false; u.seq = 1; updates.push_back(u);
+	u.neigh = 3; u.deleted = true; u.seq = 2; updates.push_back(u);
+	u.neigh = 4; u.deleted = false; u.seq = 3; updates.push_back(u);
+	u.neigh = 4; u.deleted = true; u.seq = 4; updates.push_back(u);
+	u.neigh = 2; u.deleted = true; u.seq = 5; updates.push_back(u);
+	u.neigh = 2; u.deleted = false; u.seq = 6; updates.push_back(u);
+	u.neigh = 0; u.deleted = false; u.seq = 7; updates.push_back(u);
+	std::vector<vertex_id_t> merged;
+	graph_delta::merge(edges.data(), edges.size(), updates, merged);
+	assert(merged.size() == 4);
+	assert(merged[0] == 0);
+	assert(merged[1] == 1);
+	assert(merged[2] == 2);
+	assert(merged[3] == 5);
+}
+
+void test_compact(bool directed)
+{
+	printf("test compacting a %s graph\n", directed ? "directed" : "undirected");
+	adj_lists_t in_lists(NUM_VERTICES);
+	adj_lists_t out_lists(NUM_VERTICES);
+	for (size_t i = 0; i < NUM_EDGES; i++) {
+		vertex_id_t from = random() % NUM_VERTICES;
+		vertex_id_t to = random() % NUM_VERTICES;
+		out_lists[from].insert(to);
+		if (directed)
+			in_lists[to].insert(from);
+		else if (from != to)
+			out_lists[to].insert(from);
+	}
+	in_mem_graph::ptr graph = create_image(directed, in_lists, out_lists);
+	graph_header header;
+	graph->copy_to((char *) &header, graph_header::get_header_size(), 0);
+	graph_delta::ptr delta = graph_delta::create(header);
+
+	random_updates(*delta, directed, in_lists, out_lists, NUM_UPDATES);
+	graph_compactor::ptr compactor = graph_compactor::create(graph, delta, 0,
+			"test1");
+	compactor->start();
+	compactor->wait4complete();
+	assert(compactor->get_snapshot() == NUM_UPDATES);
+	check_graph(directed, compactor->get_graph(), compactor->get_index(),
+			in_lists, out_lists);
+
+	// The updates after the snapshot are merged in the next compaction.
+	in_mem_graph::ptr graph1 = compactor->get_graph();
+	delta->truncate(compactor->get_snapshot());
+	assert(delta->get_num_updates() == 0);
+	random_updates(*delta, directed, in_lists, out_lists, NUM_UPDATES);
+	compactor = graph_compactor::create(graph1, delta,
+			compactor->get_snapshot(), "test2");
+	compactor->run();
+	assert(compactor->get_snapshot() == NUM_UPDATES * 2);
+	check_graph(directed, compactor->get_graph(), compactor->get_index(),
+			in_lists, out_lists);
+}
+
+/*
+ * Each vertex counts the edges in its edge list. A vertex with vertical
+ * partitions adds up the edges in the chunks of its part vertices.
+ */
+class degree_vertex: public compute_vertex
+{
+	size_t degree;
+public:
+	degree_vertex(vertex_id_t id): compute_vertex(id) {
+		degree = 0;
+	}
+
+	size_t get_degree() const {
+		return degree;
+	}
+
+	void add_edges(size_t num) {
+		__sync_fetch_and_add(&degree, num);
+	}
+
+	void run(vertex_program &prog) {
+		vertex_id_t id = prog.get_vertex_id(*this);
+		request_vertices(&id, 1);
+	}
+
+	void run(vertex_program &prog, const page_vertex &vertex) {
+		add_edges(vertex.get_num_edges(edge_type::BOTH_EDGES));
+	}
+
+	void run_on_message(vertex_program &prog, const vertex_message &msg) {
+	}
+};
+
+class part_degree_vertex: public part_compute_vertex
+{
+public:
+	part_degree_vertex(vertex_id_t id, int part_id): part_compute_vertex(id,
+			part_id) {
+	}
+
+	void run(vertex_program &prog) {
+		vertex_id_t id = get_id();
+		request_vertices(&id, 1);
+	}
+
+	void run(vertex_program &prog, const page_vertex &vertex) {
+		size_t num_vparts = graph_conf.get_num_vparts();
+		size_t num_edges = vertex.get_num_edges(edge_type::BOTH_EDGES);
+		size_t chunk_size = (num_edges + num_vparts - 1) / num_vparts;
+		size_t start = std::min(chunk_size * get_part_id(), num_edges);
+		size_t end = std::min(start + chunk_size, num_edges);
+		degree_vertex &v = (degree_vertex &) prog.get_graph().get_vertex(
+				get_id());
+		v.add_edges(end - start);
+	}
+};
+
+class check_degree_query: public vertex_query
+{
+	const adj_lists_t &lists;
+public:
+	check_degree_query(const adj_lists_t &_lists): lists(_lists) {
+	}
+
+	virtual void run(graph_engine &graph, compute_vertex &v) {
+		vertex_id_t id = graph.get_graph_index().get_vertex_id(v);
+		assert(((degree_vertex &) v).get_degree() == lists[id].size());
+	}
+
+	virtual void merge(graph_engine &graph, vertex_query::ptr q) {
+	}
+
+	virtual ptr clone() {
+		return vertex_query::ptr(new check_degree_query(lists));
+	}
+};
+
+/*
+ * The updates of a vertex have to be applied once in an iteration when
+ * vertices are vertically partitioned.
+ */
+void test_vparts()
+{
+	printf("test updates with vertical partitions\n");
+	adj_lists_t in_lists(NUM_VERTICES);
+	adj_lists_t out_lists(NUM_VERTICES);
+	for (size_t i = 0; i < NUM_EDGES; i++) {
+		vertex_id_t from = random() % NUM_VERTICES;
+		vertex_id_t to = random() % NUM_VERTICES;
+		out_lists[from].insert(to);
+		if (from != to)
+			out_lists[to].insert(from);
+	}
+	in_mem_graph::ptr graph = create_image(false, in_lists, out_lists);
+	graph_header header;
+	graph->copy_to((char *) &header, graph_header::get_header_size(), 0);
+
+	// The compactor constructs the vertex index of the graph.
+	graph_compactor::ptr compactor = graph_compactor::create(graph,
+			graph_delta::create(header), 0, "test_vparts");
+	compactor->run();
+
+	config_map::ptr configs = config_map::create();
+	// Most vertices have fewer than 10 edges.
+	configs->add_options("threads=2 num_vparts=4 min_vpart_degree=10");
+	graph_engine::init_flash_graph(configs);
+	FG_graph::ptr fg = FG_graph::create(compactor->get_graph(),
+			compactor->get_index(), "test_vparts", configs);
+	graph_delta::ptr delta = graph_delta::create(header);
+	random_updates(*delta, false, in_lists, out_lists, NUM_UPDATES);
+	fg->set_delta_store(delta);
+
+	graph_index::ptr index = NUMA_graph_index<degree_vertex,
+		part_degree_vertex>::create(fg->get_graph_header());
+	graph_engine::ptr engine = fg->create_engine(index);
+	engine->start_all();
+	engine->wait4complete();
+	engine->query_on_all(vertex_query::ptr(new check_degree_query(out_lists)));
+	engine = graph_engine::ptr();
+	graph_engine::destroy_flash_graph();
+}
+
+int main()
+{
+	test_merge();
+	test_compact(true);
+	test_compact(false);
+	test_vparts();
+}
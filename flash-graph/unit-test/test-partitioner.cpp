@@ -1,4 +1,7 @@
 #include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
 
 #include "partitioner.h"
 
@@ -41,14 +44,95 @@ void test_partitioner(graph_partitioner &partitioner)
 	}
 }
 
+/*
+ * Local IDs are 32 bits even if vertex IDs are 64 bits. Vertex IDs at
+ * the end of a large graph should still map to local IDs and back.
+ */
+void test_local_ids(graph_partitioner &partitioner)
+{
+	size_t num_vertices = ((size_t) MAX_LOCAL_ID) * num_parts / 2;
+	num_vertices = std::min(num_vertices, (size_t) MAX_VERTEX_ID);
+	printf("test local IDs of a graph with %ld vertices\n", num_vertices);
+	for (int k = 0; k < M; k++) {
+		vertex_id_t id = num_vertices - 1 - random() % M;
+		int part_id;
+		off_t off;
+		partitioner.map2loc(id, part_id, off);
+		local_vid_t local_id(off);
+		assert(local_id.is_valid());
+		assert(local_id.id == off);
+		vertex_id_t id1;
+		partitioner.loc2map(part_id, local_id.id, id1);
+		assert(id == id1);
+	}
+}
+
+void test_map_partitioner()
+{
+	size_t num_vertices = random() % M + M;
+	printf("test map_graph_partitioner with %ld vertices\n", num_vertices);
+	std::vector<int> part_ids(num_vertices);
+	for (size_t i = 0; i < num_vertices; i++)
+		part_ids[i] = random() % num_parts;
+	map_graph_partitioner partitioner(part_ids, num_parts);
+	assert(partitioner.get_num_partitions() == num_parts);
+
+	std::vector<vertex_id_t> parts[num_parts];
+	size_t tot = 0;
+	for (int i = 0; i < num_parts; i++) {
+		partitioner.get_all_vertices_in_part(i, num_vertices, parts[i]);
+		assert(partitioner.get_part_size(i, num_vertices) == parts[i].size());
+		// The vertices in a partition are ordered by their IDs.
+		assert(std::is_sorted(parts[i].begin(), parts[i].end()));
+		tot += parts[i].size();
+	}
+	assert(tot == num_vertices);
+	for (vertex_id_t id = 0; id < num_vertices; id++) {
+		int part_id;
+		off_t off;
+		partitioner.map2loc(id, part_id, off);
+		assert(part_id == part_ids[id]);
+		assert(part_id == partitioner.map(id));
+		assert(parts[part_id][off] == id);
+		vertex_id_t id1;
+		partitioner.loc2map(part_id, off, id1);
+		assert(id == id1);
+	}
+
+	std::vector<vertex_id_t> ids(1000);
+	for (size_t i = 0; i < ids.size(); i++)
+		ids[i] = random() % num_vertices;
+	std::vector<local_vid_t> locs[num_parts];
+	partitioner.map2loc(ids.data(), ids.size(), locs, num_parts);
+	size_t idxs[num_parts] = {0};
+	for (size_t i = 0; i < ids.size(); i++) {
+		int part_id;
+		off_t off;
+		partitioner.map2loc(ids[i], part_id, off);
+		assert(locs[part_id][idxs[part_id]++].id == off);
+	}
+
+	std::string file = "/tmp/test-partitioner.part";
+	partitioner.dump(file);
+	map_graph_partitioner::ptr loaded = map_graph_partitioner::load(file);
+	unlink(file.c_str());
+	assert(loaded->get_num_partitions() == num_parts);
+	assert(loaded->get_num_vertices() == num_vertices);
+	for (vertex_id_t id = 0; id < num_vertices; id++)
+		assert(loaded->map(id) == part_ids[id]);
+}
+
 int main()
 {
 	printf("test range_graph_partitioner\n");
 	range_graph_partitioner r_partitioner(num_parts);
 	test_partitioner(r_partitioner);
+	test_local_ids(r_partitioner);
 
 	printf("test modulo_graph_partitioner\n");
 	modulo_graph_partitioner m_partitioner(num_parts);
 	test_partitioner(m_partitioner);
+	test_local_ids(m_partitioner);
 
+	test_map_partitioner();
 }
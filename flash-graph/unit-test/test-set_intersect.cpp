@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <set>
+#include <vector>
+#include <algorithm>
+
+#include "set_intersect.h"
+
+using namespace fg;
+
+/*
+ * Generate a sorted list. The list may have duplicates.
+ */
+std::vector<vertex_id_t> gen_list(size_t num, size_t range, bool unique)
+{
+	std::vector<vertex_id_t> list(num);
+	for (size_t i = 0; i < num; i++)
+		list[i] = random() % range;
+	std::sort(list.begin(), list.end());
+	if (unique)
+		list.resize(std::unique(list.begin(), list.end()) - list.begin());
+	return list;
+}
+
+std::vector<uint32_t> intersect_ref(const std::vector<vertex_id_t> &a,
+		const std::vector<vertex_id_t> &b)
+{
+	std::set<vertex_id_t> b_set(b.begin(), b.end());
+	std::vector<uint32_t> idxs;
+	for (size_t i = 0; i < a.size(); i++)
+		if (b_set.find(a[i]) != b_set.end())
+			idxs.push_back(i);
+	return idxs;
+}
+
+void check(const std::vector<vertex_id_t> &a, const std::vector<vertex_id_t> &b)
+{
+	std::vector<uint32_t> ref = intersect_ref(a, b);
+	std::vector<uint32_t> idxs(a.size());
+	for (int level = (int) simd_level::NONE;
+			level <= (int) get_simd_level(); level++) {
+		size_t num = intersect_merge(a.data(), a.size(), b.data(), b.size(),
+				idxs.data(), (simd_level) level);
+		assert(num == ref.size());
+		assert(std::equal(ref.begin(), ref.end(), idxs.begin()));
+		assert(intersect_merge(a.data(), a.size(), b.data(), b.size(), NULL,
+					(simd_level) level) == num);
+	}
+	size_t num = intersect_sorted(a.data(), a.size(), b.data(), b.size(),
+			idxs.data());
+	assert(num == ref.size());
+	assert(std::equal(ref.begin(), ref.end(), idxs.begin()));
+
+	std::vector<uint32_t> found;
+	gallop_intersect(a.begin(), a.end(), b.begin(), b.end(),
+			[&found, &a, &b](size_t i, size_t j) {
+				assert(a[i] == b[j]);
+				found.push_back(i);
+			});
+	assert(found == ref);
+}
+
+void test_intersect()
+{
+	printf("test intersection\n");
+	size_t sizes[] = {0, 1, 7, 8, 9, 16, 17, 100, 1000, 10000};
+	size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+	for (size_t i = 0; i < num_sizes; i++) {
+		for (size_t j = 0; j < num_sizes; j++) {
+			// A small range has many common vertices and duplicates.
+			size_t range = std::max(sizes[i], sizes[j]) * 2 + 1;
+			check(gen_list(sizes[i], range, true),
+					gen_list(sizes[j], range, false));
+			check(gen_list(sizes[i], range, true),
+					gen_list(sizes[j], range, true));
+			check(gen_list(sizes[i], range * 100, true),
+					gen_list(sizes[j], range * 100, false));
+		}
+	}
+}
+
+void test_bitmap()
+{
+	printf("test rank bitmap\n");
+	std::vector<vertex_id_t> list = gen_list(1000, 10000, true);
+	rank_bitmap bitmap;
+	assert(bitmap.init(list.data(), list.size()));
+	for (vertex_id_t id = 0; id < 10000; id++) {
+		off_t idx = bitmap.find(id);
+		auto it = std::lower_bound(list.begin(), list.end(), id);
+		if (it != list.end() && *it == id)
+			assert(idx == it - list.begin());
+		else
+			assert(idx == -1);
+	}
+
+	// The bitmap isn't built on a sparse list or a list with duplicates.
+	rank_bitmap sparse;
+	list = gen_list(100, 1000000, true);
+	assert(!sparse.init(list.data(), list.size()));
+	assert(sparse.empty());
+	assert(!sparse.contains(list[0]));
+	rank_bitmap dups;
+	list = gen_list(1000, 100, false);
+	assert(!dups.init(list.data(), list.size()));
+	assert(dups.empty());
+}
+
+int main()
+{
+	test_intersect();
+	test_bitmap();
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ts_graph.h"
+
+using namespace fg;
+
+const size_t NUM_VERTICES = 1000;
+const time_t START_TIME = 1000;
+const time_t INTERVAL = 10;
+
+typedef std::vector<std::vector<ts_edge_data> > ts_lists_t;
+
+/*
+ * Generate the sorted timestamps of the edge lists. Some of the edges
+ * are before the start time of the index.
+ */
+void gen_lists(ts_lists_t &lists)
+{
+	lists.resize(NUM_VERTICES * 2);
+	for (size_t i = 0; i < lists.size(); i++) {
+		size_t num_edges = random() % 100;
+		std::vector<time_t> times(num_edges);
+		for (size_t j = 0; j < num_edges; j++)
+			times[j] = START_TIME - 50 + random() % 1000;
+		std::sort(times.begin(), times.end());
+		for (size_t j = 0; j < num_edges; j++)
+			lists[i].push_back(ts_edge_data(times[j]));
+	}
+}
+
+ts_edge_index::ptr create_index(const ts_lists_t &lists, size_t min_num_edges)
+{
+	ts_edge_index::ptr index = ts_edge_index::create(START_TIME, INTERVAL,
+			min_num_edges);
+	for (size_t i = 0; i < lists.size(); i++)
+		index->add_edge_list(lists[i].data(), lists[i].size());
+	return index;
+}
+
+void check_range(const ts_edge_index &index, const ts_lists_t &lists,
+		time_t time_start, time_t time_interval)
+{
+	for (size_t i = 0; i < NUM_VERTICES; i++) {
+		edge_type types[] = {edge_type::IN_EDGE, edge_type::OUT_EDGE};
+		for (int j = 0; j < 2; j++) {
+			const std::vector<ts_edge_data> &l = lists[i * 2 + j];
+			if (!index.is_indexed(i, types[j])) {
+				assert(!index.has_all_lists());
+				continue;
+			}
+			std::pair<vsize_t, vsize_t> range = index.get_edge_range(i,
+					types[j], time_start, time_interval);
+			vsize_t start = std::lower_bound(l.begin(), l.end(),
+					ts_edge_data(time_start)) - l.begin();
+			vsize_t end = std::lower_bound(l.begin(), l.end(),
+					ts_edge_data(time_start + time_interval)) - l.begin();
+			assert(range.first == start);
+			assert(range.second == end);
+		}
+	}
+}
+
+void check_index(const ts_edge_index &index, const ts_lists_t &lists)
+{
+	assert(index.get_num_vertices() == NUM_VERTICES);
+	assert(index.is_aligned(START_TIME, INTERVAL * 3));
+	assert(!index.is_aligned(START_TIME + 1, INTERVAL));
+	assert(!index.is_aligned(START_TIME, INTERVAL + 1));
+	for (int i = -10; i < 100; i += 7)
+		for (int len = 1; len < 20; len += 3)
+			check_range(index, lists, START_TIME + i * INTERVAL,
+					len * INTERVAL);
+}
+
+void test_index(size_t min_num_edges)
+{
+	printf("test the index with at least %ld edges in a list\n",
+			min_num_edges);
+	ts_lists_t lists;
+	gen_lists(lists);
+	ts_edge_index::ptr index = create_index(lists, min_num_edges);
+	assert(index->has_all_lists() == (min_num_edges <= 1));
+	check_index(*index, lists);
+
+	size_t num_indexed = 0;
+	for (size_t i = 0; i < NUM_VERTICES; i++) {
+		num_indexed += index->is_indexed(i, edge_type::IN_EDGE);
+		num_indexed += index->is_indexed(i, edge_type::OUT_EDGE);
+	}
+	for (size_t i = 0; i < lists.size(); i++)
+		if (lists[i].size() >= min_num_edges || lists[i].empty())
+			num_indexed--;
+	assert(num_indexed == 0);
+
+	char file_name[] = "/tmp/test-ts_index.XXXXXX";
+	int fd = mkstemp(file_name);
+	assert(fd >= 0);
+	close(fd);
+	index->dump(file_name);
+	ts_edge_index::ptr loaded = ts_edge_index::load(file_name);
+	unlink(file_name);
+	assert(loaded->get_start_time() == START_TIME);
+	assert(loaded->get_interval() == INTERVAL);
+	assert(loaded->has_all_lists() == index->has_all_lists());
+	check_index(*loaded, lists);
+}
+
+int main()
+{
+	test_index(0);
+	test_index(50);
+}
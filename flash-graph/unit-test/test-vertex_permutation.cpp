@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "vertex_permutation.h"
+
+using namespace fg;
+
+const size_t NUM_VERTICES = 10000;
+
+vertex_permutation::ptr create_rand_perm()
+{
+	std::vector<vertex_id_t> new2orig(NUM_VERTICES);
+	for (size_t i = 0; i < NUM_VERTICES; i++)
+		new2orig[i] = i;
+	std::random_shuffle(new2orig.begin(), new2orig.end());
+	return vertex_permutation::create(new2orig);
+}
+
+void test_map()
+{
+	printf("test mapping vertex IDs\n");
+	vertex_permutation::ptr perm = create_rand_perm();
+	assert(perm->get_num_vertices() == NUM_VERTICES);
+	for (vertex_id_t id = 0; id < NUM_VERTICES; id++) {
+		assert(perm->get_orig_id(perm->get_new_id(id)) == id);
+		assert(perm->get_new_id(perm->get_orig_id(id)) == id);
+	}
+
+	// A vector indexed by the new IDs stores the original ID of
+	// each vertex.
+	FG_vector<vertex_id_t>::ptr vec = FG_vector<vertex_id_t>::create(
+			NUM_VERTICES);
+	for (vertex_id_t id = 0; id < NUM_VERTICES; id++)
+		vec->set(id, perm->get_orig_id(id));
+	FG_vector<vertex_id_t>::ptr orig = perm->to_orig<vertex_id_t>(vec);
+	for (vertex_id_t id = 0; id < NUM_VERTICES; id++)
+		assert(orig->get(id) == id);
+
+	// A vector whose values are the new IDs of the vertices.
+	for (vertex_id_t id = 0; id < NUM_VERTICES; id++)
+		vec->set(id, id);
+	vec->set(0, INVALID_VERTEX_ID);
+	orig = perm->ids_to_orig(vec);
+	for (vertex_id_t id = 0; id < NUM_VERTICES; id++) {
+		if (perm->get_new_id(id) == 0)
+			assert(orig->get(id) == INVALID_VERTEX_ID);
+		else
+			assert(orig->get(id) == id);
+	}
+}
+
+void test_dump_load()
+{
+	printf("test dumping and loading a permutation\n");
+	vertex_permutation::ptr perm = create_rand_perm();
+	char file_name[] = "/tmp/test-perm.XXXXXX";
+	int fd = mkstemp(file_name);
+	assert(fd >= 0);
+	close(fd);
+	perm->dump(file_name);
+	vertex_permutation::ptr loaded = vertex_permutation::load(file_name);
+	unlink(file_name);
+	assert(loaded->get_num_vertices() == NUM_VERTICES);
+	for (vertex_id_t id = 0; id < NUM_VERTICES; id++)
+		assert(loaded->get_orig_id(id) == perm->get_orig_id(id));
+
+	// IDs that aren't a permutation are rejected.
+	std::vector<vertex_id_t> ids(NUM_VERTICES, 0);
+	bool caught = false;
+	try {
+		vertex_permutation::create(ids);
+	} catch (wrong_format &e) {
+		caught = true;
+	}
+	assert(caught);
+}
+
+int main()
+{
+	test_map();
+	test_dump_load();
+}
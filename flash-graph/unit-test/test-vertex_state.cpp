@@ -0,0 +1,49 @@
+#include <stdlib.h>
+
+#include "vertex_state.h"
+
+using namespace fg;
+
+const int num_parts = 16;
+const int M = 1024 * 1024;
+
+void test_vertex_state(graph_partitioner &partitioner)
+{
+	size_t num_vertices = random() % M + M;
+	printf("test vertex state of %ld vertices\n", num_vertices);
+	vertex_state<vertex_id_t>::ptr state = vertex_state<vertex_id_t>::create(
+			partitioner, num_vertices, 1, INVALID_VERTEX_ID);
+	assert(state->get_mem_size() == sizeof(vertex_id_t) * num_vertices);
+	for (vertex_id_t id = 0; id < num_vertices; id++) {
+		assert(state->get(id) == INVALID_VERTEX_ID);
+		state->get(id) = id;
+	}
+
+	// The state of a vertex is the same with its ID and its location.
+	for (vertex_id_t id = 0; id < num_vertices; id++) {
+		int part_id;
+		off_t off;
+		partitioner.map2loc(id, part_id, off);
+		assert(state->get(part_id, local_vid_t(off)) == id);
+	}
+
+	std::vector<vertex_id_t> buf(num_vertices);
+	state->copy_to(buf.data());
+	for (vertex_id_t id = 0; id < num_vertices; id++)
+		assert(buf[id] == id);
+
+	state->assign(0);
+	for (vertex_id_t id = 0; id < num_vertices; id++)
+		assert(state->get(id) == 0);
+}
+
+int main()
+{
+	printf("test vertex state with range_graph_partitioner\n");
+	range_graph_partitioner r_partitioner(num_parts);
+	test_vertex_state(r_partitioner);
+
+	printf("test vertex state with modulo_graph_partitioner\n");
+	modulo_graph_partitioner m_partitioner(num_parts);
+	test_vertex_state(m_partitioner);
+}
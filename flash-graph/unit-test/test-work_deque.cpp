@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <pthread.h>
+
+#include <vector>
+#include <atomic>
+
+#include "work_deque.h"
+
+using namespace fg;
+
+const size_t NUM_ITEMS = 1000000;
+const size_t BUF_SIZE = 10000;
+const int NUM_THIEVES = 3;
+
+work_deque<size_t> deque;
+std::vector<std::atomic<int> > counts(NUM_ITEMS);
+std::atomic<size_t> num_processed;
+
+void *steal_func(void *arg)
+{
+	std::vector<size_t> items(BUF_SIZE);
+	while (num_processed.load() < NUM_ITEMS) {
+		size_t num = deque.steal(items.data(), items.size());
+		for (size_t i = 0; i < num; i++)
+			counts[items[i]]++;
+		num_processed += num;
+	}
+	return NULL;
+}
+
+/*
+ * The owner fills the deque with buffers of items and processes the items
+ * while thieves steal them. Every item should be processed exactly once.
+ */
+void test_steal(size_t chunk_size)
+{
+	printf("test stealing with chunk size %ld\n", chunk_size);
+	for (size_t i = 0; i < NUM_ITEMS; i++)
+		counts[i] = 0;
+	num_processed = 0;
+
+	pthread_t threads[NUM_THIEVES];
+	for (int i = 0; i < NUM_THIEVES; i++)
+		pthread_create(&threads[i], NULL, steal_func, NULL);
+
+	std::vector<size_t> buf;
+	size_t num_owner = 0;
+	for (size_t start = 0; start < NUM_ITEMS; start += BUF_SIZE) {
+		buf.clear();
+		for (size_t i = start; i < std::min(start + BUF_SIZE, NUM_ITEMS); i++)
+			buf.push_back(i);
+		deque.refill(buf, chunk_size);
+		const size_t *items;
+		size_t num;
+		while (deque.pop(items, num)) {
+			for (size_t i = 0; i < num; i++)
+				counts[items[i]]++;
+			num_processed += num;
+			num_owner += num;
+		}
+		assert(deque.is_empty());
+	}
+
+	for (int i = 0; i < NUM_THIEVES; i++)
+		pthread_join(threads[i], NULL);
+	for (size_t i = 0; i < NUM_ITEMS; i++)
+		assert(counts[i] == 1);
+	assert(num_processed == NUM_ITEMS);
+	printf("the owner processes %ld items\n", num_owner);
+}
+
+int main()
+{
+	test_steal(1);
+	test_steal(16);
+	test_steal(BUF_SIZE);
+}
@@ -17,8 +17,11 @@
  * limitations under the License.
  */
 
+#include <pthread.h>
+
 #include "vertex.h"
 #include "vertex_index.h"
+#include "edge_codec.h"
 
 namespace fg
 {
@@ -48,4 +51,167 @@ size_t ext_mem_undirected_vertex::serialize(const in_mem_vertex &v, char *buf,
 	return mem_size;
 }
 
+size_t ext_mem_compressed_vertex::get_max_size(vsize_t num_edges,
+		uint32_t edge_data_size)
+{
+	size_t size = get_header_size() + max_encoded_neighbors_size(num_edges);
+	if (edge_data_size > 0)
+		size = ROUNDUP(size, edge_data_size) + num_edges * edge_data_size;
+	return ROUNDUP(size, sizeof(vertex_id_t));
+}
+
+size_t ext_mem_compressed_vertex::serialize(const ext_mem_undirected_vertex &v,
+		char *buf, size_t size)
+{
+	assert(!v.is_compressed());
+	assert(get_max_size(v.get_num_edges(), v.get_edge_data_size()) <= size);
+	// The padding bytes are written to the file as well.
+	memset(buf, 0, get_max_size(v.get_num_edges(), v.get_edge_data_size()));
+	ext_mem_compressed_vertex *c_v = (ext_mem_compressed_vertex *) buf;
+	c_v->id = v.get_id();
+	c_v->num_edges = v.get_num_edges();
+	bool wide;
+	c_v->encoded_size = encode_neighbors(v.neighbors, v.get_num_edges(),
+			c_v->data, wide);
+	c_v->edge_data_size = v.get_edge_data_size() | COMPRESSED_FLAG;
+	if (wide)
+		c_v->edge_data_size |= WIDE_FLAG;
+	if (v.has_edge_data())
+		memcpy(buf + c_v->get_edge_data_off(), v.get_raw_edge_data(0),
+				v.get_num_edges() * v.get_edge_data_size());
+	return c_v->get_size();
+}
+
+void ext_mem_compressed_vertex::decode(char *buf, size_t size) const
+{
+	assert(size >= get_decoded_size());
+	ext_mem_undirected_vertex *v = (ext_mem_undirected_vertex *) buf;
+	*v = ext_mem_undirected_vertex(id, num_edges, get_edge_data_size());
+	decode_neighbors(data, encoded_size, num_edges, edge_data_size & WIDE_FLAG,
+			v->neighbors);
+	if (v->has_edge_data())
+		memcpy(v->get_edge_data_addr(), ((char *) this) + get_edge_data_off(),
+				num_edges * get_edge_data_size());
+}
+
+namespace
+{
+
+/*
+ * Each thread keeps the buffer of the last destroyed decoded vertex array,
+ * so decoding a vertex usually doesn't need to allocate memory.
+ */
+class spare_buf_store
+{
+	// We don't keep a very large buffer for a thread.
+	static const size_t MAX_SPARE_SIZE = 1024 * 1024;
+
+	struct spare_buf
+	{
+		char *buf;
+		size_t capacity;
+	};
+
+	pthread_key_t key;
+
+	static void destroy_buf(void *p) {
+		spare_buf *spare = (spare_buf *) p;
+		free(spare->buf);
+		delete spare;
+	}
+
+	spare_buf *get_spare() {
+		spare_buf *spare = (spare_buf *) pthread_getspecific(key);
+		if (spare == NULL) {
+			spare = new spare_buf();
+			spare->buf = NULL;
+			spare->capacity = 0;
+			pthread_setspecific(key, spare);
+		}
+		return spare;
+	}
+public:
+	spare_buf_store() {
+		pthread_key_create(&key, destroy_buf);
+	}
+
+	/*
+	 * Get the spare buffer of the thread. It returns NULL if the thread
+	 * doesn't have one.
+	 */
+	char *get(size_t &capacity) {
+		spare_buf *spare = get_spare();
+		char *buf = spare->buf;
+		capacity = spare->capacity;
+		spare->buf = NULL;
+		spare->capacity = 0;
+		return buf;
+	}
+
+	void put(char *buf, size_t capacity) {
+		spare_buf *spare = get_spare();
+		if (capacity <= MAX_SPARE_SIZE && capacity > spare->capacity) {
+			free(spare->buf);
+			spare->buf = buf;
+			spare->capacity = capacity;
+		}
+		else
+			free(buf);
+	}
+};
+
+spare_buf_store spare_bufs;
+
+}
+
+decoded_vertex_array::~decoded_vertex_array()
+{
+	if (buf)
+		spare_bufs.put(buf, capacity);
+}
+
+size_t decoded_vertex_array::decode(const safs::page_byte_array &arr)
+{
+	size_t header_size = ext_mem_compressed_vertex::get_header_size();
+	assert(arr.get_size() >= header_size);
+	ext_mem_compressed_vertex header;
+	arr.memcpy(0, (char *) &header, header_size);
+	size_t compressed_size = header.get_size();
+	assert(arr.get_size() >= compressed_size);
+
+	// A compressed vertex in a single page is decoded in the page directly.
+	// Otherwise, we need to copy it to contiguous memory first.
+	std::unique_ptr<char[]> tmp;
+	const ext_mem_compressed_vertex *c_v;
+	off_t off_in_page = arr.get_offset_in_first_page();
+	if (off_in_page + compressed_size <= (size_t) safs::PAGE_SIZE)
+		c_v = (const ext_mem_compressed_vertex *) (arr.get_page(0)
+				+ off_in_page);
+	else {
+		tmp = std::unique_ptr<char[]>(new char[compressed_size]);
+		arr.memcpy(0, tmp.get(), compressed_size);
+		c_v = (const ext_mem_compressed_vertex *) tmp.get();
+	}
+
+	char *decoded = alloc(c_v->get_decoded_size(), arr.get_offset());
+	c_v->decode(decoded, size);
+	return compressed_size;
+}
+
+char *decoded_vertex_array::alloc(size_t size, off_t off)
+{
+	this->size = size;
+	this->off = off;
+	if (buf == NULL)
+		buf = spare_bufs.get(capacity);
+	if (capacity < size) {
+		free(buf);
+		capacity = std::max(size, (size_t) safs::PAGE_SIZE);
+		buf = (char *) malloc(capacity);
+		if (buf == NULL)
+			throw oom_exception("can't allocate memory for a decoded vertex");
+	}
+	return buf;
+}
+
 }
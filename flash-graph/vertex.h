@@ -443,6 +443,8 @@ class in_mem_vertex;
  */
 class ext_mem_undirected_vertex
 {
+	friend class ext_mem_compressed_vertex;
+
 	vertex_id_t id;
 	uint32_t edge_data_size;
 	vsize_t num_edges;
@@ -475,6 +477,12 @@ class ext_mem_undirected_vertex
 		return (edge_data_type *) get_edge_data_addr();
 	}
 public:
+	/*
+	 * The highest bit of `edge_data_size' is set in a vertex stored in
+	 * the compressed format (see ext_mem_compressed_vertex).
+	 */
+	static const uint32_t COMPRESSED_FLAG = 1U << 31;
+
 	static size_t get_header_size() {
 		return offsetof(ext_mem_undirected_vertex, neighbors);
 	}
@@ -559,6 +567,149 @@ public:
 	vertex_id_t get_id() const {
 		return id;
 	}
+
+	bool is_compressed() const {
+		return edge_data_size & COMPRESSED_FLAG;
+	}
+};
+
+/*
+ * This represents a vertex whose neighbor list is compressed in
+ * the external memory. It starts with the same fields as
+ * ext_mem_undirected_vertex, followed by the size of the encoded neighbor
+ * list, the encoded neighbor list (see encode_neighbors()) and the edge
+ * data list, which isn't compressed.
+ */
+class ext_mem_compressed_vertex
+{
+	vertex_id_t id;
+	uint32_t edge_data_size;
+	vsize_t num_edges;
+	uint32_t encoded_size;
+	unsigned char data[0];
+
+	static const uint32_t COMPRESSED_FLAG
+		= ext_mem_undirected_vertex::COMPRESSED_FLAG;
+	// The deltas in the neighbor list are stored with 64 bits.
+	static const uint32_t WIDE_FLAG = 1U << 30;
+	static const uint32_t FLAG_MASK = COMPRESSED_FLAG | WIDE_FLAG;
+
+	size_t get_edge_data_off() const {
+		return ROUNDUP(get_header_size() + encoded_size,
+				get_edge_data_size());
+	}
+public:
+	static size_t get_header_size() {
+		return offsetof(ext_mem_compressed_vertex, data);
+	}
+
+	static size_t get_max_size(vsize_t num_edges, uint32_t edge_data_size);
+
+	/*
+	 * Compress the vertex. The neighbor list of the vertex has to be sorted.
+	 * It returns the size of the compressed vertex.
+	 */
+	static size_t serialize(const ext_mem_undirected_vertex &v, char *buf,
+			size_t size);
+
+	vertex_id_t get_id() const {
+		return id;
+	}
+
+	size_t get_num_edges() const {
+		return num_edges;
+	}
+
+	size_t get_edge_data_size() const {
+		return edge_data_size & ~FLAG_MASK;
+	}
+
+	size_t get_size() const {
+		if (get_edge_data_size() > 0)
+			return ROUNDUP(get_edge_data_off()
+					+ num_edges * get_edge_data_size(), sizeof(vertex_id_t));
+		else
+			return ROUNDUP(get_header_size() + encoded_size,
+					sizeof(vertex_id_t));
+	}
+
+	/*
+	 * The size of the vertex in the format of ext_mem_undirected_vertex.
+	 */
+	size_t get_decoded_size() const {
+		return ext_mem_undirected_vertex::num_edges2vsize(num_edges,
+				get_edge_data_size());
+	}
+
+	/*
+	 * Decode the vertex to the format of ext_mem_undirected_vertex.
+	 */
+	void decode(char *buf, size_t size) const;
+};
+
+/*
+ * This byte array contains a vertex decoded from ext_mem_compressed_vertex
+ * in the format of ext_mem_undirected_vertex, so a page vertex accesses
+ * the decoded vertex in the same way as a vertex in the page cache.
+ * The memory of the array is contiguous and it's reused by the next
+ * decoded vertex in the thread after the array is destroyed.
+ */
+class decoded_vertex_array: public safs::page_byte_array
+{
+	char *buf;
+	size_t capacity;
+	size_t size;
+	off_t off;
+
+	decoded_vertex_array(const decoded_vertex_array &);
+	decoded_vertex_array &operator=(const decoded_vertex_array &);
+public:
+	decoded_vertex_array() {
+		buf = NULL;
+		capacity = 0;
+		size = 0;
+		off = 0;
+	}
+
+	~decoded_vertex_array();
+
+	/*
+	 * Decode the compressed vertex at the beginning of the byte array.
+	 * It returns the size of the compressed vertex.
+	 */
+	size_t decode(const safs::page_byte_array &arr);
+
+	/*
+	 * Get the buffer for a vertex of the specified size that is constructed
+	 * in memory. The byte array contains the vertex afterwards.
+	 */
+	char *alloc(size_t size, off_t off);
+
+	virtual void lock() {
+	}
+
+	virtual void unlock() {
+	}
+
+	virtual off_t get_offset() const {
+		return off;
+	}
+
+	virtual size_t get_size() const {
+		return size;
+	}
+
+	virtual page_byte_array *clone() {
+		return NULL;
+	}
+
+	virtual off_t get_offset_in_first_page() const {
+		return 0;
+	}
+
+	virtual const char *get_page(int idx) const {
+		return buf + ((size_t) idx) * safs::PAGE_SIZE;
+	}
 };
 
 inline bool ext_mem_vertex_info::has_edges() const
@@ -737,6 +888,35 @@ class page_directed_vertex: public page_vertex
 	size_t out_size;
 	const safs::page_byte_array *in_array;
 	const safs::page_byte_array *out_array;
+	// Compressed vertices are decoded here.
+	decoded_vertex_array in_decoded;
+	decoded_vertex_array out_decoded;
+	// The location of the neighbors in the byte arrays. A partial edge list
+	// only has the neighbors, so the location is 0.
+	size_t neigh_off;
+
+	/*
+	 * Initialize a part of the vertex in the byte array. The part is decoded
+	 * if it's compressed. It returns the vertex ID.
+	 */
+	static vertex_id_t init_part(const safs::page_byte_array &arr,
+			decoded_vertex_array &decoded, const safs::page_byte_array *&part,
+			size_t &part_size, vsize_t &num_edges) {
+		size_t size = arr.get_size();
+		BOOST_VERIFY(size >= ext_mem_undirected_vertex::get_header_size());
+		ext_mem_undirected_vertex v = arr.get<ext_mem_undirected_vertex>(0);
+		if (v.is_compressed()) {
+			part_size = decoded.decode(arr);
+			part = &decoded;
+		}
+		else {
+			part_size = v.get_size();
+			assert(size >= part_size);
+			part = &arr;
+		}
+		num_edges = v.get_num_edges();
+		return v.get_id();
+	}
 public:
 	static vertex_id_t get_id(const safs::page_byte_array &arr) {
 		BOOST_VERIFY(arr.get_size()
@@ -753,51 +933,64 @@ public:
      */
 	page_directed_vertex(const safs::page_byte_array &arr,
 			bool in_part): page_vertex(true) {
-		size_t size = arr.get_size();
-		BOOST_VERIFY(size >= ext_mem_undirected_vertex::get_header_size());
-		ext_mem_undirected_vertex v = arr.get<ext_mem_undirected_vertex>(0);
-
+		neigh_off = ext_mem_undirected_vertex::get_header_size();
 		if (in_part) {
-			in_size = v.get_size();
-			assert(size >= in_size);
+			id = init_part(arr, in_decoded, in_array, in_size, num_in_edges);
 			out_size = 0;
-			this->in_array = &arr;
 			this->out_array = NULL;
-			num_in_edges = v.get_num_edges();
 			num_out_edges = 0;
 		}
 		else {
-			out_size = v.get_size();
+			id = init_part(arr, out_decoded, out_array, out_size,
+					num_out_edges);
 			in_size = 0;
-			assert(size >= out_size);
-			this->out_array = &arr;
 			this->in_array = NULL;
-			num_out_edges = v.get_num_edges();
 			num_in_edges = 0;
 		}
-		id = v.get_id();
 	}
 
 	page_directed_vertex(const safs::page_byte_array &in_arr,
 			const safs::page_byte_array &out_arr): page_vertex(true) {
-		this->in_array = &in_arr;
-		this->out_array = &out_arr;
+		neigh_off = ext_mem_undirected_vertex::get_header_size();
+		id = init_part(in_arr, in_decoded, in_array, in_size, num_in_edges);
+		BOOST_VERIFY(id == init_part(out_arr, out_decoded, out_array,
+					out_size, num_out_edges));
+	}
 
-		size_t size = in_arr.get_size();
-		BOOST_VERIFY(size >= ext_mem_undirected_vertex::get_header_size());
-		ext_mem_undirected_vertex v = in_arr.get<ext_mem_undirected_vertex>(0);
-		in_size = v.get_size();
-		assert(size >= in_size);
-		id = v.get_id();
-		num_in_edges = v.get_num_edges();
+	/**
+	 * \internal
+	 * The constructor for a range of the in-edge or out-edge list of
+	 * a directed vertex. The byte array only contains the neighbors in
+	 * the range, so the vertex doesn't have the edge data.
+	 */
+	page_directed_vertex(const safs::page_byte_array &arr, bool in_part,
+			vertex_id_t id, vsize_t num_edges): page_vertex(true) {
+		assert(arr.get_size() == num_edges * sizeof(vertex_id_t));
+		this->id = id;
+		neigh_off = 0;
+		if (in_part) {
+			in_array = &arr;
+			in_size = arr.get_size();
+			num_in_edges = num_edges;
+			out_array = NULL;
+			out_size = 0;
+			num_out_edges = 0;
+		}
+		else {
+			out_array = &arr;
+			out_size = arr.get_size();
+			num_out_edges = num_edges;
+			in_array = NULL;
+			in_size = 0;
+			num_in_edges = 0;
+		}
+	}
 
-		size = out_arr.get_size();
-		assert(size >= ext_mem_undirected_vertex::get_header_size());
-		v = out_arr.get<ext_mem_undirected_vertex>(0);
-		out_size = v.get_size();
-		assert(size >= out_size);
-		assert(id == v.get_id());
-		num_out_edges = v.get_num_edges();
+	/*
+	 * Whether the vertex only has a range of an edge list.
+	 */
+	bool is_partial_list() const {
+		return neigh_off == 0;
 	}
 
 	size_t get_in_size() const {
@@ -838,12 +1031,10 @@ public:
 		switch(type) {
 			case IN_EDGE:
 				assert(in_array);
-				return in_array->begin<vertex_id_t>(
-						ext_mem_undirected_vertex::get_header_size());
+				return in_array->begin<vertex_id_t>(neigh_off);
 			case OUT_EDGE:
 				assert(out_array);
-				return out_array->begin<vertex_id_t>(
-						ext_mem_undirected_vertex::get_header_size());
+				return out_array->begin<vertex_id_t>(neigh_off);
 			default:
 				throw invalid_arg_exception("invalid edge type");
 		}
@@ -882,17 +1073,13 @@ public:
 			case IN_EDGE:
 				assert(in_array);
 				return in_array->get_seq_iterator<vertex_id_t>(
-						ext_mem_undirected_vertex::get_header_size()
-						+ start * sizeof(vertex_id_t),
-						ext_mem_undirected_vertex::get_header_size()
-						+ end * sizeof(vertex_id_t));
+						neigh_off + start * sizeof(vertex_id_t),
+						neigh_off + end * sizeof(vertex_id_t));
 			case OUT_EDGE:
 				assert(out_array);
 				return out_array->get_seq_iterator<vertex_id_t>(
-						ext_mem_undirected_vertex::get_header_size()
-						+ start * sizeof(vertex_id_t),
-						ext_mem_undirected_vertex::get_header_size()
-						+ end * sizeof(vertex_id_t));
+						neigh_off + start * sizeof(vertex_id_t),
+						neigh_off + end * sizeof(vertex_id_t));
 			default:
 				throw invalid_arg_exception("invalid edge type");
 		}
@@ -909,6 +1096,7 @@ public:
 	template<class edge_data_type>
 	safs::page_byte_array::const_iterator<edge_data_type> get_data_begin(
 			edge_type type) const {
+		assert(!is_partial_list());
 		switch(type) {
 			case IN_EDGE:
 				assert(in_array);
@@ -953,6 +1141,7 @@ public:
 	template<class edge_data_type>
 	safs::page_byte_array::seq_const_iterator<edge_data_type> get_data_seq_it(
 			edge_type type, size_t start, size_t end) const {
+		assert(!is_partial_list());
 		off_t edge_end;
 		switch(type) {
 			case IN_EDGE:
@@ -997,15 +1186,15 @@ public:
 				assert(num_in_edges <= num);
 				assert(in_array);
 				num_edges = num_in_edges;
-				in_array->memcpy(ext_mem_undirected_vertex::get_header_size(),
-						(char *) edges, sizeof(vertex_id_t) * num_edges);
+				in_array->memcpy(neigh_off, (char *) edges,
+						sizeof(vertex_id_t) * num_edges);
 				break;
 			case OUT_EDGE:
 				assert(num_out_edges <= num);
 				assert(out_array);
 				num_edges = num_out_edges;
-				out_array->memcpy(ext_mem_undirected_vertex::get_header_size(),
-						(char *) edges, sizeof(vertex_id_t) * num_edges);
+				out_array->memcpy(neigh_off, (char *) edges,
+						sizeof(vertex_id_t) * num_edges);
 				break;
 			default:
 				abort();
@@ -1043,17 +1232,26 @@ class page_undirected_vertex: public page_vertex
 	vertex_id_t id;
 	vsize_t vertex_size;
 	vsize_t num_edges;
-	const safs::page_byte_array &array;
+	const safs::page_byte_array *array;
+	// A compressed vertex is decoded here.
+	decoded_vertex_array decoded;
 public:
 	page_undirected_vertex(const safs::page_byte_array &arr): page_vertex(
-			false), array(arr) {
+			false) {
 		size_t size = arr.get_size();
 		BOOST_VERIFY(size >= ext_mem_undirected_vertex::get_header_size());
 		// We only want to know the header of the vertex, so we don't need to
 		// know what data type an edge has.
 		ext_mem_undirected_vertex v = arr.get<ext_mem_undirected_vertex>(0);
-		BOOST_VERIFY((unsigned) size >= v.get_size());
-		vertex_size = v.get_size();
+		if (v.is_compressed()) {
+			vertex_size = decoded.decode(arr);
+			array = &decoded;
+		}
+		else {
+			BOOST_VERIFY((unsigned) size >= v.get_size());
+			vertex_size = v.get_size();
+			array = &arr;
+		}
 
 		id = v.get_id();
 		num_edges = v.get_num_edges();
@@ -1082,7 +1280,7 @@ public:
 	 *         neighbor list of a vertex.
 	 */
 	edge_iterator get_neigh_begin(edge_type type) const {
-		return array.begin<vertex_id_t>(
+		return array->begin<vertex_id_t>(
 				ext_mem_undirected_vertex::get_header_size());
 	}
 
@@ -1117,7 +1315,7 @@ public:
 		end = std::min(end, get_num_edges(type));
 		assert(start <= end);
 		assert(end <= get_num_edges(type));
-		return array.get_seq_iterator<vertex_id_t>(
+		return array->get_seq_iterator<vertex_id_t>(
 				ext_mem_undirected_vertex::get_header_size()
 				+ start * sizeof(vertex_id_t),
 				ext_mem_undirected_vertex::get_header_size()
@@ -1135,7 +1333,7 @@ public:
 			size_t num) const {
 		vsize_t num_edges = get_num_edges(type);
 		assert(num_edges <= num);
-		array.memcpy(ext_mem_undirected_vertex::get_header_size(),
+		array->memcpy(ext_mem_undirected_vertex::get_header_size(),
 				(char *) edges, sizeof(vertex_id_t) * num_edges);
 		return num_edges;
 	}
@@ -1152,7 +1350,7 @@ public:
 			size_t start, size_t end) const {
 		off_t edge_end = ext_mem_undirected_vertex::get_edge_data_offset(
 				num_edges, sizeof(edge_data_type));
-		return array.get_seq_iterator<edge_data_type>(
+		return array->get_seq_iterator<edge_data_type>(
 				edge_end + start * sizeof(edge_data_type),
 				edge_end + end * sizeof(edge_data_type));
 	}
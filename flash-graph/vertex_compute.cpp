@@ -71,7 +71,8 @@ void vertex_compute::request_num_edges(vertex_id_t ids[], size_t num)
 void vertex_compute::run_on_vertex_size(vertex_id_t id, vsize_t size)
 {
 	start_run();
-	vsize_t num_edges = issue_thread->get_graph().cal_num_edges(size);
+	vsize_t num_edges = issue_thread->get_graph().cal_num_edges(id,
+			edge_type::IN_EDGE, size);
 	vertex_header header(id, num_edges);
 	issue_thread->get_vertex_program(v.is_part()).run_on_num_edges(*v, header);
 	num_edge_completed++;
@@ -100,20 +101,34 @@ void vertex_compute::run(page_byte_array &array)
 	num_complete_fetched++;
 	start_run();
 	page_undirected_vertex pg_v(array);
-	issue_thread->get_vertex_program(v.is_part()).run(*v, pg_v);
+	issue_thread->get_vertex_program(v.is_part()).run_on_page_vertex(*v, pg_v);
 	finish_run();
 }
 
 void directed_vertex_compute::run_on_page_vertex(page_directed_vertex &pg_v)
 {
 	start_run();
-	issue_thread->get_vertex_program(v.is_part()).run(*v, pg_v);
+	issue_thread->get_vertex_program(v.is_part()).run_on_page_vertex(*v, pg_v);
 	finish_run();
 }
 
 void directed_vertex_compute::run(page_byte_array &array)
 {
 	num_complete_fetched++;
+	// A range of an edge list doesn't have the vertex header, so it's
+	// identified by its location.
+	if (!issued_ranges.empty()) {
+		auto it = issued_ranges.find(array.get_offset());
+		if (it != issued_ranges.end()) {
+			edge_range range = it->second;
+			issued_ranges.erase(it);
+			page_directed_vertex pg_v(array, range.in_part, range.id,
+					range.end - range.start);
+			run_on_page_vertex(pg_v);
+			return;
+		}
+	}
+
 	// If the combine map is empty, we don't need to merge
 	// byte arrays.
 	if (combine_map.empty()) {
@@ -174,6 +189,16 @@ void directed_vertex_compute::request_partial_vertices(
 			num_requested += 2;
 		else
 			num_requested++;
+		if (reqs[i].is_partial_list()) {
+			assert(!get_graph().get_graph_header().has_compressed_edges());
+			edge_range range;
+			range.id = reqs[i].get_id();
+			range.in_part = reqs[i].get_type() == edge_type::IN_EDGE;
+			range.start = reqs[i].get_start();
+			range.end = reqs[i].get_end();
+			pending_ranges.insert(std::pair<vertex_id_t, edge_range>(
+						range.id, range));
+		}
 	}
 	issue_thread->get_index_reader().request_vertices(reqs, num, *this);
 }
@@ -182,14 +207,45 @@ void directed_vertex_compute::run_on_vertex_size(vertex_id_t id,
 		size_t in_size, size_t out_size)
 {
 	start_run();
-	vsize_t num_in_edges = issue_thread->get_graph().cal_num_edges(in_size);
-	vsize_t num_out_edges = issue_thread->get_graph().cal_num_edges(out_size);
+	vsize_t num_in_edges = issue_thread->get_graph().cal_num_edges(id,
+			edge_type::IN_EDGE, in_size);
+	vsize_t num_out_edges = issue_thread->get_graph().cal_num_edges(id,
+			edge_type::OUT_EDGE, out_size);
 	directed_vertex_header header(id, num_in_edges, num_out_edges);
 	issue_thread->get_vertex_program(v.is_part()).run_on_num_edges(*v, header);
 	num_edge_completed++;
 	finish_run();
 }
 
+void directed_vertex_compute::issue_io_request(const ext_mem_vertex_info &info)
+{
+	if (pending_ranges.empty()) {
+		vertex_compute::issue_io_request(info);
+		return;
+	}
+
+	bool in_part = (size_t) info.get_off() < get_graph().get_in_part_size();
+	auto ranges = pending_ranges.equal_range(info.get_id());
+	for (auto it = ranges.first; it != ranges.second; it++) {
+		if (it->second.in_part != in_part)
+			continue;
+
+		edge_range range = it->second;
+		pending_ranges.erase(it);
+		assert(range.end <= get_graph().cal_num_edges(info.get_id(),
+					in_part ? edge_type::IN_EDGE : edge_type::OUT_EDGE,
+					info.get_size()));
+		// Only read the neighbors in the range.
+		off_t off = info.get_off() + ext_mem_undirected_vertex::get_header_size()
+			+ range.start * sizeof(vertex_id_t);
+		issued_ranges.insert(std::pair<off_t, edge_range>(off, range));
+		vertex_compute::issue_io_request(ext_mem_vertex_info(info.get_id(),
+					off, (range.end - range.start) * sizeof(vertex_id_t)));
+		return;
+	}
+	vertex_compute::issue_io_request(info);
+}
+
 void directed_vertex_compute::issue_io_request(const ext_mem_vertex_info &in_info,
 		const ext_mem_vertex_info &out_info)
 {
@@ -252,7 +308,7 @@ void merged_undirected_vertex_compute::run(page_byte_array &array)
 		assert(pg_v.get_id() == id);
 		compute_vertex_pointer v(&get_graph().get_vertex(pg_v.get_id()));
 		start_run(v);
-		curr_vprog.run(*v, pg_v);
+		curr_vprog.run_on_page_vertex(*v, pg_v);
 		finish_run(v);
 		off += pg_v.get_size();
 	}
@@ -274,7 +330,7 @@ void merged_directed_vertex_compute::run_on_array(page_byte_array &array)
 		assert(pg_v.get_id() == id);
 		compute_vertex_pointer v(&get_graph().get_vertex(pg_v.get_id()));
 		start_run(v);
-		curr_vprog.run(*v, pg_v);
+		curr_vprog.run_on_page_vertex(*v, pg_v);
 		finish_run(v);
 		if (in_part)
 			off += pg_v.get_in_size();
@@ -299,7 +355,7 @@ void merged_directed_vertex_compute::run_on_arrays(page_byte_array &in_arr,
 		assert(pg_v.get_id() == id);
 		compute_vertex_pointer v(&get_graph().get_vertex(pg_v.get_id()));
 		start_run(v);
-		curr_vprog.run(*v, pg_v);
+		curr_vprog.run_on_page_vertex(*v, pg_v);
 		finish_run(v);
 		in_off += pg_v.get_in_size();
 		out_off += pg_v.get_out_size();
@@ -377,7 +433,7 @@ void sparse_undirected_vertex_compute::run(page_byte_array &arr)
 			assert(pg_v.get_id() == id);
 			compute_vertex_pointer v(&get_graph().get_vertex(pg_v.get_id()));
 			start_run(v);
-			curr_vprog.run(*v, pg_v);
+			curr_vprog.run_on_page_vertex(*v, pg_v);
 			finish_run(v);
 			off += pg_v.get_size();
 		}
@@ -402,7 +458,7 @@ void sparse_directed_vertex_compute::run_on_array(page_byte_array &arr)
 			assert(pg_v.get_id() == id);
 			compute_vertex_pointer v(&get_graph().get_vertex(pg_v.get_id()));
 			start_run(v);
-			curr_vprog.run(*v, pg_v);
+			curr_vprog.run_on_page_vertex(*v, pg_v);
 			finish_run(v);
 			if (in_part)
 				off += pg_v.get_in_size();
@@ -437,7 +493,7 @@ void sparse_directed_vertex_compute::run_on_arrays(page_byte_array &in_arr,
 			assert(pg_v.get_id() == id);
 			compute_vertex_pointer v(&get_graph().get_vertex(pg_v.get_id()));
 			start_run(v);
-			curr_vprog.run(*v, pg_v);
+			curr_vprog.run_on_page_vertex(*v, pg_v);
 			finish_run(v);
 			in_off += pg_v.get_in_size();
 			out_off += pg_v.get_out_size();
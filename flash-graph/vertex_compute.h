@@ -171,7 +171,7 @@ public:
 	 * a vertex is ready, the vertex index notifies the vertex compute
 	 * of the information.
 	 */
-	void issue_io_request(const ext_mem_vertex_info &info);
+	virtual void issue_io_request(const ext_mem_vertex_info &info);
 
 	/*
 	 * The methods below deal with requesting # edges of vertices.
@@ -213,6 +213,24 @@ class directed_vertex_compute: public vertex_compute
 	typedef std::unordered_map<vertex_id_t, safs::page_byte_array *> combine_map_t;
 	combine_map_t combine_map;
 
+	/*
+	 * A range of an edge list requested by `request_partial_vertices'.
+	 */
+	struct edge_range
+	{
+		vertex_id_t id;
+		bool in_part;
+		vsize_t start;
+		vsize_t end;
+	};
+	// The ranges whose edge lists are being located in the vertex index.
+	// The requests for the same edge list are indistinguishable when
+	// the index returns the location, so any of them can be issued.
+	std::unordered_multimap<vertex_id_t, edge_range> pending_ranges;
+	// The ranges being read from the graph file, indexed by the location
+	// of the I/O requests.
+	std::unordered_multimap<off_t, edge_range> issued_ranges;
+
 	void run_on_page_vertex(page_directed_vertex &);
 public:
 	directed_vertex_compute(graph_engine *graph,
@@ -242,7 +260,11 @@ public:
 	 */
 	void run_on_vertex_size(vertex_id_t id, size_t in_size, size_t out_size);
 
-	using vertex_compute::issue_io_request;
+	/*
+	 * This is a callback function that reads a range of the edge list
+	 * if the edge list is requested partially.
+	 */
+	virtual void issue_io_request(const ext_mem_vertex_info &info);
 	void issue_io_request(const ext_mem_vertex_info &in_info,
 			const ext_mem_vertex_info &out_info);
 
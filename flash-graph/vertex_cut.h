@@ -0,0 +1,313 @@
+#ifndef __VERTEX_CUT_H__
+#define __VERTEX_CUT_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "vertex.h"
+#include "vertex_program.h"
+#include "graph_engine.h"
+#include "graph_config.h"
+#include "graph_index.h"
+
+namespace fg
+{
+
+/**
+ * \brief The part vertex of the vertex-cut mode.
+ *
+ * When `num_vparts' is larger than 1, an activated vertex with at least
+ * `min_vpart_degree' edges is processed by `num_vparts' part vertices.
+ * Each part vertex reads and runs on a chunk of the edge list in
+ * the thread that fetches or steals it, so a vertex with many edges
+ * doesn't keep a thread busy after the other threads finish the iteration.
+ * The results of the chunks are merged and applied to the main vertex once.
+ * If the vertex scatters the new value, each part vertex scatters to its
+ * chunk of the out-edges at the beginning of the next iteration, when
+ * the part vertices are spread among the threads again.
+ *
+ * An algorithm uses the mode by creating its graph index with
+ * NUMA_graph_index<vertex_type, gas_part_vertex<vertex_type> >.
+ * The vertex type defines:
+ *
+ * gather_type: the result of a chunk of edges. It's default constructed
+ * and merged with `+='.
+ *
+ * edge_type get_cut_edges(vertex_program &prog) const: the edges gathered
+ * by the part vertices in the current iteration. It's invoked when
+ * the activated vertices are fetched for the iteration, and the main
+ * vertex runs as usual if it returns NONE and there is nothing to scatter,
+ * or if the vertex has updates in the delta store of the graph. It's
+ * invoked again by each part vertex, which doesn't gather if it returns
+ * NONE, so it should only change when the vertex is applied.
+ *
+ * void run_on_edges(vertex_program &prog, const page_vertex &vertex,
+ * edge_type type, size_t start, size_t end, gather_type &accum) const:
+ * gathers from the neighbors in [start, end) of the edge list of `type'
+ * in `vertex'. It runs in parallel with the other chunks of the vertex,
+ * so it can't modify the vertex.
+ *
+ * bool apply(vertex_program &prog, const gather_type &accum): applies
+ * the merged result to the vertex after all chunks are gathered, and
+ * returns true if the out-neighbors should be scattered to.
+ *
+ * void scatter(vertex_program &prog, const page_vertex &vertex,
+ * size_t start, size_t end) const: scatters to the neighbors in
+ * [start, end) of the out-edge list in `vertex'. It runs in parallel with
+ * the other chunks of the vertex.
+ *
+ * The edge list of a vertex in an undirected graph or in a graph with
+ * compressed edges can't be read in ranges, so every part vertex reads
+ * the entire edge list, which is shared by the page cache, and runs on its
+ * own chunk.
+ */
+template<class vertex_type>
+class gas_part_vertex: public part_compute_directed_vertex
+{
+	typedef typename vertex_type::gather_type gather_type;
+
+	edge_type type;
+	gather_type accum;
+	// The number of the edge lists the part vertex is waiting for to
+	// gather from.
+	size_t num_pending;
+	// Whether the part vertex scatters to its chunk of the out-edges when
+	// it runs next time. Only the part vertex that applies the merged result
+	// sets it.
+	bool scatter_pending;
+	// Whether the part vertex is waiting for its chunk of the out-edges
+	// to scatter to.
+	bool scattering;
+	// The number of the part vertices that have processed their chunks
+	// in the current iteration. Only the first part vertex counts them.
+	std::atomic<size_t> num_done;
+
+	static bool read_ranges(vertex_program &prog) {
+		return prog.get_graph().is_directed()
+			&& !prog.get_graph().get_graph_header().has_compressed_edges();
+	}
+
+	void get_chunk(size_t num_edges, size_t &start, size_t &end) const {
+		size_t num_vparts = graph_conf.get_num_vparts();
+		size_t chunk_size = (num_edges + num_vparts - 1) / num_vparts;
+		start = std::min(chunk_size * get_part_id(), num_edges);
+		end = std::min(start + chunk_size, num_edges);
+	}
+
+	void request_scatter(vertex_program &prog);
+	void request_gather(vertex_program &prog);
+	void gather(vertex_program &prog, const page_vertex &vertex);
+	void apply(vertex_program &prog);
+public:
+	gas_part_vertex(vertex_id_t id, int part_id): part_compute_directed_vertex(
+			id, part_id) {
+		type = edge_type::NONE;
+		num_pending = 0;
+		scatter_pending = false;
+		scattering = false;
+		num_done = 0;
+	}
+
+	static bool run_on_vparts(vertex_program &prog, const compute_vertex &v) {
+		if (((const vertex_type &) v).get_cut_edges(prog) != edge_type::NONE)
+			return true;
+		compute_vertex_pointer first;
+		BOOST_VERIFY(prog.get_graph().get_graph_index().get_vpart_vertices(
+					prog.get_vertex_id(v), &first, 1) == 1);
+		return ((const gas_part_vertex &) *first).scatter_pending;
+	}
+
+	void run(vertex_program &prog) {
+		const vertex_type &v = (const vertex_type &) prog.get_graph().get_vertex(
+				get_id());
+		type = v.get_cut_edges(prog);
+		// The part vertex scatters the result of the previous iteration
+		// before it gathers for the current one.
+		if (scatter_pending) {
+			scatter_pending = false;
+			request_scatter(prog);
+		}
+		else if (type != edge_type::NONE)
+			request_gather(prog);
+	}
+
+	void run(vertex_program &prog, const page_vertex &vertex);
+};
+
+template<class vertex_type>
+void gas_part_vertex<vertex_type>::request_scatter(vertex_program &prog)
+{
+	vertex_id_t id = get_id();
+	if (!read_ranges(prog)) {
+		scattering = true;
+		if (prog.get_graph().is_directed()) {
+			directed_vertex_request req(id, edge_type::OUT_EDGE);
+			request_partial_vertices(&req, 1);
+		}
+		else
+			request_vertices(&id, 1);
+		return;
+	}
+
+	size_t start, end;
+	get_chunk(prog.get_graph().get_num_edges(id, edge_type::OUT_EDGE),
+			start, end);
+	if (start < end) {
+		scattering = true;
+		directed_vertex_request req(id, edge_type::OUT_EDGE, start, end);
+		request_partial_vertices(&req, 1);
+	}
+	else if (type != edge_type::NONE)
+		request_gather(prog);
+}
+
+template<class vertex_type>
+void gas_part_vertex<vertex_type>::request_gather(vertex_program &prog)
+{
+	accum = gather_type();
+	vertex_id_t id = get_id();
+	if (!read_ranges(prog)) {
+		num_pending = 1;
+		if (prog.get_graph().is_directed()) {
+			directed_vertex_request req(id, type);
+			request_partial_vertices(&req, 1);
+		}
+		else
+			request_vertices(&id, 1);
+		return;
+	}
+
+	// The chunk of a vertex with both types of edges may have some of
+	// the in-edges and some of the out-edges.
+	size_t num_in_edges = 0;
+	size_t num_out_edges = 0;
+	if (type == edge_type::IN_EDGE || type == edge_type::BOTH_EDGES)
+		num_in_edges = prog.get_graph().get_num_edges(id, edge_type::IN_EDGE);
+	if (type == edge_type::OUT_EDGE || type == edge_type::BOTH_EDGES)
+		num_out_edges = prog.get_graph().get_num_edges(id, edge_type::OUT_EDGE);
+	size_t start, end;
+	get_chunk(num_in_edges + num_out_edges, start, end);
+	directed_vertex_request reqs[2];
+	num_pending = 0;
+	if (start < std::min(end, num_in_edges))
+		reqs[num_pending++] = directed_vertex_request(id, edge_type::IN_EDGE,
+				start, std::min(end, num_in_edges));
+	if (end > num_in_edges)
+		reqs[num_pending++] = directed_vertex_request(id, edge_type::OUT_EDGE,
+				std::max(start, num_in_edges) - num_in_edges,
+				end - num_in_edges);
+	if (num_pending > 0)
+		request_partial_vertices(reqs, num_pending);
+	else
+		apply(prog);
+}
+
+template<class vertex_type>
+void gas_part_vertex<vertex_type>::run(vertex_program &prog,
+		const page_vertex &vertex)
+{
+	assert(vertex.get_id() == get_id());
+	if (!scattering) {
+		gather(prog, vertex);
+		return;
+	}
+
+	const vertex_type &v = (const vertex_type &) prog.get_graph().get_vertex(
+			get_id());
+	scattering = false;
+	size_t start = 0;
+	size_t end = vertex.get_num_edges(edge_type::OUT_EDGE);
+	if (!read_ranges(prog))
+		get_chunk(end, start, end);
+	if (start < end)
+		v.scatter(prog, vertex, start, end);
+	if (type != edge_type::NONE)
+		request_gather(prog);
+}
+
+template<class vertex_type>
+void gas_part_vertex<vertex_type>::gather(vertex_program &prog,
+		const page_vertex &vertex)
+{
+	const vertex_type &v = (const vertex_type &) prog.get_graph().get_vertex(
+			get_id());
+	if (read_ranges(prog)) {
+		// The page vertex only has the range of the edge list.
+		edge_type range_type = ((const page_directed_vertex &) vertex).has_in_part()
+			? edge_type::IN_EDGE : edge_type::OUT_EDGE;
+		v.run_on_edges(prog, vertex, range_type, 0,
+				vertex.get_num_edges(range_type), accum);
+	}
+	else {
+		size_t start, end;
+		get_chunk(vertex.get_num_edges(type), start, end);
+		if (type == edge_type::BOTH_EDGES && prog.get_graph().is_directed()) {
+			size_t num_in_edges = vertex.get_num_edges(edge_type::IN_EDGE);
+			if (start < num_in_edges)
+				v.run_on_edges(prog, vertex, edge_type::IN_EDGE, start,
+						std::min(end, num_in_edges), accum);
+			if (end > num_in_edges)
+				v.run_on_edges(prog, vertex, edge_type::OUT_EDGE,
+						std::max(start, num_in_edges) - num_in_edges,
+						end - num_in_edges, accum);
+		}
+		else if (start < end)
+			v.run_on_edges(prog, vertex, type, start, end, accum);
+	}
+	assert(num_pending > 0);
+	if (--num_pending == 0)
+		apply(prog);
+}
+
+/*
+ * The part vertex that processes the last chunk merges the results of
+ * all chunks and applies them to the main vertex. If the main vertex
+ * scatters, it's activated, so its part vertices run in the next iteration
+ * to scatter.
+ */
+template<class vertex_type>
+void gas_part_vertex<vertex_type>::apply(vertex_program &prog)
+{
+	size_t num_vparts = graph_conf.get_num_vparts();
+	std::vector<compute_vertex_pointer> parts(num_vparts);
+	BOOST_VERIFY(prog.get_graph().get_graph_index().get_vpart_vertices(
+				get_id(), parts.data(), parts.size()) == num_vparts);
+	gas_part_vertex &first = (gas_part_vertex &) *parts[0];
+	if (first.num_done.fetch_add(1) + 1 < num_vparts)
+		return;
+
+	first.num_done = 0;
+	gather_type merged = gather_type();
+	for (size_t i = 0; i < num_vparts; i++)
+		merged += ((gas_part_vertex &) *parts[i]).accum;
+	vertex_type &v = (vertex_type &) prog.get_graph().get_vertex(get_id());
+	if (v.apply(prog, merged) && prog.get_graph().get_num_edges(get_id(),
+				edge_type::OUT_EDGE) > 0) {
+		for (size_t i = 0; i < num_vparts; i++)
+			((gas_part_vertex &) *parts[i]).scatter_pending = true;
+		prog.activate_vertex(get_id());
+	}
+}
+
+}
+
+#endif
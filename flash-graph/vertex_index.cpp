@@ -43,6 +43,8 @@ static void verify_index(vertex_index::ptr idx)
 	if (!idx->get_graph_header().is_graph_file()
 			|| !idx->get_graph_header().is_right_version())
 		throw wrong_format("wrong index file or format version");
+	if (!idx->get_graph_header().is_right_id_size())
+		throw wrong_format("the index uses vertex IDs of a different size");
 
 	bool verify_format;
 	if (idx->get_graph_header().is_directed_graph()) {
@@ -144,6 +146,8 @@ vertex_index::ptr vertex_index::safs_load(const std::string &index_file)
 	if (!index->get_graph_header().is_graph_file()
 			|| !index->get_graph_header().is_right_version())
 		throw wrong_format("wrong index file or format version");
+	if (!index->get_graph_header().is_right_id_size())
+		throw wrong_format("the index uses vertex IDs of a different size");
 
 	// Initialize the buffer for containing the index.
 	size_t index_size = index->get_index_size();
@@ -330,6 +334,9 @@ in_mem_cundirected_vertex_index::in_mem_cundirected_vertex_index(
 			index.get_graph_header().is_directed_graph(),
 			true)
 {
+	if (index.get_graph_header().has_compressed_edges())
+		throw wrong_format(
+				"a graph with compressed edge lists can't use a compressed index");
 	if (index.is_compressed())
 		init((const cundirected_vertex_index &) index);
 	else
@@ -438,6 +445,9 @@ in_mem_cdirected_vertex_index::in_mem_cdirected_vertex_index(
 			index.get_graph_header().is_directed_graph(),
 			true)
 {
+	if (index.get_graph_header().has_compressed_edges())
+		throw wrong_format(
+				"a graph with compressed edge lists can't use a compressed index");
 	if (index.is_compressed())
 		init((const cdirected_vertex_index &) index);
 	else
@@ -480,6 +490,9 @@ void in_mem_cdirected_vertex_index::verify_against(
 cdirected_vertex_index::ptr cdirected_vertex_index::construct(
 		directed_vertex_index &index)
 {
+	if (index.get_graph_header().has_compressed_edges())
+		throw wrong_format(
+				"a graph with compressed edge lists can't use a compressed index");
 	size_t edge_data_size = index.get_graph_header().get_edge_data_size();
 	size_t num_entries = index.get_num_entries();
 	size_t num_vertices = num_entries - 1;
@@ -611,6 +624,9 @@ cdirected_vertex_index::ptr cdirected_vertex_index::construct(
 cundirected_vertex_index::ptr cundirected_vertex_index::construct(
 		undirected_vertex_index &index)
 {
+	if (index.get_graph_header().has_compressed_edges())
+		throw wrong_format(
+				"a graph with compressed edge lists can't use a compressed index");
 	size_t edge_data_size = index.get_graph_header().get_edge_data_size();
 	size_t num_entries = index.get_num_entries();
 	size_t num_vertices = num_entries - 1;
@@ -725,12 +741,16 @@ public:
 	}
 
 	vsize_t get_num_in_edges(vertex_id_t id) const {
+		if (index->get_graph_header().has_compressed_edges())
+			return index->get_num_in_edges(id);
 		ext_mem_vertex_info info = index->get_vertex_info_in(id);
 		return ext_mem_undirected_vertex::vsize2num_edges(info.get_size(),
 				index->get_graph_header().get_edge_data_size());
 	}
 
 	vsize_t get_num_out_edges(vertex_id_t id) const {
+		if (index->get_graph_header().has_compressed_edges())
+			return index->get_num_out_edges(id);
 		ext_mem_vertex_info info = index->get_vertex_info_out(id);
 		return ext_mem_undirected_vertex::vsize2num_edges(info.get_size(),
 				index->get_graph_header().get_edge_data_size());
@@ -767,6 +787,8 @@ public:
 	}
 
 	virtual vsize_t get_num_edges(vertex_id_t id, edge_type type) const {
+		if (index->get_graph_header().has_compressed_edges())
+			return index->get_num_edges(id);
 		ext_mem_vertex_info info = index->get_vertex_info(id);
 		return ext_mem_undirected_vertex::vsize2num_edges(info.get_size(),
 				index->get_graph_header().get_edge_data_size());
@@ -780,6 +802,10 @@ public:
 in_mem_query_vertex_index::ptr in_mem_query_vertex_index::create(
 		vertex_index::ptr index, bool compress)
 {
+	// The compressed vertex index computes the number of edges of a vertex
+	// from its size, which doesn't work for compressed edge lists.
+	if (index->get_graph_header().has_compressed_edges())
+		compress = false;
 	if (index->is_compressed() || compress) {
 		if (index->get_graph_header().is_directed_graph())
 			return in_mem_cdirected_vertex_index::create(*index);
@@ -89,6 +89,22 @@ public:
 		return sizeof(vertex_index);
 	}
 
+	/*
+	 * The number of edges of a vertex can't be computed from the size of
+	 * a compressed vertex, so the index of a graph with compressed edge lists
+	 * stores the number of edges of each vertex behind the index entries.
+	 * In a directed graph, the numbers of in-edges of all vertices are
+	 * followed by the numbers of out-edges.
+	 */
+	static size_t get_degree_size(const graph_header &header) {
+		if (!header.has_compressed_edges())
+			return 0;
+		size_t num = header.get_num_vertices();
+		if (header.is_directed_graph())
+			num *= 2;
+		return num * sizeof(vsize_t);
+	}
+
 	const graph_header &get_graph_header() const {
 		return (const graph_header &) *this;
 	}
@@ -138,7 +154,7 @@ class vertex_index_temp: public vertex_index
 protected:
 	vertex_index_temp(const graph_header &header): vertex_index(
 			sizeof(vertex_entry_type)) {
-		memcpy(this, &header, sizeof(h.data.header));
+		header.copy_to(h.page);
 		h.data.num_entries = 1;
 		vertices[0] = vertex_entry_type(sizeof(graph_header));
 	}
@@ -151,24 +167,35 @@ public:
 			   vertex_index>(index);
 	}
 
+	/*
+	 * `degrees' is only required by a graph with compressed edge lists.
+	 */
 	static vertex_index::ptr create(const graph_header &header,
-			const std::vector<vertex_entry_type> &vertices) {
+			const std::vector<vertex_entry_type> &vertices,
+			const std::vector<vsize_t> &degrees = std::vector<vsize_t>()) {
+		size_t entry_size = vertices.size() * sizeof(vertices[0]);
+		assert(degrees.size() * sizeof(vsize_t) == get_degree_size(header));
 		char *buf = (char *) malloc(vertex_index::get_header_size()
-				+ vertices.size() * sizeof(vertices[0]));
+				+ entry_size + get_degree_size(header));
 		vertex_index_temp<vertex_entry_type> *index
 			= new (buf) vertex_index_temp<vertex_entry_type>(header);
 		index->h.data.num_entries = vertices.size();
 		assert(header.get_num_vertices() + 1 == vertices.size());
 		memcpy(buf + vertex_index::get_header_size(), vertices.data(),
-				vertices.size() * sizeof(vertices[0]));
+				entry_size);
+		if (!degrees.empty())
+			memcpy(buf + vertex_index::get_header_size() + entry_size,
+					degrees.data(), get_degree_size(header));
 		return vertex_index::ptr(index, destroy_index());
 	}
 
 	static void dump(const std::string &file, const graph_header &header,
-			const std::vector<vertex_entry_type> &vertices) {
+			const std::vector<vertex_entry_type> &vertices,
+			const std::vector<vsize_t> &degrees = std::vector<vsize_t>()) {
 		vertex_index_temp<vertex_entry_type> index(header);
 		index.h.data.num_entries = vertices.size();
 		assert(header.get_num_vertices() + 1 == vertices.size());
+		assert(degrees.size() * sizeof(vsize_t) == get_degree_size(header));
 		FILE *f = fopen(file.c_str(), "w");
 		if (f == NULL)
 			ABORT_MSG(boost::format("fail to open %1%: %2%")
@@ -177,10 +204,23 @@ public:
 		BOOST_VERIFY(fwrite(&index, vertex_index::get_header_size(), 1, f));
 		BOOST_VERIFY(fwrite(vertices.data(),
 					vertices.size() * sizeof(vertices[0]), 1, f));
+		if (!degrees.empty())
+			BOOST_VERIFY(fwrite(degrees.data(),
+						degrees.size() * sizeof(degrees[0]), 1, f));
 
 		fclose(f);
 	}
 
+	/*
+	 * Write the header of the index, so the caller can write the index
+	 * entries behind it without keeping them in memory.
+	 */
+	static void dump_header(FILE *f, const graph_header &header) {
+		vertex_index_temp<vertex_entry_type> index(header);
+		index.h.data.num_entries = header.get_num_vertices() + 1;
+		BOOST_VERIFY(fwrite(&index, vertex_index::get_header_size(), 1, f));
+	}
+
 	const vertex_entry_type &get_vertex(vertex_id_t id) const {
 		assert(id < h.data.num_entries);
 		return vertices[id];
@@ -194,9 +234,15 @@ public:
 		return vertices;
 	}
 
+	const vsize_t *get_degrees() const {
+		assert(get_graph_header().has_compressed_edges());
+		return (const vsize_t *) (vertices + h.data.num_entries);
+	}
+
 	size_t cal_index_size() const {
 		return sizeof(vertex_index)
-			+ h.data.num_entries * h.data.entry_size;
+			+ h.data.num_entries * h.data.entry_size
+			+ get_degree_size(get_graph_header());
 	}
 
 	bool verify() const {
@@ -268,6 +314,13 @@ public:
 		off_t off = get_vertex(id).get_off();
 		return ext_mem_vertex_info(id, off, next_off - off);
 	}
+
+	/*
+	 * This only works for a graph with compressed edge lists.
+	 */
+	vsize_t get_num_edges(vertex_id_t id) const {
+		return get_degrees()[id];
+	}
 };
 
 class directed_vertex_entry
@@ -326,25 +379,36 @@ public:
 		return ret;
 	}
 
+	/*
+	 * `degrees' is only required by a graph with compressed edge lists.
+	 */
 	static vertex_index::ptr create(const graph_header &header,
-			const std::vector<directed_vertex_entry> &vertices) {
+			const std::vector<directed_vertex_entry> &vertices,
+			const std::vector<vsize_t> &degrees = std::vector<vsize_t>()) {
+		size_t entry_size = vertices.size() * sizeof(vertices[0]);
+		assert(degrees.size() * sizeof(vsize_t) == get_degree_size(header));
 		char *buf = (char *) malloc(vertex_index::get_header_size()
-				+ vertices.size() * sizeof(vertices[0]));
+				+ entry_size + get_degree_size(header));
 		directed_vertex_index *index = new (buf) directed_vertex_index(header);
 		index->h.data.num_entries = vertices.size();
 		index->h.data.out_part_loc = vertices.front().get_out_off();
 		assert(header.get_num_vertices() + 1 == vertices.size());
 		memcpy(buf + vertex_index::get_header_size(), vertices.data(),
-				vertices.size() * sizeof(vertices[0]));
+				entry_size);
+		if (!degrees.empty())
+			memcpy(buf + vertex_index::get_header_size() + entry_size,
+					degrees.data(), get_degree_size(header));
 		return vertex_index::ptr(index, destroy_index());
 	}
 
 	static void dump(const std::string &file, const graph_header &header,
-			const std::vector<directed_vertex_entry> &vertices) {
+			const std::vector<directed_vertex_entry> &vertices,
+			const std::vector<vsize_t> &degrees = std::vector<vsize_t>()) {
 		directed_vertex_index index(header);
 		index.h.data.num_entries = vertices.size();
 		index.h.data.out_part_loc = vertices.front().get_out_off();
 		assert(header.get_num_vertices() + 1 == vertices.size());
+		assert(degrees.size() * sizeof(vsize_t) == get_degree_size(header));
 		FILE *f = fopen(file.c_str(), "w");
 		if (f == NULL)
 			ABORT_MSG(boost::format("fail to open %1%: %2%")
@@ -353,10 +417,24 @@ public:
 		BOOST_VERIFY(fwrite(&index, vertex_index::get_header_size(), 1, f));
 		BOOST_VERIFY(fwrite(vertices.data(),
 					vertices.size() * sizeof(vertices[0]), 1, f));
+		if (!degrees.empty())
+			BOOST_VERIFY(fwrite(degrees.data(),
+						degrees.size() * sizeof(degrees[0]), 1, f));
 
 		fclose(f);
 	}
 
+	/*
+	 * `out_part_loc' is the location of the out-part of the first vertex.
+	 */
+	static void dump_header(FILE *f, const graph_header &header,
+			off_t out_part_loc) {
+		directed_vertex_index index(header);
+		index.h.data.num_entries = header.get_num_vertices() + 1;
+		index.h.data.out_part_loc = out_part_loc;
+		BOOST_VERIFY(fwrite(&index, vertex_index::get_header_size(), 1, f));
+	}
+
 	bool verify() const {
 		if (!vertex_index_temp<directed_vertex_entry>::verify())
 			return false;
@@ -385,6 +463,18 @@ public:
 		off_t off = get_vertex(id).get_out_off();
 		return ext_mem_vertex_info(id, off, next_off - off);
 	}
+
+	/*
+	 * These only work for a graph with compressed edge lists.
+	 */
+
+	vsize_t get_num_in_edges(vertex_id_t id) const {
+		return get_degrees()[id];
+	}
+
+	vsize_t get_num_out_edges(vertex_id_t id) const {
+		return get_degrees()[get_num_vertices() + id];
+	}
 };
 
 /*
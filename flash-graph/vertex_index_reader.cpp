@@ -113,6 +113,10 @@ public:
 	size_t get_num_pending_tasks() const {
 		return req_vertex_store->get_num_pending_tasks();
 	}
+
+	virtual io_interface::ptr get_io() const {
+		return io;
+	}
 };
 
 /*
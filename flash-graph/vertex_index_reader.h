@@ -385,6 +385,13 @@ public:
 	virtual void request_index(index_compute *compute) = 0;
 	virtual void wait4complete(int num) = 0;
 	virtual size_t get_num_pending_tasks() const = 0;
+	/*
+	 * The I/O instance used to read the vertex index from SSDs.
+	 * It's NULL if the index is in memory.
+	 */
+	virtual std::shared_ptr<safs::io_interface> get_io() const {
+		return std::shared_ptr<safs::io_interface>();
+	}
 };
 
 /*
@@ -1259,6 +1266,10 @@ public:
 	size_t get_num_pending_tasks() const {
 		return index_reader->get_num_pending_tasks();
 	}
+
+	std::shared_ptr<safs::io_interface> get_io() const {
+		return index_reader->get_io();
+	}
 };
 
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <boost/format.hpp>
+
+#include "graph_exception.h"
+#include "vertex_permutation.h"
+
+namespace fg
+{
+
+namespace
+{
+
+const int64_t PERM_MAGIC_NUMBER = 0x7065726d75746531L;
+
+/*
+ * The header of a permutation file. It's followed by the original ID of
+ * each new vertex ID.
+ */
+struct perm_header
+{
+	int64_t magic_number;
+	uint32_t vertex_id_size;
+	uint32_t unused;
+	uint64_t num_vertices;
+};
+
+}
+
+vertex_permutation::vertex_permutation(std::vector<vertex_id_t> &new2orig)
+{
+	this->new2orig.swap(new2orig);
+	orig2new.resize(this->new2orig.size(), INVALID_VERTEX_ID);
+	for (size_t i = 0; i < this->new2orig.size(); i++) {
+		vertex_id_t orig_id = this->new2orig[i];
+		if (orig_id >= orig2new.size() || orig2new[orig_id] != INVALID_VERTEX_ID)
+			throw wrong_format("the vertex IDs aren't a permutation");
+		orig2new[orig_id] = i;
+	}
+}
+
+vertex_permutation::ptr vertex_permutation::load(const std::string &file)
+{
+	FILE *f = fopen(file.c_str(), "r");
+	if (f == NULL)
+		throw wrong_format(boost::str(boost::format("can't open %1%")
+					% file));
+	perm_header header;
+	if (fread(&header, sizeof(header), 1, f) != 1
+			|| header.magic_number != PERM_MAGIC_NUMBER) {
+		fclose(f);
+		throw wrong_format(boost::str(boost::format(
+						"%1% isn't a permutation file") % file));
+	}
+	if (header.vertex_id_size != sizeof(vertex_id_t)) {
+		fclose(f);
+		throw wrong_format(
+				"the permutation uses vertex IDs of a different size");
+	}
+	std::vector<vertex_id_t> new2orig(header.num_vertices);
+	size_t ret = fread(new2orig.data(), sizeof(vertex_id_t),
+			new2orig.size(), f);
+	fclose(f);
+	if (ret != new2orig.size())
+		throw wrong_format(boost::str(boost::format(
+						"%1% is truncated") % file));
+	return create(new2orig);
+}
+
+void vertex_permutation::dump(const std::string &file) const
+{
+	perm_header header;
+	header.magic_number = PERM_MAGIC_NUMBER;
+	header.vertex_id_size = sizeof(vertex_id_t);
+	header.unused = 0;
+	header.num_vertices = new2orig.size();
+	FILE *f = fopen(file.c_str(), "w");
+	if (f == NULL)
+		ABORT_MSG(boost::format("fail to open %1%: %2%")
+				% file % strerror(errno));
+	BOOST_VERIFY(fwrite(&header, sizeof(header), 1, f) == 1);
+	BOOST_VERIFY(fwrite(new2orig.data(), sizeof(vertex_id_t), new2orig.size(),
+				f) == new2orig.size());
+	fclose(f);
+}
+
+FG_vector<vertex_id_t>::ptr vertex_permutation::ids_to_orig(
+		FG_vector<vertex_id_t>::ptr vec) const
+{
+	assert(vec->get_size() == new2orig.size());
+	FG_vector<vertex_id_t>::ptr ret = FG_vector<vertex_id_t>::create(
+			vec->get_size());
+#pragma omp parallel for
+	for (size_t i = 0; i < new2orig.size(); i++) {
+		vertex_id_t id = vec->get(i);
+		// Some algorithms use an invalid vertex ID for unreached vertices.
+		if (id < new2orig.size())
+			id = new2orig[id];
+		ret->set(new2orig[i], id);
+	}
+	return ret;
+}
+
+}
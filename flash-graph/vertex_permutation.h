@@ -0,0 +1,109 @@
+#ifndef __VERTEX_PERMUTATION_H__
+#define __VERTEX_PERMUTATION_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FG_basic_types.h"
+#include "FG_vector.h"
+
+namespace fg
+{
+
+/**
+ * \brief The mapping between the vertex IDs of a relabeled graph and
+ *        the vertex IDs of the original graph.
+ *
+ * A graph is relabeled by `relabel-graph', which stores the permutation
+ * in a file next to the new graph. The results that an algorithm computes
+ * on the relabeled graph are indexed by the new vertex IDs, and they are
+ * mapped back to the original vertex IDs with the permutation.
+ */
+class vertex_permutation
+{
+	// The original ID of each new vertex ID.
+	std::vector<vertex_id_t> new2orig;
+	// The new ID of each original vertex ID.
+	std::vector<vertex_id_t> orig2new;
+
+	vertex_permutation(std::vector<vertex_id_t> &new2orig);
+public:
+	typedef std::shared_ptr<vertex_permutation> ptr;
+
+	/**
+	 * \brief Create a permutation.
+	 * \param new2orig The original ID of each new vertex ID. Its content
+	 *        is moved to the permutation.
+	 */
+	static ptr create(std::vector<vertex_id_t> &new2orig) {
+		return ptr(new vertex_permutation(new2orig));
+	}
+
+	/**
+	 * \brief Load a permutation from a file in the Linux filesystem.
+	 */
+	static ptr load(const std::string &file);
+
+	/**
+	 * \brief Write the permutation to a file in the Linux filesystem.
+	 */
+	void dump(const std::string &file) const;
+
+	size_t get_num_vertices() const {
+		return new2orig.size();
+	}
+
+	vertex_id_t get_new_id(vertex_id_t orig_id) const {
+		return orig2new[orig_id];
+	}
+
+	vertex_id_t get_orig_id(vertex_id_t new_id) const {
+		return new2orig[new_id];
+	}
+
+	/**
+	 * \brief Reorder a vector computed on the relabeled graph, so it's
+	 *        indexed by the original vertex IDs.
+	 */
+	template<class T>
+	typename FG_vector<T>::ptr to_orig(typename FG_vector<T>::ptr vec) const {
+		assert(vec->get_size() == new2orig.size());
+		typename FG_vector<T>::ptr ret = FG_vector<T>::create(vec->get_size());
+#pragma omp parallel for
+		for (size_t i = 0; i < new2orig.size(); i++)
+			ret->set(new2orig[i], vec->get(i));
+		return ret;
+	}
+
+	/**
+	 * \brief Reorder a vector whose values are also vertex IDs, such as
+	 *        the component IDs of WCC, and map its values to
+	 *        the original vertex IDs as well.
+	 */
+	FG_vector<vertex_id_t>::ptr ids_to_orig(
+			FG_vector<vertex_id_t>::ptr vec) const;
+};
+
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include "messaging.h"
 #include "worker_thread.h"
 #include "message_processor.h"
+#include "graph_config.h"
 
 namespace fg
 {
@@ -46,6 +47,14 @@ void vertex_program::init(graph_engine *graph, worker_thread *t)
 	this->t = t;
 	this->graph = graph;
 	part_id = t->get_worker_id();
+	delta = graph->get_delta_store().get();
+}
+
+void vertex_program::run_on_merged_vertex(compute_vertex &comp_v,
+		const page_vertex &vertex)
+{
+	delta->run_on_vertex(*this, comp_v, vertex, graph->get_delta_base(),
+			graph->get_delta_snapshot());
 }
 
 void vertex_program::init_messaging(const std::vector<worker_thread *> &threads,
@@ -72,6 +81,18 @@ void vertex_program::init_messaging(const std::vector<worker_thread *> &threads,
 		activate_sender->init(msg);
 		activate_senders.push_back(activate_sender);
 	}
+	// The combiner may be set before the senders are created.
+	for (size_t i = 0; i < msg_senders.size(); i++)
+		msg_senders[i]->set_combiner(combiner.get());
+}
+
+void vertex_program::set_message_combiner(message_combiner::ptr combiner)
+{
+	if (!graph_conf.use_msg_combiner())
+		return;
+	this->combiner = combiner;
+	for (size_t i = 0; i < msg_senders.size(); i++)
+		msg_senders[i]->set_combiner(combiner.get());
 }
 
 void vertex_program::multicast_msg(vertex_id_t ids[], int num,
@@ -95,6 +116,8 @@ void vertex_program::multicast_msg(vertex_id_t ids[], int num,
 		if (vid_bufs[i].empty())
 			continue;
 
+		if (i != t->get_worker_id())
+			num_remote_msgs += vid_bufs[i].size();
 		multicast_msg_sender &sender = get_multicast_sender(i);
 		sender.init(msg);
 		BOOST_VERIFY((size_t) sender.add_dests(vid_bufs[i].data(),
@@ -126,6 +149,8 @@ void vertex_program::multicast_msg(edge_seq_iterator &it, vertex_message &msg)
 		if (vid_bufs[i].empty())
 			continue;
 
+		if (i != t->get_worker_id())
+			num_remote_msgs += vid_bufs[i].size();
 		multicast_msg_sender &sender = get_multicast_sender(i);
 		sender.init(msg);
 		BOOST_VERIFY((size_t) sender.add_dests(vid_bufs[i].data(),
@@ -145,6 +170,8 @@ void vertex_program::send_msg(vertex_id_t dest, vertex_message &msg)
 	off_t local_id;
 	graph->get_partitioner()->map2loc(dest, part_id, local_id);
 	msg.set_dest(local_vid_t(local_id));
+	if (part_id != t->get_worker_id())
+		num_remote_msgs++;
 	if (msg.is_flush()) {
 		// Let's flush all messages sent by the thread before sending
 		// the flush message.
@@ -156,6 +183,10 @@ void vertex_program::send_msg(vertex_id_t dest, vertex_message &msg)
 		sender.send_cached(msg);
 		sender.flush();
 	}
+	else if (combiner) {
+		simple_msg_sender &sender = get_msg_sender(part_id);
+		sender.send_combined(msg);
+	}
 	else {
 		simple_msg_sender &sender = get_msg_sender(part_id);
 		sender.send_cached(msg);
@@ -178,6 +209,8 @@ void vertex_program::activate_vertices(vertex_id_t ids[], int num)
 			// the ID of the vertex.
 			off_t local_id;
 			graph->get_partitioner()->map2loc(ids[i], part_id, local_id);
+			if (part_id != t->get_worker_id())
+				num_remote_msgs++;
 			multicast_msg_sender &sender = get_activate_sender(part_id);
 			BOOST_VERIFY(sender.add_dest((local_vid_t) local_id));
 		}
@@ -190,6 +223,8 @@ void vertex_program::activate_vertices(vertex_id_t ids[], int num)
 		multicast_msg_sender &sender = get_activate_sender(i);
 		if (vid_bufs[i].empty())
 			continue;
+		if (i != t->get_worker_id())
+			num_remote_msgs += vid_bufs[i].size();
 		int ret = sender.add_dests(vid_bufs[i].data(), vid_bufs[i].size());
 		BOOST_VERIFY((size_t) ret == vid_bufs[i].size());
 		vid_bufs[i].clear();
@@ -220,6 +255,7 @@ void vertex_program::activate_vertices(edge_seq_iterator &it)
 				local_vid_t local_id = vertex_locs[i].second;
 				multicast_msg_sender &sender = get_activate_sender(part_id);
 				BOOST_VERIFY(sender.add_dest(local_id));
+				num_remote_msgs++;
 			}
 		}
 		return;
@@ -236,6 +272,7 @@ void vertex_program::activate_vertices(edge_seq_iterator &it)
 			vid_bufs[i].clear();
 		}
 		else {
+			num_remote_msgs += vid_bufs[i].size();
 			int ret = sender.add_dests(vid_bufs[i].data(), vid_bufs[i].size());
 			BOOST_VERIFY((size_t) ret == vid_bufs[i].size());
 			vid_bufs[i].clear();
@@ -250,6 +287,11 @@ void vertex_program::flush_msgs()
 	for (size_t i = 0; i < multicast_senders.size(); i++)
 		multicast_senders[i]->flush();
 	for (size_t i = 0; i < activate_senders.size(); i++) {
+		// The activation message is always initialized. We don't send it
+		// if it doesn't activate any vertices, so that a thread isn't woken
+		// up by an empty message in the async mode.
+		if (activate_senders[i]->get_num_dests() == 0)
+			continue;
 		activate_senders[i]->flush();
 		activation_message msg;
 		activate_senders[i]->init(msg);
@@ -262,7 +304,7 @@ void vertex_program::request_notify_iter_end(const compute_vertex &v)
 			t->get_worker_id(), v);
 	// TODO this shouldn't be right. We should allow a vertex to request
 	// the notification of iteration end at any thread.
-	assert(local_id.id != INVALID_VERTEX_ID);
+	assert(local_id.is_valid());
 	t->request_notify_iter_end(local_id);
 }
 
@@ -282,6 +324,20 @@ vertex_id_t vertex_program::get_vertex_id(const compute_vertex &v) const
 	return id;
 }
 
+vertex_loc_t vertex_program::get_vertex_loc(const compute_vertex &v) const
+{
+	local_vid_t id = graph->get_graph_index().get_local_id(t->get_worker_id(), v);
+	if (id.is_valid())
+		return vertex_loc_t(t->get_worker_id(), id);
+
+	// The vertex is stolen from another thread.
+	int part_id = t->get_stolen_vertex_part(v);
+	assert(part_id >= 0);
+	id = graph->get_graph_index().get_local_id(part_id, v);
+	assert(id.is_valid());
+	return vertex_loc_t(part_id, id);
+}
+
 vertex_id_t vertex_program::get_vertex_id(compute_vertex_pointer v) const
 {
 	// The current thread is usually the owner thread of the compute vertex.
@@ -26,6 +26,7 @@
 #include "vertex.h"
 #include "messaging.h"
 #include "vertex_pointer.h"
+#include "graph_delta.h"
 
 namespace fg
 {
@@ -59,6 +60,14 @@ class vertex_program
 	std::vector<simple_msg_sender *> flush_msg_senders;
 	std::vector<multicast_msg_sender *> multicast_senders;
 	std::vector<multicast_msg_sender *> activate_senders;
+	// The combiner merges the point-to-point messages sent to the same
+	// vertex.
+	message_combiner::ptr combiner;
+	// The updates made to the graph after its image was created.
+	const graph_delta *delta;
+	// The number of messages and activations sent to the vertices
+	// in other partitions.
+	size_t num_remote_msgs;
     
 	multicast_msg_sender &get_activate_sender(int thread_id) const {
 		return *activate_senders[thread_id];
@@ -82,6 +91,8 @@ public:
 		part_id = 0;
 		t = NULL;
 		graph = NULL;
+		delta = NULL;
+		num_remote_msgs = 0;
 	}
     
     /** \brief Destructor */
@@ -119,6 +130,35 @@ public:
 	 */
 	virtual void run(compute_vertex &comp_v, const page_vertex &vertex) = 0;
 
+	/**
+	 * \internal
+	 * \brief Whether the vertex may have updates in the delta store of
+	 *        the graph.
+	 */
+	bool has_delta(vertex_id_t id) const {
+		return delta && delta->has_delta(id);
+	}
+
+	/**
+	 * \internal
+	 * \brief The graph engine calls this when the adjacency list of a vertex
+	 *        is read. The updates to the vertex in the delta store of
+	 *        the graph are applied before user's code gets the vertex.
+	 *        A range of an edge list is located by the positions of
+	 *        the edges in the graph file, so it doesn't get the updates.
+	 *        A vertex with updates doesn't run on its part vertices, so
+	 *        the updates are applied once when it runs.
+	 */
+	void run_on_page_vertex(compute_vertex &comp_v, const page_vertex &vertex) {
+		if (has_delta(vertex.get_id()) && !(vertex.is_directed()
+					&& ((const page_directed_vertex &) vertex).is_partial_list()))
+			run_on_merged_vertex(comp_v, vertex);
+		else
+			run(comp_v, vertex);
+	}
+
+	void run_on_merged_vertex(compute_vertex &comp_v, const page_vertex &vertex);
+
 	/**
 	 * \brief Run user's code when the vertex receives messages from another.
      * \param c_vertex A `compute_vertex` that is executed in the method.
@@ -194,6 +234,27 @@ public:
      */
 	void send_msg(vertex_id_t dest, vertex_message &msg);
 
+	/**
+	 * \brief Set the combiner that merges the messages sent to the same
+	 * vertex in an iteration. The messages are merged before they are sent
+	 * to other threads and before they are delivered to vertices, so
+	 * a vertex may receive a single message that combines many messages.
+	 * The combiner is ignored if combiners are disabled in the graph
+	 * configuration. The vertex program must send only messages of
+	 * the combiner's type with send_msg(), because the messages of two
+	 * types of the same size would be merged with each other.
+	 *  \param combiner The message combiner.
+	 */
+	void set_message_combiner(message_combiner::ptr combiner);
+
+	/**
+	 * \brief Get the message combiner of the vertex program.
+	 * \return The message combiner or NULL if there isn't one.
+	 */
+	const message_combiner *get_message_combiner() const {
+		return combiner.get();
+	}
+
 	/**
 	 * \brief Activate vertices to be processed in the next level (iteration).
      *  \param ids The unique IDs of the vertices to be activated.
@@ -228,10 +289,27 @@ public:
 
 	vertex_id_t get_vertex_id(compute_vertex_pointer v) const;
 	vertex_id_t get_vertex_id(const compute_vertex &v) const;
+	/*
+	 * This gets the partition and the local ID of a vertex.
+	 * It works for the vertices stolen from other threads as well.
+	 */
+	vertex_loc_t get_vertex_loc(const compute_vertex &v) const;
 	vsize_t get_num_edges(vertex_id_t id) const;
 	int get_partition_id() const {
 		return part_id;
 	}
+
+	/**
+	 * \internal
+	 * \brief Get the number of messages and activations sent to
+	 * the vertices in other partitions since the last call and reset
+	 * the counter.
+	 */
+	size_t fetch_reset_num_remote_msgs() {
+		size_t ret = num_remote_msgs;
+		num_remote_msgs = 0;
+		return ret;
+	}
 };
 
 /**
@@ -20,6 +20,8 @@
  * limitations under the License.
  */
 
+#include <limits>
+
 #include "vertex.h"
 
 namespace fg
@@ -58,18 +60,53 @@ public:
 class directed_vertex_request: public vertex_request
 {
 	edge_type type;
+	// The range of edges requested in the edge list. By default,
+	// the entire edge list is requested.
+	vsize_t start;
+	vsize_t end;
 public:
 	directed_vertex_request() {
 		type = edge_type::NONE;
+		start = 0;
+		end = std::numeric_limits<vsize_t>::max();
 	}
 
 	directed_vertex_request(vertex_id_t id, edge_type type): vertex_request(id) {
 		this->type = type;
+		this->start = 0;
+		this->end = std::numeric_limits<vsize_t>::max();
+	}
+
+	/*
+	 * Request the edges in [start, end) of the in-edge or out-edge list.
+	 * Only the neighbors in the range are read from the graph file, so
+	 * the page vertex doesn't have the edge data. The range has to be
+	 * non-empty and in the edge list, and the edges can't be compressed.
+	 */
+	directed_vertex_request(vertex_id_t id, edge_type type, vsize_t start,
+			vsize_t end): vertex_request(id) {
+		assert(type == edge_type::IN_EDGE || type == edge_type::OUT_EDGE);
+		assert(start < end);
+		this->type = type;
+		this->start = start;
+		this->end = end;
 	}
 
 	edge_type get_type() const {
 		return type;
 	}
+
+	bool is_partial_list() const {
+		return start > 0 || end < std::numeric_limits<vsize_t>::max();
+	}
+
+	vsize_t get_start() const {
+		return start;
+	}
+
+	vsize_t get_end() const {
+		return end;
+	}
 };
 
 /**
@@ -0,0 +1,190 @@
+#ifndef __VERTEX_STATE_H__
+#define __VERTEX_STATE_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <numa.h>
+
+#include <memory>
+#include <vector>
+
+#include "vertex.h"
+#include "partitioner.h"
+#include "vertex_program.h"
+#include "graph_engine.h"
+
+namespace fg
+{
+
+/**
+ * \brief A column of vertex state.
+ *
+ * Instead of keeping all state of a vertex in its `compute_vertex' object,
+ * a graph algorithm can keep each field of the state in a separate column.
+ * A column has an array per graph partition, which is allocated on
+ * the NUMA node of the worker thread that owns the partition, and is
+ * indexed by the local IDs of vertices in the partition. An algorithm that
+ * touches one field in an iteration only brings that field to the CPU
+ * cache, and a column doesn't waste memory on padding.
+ *
+ * A `compute_vertex' with all its state in columns is an empty object.
+ * The state of vertically partitioned vertices isn't stored in columns.
+ * The element type has to be copied with memcpy. A column refers to
+ * the partitioner of the graph engine, so it can't outlive the engine.
+ */
+template<class T>
+class vertex_state
+{
+	struct column
+	{
+		T *arr;
+		size_t num;
+	};
+
+	std::vector<column> cols;
+	const graph_partitioner &partitioner;
+
+	vertex_state(const graph_partitioner &_partitioner, size_t num_vertices,
+			int num_nodes, const T &init): partitioner(_partitioner) {
+		cols.resize(partitioner.get_num_partitions());
+		for (size_t i = 0; i < cols.size(); i++) {
+			cols[i].num = partitioner.get_part_size(i, num_vertices);
+			cols[i].arr = NULL;
+			if (cols[i].num == 0)
+				continue;
+			// A graph partition is on the same NUMA node as the worker
+			// thread that owns it.
+			cols[i].arr = (T *) numa_alloc_onnode(sizeof(T) * cols[i].num,
+					i % num_nodes);
+			assert(cols[i].arr);
+			std::uninitialized_fill(cols[i].arr, cols[i].arr + cols[i].num,
+					init);
+		}
+	}
+public:
+	typedef std::shared_ptr<vertex_state<T> > ptr;
+
+	/**
+	 * \brief Create a column of vertex state for the graph processed by
+	 * a graph engine.
+	 * \param graph The graph engine.
+	 * \param init The initial value of all vertices.
+	 */
+	static ptr create(graph_engine &graph, const T &init = T()) {
+		return create(*graph.get_partitioner(), graph.get_num_vertices(),
+				graph.get_num_nodes(), init);
+	}
+
+	/**
+	 * \brief Create a column of vertex state for a partitioned graph.
+	 * \param partitioner The partitioner of the graph.
+	 * \param num_vertices The number of vertices in the graph.
+	 * \param num_nodes The number of NUMA nodes.
+	 * \param init The initial value of all vertices.
+	 */
+	static ptr create(const graph_partitioner &partitioner,
+			size_t num_vertices, int num_nodes, const T &init = T()) {
+		return ptr(new vertex_state<T>(partitioner, num_vertices, num_nodes,
+					init));
+	}
+
+	~vertex_state() {
+		for (size_t i = 0; i < cols.size(); i++) {
+			if (cols[i].arr)
+				numa_free(cols[i].arr, sizeof(T) * cols[i].num);
+		}
+	}
+
+	/**
+	 * \brief Set the state of all vertices to the same value.
+	 */
+	void assign(const T &val) {
+		for (size_t i = 0; i < cols.size(); i++)
+			std::fill(cols[i].arr, cols[i].arr + cols[i].num, val);
+	}
+
+	/**
+	 * \brief Get the state of a vertex with its location in a partition.
+	 */
+	T &get(int part_id, local_vid_t id) {
+		assert((size_t) part_id < cols.size() && id.id < cols[part_id].num);
+		return cols[part_id].arr[id.id];
+	}
+
+	/**
+	 * \brief Get the state of a vertex with its vertex ID.
+	 */
+	T &get(vertex_id_t id) {
+		int part_id;
+		off_t off;
+		partitioner.map2loc(id, part_id, off);
+		return get(part_id, local_vid_t(off));
+	}
+
+	/**
+	 * \brief Get the state of a vertex in the code of a vertex program.
+	 * \param prog The vertex program that runs the vertex.
+	 * \param v The vertex.
+	 */
+	T &get(const vertex_program &prog, const compute_vertex &v) {
+		vertex_loc_t loc = prog.get_vertex_loc(v);
+		return get(loc.first, loc.second);
+	}
+
+	/**
+	 * \brief Copy the state of all vertices to an array indexed by vertex ID.
+	 */
+	void copy_to(T *buf) const {
+		for (size_t i = 0; i < cols.size(); i++) {
+			for (size_t j = 0; j < cols[i].num; j++) {
+				vertex_id_t id;
+				partitioner.loc2map(i, j, id);
+				buf[id] = cols[i].arr[j];
+			}
+		}
+	}
+
+	/**
+	 * \brief Set the state of all vertices from an array indexed by vertex ID.
+	 */
+	void copy_from(const T *buf) {
+		for (size_t i = 0; i < cols.size(); i++) {
+			for (size_t j = 0; j < cols[i].num; j++) {
+				vertex_id_t id;
+				partitioner.loc2map(i, j, id);
+				cols[i].arr[j] = buf[id];
+			}
+		}
+	}
+
+	/**
+	 * \brief Get the number of bytes used by the column.
+	 */
+	size_t get_mem_size() const {
+		size_t size = 0;
+		for (size_t i = 0; i < cols.size(); i++)
+			size += sizeof(T) * cols[i].num;
+		return size;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef __WORK_DEQUE_H__
+#define __WORK_DEQUE_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashGraph.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <sched.h>
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+namespace fg
+{
+
+/*
+ * This is a work-stealing deque in the style of the Chase-Lev deque.
+ * Instead of single items, it contains chunks of a buffer of items.
+ * Only the owner thread refills the buffer and pops chunks from the bottom
+ * of the deque, which is the front of the buffer, so the owner processes
+ * items in the order of the buffer. Other threads steal chunks from the top
+ * of the deque, which is the end of the buffer.
+ *
+ * The owner can refill the buffer only when the deque is empty. A thief
+ * copies items out of the buffer after it wins a chunk, so the owner waits
+ * for all thieves to leave before it overwrites the buffer.
+ * The positions in the deque only increase, so a thief that sees an empty
+ * deque never touches the buffer.
+ */
+template<class T>
+class work_deque
+{
+	struct chunk
+	{
+		size_t start;
+		size_t size;
+	};
+
+	std::vector<T> buf;
+	std::vector<chunk> chunks;
+	std::atomic<long> top;
+	std::atomic<long> bottom;
+	// The number of thieves that may access the buffer.
+	std::atomic<int> num_thieves;
+
+	bool steal(chunk &c, size_t max_size) {
+		long t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return false;
+		c = chunks[t % chunks.size()];
+		if (c.size > max_size)
+			return false;
+		return top.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+public:
+	work_deque() {
+		top = 0;
+		bottom = 0;
+		num_thieves = 0;
+	}
+
+	/*
+	 * The number of chunks in the deque. The owner gets the exact number
+	 * and thieves get an estimate.
+	 */
+	size_t get_num_chunks() const {
+		long t = top.load(std::memory_order_relaxed);
+		long b = bottom.load(std::memory_order_relaxed);
+		return b > t ? b - t : 0;
+	}
+
+	bool is_empty() const {
+		return get_num_chunks() == 0;
+	}
+
+	/*
+	 * The owner replaces the buffer with `items' and splits it into chunks.
+	 * The items left in `items' are undefined.
+	 */
+	void refill(std::vector<T> &items, size_t chunk_size) {
+		assert(is_empty());
+		assert(chunk_size > 0);
+		while (num_thieves.load(std::memory_order_seq_cst) > 0)
+			sched_yield();
+		buf.swap(items);
+		size_t num_chunks = (buf.size() + chunk_size - 1) / chunk_size;
+		if (chunks.size() < num_chunks)
+			chunks.resize(num_chunks);
+		// Push the chunk at the end of the buffer first, so thieves take
+		// the items furthest from the ones the owner is processing.
+		long b = bottom.load(std::memory_order_relaxed);
+		for (size_t i = num_chunks; i > 0; i--) {
+			chunk c;
+			c.start = (i - 1) * chunk_size;
+			c.size = std::min(chunk_size, buf.size() - c.start);
+			chunks[b % chunks.size()] = c;
+			b++;
+		}
+		bottom.store(b, std::memory_order_release);
+	}
+
+	/*
+	 * The owner pops a chunk from the bottom of the deque.
+	 * The items stay valid until the next refill.
+	 */
+	bool pop(const T *&items, size_t &num) {
+		long b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		chunk c = chunks[b % chunks.size()];
+		// This is the last chunk. We race with thieves for it.
+		if (t == b) {
+			bool success = top.compare_exchange_strong(t, t + 1,
+					std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			if (!success)
+				return false;
+		}
+		items = buf.data() + c.start;
+		num = c.size;
+		return true;
+	}
+
+	/*
+	 * A thief steals up to half of the chunks in the deque and copies
+	 * the items to `items'. It returns the number of items stolen.
+	 */
+	size_t steal(T items[], size_t max_num) {
+		num_thieves.fetch_add(1, std::memory_order_seq_cst);
+		size_t num_stolen = 0;
+		size_t max_chunks = std::max(1UL, get_num_chunks() / 2);
+		chunk c;
+		for (size_t i = 0; i < max_chunks
+				&& steal(c, max_num - num_stolen); i++) {
+			memcpy(items + num_stolen, buf.data() + c.start,
+					sizeof(T) * c.size);
+			num_stolen += c.size;
+		}
+		num_thieves.fetch_sub(1, std::memory_order_seq_cst);
+		return num_stolen;
+	}
+};
+
+}
+
+#endif
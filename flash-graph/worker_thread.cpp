@@ -84,10 +84,11 @@ void active_vertex_set::fetch_reset_active_vertices(
  * This method split a list of vertices into a list of vertically
  * partitioned vertices and a list of unpartitioned vertices.
  * The input vertex list is sorted on vertex ID and will have
- * the unpartitioned vertices.
+ * the unpartitioned vertices. A vertex with vertical partitions stays
+ * unpartitioned in the iteration if it doesn't run on its part vertices.
  */
-static void split_vertices(const graph_index &index, int part_id,
-		std::vector<vertex_id_t> &vertices,
+static void split_vertices(vertex_program &prog, const graph_index &index,
+		int part_id, std::vector<vertex_id_t> &vertices,
 		std::vector<vpart_vertex_pointer> &vpart_ps)
 {
 	assert(std::is_sorted(vertices.begin(), vertices.end()));
@@ -101,9 +102,11 @@ static void split_vertices(const graph_index &index, int part_id,
 		vertex_id_t id = vertices[j];
 		if (p.get_vertex_id() == id) {
 			i++;
-			vertices[j] = INVALID_VERTEX_ID;
+			if (index.run_on_vparts(prog, id)) {
+				vertices[j] = INVALID_VERTEX_ID;
+				vpart_ps.push_back(p);
+			}
 			j++;
-			vpart_ps.push_back(p);
 		}
 		else if (p.get_vertex_id() > id) {
 			j++;
@@ -115,10 +118,28 @@ static void split_vertices(const graph_index &index, int part_id,
 	delete_val(vertices, INVALID_VERTEX_ID);
 }
 
+/*
+ * Split the vertices into chunks and put them in the deque.
+ * Chunks are small enough for other threads to share the vertices
+ * when they steal them, but not too small to make stealing expensive.
+ */
+void default_vertex_queue::refill(std::vector<compute_vertex_pointer> &vertices,
+		size_t min_chunk_size)
+{
+	size_t chunk_size = vertices.size()
+		/ (graph.get_num_threads() * CHUNKS_PER_THREAD);
+	chunk_size = max(chunk_size, min_chunk_size);
+	// A thread can't steal more vertices than it can process.
+	chunk_size = min(chunk_size,
+			max(1UL, (size_t) graph.get_max_processing_vertices() / 4));
+	curr_chunk = NULL;
+	curr_chunk_size = 0;
+	deque.refill(vertices, chunk_size);
+}
+
 void default_vertex_queue::init(const vertex_id_t buf[], size_t size, bool sorted)
 {
-	pthread_spin_lock(&lock);
-	vertex_buf.clear();
+	assert(deque.is_empty());
 	vpart_ps.clear();
 	active_vertices->clear();
 
@@ -127,25 +148,23 @@ void default_vertex_queue::init(const vertex_id_t buf[], size_t size, bool sorte
 	vertices.insert(vertices.end(), buf, buf + size);
 	if (!sorted)
 		std::sort(vertices.begin(), vertices.end());
-	split_vertices(index, part_id, vertices, vpart_ps);
+	worker_thread *t = (worker_thread *) thread::get_curr_thread();
+	split_vertices(t->get_vertex_program(false), index, part_id, vertices,
+			vpart_ps);
 
 	// The buffer contains the vertex Ids and we only store the location of
 	// vertices in the local partition.
-	vertex_buf.resize(vertices.size());
+	std::vector<compute_vertex_pointer> vertex_buf(vertices.size());
 	index.get_vertices(vertices.data(), vertices.size(),
 			compute_vertex_pointer::conv(vertex_buf.data()));
-
-	buf_fetch_idx = scan_pointer(vertex_buf.size(), true);
 	num_active = vertex_buf.size() + vpart_ps.size() * graph_conf.get_num_vparts();
-
-	pthread_spin_unlock(&lock);
-	curr_vpart = 0;
+	refill(vertex_buf);
+	fetching_vparts = false;
 }
 
 void default_vertex_queue::init(worker_thread &t)
 {
-	pthread_spin_lock(&lock);
-	vertex_buf.clear();
+	assert(deque.is_empty());
 	vpart_ps.clear();
 	assert(active_vertices->get_num_active_vertices() == 0);
 	// This process only happens in a single thread, so we can swap
@@ -168,7 +187,9 @@ void default_vertex_queue::init(worker_thread &t)
 			int part_id;
 			off_t off;
 			graph.get_partitioner()->map2loc(p.get_vertex_id(), part_id, off);
-			if (active_vertices->is_active(local_vid_t(off))) {
+			if (active_vertices->is_active(local_vid_t(off))
+					&& index.run_on_vparts(t.get_vertex_program(false),
+						p.get_vertex_id())) {
 				vpart_ps.push_back(p);
 				active_vertices->reset_active_vertex(local_vid_t(off));
 				num_active_vertices--;
@@ -183,85 +204,99 @@ void default_vertex_queue::init(worker_thread &t)
 	if (graph_conf.get_elevator_enabled())
 		forward = graph.get_curr_level() % 2;
 	active_vertices->set_dir(forward);
-	buf_fetch_idx = scan_pointer(0, true);
-	pthread_spin_unlock(&lock);
-	curr_vpart = 0;
+	curr_chunk = NULL;
+	curr_chunk_size = 0;
+	fetching_vparts = false;
 }
 
 void default_vertex_queue::fetch_from_map()
 {
-	assert(buf_fetch_idx.get_num_remaining() == 0);
-	vertex_buf.clear();
+	assert(deque.is_empty());
 	std::vector<local_vid_t> local_ids;
 	active_vertices->fetch_reset_active_vertices(VERTEX_BUF_SIZE, local_ids);
-	vertex_buf.resize(local_ids.size());
+	std::vector<compute_vertex_pointer> vertex_buf(local_ids.size());
 	index.get_vertices(part_id, local_ids.data(), local_ids.size(),
 			compute_vertex_pointer::conv(vertex_buf.data()));
 
 	bool forward = true;
 	if (graph_conf.get_elevator_enabled())
 		forward = graph.get_curr_level() % 2;
-	buf_fetch_idx = scan_pointer(vertex_buf.size(), forward);
+	// The owner thread processes the vertices in the deque from
+	// the beginning to the end.
+	if (!forward)
+		std::reverse(vertex_buf.begin(), vertex_buf.end());
+	refill(vertex_buf);
 }
 
+/*
+ * The part vertices of all activated vertices are put in the deque at once
+ * and a chunk may have a single part vertex, so other threads can steal
+ * the parts of a vertex and process its edges in parallel.
+ */
 void default_vertex_queue::fetch_vparts()
 {
-	if (curr_vpart >= graph_conf.get_num_vparts())
-		return;
-
-	assert(buf_fetch_idx.get_num_remaining() == 0);
-	vertex_buf.clear();
-	vertex_buf.resize(vpart_ps.size());
-	index.get_vpart_vertices(part_id, curr_vpart, vpart_ps.data(),
-			vpart_ps.size(), vertex_buf.data());
-	curr_vpart++;
+	assert(deque.is_empty());
+	size_t num_vparts = graph_conf.get_num_vparts();
+	std::vector<compute_vertex_pointer> vertex_buf(
+			vpart_ps.size() * num_vparts);
+	for (size_t i = 0; i < num_vparts; i++)
+		index.get_vpart_vertices(part_id, i, vpart_ps.data(),
+				vpart_ps.size(), vertex_buf.data() + i * vpart_ps.size());
+	vpart_ps.clear();
+	fetching_vparts = true;
 
 	// TODO Right now let's just scan the vertices in one direction.
-	buf_fetch_idx = scan_pointer(vertex_buf.size(), true);
+	refill(vertex_buf, 1);
 }
 
+/*
+ * This is only invoked by the owner thread.
+ */
 int default_vertex_queue::fetch(compute_vertex_pointer vertices[], int num)
 {
 	if (num_active == 0)
 		return 0;
 
 	int num_fetched = 0;
-	pthread_spin_lock(&lock);
-	if (buf_fetch_idx.get_num_remaining() > 0) {
-		int num_to_fetch = min(num, buf_fetch_idx.get_num_remaining());
-		size_t curr_loc = buf_fetch_idx.get_curr_loc();
-		size_t new_loc = buf_fetch_idx.move(num_to_fetch);
-		memcpy(vertices, vertex_buf.data() + min(curr_loc, new_loc),
+	while (num_fetched < num) {
+		if (curr_chunk_size == 0
+				&& !deque.pop(curr_chunk, curr_chunk_size)) {
+			// The deque is empty. We start with unpartitioned vertices
+			// first and then vertically partitioned vertices.
+			fetch_from_map();
+			if (deque.is_empty() && !vpart_ps.empty())
+				fetch_vparts();
+			if (!deque.pop(curr_chunk, curr_chunk_size))
+				break;
+		}
+		int num_to_fetch = min((size_t) (num - num_fetched), curr_chunk_size);
+		memcpy(vertices + num_fetched, curr_chunk,
 				num_to_fetch * sizeof(vertices[0]));
+		curr_chunk += num_to_fetch;
+		curr_chunk_size -= num_to_fetch;
 		num_fetched += num_to_fetch;
-	}
-	// We have fetched all we need.
-	assert(num == num_fetched
-			// the vertex buffer is empty.
-			|| buf_fetch_idx.get_num_remaining() == 0);
-	// If the vertex buffer is empty, let's get some from the bitmap.
-	if (buf_fetch_idx.get_num_remaining() == 0) {
-		// We start with unpartitioned vertices first and then
-		// vertically partitioned vertices.
-		fetch_from_map();
-		if (vertex_buf.empty() && !vpart_ps.empty())
-			fetch_vparts();
-	}
-	// If we still need some vertices.
-	if (buf_fetch_idx.get_num_remaining() > 0 && num_fetched < num) {
-		int fetch_again = min(num - num_fetched, buf_fetch_idx.get_num_remaining());
-		size_t curr_loc = buf_fetch_idx.get_curr_loc();
-		size_t new_loc = buf_fetch_idx.move(fetch_again);
-		memcpy(vertices + num_fetched,
-				vertex_buf.data() + min(curr_loc, new_loc),
-				fetch_again * sizeof(vertices[0]));
-		num_fetched += fetch_again;
+		// The owner thread takes one chunk of part vertices at a time,
+		// and leaves the other parts to idle threads.
+		if (fetching_vparts)
+			break;
 	}
 	num_active -= num_fetched;
-	pthread_spin_unlock(&lock);
 	return num_fetched;
 }
 
+/*
+ * This is invoked by other threads.
+ */
+int default_vertex_queue::steal(compute_vertex_pointer vertices[], int num)
+{
+	if (num_active == 0)
+		return 0;
+
+	int num_stolen = deque.steal(vertices, num);
+	num_active -= num_stolen;
+	return num_stolen;
+}
+
 void customized_vertex_queue::get_compute_vertex_pointers(
 		const std::vector<vertex_id_t> &vertices,
 		std::vector<vpart_vertex_pointer> &vpart_ps)
@@ -271,7 +306,8 @@ void customized_vertex_queue::get_compute_vertex_pointers(
 	// Get unpartitioned vertices.
 	index.get_vertices(vertices.data(), vertices.size(),
 			compute_vertex_pointer::conv(sorted_vertices.data()));
-	if (graph_conf.get_num_vparts() <= 1)
+	// A partition may not have any vertically partitioned vertices.
+	if (graph_conf.get_num_vparts() <= 1 || vpart_ps.empty())
 		return;
 	// Get vertically partitioned vertices.
 	for (int i = 0; i < graph_conf.get_num_vparts(); i++) {
@@ -297,7 +333,7 @@ void customized_vertex_queue::init(const vertex_id_t buf[],
 	if (!sorted)
 		std::sort(vertices.begin(), vertices.end());
 	if (graph_conf.get_num_vparts() > 1)
-		split_vertices(index, part_id, vertices, vpart_ps);
+		split_vertices(*vprog, index, part_id, vertices, vpart_ps);
 	get_compute_vertex_pointers(vertices, vpart_ps);
 
 	scheduler->schedule(*vprog, sorted_vertices);
@@ -313,6 +349,11 @@ void customized_vertex_queue::init(worker_thread &t)
 	pthread_spin_lock(&lock);
 	sorted_vertices.clear();
 	std::vector<local_vid_t> local_ids;
+	// A vertex activated multiple times can't be in the queue twice,
+	// or it may be stolen and returned twice. The scheduler orders
+	// the vertices, so we always scan the bitmap forward.
+	t.next_activated_vertices->finalize();
+	t.next_activated_vertices->set_dir(true);
 	t.next_activated_vertices->fetch_reset_active_vertices(local_ids);
 
 	// the bitmap only contains the locations of vertices in the bitmap.
@@ -326,7 +367,7 @@ void customized_vertex_queue::init(worker_thread &t)
 	std::vector<local_vid_t>().swap(local_ids);
 	std::vector<vpart_vertex_pointer> vpart_ps;
 	if (graph_conf.get_num_vparts() > 1)
-		split_vertices(index, part_id, vertices, vpart_ps);
+		split_vertices(*vprog, index, part_id, vertices, vpart_ps);
 	get_compute_vertex_pointers(vertices, vpart_ps);
 
 	scheduler->schedule(*vprog, sorted_vertices);
@@ -353,6 +394,8 @@ worker_thread::worker_thread(graph_engine *graph,
 	start_all = false;
 	this->worker_id = worker_id;
 	this->graph = graph;
+	tail_time = 0;
+	num_async_rounds = 0;
 	this->io = NULL;
 	this->graph_factory = graph_factory;
 	this->index_factory = index_factory;
@@ -436,6 +479,10 @@ void worker_thread::init()
 				graph->get_graph_header().get_graph_type() == graph_type::DIRECTED,
 				this);
 	}
+	std::vector<io_interface::ptr> ios(1, io);
+	if (index_reader->get_io())
+		ios.push_back(index_reader->get_io());
+	select = create_io_select(ios);
 
 	if (!started_vertices.empty()) {
 		assert(curr_activated_vertices->is_empty());
@@ -508,8 +555,9 @@ int worker_thread::process_activated_vertices(int max)
 
 	process_vertex_buf.resize(max);
 	int num = curr_activated_vertices->fetch(process_vertex_buf.data(), max);
+	// The queue may not look empty yet if other threads are stealing
+	// the last vertices from it.
 	if (num == 0) {
-		assert(curr_activated_vertices->is_empty());
 		num = balancer->steal_activated_vertices(process_vertex_buf.data(),
 				max);
 	}
@@ -563,27 +611,43 @@ size_t worker_thread::enter_next_level()
 	return curr_activated_vertices->get_num_vertices();
 }
 
+/*
+ * Process activated vertices, messages and I/O requests once.
+ */
+int worker_thread::process_one_step()
+{
+	balancer->process_completed_stolen_vertices();
+	int num = process_activated_vertices(
+			graph->get_max_processing_vertices()
+			- get_num_vertices_processing());
+	msg_processor->process_msgs();
+	index_reader->wait4complete(0);
+	io->access(adj_reqs.data(), adj_reqs.size());
+	adj_reqs.clear();
+	// We wait for the requests to the adjacency lists and the vertex
+	// index together, so the thread is woken up by whichever
+	// completes first.
+	int num_to_complete = min(io->num_pending_ios() / 10, 2);
+	if (io->num_pending_ios() == 0 && index_reader->get_num_pending_tasks() > 0)
+		num_to_complete = 1;
+	select->wait4complete(num_to_complete);
+	return num;
+}
+
 /**
  * This method is the main function of the graph engine.
  */
 void worker_thread::run()
 {
+	if (graph->is_async()) {
+		run_async();
+		return;
+	}
+
 	while (true) {
 		int num_visited = 0;
-		int num;
 		do {
-			balancer->process_completed_stolen_vertices();
-			num = process_activated_vertices(
-					graph->get_max_processing_vertices()
-					- get_num_vertices_processing());
-			num_visited += num;
-			msg_processor->process_msgs();
-			index_reader->wait4complete(0);
-			io->access(adj_reqs.data(), adj_reqs.size());
-			adj_reqs.clear();
-			if (io->num_pending_ios() == 0 && index_reader->get_num_pending_tasks() > 0)
-				index_reader->wait4complete(1);
-			io->wait4complete(min(io->num_pending_ios() / 10, 2));
+			num_visited += process_one_step();
 			// If there are vertices being processed, we need to call
 			// wait4complete to complete processing them.
 		} while (get_num_vertices_processing() > 0
@@ -619,11 +683,101 @@ void worker_thread::run()
 		// threads.
 		balancer->process_completed_stolen_vertices();
 		balancer->reset();
+		tail_time = balancer->end_level();
 
 		bool completed = graph->progress_next_level();
 		if (completed)
 			break;
 	}
+#ifdef STATISTICS
+	balancer->print_stat();
+#endif
+	stop();
+}
+
+/*
+ * In the async mode, a thread starts a new round with the vertices
+ * activated so far as soon as it finishes the vertices of the current
+ * round. It returns the number of vertices in the new round.
+ */
+size_t worker_thread::enter_next_round()
+{
+	msg_processor->process_msgs();
+
+	// The end of a round is the end of an iteration for the vertices
+	// that request the notification.
+	if (notify_vertices->get_num_set_bits() > 0) {
+		std::vector<vertex_id_t> vertex_buf;
+		notify_vertices->get_reset_set_bits(vertex_buf);
+		BOOST_FOREACH(vertex_id_t id, vertex_buf) {
+			local_vid_t local_id(id);
+			compute_vertex &v = graph->get_vertex(worker_id, local_id);
+			vprogram->notify_iteration_end(v);
+		}
+	}
+
+	// Remove the duplicated vertices before we count them.
+	next_activated_vertices->finalize();
+	size_t num = next_activated_vertices->get_num_active_vertices();
+	if (num == 0)
+		return 0;
+	// Other threads may steal the vertices once they are in the queue,
+	// so they have to be counted first.
+	graph->add_remaining_vertices(num);
+	curr_activated_vertices->init(*this);
+	// A vertically partitioned vertex is processed once in each partition.
+	size_t num_vertices = curr_activated_vertices->get_num_vertices();
+	if (num_vertices > num)
+		graph->add_remaining_vertices(num_vertices - num);
+	num_async_rounds++;
+	return num_vertices;
+}
+
+/*
+ * The main function of the graph engine in the async mode. There are no
+ * level barriers. A thread processes the vertices activated by messages
+ * in rounds, and steals vertices from other threads when it has none.
+ */
+void worker_thread::run_async()
+{
+	while (true) {
+		do {
+			process_one_step();
+		} while (get_num_vertices_processing() > 0
+				|| !curr_activated_vertices->is_empty());
+
+		vprogram->run_on_iteration_end();
+		vpart_vprogram->run_on_iteration_end();
+		// Other threads can only see the messages after they are flushed.
+		vprogram->flush_msgs();
+		vpart_vprogram->flush_msgs();
+		balancer->process_completed_stolen_vertices();
+
+		// A vertex activated again may still be processed by the thread
+		// that stole it. We can't start a new round until all stolen
+		// vertices are returned.
+		if (num_stolen_out.get() > 0)
+			continue;
+		if (enter_next_round() > 0)
+			continue;
+		// Help other threads with their vertices before becoming idle.
+		if (graph->get_num_remaining_vertices() > 0)
+			continue;
+		if (graph->wait4async_work())
+			break;
+	}
+	assert(index_reader->get_num_pending_tasks() == 0);
+	assert(io->num_pending_ios() == 0);
+	assert(active_computes.size() == 0);
+	assert(get_num_vertices_processing() == 0);
+	BOOST_LOG_TRIVIAL(info)
+		<< boost::format("worker %1% runs %2% rounds asynchronously")
+		% worker_id % num_async_rounds;
+	num_activated_vertices_in_level = atomic_number<long>(0);
+	num_completed_vertices_in_level = atomic_number<long>(0);
+#ifdef STATISTICS
+	balancer->print_stat();
+#endif
 	stop();
 }
 
@@ -634,22 +788,29 @@ int worker_thread::steal_activated_vertices(compute_vertex_pointer vertices[], i
 	// skip it.
 	if (curr_activated_vertices == NULL)
 		return 0;
-	// We want to steal as much as possible, but we don't want
-	// to overloaded by the stolen vertices.
-	size_t num_steal = std::max(1UL,
-			curr_activated_vertices->get_num_vertices() / graph->get_num_threads());
-	num = curr_activated_vertices->fetch(vertices,
-			std::min((size_t) num, num_steal));
-	if (num > 0)
+	// The owner thread in the async mode shouldn't see an empty queue
+	// before it sees the vertices being stolen.
+	num_stolen_out.inc(1);
+	num = curr_activated_vertices->steal(vertices, num);
+	if (num > 0) {
 		// If the thread steals vertices from another thread successfully,
 		// it needs to notify the thread of the stolen vertices.
 		msg_processor->steal_vertices(vertices, num);
+		// Only the main vertices are returned to the owner thread.
+		int num_main = 0;
+		for (int i = 0; i < num; i++)
+			if (!vertices[i].is_part())
+				num_main++;
+		num_stolen_out.inc(num_main);
+	}
+	num_stolen_out.dec(1);
 	return num;
 }
 
 void worker_thread::return_vertices(vertex_id_t ids[], int num)
 {
 	msg_processor->return_vertices(ids, num);
+	num_stolen_out.dec(num);
 }
 
 void worker_thread::complete_vertex(const compute_vertex_pointer v)
@@ -28,11 +28,13 @@
 #include "graph_engine.h"
 #include "bitmap.h"
 #include "scan_pointer.h"
+#include "work_deque.h"
 
 namespace safs
 {
 	class file_io_factory;
 	class io_interface;
+	class io_select;
 }
 
 namespace fg
@@ -167,6 +169,12 @@ public:
 	// This is the common case for iterations.
 	virtual void init(worker_thread &) = 0;
 	virtual int fetch(compute_vertex_pointer vertices[], int num) = 0;
+	/*
+	 * Other threads steal vertices from the queue with this method.
+	 */
+	virtual int steal(compute_vertex_pointer vertices[], int num) {
+		return fetch(vertices, num);
+	}
 	virtual bool is_empty() = 0;
 	virtual size_t get_num_vertices() = 0;
 
@@ -177,45 +185,55 @@ public:
 
 /*
  * This vertex queue is sorted based on the vertex ID.
+ * The owner thread fetches vertices from a work-stealing deque, so other
+ * threads can steal vertices from it without locking.
  */
 class default_vertex_queue: public active_vertex_queue
 {
 	static const size_t VERTEX_BUF_SIZE = 64 * 1024;
-	pthread_spinlock_t lock;
-	// It contains the offset of the vertex in the local partition
-	// instead of the real vertex Ids.
-	std::vector<compute_vertex_pointer> vertex_buf;
+	// The min number of vertices in a chunk of the deque.
+	static const size_t MIN_CHUNK_SIZE = 16;
+	// The number of chunks each thread should get if the vertices in
+	// the deque are evenly split among all threads.
+	static const size_t CHUNKS_PER_THREAD = 4;
+	// It contains the vertices in the local partition.
+	work_deque<compute_vertex_pointer> deque;
+	// The chunk of vertices the owner thread is fetching from.
+	const compute_vertex_pointer *curr_chunk;
+	size_t curr_chunk_size;
 	// Pointers to the vertically partitioned vertices that are activated
 	// in this iteration.
 	std::vector<vpart_vertex_pointer> vpart_ps;
-	int curr_vpart;
+	// Whether the owner thread is fetching the part vertices.
+	bool fetching_vparts;
 	std::unique_ptr<active_vertex_set> active_vertices;
-	// The fetch index in the vertex buffer.
-	scan_pointer buf_fetch_idx;
 	graph_engine &graph;
 	const graph_index &index;
 	std::atomic<size_t> num_active;
 	int part_id;
 
+	void refill(std::vector<compute_vertex_pointer> &vertices,
+			size_t min_chunk_size = MIN_CHUNK_SIZE);
 	void fetch_from_map();
 	void fetch_vparts();
 public:
 	default_vertex_queue(graph_engine &_graph, int part_id,
-			int node_id): buf_fetch_idx(0, true), graph(_graph), index(
-				_graph.get_graph_index()) {
-		pthread_spin_init(&lock, PTHREAD_PROCESS_PRIVATE);
+			int node_id): graph(_graph), index(_graph.get_graph_index()) {
 		num_active = 0;
 		this->part_id = part_id;
 		size_t num_local_vertices = _graph.get_partitioner()->get_part_size(
 				part_id, _graph.get_num_vertices());
 		this->active_vertices = std::unique_ptr<active_vertex_set>(
 				new active_vertex_set(num_local_vertices, node_id));
-		curr_vpart = 0;
+		fetching_vparts = false;
+		curr_chunk = NULL;
+		curr_chunk_size = 0;
 	}
 
 	virtual void init(const vertex_id_t buf[], size_t size, bool sorted);
 	virtual void init(worker_thread &);
 	virtual int fetch(compute_vertex_pointer vertices[], int num);
+	virtual int steal(compute_vertex_pointer vertices[], int num);
 
 	virtual bool is_empty() {
 		return num_active == 0;
@@ -293,6 +311,9 @@ class worker_thread: public thread
 	std::shared_ptr<safs::file_io_factory> graph_factory;
 	std::shared_ptr<safs::file_io_factory> index_factory;
 	std::shared_ptr<safs::io_interface> io;
+	// This waits for the I/O requests to the adjacency lists and
+	// the vertex index together.
+	std::shared_ptr<safs::io_select> select;
 	graph_engine *graph;
 	const graph_index &index;
 
@@ -353,6 +374,14 @@ class worker_thread: public thread
 	atomic_number<long> num_activated_vertices_in_level;
 	// The number of vertices completed in the current level.
 	atomic_number<long> num_completed_vertices_in_level;
+	// The time from when the thread runs out of its own activated vertices
+	// to the end of the last level.
+	double tail_time;
+	// The number of vertices of this thread that other threads have stolen
+	// but haven't returned.
+	atomic_integer num_stolen_out;
+	// The number of rounds the thread runs in the async mode.
+	size_t num_async_rounds;
 
 	/*
 	 * Get the number of vertices being processed in the current level.
@@ -362,6 +391,9 @@ class worker_thread: public thread
 			- num_completed_vertices_in_level.get();
 	}
 	int process_activated_vertices(int max);
+	int process_one_step();
+	void run_async();
+	size_t enter_next_round();
 public:
 	worker_thread(graph_engine *graph, std::shared_ptr<safs::file_io_factory> graph_factory,
 			std::shared_ptr<safs::file_io_factory> index_factory, vertex_program::ptr prog,
@@ -469,6 +501,10 @@ public:
 		adj_reqs.push_back(req);
 	}
 
+	double get_tail_time() const {
+		return tail_time;
+	}
+
 	size_t get_activates() const {
 		return curr_activated_vertices->get_num_vertices();
 	}
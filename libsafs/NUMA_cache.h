@@ -67,7 +67,19 @@ public:
 	}
 
 	virtual long size() {
-		return cache_conf->get_size();
+		long tot = 0;
+		for (size_t i = 0; i < caches.size(); i++)
+			tot += caches[i]->size();
+		return tot;
+	}
+
+	/*
+	 * The cache is resized evenly on all NUMA nodes.
+	 */
+	virtual long resize(long new_size) {
+		for (size_t i = 0; i < caches.size(); i++)
+			caches[i]->resize(new_size / caches.size());
+		return size();
 	}
 
 	// TODO shouldn't I use a different underlying IO for cache
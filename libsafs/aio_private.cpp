@@ -340,6 +340,8 @@ void async_io::return_cb(thread_callback_s *tcbs[], int num)
 	int num_remote = 0;
 
 	num_completed_reqs += num;
+	if (params.is_verify_checksum())
+		process_checksums(tcbs, num);
 	for (int i = 0; i < num; i++) {
 		thread_callback_s *tcb = tcbs[i];
 		if (tcb->req.get_io() == this)
@@ -368,6 +370,23 @@ void async_io::return_cb(thread_callback_s *tcbs[], int num)
 	}
 }
 
+void async_io::process_checksums(thread_callback_s *tcbs[], int num)
+{
+	for (int i = 0; i < num; i++) {
+		const io_request &req = tcbs[i]->req;
+		auto it = open_files.find(req.get_file_id());
+		if (it == open_files.end() || !it->second.is_valid())
+			continue;
+		buffered_io &io = it->second.get_io();
+		if (!io.has_checksums())
+			continue;
+		if (req.get_access_method() == READ)
+			io.verify_checksums(req);
+		else
+			io.update_checksums(req);
+	}
+}
+
 void async_io::notify_completion(io_request *reqs[], int num)
 {
 	if (this->cb) {
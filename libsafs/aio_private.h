@@ -90,6 +90,11 @@ class async_io: public io_interface
 	io_ref default_io;
 
 	struct iocb *construct_req(io_request &io_req, callback_t cb_func);
+	/*
+	 * Verify the data read by the completed requests and update
+	 * the checksums of the data written by them.
+	 */
+	void process_checksums(thread_callback_s *tcbs[], int num);
 public:
 	/**
 	 * @aio_depth_per_file
@@ -141,6 +146,13 @@ public:
 	int wait4complete(int num) {
 		return ctx->io_wait(NULL, num);
 	}
+	/*
+	 * Process the completed I/O without blocking.
+	 */
+	int poll4complete() {
+		struct timespec timeout = {0, 0};
+		return ctx->io_wait(&timeout, 0);
+	}
 	virtual int get_max_num_pending_ios() const {
 		return AIO_DEPTH;
 	}
@@ -19,6 +19,7 @@
 
 #include <errno.h>
 #include <limits.h>
+#include <sched.h>
 
 #include <algorithm>
 
@@ -94,9 +95,8 @@ void page_cell<T>::steal_pages(T pages[], int &npages)
 	int num_copied = 0;
 	for (int i = 0; i < CELL_SIZE && num_copied < npages; i++) {
 		if (buf[i].get_data()) {
-			// We have to make sure the page isn't being referenced.
-			// TODO busy wait.
-			while (buf[i].get_ref() > 0) {}
+			// The caller makes sure the page isn't being referenced.
+			assert(buf[i].get_ref() == 0);
 			pages[num_copied++] = buf[i];
 			buf[i] = T();
 		}
@@ -112,7 +112,9 @@ void page_cell<T>::steal_pages(T pages[], int &npages)
 template<class T>
 void page_cell<T>::sanity_check() const
 {
-	assert(params.get_SA_min_cell_size() <= num_pages);
+	// A cell may have fewer pages than the minimal cell size
+	// after the cache shrinks.
+	assert(num_pages > 0);
 	int num_used_pages = 0;
 	for (int i = 0; i < CELL_SIZE; i++)
 		if (buf[i].get_data())
@@ -169,7 +171,7 @@ void hash_cell::add_pages(char *pages[], int num)
 
 int hash_cell::add_pages_to_min(char *pages[], int num)
 {
-	int num_required = CELL_MIN_NUM_PAGES - buf.get_num_pages();
+	int num_required = params.get_SA_min_cell_size() - buf.get_num_pages();
 	if (num_required > 0) {
 		num_required = min(num_required, num);
 		buf.add_pages(pages, num_required, table->get_node_id());
@@ -179,20 +181,32 @@ int hash_cell::add_pages_to_min(char *pages[], int num)
 		return 0;
 }
 
-void hash_cell::merge(hash_cell *cell)
+bool hash_cell::merge(hash_cell *cell)
 {
 	pthread_spin_lock(&_lock);
 	pthread_spin_lock(&cell->_lock);
 
 	assert(cell->get_num_pages() + this->get_num_pages() <= CELL_SIZE);
-	thread_safe_page pages[CELL_SIZE];
-	int npages = CELL_SIZE;
-	// TODO there may be busy wait in this method.
-	cell->buf.steal_pages(pages, npages);
-	buf.inject_pages(pages, npages);
+	// The pages in the other cell are copied to this cell, so nobody can
+	// use them. A page can only get a new reference under the cell lock,
+	// so they stay unused until we release the lock.
+	bool can_merge = true;
+	for (unsigned i = 0; i < cell->buf.get_num_pages() && can_merge; i++) {
+		thread_safe_page *pg = cell->buf.get_page(i);
+		if (pg->get_ref() > 0 || pg->is_dirty() || pg->is_old_dirty()
+				|| pg->is_io_pending() || pg->is_prepare_writeback())
+			can_merge = false;
+	}
+	if (can_merge) {
+		thread_safe_page pages[CELL_SIZE];
+		int npages = CELL_SIZE;
+		cell->buf.steal_pages(pages, npages);
+		buf.inject_pages(pages, npages);
+	}
 
 	pthread_spin_unlock(&cell->_lock);
 	pthread_spin_unlock(&_lock);
+	return can_merge;
 }
 
 /**
@@ -297,6 +311,41 @@ void hash_cell::steal_pages(char *pages[], int &npages)
 	npages = num_stolen;
 }
 
+int hash_cell::release_pages(char *pages[], int num, int min_npages)
+{
+	pthread_spin_lock(&_lock);
+	thread_safe_page *released[CELL_SIZE];
+	int num_released = 0;
+	int max_release = std::min(num, (int) buf.get_num_pages() - min_npages);
+	// We remove the pages without data first, and then the pages
+	// with fewer hits.
+	std::vector<std::pair<int, thread_safe_page *> > candidates;
+	for (unsigned int i = 0; i < buf.get_num_pages() && max_release > 0; i++) {
+		thread_safe_page *pg = buf.get_page(i);
+		// We can only remove pages that nobody is using and whose data
+		// doesn't need to be written back.
+		if (pg->get_ref() > 0 || pg->is_dirty() || pg->is_old_dirty()
+				|| pg->is_io_pending() || pg->is_prepare_writeback())
+			continue;
+		int score = pg->initialized() ? pg->get_hits() + 1 : 0;
+		candidates.push_back(std::pair<int, thread_safe_page *>(score, pg));
+	}
+	std::sort(candidates.begin(), candidates.end());
+	for (size_t i = 0; i < candidates.size()
+			&& num_released < max_release; i++)
+		released[num_released++] = candidates[i].second;
+	// We can't steal pages while iterating them.
+	for (int i = 0; i < num_released; i++) {
+		pages[i] = (char *) released[i]->get_data();
+		buf.steal_page(released[i], false);
+		*released[i] = thread_safe_page();
+	}
+	if (num_released > 0)
+		buf.rebuild_map();
+	pthread_spin_unlock(&_lock);
+	return num_released;
+}
+
 void hash_cell::rebalance(hash_cell *cell)
 {
 	// TODO
@@ -415,6 +464,9 @@ void hash_cell::print_cell()
 /* this function has to be called with lock held */
 thread_safe_page *hash_cell::get_empty_page()
 {
+	// The cell may have been merged to another cell when the cache shrinks.
+	if (buf.get_num_pages() == 0)
+		return NULL;
 	thread_safe_page *ret = policy.evict_page(buf);
 	if (ret == NULL) {
 #ifdef DEBUG
@@ -707,80 +759,144 @@ associative_cache::~associative_cache()
 	memory_manager::destroy(manager);
 }
 
-bool associative_cache::shrink(int npages, char *pages[])
+/*
+ * Remove pages from the cells, but keep at least `min_npages' pages
+ * in each cell.
+ */
+int associative_cache::release_pages_in_cells(char *pages[], int npages,
+		int min_npages)
+{
+	int pg_idx = 0;
+	int ncells = get_num_cells();
+	for (int i = 0; i < ncells && pg_idx < npages; i++) {
+		hash_cell *cell = get_cell(i);
+		pg_idx += cell->release_pages(&pages[pg_idx], npages - pg_idx,
+				min_npages);
+	}
+	return pg_idx;
+}
+
+/*
+ * Merge the high cell to the low cell. The two cells together can't have
+ * more than CELL_SIZE pages, so we may have to remove pages from them first.
+ * The removed pages are returned to the memory manager.
+ * It fails if the high cell has pages that are referenced or dirty.
+ */
+bool associative_cache::merge_cells(hash_cell *cell, hash_cell *high_cell)
+{
+	int num_excess = cell->get_num_pages() + high_cell->get_num_pages()
+		- CELL_SIZE;
+	if (num_excess > 0) {
+		char *excess[CELL_SIZE];
+		int num = high_cell->release_pages(excess, num_excess, 0);
+		num += cell->release_pages(&excess[num], num_excess - num, 0);
+		manager->release_pages(num, excess);
+		cache_npages.dec(num);
+		num_released_pages += num;
+		// There are too many pages being used or dirty in the two cells.
+		if (num < num_excess)
+			return false;
+	}
+	// We don't wait for the pages in the high cell to be unused or
+	// written back. We give up and try to shrink the cache later.
+	return cell->merge(high_cell);
+}
+
+int associative_cache::shrink(int npages, char *pages[])
 {
 	if (flags.set_flag(TABLE_EXPANDING)) {
 		/*
 		 * if the flag has been set before,
 		 * it means another thread is expanding the table,
 		 */
-		return false;
+		return 0;
 	}
 
 	/* starting from this point, only one thred can be here. */
 
+	int min_cell_size = params.get_SA_min_cell_size();
 	int pg_idx = 0;
-	int orig_ncells = get_num_cells();
-	while (pg_idx < npages) {
-		// The cell table isn't in the stage of splitting.
+	bool shrink_over = false;
+	while (pg_idx < npages && !shrink_over) {
+		// The cell table isn't in the stage of splitting, so we first try
+		// to remove pages from the cells with more than the minimal number
+		// of pages.
 		if (split == 0) {
-			hash_cell *cell = get_cell(expand_cell_idx);
-			while (height >= params.get_SA_min_cell_size()) {
-				int num = max(0, cell->get_num_pages() - height);
-				num = min(npages - pg_idx, num);
-				if (num > 0) {
-					cell->steal_pages(&pages[pg_idx], num);
-					pg_idx += num;
-				}
-
-				if (expand_cell_idx <= 0) {
-					height--;
-					expand_cell_idx = orig_ncells;
-				}
-				expand_cell_idx--;
-				cell = get_cell(expand_cell_idx);
-			}
-			if (pg_idx == npages) {
-				cache_npages.dec(npages);
-				flags.clear_flag(TABLE_EXPANDING);
-				return true;
-			}
-		}
-
-		/* From here, we shrink the cell table. */
+			pg_idx += release_pages_in_cells(&pages[pg_idx], npages - pg_idx,
+					min_cell_size);
+			if (pg_idx == npages || level == 0)
+				break;
 
-		// When the thread is within in the while loop, other threads can
-		// hardly access the cells in the table.
-		if (level == 0)
-			break;
-		int num_half = (1 << level) * init_ncells / 2;
-		table_lock.write_lock();
-		if (split == 0) {
-			split = num_half - 1;
+			/* We have to shrink the cell table to remove more pages. */
+			table_lock.write_lock();
 			level--;
+			// All cells in the lower half are still split.
+			split = (1 << level) * init_ncells;
+			table_lock.write_unlock();
 		}
-		table_lock.write_unlock();
+
+		// We merge the cells in the upper half to the lower half one by one.
+		// We don't free the cells in the upper half because the dirty page
+		// flusher may still reference them. They are reused when the table
+		// expands again.
+		int num_half = (1 << level) * init_ncells;
 		while (split > 0) {
-			hash_cell *high_cell = get_cell(split + num_half);
-			hash_cell *cell = get_cell(split);
-			// At this point, the high cell and the low cell together
-			// should have no more than CELL_MIN_NUM_PAGES pages.
-			cell->merge(high_cell);
+			hash_cell *high_cell = get_cell(split - 1 + num_half);
+			hash_cell *cell = get_cell(split - 1);
+			if (!merge_cells(cell, high_cell)) {
+				shrink_over = true;
+				break;
+			}
 			table_lock.write_lock();
 			split--;
 			table_lock.write_unlock();
 		}
-		int orig_narrays = (1 << level);
-		// It's impossible to access the arrays after `narrays' now.
-		int narrays = orig_narrays / 2;
-		for (int i = narrays; i < orig_narrays; i++) {
-			hash_cell::destroy_array(cells_table[i], init_ncells);
-			cells_table[i] = NULL;
-		}
 	}
+	// If the cell table can't shrink any more, we have to keep fewer pages
+	// than the minimal cell size in each cell.
+	if (pg_idx < npages && level == 0 && split == 0) {
+		pg_idx += release_pages_in_cells(&pages[pg_idx], npages - pg_idx, 1);
+		height = 1;
+	}
+	else
+		height = min(height, min_cell_size);
+	expand_cell_idx = 0;
+	cache_npages.dec(pg_idx);
 	flags.clear_flag(TABLE_EXPANDING);
-	cache_npages.dec(npages);
-	return true;
+	return pg_idx;
+}
+
+long associative_cache::resize(long new_size)
+{
+	long curr_npages = cache_npages.get();
+	long new_npages = new_size / PAGE_SIZE;
+	num_resizes++;
+	// We resize the cache incrementally, so the cache can still serve
+	// requests from other threads.
+	const int max_npages_step = 4096;
+	if (new_npages > curr_npages) {
+		while (cache_npages.get() < new_npages) {
+			int npages = std::min((long) max_npages_step,
+					new_npages - cache_npages.get());
+			int ret = expand(npages);
+			if (ret == 0)
+				break;
+			num_grown_pages += ret;
+		}
+	}
+	else if (new_npages < curr_npages) {
+		std::vector<char *> pages(max_npages_step);
+		while (cache_npages.get() > new_npages) {
+			int npages = std::min((long) max_npages_step,
+					cache_npages.get() - new_npages);
+			int ret = shrink(npages, pages.data());
+			manager->release_pages(ret, pages.data());
+			num_released_pages += ret;
+			if (ret < npages)
+				break;
+		}
+	}
+	return size();
 }
 
 /**
@@ -844,9 +960,15 @@ next_cell:
 			/* create cells and put them in a temporary table. */
 			std::vector<hash_cell *> table;
 			int orig_narrays = (1 << level);
+			if ((size_t) orig_narrays * 2 > cells_table.size()) {
+				fprintf(stderr, "expand: the cell table can't be doubled\n");
+				break;
+			}
 			for (int i = orig_narrays; i < orig_narrays * 2; i++) {
-				hash_cell *cells = hash_cell::create_array(node_id, init_ncells);
-				printf("create %d cells: %p\n", init_ncells, cells);
+				// The cells may have been created before the table shrinks.
+				hash_cell *cells = cells_table[i];
+				if (cells == NULL)
+					cells = hash_cell::create_array(node_id, init_ncells);
 				for (int j = 0; j < init_ncells; j++) {
 					cells[j].init(this, i * init_ncells + j, false);
 				}
@@ -880,9 +1002,10 @@ next_cell:
 			 */
 
 			/* Add pages to the cell without enough pages. */
-			int num_required = max(expanded_cell->get_num_pages()
-				- params.get_SA_min_cell_size(), 0);
-			num_required += max(cell->get_num_pages() - params.get_SA_min_cell_size(), 0);
+			int num_required = max(params.get_SA_min_cell_size()
+					- expanded_cell->get_num_pages(), 0);
+			num_required += max(params.get_SA_min_cell_size()
+					- cell->get_num_pages(), 0);
 			if (num_required <= npages - pg_idx) {
 				/* 
 				 * Actually only one cell requires more pages, the other
@@ -896,8 +1019,12 @@ next_cell:
 
 			if (expanded_cell->get_num_pages() < params.get_SA_min_cell_size()
 					|| cell->get_num_pages() < params.get_SA_min_cell_size()) {
-				// If we failed to split a cell, we should merge the two half
-				cell->merge(expanded_cell);
+				// If we failed to split a cell, we should merge the two half.
+				// The pages in the expanded cell can't be found until
+				// they are merged back, so we have to wait for them to be
+				// unused and clean. We don't wait under the cell locks.
+				while (!cell->merge(expanded_cell))
+					sched_yield();
 				expand_over = true;
 				fprintf(stderr, "A cell can't have enough pages, merge back\n");
 				break;
@@ -917,8 +1044,8 @@ next_cell:
 	if (pg_idx < npages)
 		manager->free_pages(npages - pg_idx, &pages[pg_idx]);
 	flags.clear_flag(TABLE_EXPANDING);
-	cache_npages.inc(npages);
-	return npages - pg_idx;
+	cache_npages.inc(pg_idx);
+	return pg_idx;
 }
 
 page *associative_cache::search(const page_id_t &pg_id, page_id_t &old_id) {
@@ -989,6 +1116,9 @@ associative_cache::associative_cache(long cache_size, long max_cache_size,
 	height = params.get_SA_min_cell_size();
 	expand_cell_idx = 0;
 	this->expandable = expandable;
+	num_grown_pages = 0;
+	num_released_pages = 0;
+	num_resizes = 0;
 	this->manager = memory_manager::create(max_cache_size, node_id);
 	manager->register_cache(this);
 	long init_cache_size = default_init_cache_size;
@@ -1013,6 +1143,7 @@ associative_cache::associative_cache(long cache_size, long max_cache_size,
 				max_npages, npages);
 		exit(1);
 	}
+	cache_npages.inc(init_ncells * min_cell_size);
 
 	cells_table.push_back(cells);
 
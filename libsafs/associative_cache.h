@@ -305,13 +305,22 @@ public:
 	/**
 	 * Merge two cells and put all pages in the current cell.
 	 * The other cell will contain no pages.
+	 * It fails without waiting if any page in the other cell is referenced
+	 * or dirty.
+	 * \return true if the cells are merged.
 	 */
-	void merge(hash_cell *cell);
+	bool merge(hash_cell *cell);
 	/**
 	 * Steal pages from the cell, possibly the one to be evicted
 	 * by the eviction policy. The page can't be referenced and dirty.
 	 */
 	void steal_pages(char *pages[], int &npages);
+	/**
+	 * Remove up to `num' clean pages that aren't referenced from the cell,
+	 * but keep at least `min_npages' pages in the cell.
+	 * It returns the number of removed pages.
+	 */
+	int release_pages(char *pages[], int num, int min_npages);
 
 	/**
 	 * This method returns a specified number of pages that contains
@@ -415,6 +424,14 @@ class associative_cache: public page_cache
 	std::unique_ptr<dirty_page_flusher> _flusher;
 	pthread_mutex_t init_mutex;
 
+	// The statistics of resizing the cache at runtime.
+	long num_grown_pages;
+	long num_released_pages;
+	int num_resizes;
+
+	int release_pages_in_cells(char *pages[], int npages, int min_npages);
+	bool merge_cells(hash_cell *cell, hash_cell *high_cell);
+
 	associative_cache(long cache_size, long max_cache_size, int node_id,
 			int offset_factor, int _max_num_pending_flush,
 			bool expandable = false);
@@ -497,7 +514,21 @@ public:
 	 * of pages that the cache has been expanded.
 	 */
 	int expand(int npages);
-	bool shrink(int npages, char *pages[]);
+	/**
+	 * Remove `npages' pages from the cache, and return the actual number
+	 * of pages removed from the cache. The cell table shrinks if removing
+	 * pages from the cells isn't enough.
+	 */
+	int shrink(int npages, char *pages[]);
+	virtual long resize(long new_size);
+
+	long get_num_released_pages() const {
+		return num_released_pages;
+	}
+
+	long get_num_grown_pages() const {
+		return num_grown_pages;
+	}
 
 	void print_cell(off_t off) {
 		get_cell(off)->print_cell();
@@ -568,6 +599,10 @@ public:
 		printf("\tmax pending flushes: %ld, avg: %ld, remaining pending: %d\n",
 				recorded_max_num_pending.get(), (long) avg_num_pending.get(),
 				num_pending_flush.get());
+		if (num_resizes > 0)
+			printf("\tresized %d times: grow %ld pages, release %ld pages, size: %ld\n",
+					num_resizes, num_grown_pages, num_released_pages,
+					((long) cache_npages.get()) * PAGE_SIZE);
 #ifdef DETAILED_STATISTICS
 		for (int i = 0; i < get_num_cells(); i++)
 			printf("cell %d: %ld accesses, %ld evictions\n", i,
@@ -425,8 +425,22 @@ public:
 	/* This method should be called within each thread. */
 	virtual void init(std::shared_ptr<io_interface> underlying) {
 	}
-	virtual bool shrink(int npages, char *pages[]) {
-		return false;
+	/**
+	 * This method removes pages from the cache and returns their memory
+	 * in `pages'. Only clean pages that aren't referenced are removed.
+	 * \return the number of pages removed from the cache.
+	 */
+	virtual int shrink(int npages, char *pages[]) {
+		return 0;
+	}
+	/**
+	 * This method grows or shrinks the cache at runtime to the specified
+	 * size in bytes. The memory of the removed pages is returned to
+	 * the operating system.
+	 * \return the size of the cache after resizing.
+	 */
+	virtual long resize(long new_size) {
+		return size();
 	}
 	virtual void create_flusher(std::shared_ptr<io_interface> io,
 			page_cache *global_cache) {
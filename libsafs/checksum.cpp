@@ -0,0 +1,241 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of SAFSlib.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+#include <vector>
+
+#include <boost/format.hpp>
+
+#ifdef __x86_64__
+#include <nmmintrin.h>
+#endif
+
+#include "log.h"
+#include "common.h"
+#include "concurrency.h"
+#include "native_file.h"
+#include "io_interface.h"
+#include "checksum.h"
+
+namespace safs
+{
+
+namespace
+{
+
+/*
+ * The table for computing CRC32C one byte at a time.
+ * It's only used when the CPU doesn't support SSE4.2.
+ */
+class crc32c_table
+{
+	uint32_t table[256];
+public:
+	crc32c_table() {
+		// The reversed Castagnoli polynomial.
+		const uint32_t poly = 0x82F63B78;
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t crc = i;
+			for (int j = 0; j < 8; j++)
+				crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+			table[i] = crc;
+		}
+	}
+
+	uint32_t operator[](int idx) const {
+		return table[idx];
+	}
+};
+
+const crc32c_table sw_table;
+
+uint32_t crc32c_sw(uint32_t crc, const unsigned char *buf, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		crc = sw_table[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+#ifdef __x86_64__
+__attribute__((target("sse4.2")))
+uint32_t crc32c_hw(uint32_t crc, const unsigned char *buf, size_t len)
+{
+	uint64_t crc64 = crc;
+	for (; len >= sizeof(uint64_t); len -= sizeof(uint64_t)) {
+		crc64 = _mm_crc32_u64(crc64, *(const uint64_t *) buf);
+		buf += sizeof(uint64_t);
+	}
+	crc = crc64;
+	for (; len > 0; len--)
+		crc = _mm_crc32_u8(crc, *buf++);
+	return crc;
+}
+
+const bool has_hw_crc32c = __builtin_cpu_supports("sse4.2");
+#endif
+
+atomic_number<size_t> num_checksum_errors;
+checksum_error_callback::ptr error_cb;
+
+}
+
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len)
+{
+	crc = ~crc;
+#ifdef __x86_64__
+	if (has_hw_crc32c)
+		crc = crc32c_hw(crc, (const unsigned char *) buf, len);
+	else
+#endif
+		crc = crc32c_sw(crc, (const unsigned char *) buf, len);
+	return ~crc;
+}
+
+std::string block_checksums::get_checksum_file(const std::string &part_file)
+{
+	native_file f(part_file);
+	return f.get_dir_name() + "/checksum";
+}
+
+bool block_checksums::create(const std::string &part_file)
+{
+	int fd = ::open(part_file.c_str(), O_RDONLY);
+	if (fd < 0) {
+		BOOST_LOG_TRIVIAL(error) << boost::format("can't open %1%: %2%")
+			% part_file % strerror(errno);
+		return false;
+	}
+	std::string sum_file = get_checksum_file(part_file);
+	FILE *f = fopen(sum_file.c_str(), "w");
+	if (f == NULL) {
+		BOOST_LOG_TRIVIAL(error) << boost::format("can't open %1%: %2%")
+			% sum_file % strerror(errno);
+		close(fd);
+		return false;
+	}
+
+	// Only full pages have checksums.
+	const size_t BUF_SIZE = 16 * 1024 * 1024;
+	std::vector<char> buf(BUF_SIZE);
+	std::vector<uint32_t> sums(BUF_SIZE / PAGE_SIZE);
+	bool ret = true;
+	while (true) {
+		ssize_t size = 0;
+		while ((size_t) size < BUF_SIZE) {
+			ssize_t tmp = read(fd, buf.data() + size, BUF_SIZE - size);
+			if (tmp <= 0)
+				break;
+			size += tmp;
+		}
+		size_t num_pages = size / PAGE_SIZE;
+		if (num_pages == 0)
+			break;
+		for (size_t i = 0; i < num_pages; i++)
+			sums[i] = crc32c(0, buf.data() + i * PAGE_SIZE, PAGE_SIZE);
+		if (fwrite(sums.data(), sizeof(sums[0]) * num_pages, 1, f) != 1) {
+			BOOST_LOG_TRIVIAL(error) << boost::format("can't write to %1%: %2%")
+				% sum_file % strerror(errno);
+			ret = false;
+			break;
+		}
+		if ((size_t) size < BUF_SIZE)
+			break;
+	}
+	fclose(f);
+	close(fd);
+	return ret;
+}
+
+block_checksums::ptr block_checksums::open(const std::string &part_file,
+		bool writable)
+{
+	std::string sum_file = get_checksum_file(part_file);
+	native_file f(sum_file);
+	if (!f.exist())
+		return block_checksums::ptr();
+	size_t num_pages = f.get_size() / sizeof(uint32_t);
+	if (num_pages == 0)
+		return block_checksums::ptr();
+
+	int fd = ::open(sum_file.c_str(), writable ? O_RDWR : O_RDONLY);
+	if (fd < 0) {
+		BOOST_LOG_TRIVIAL(error) << boost::format("can't open %1%: %2%")
+			% sum_file % strerror(errno);
+		return block_checksums::ptr();
+	}
+	void *addr = mmap(NULL, num_pages * sizeof(uint32_t),
+			writable ? PROT_READ | PROT_WRITE : PROT_READ,
+			MAP_SHARED | MAP_POPULATE, fd, 0);
+	int err = errno;
+	close(fd);
+	if (addr == MAP_FAILED) {
+		BOOST_LOG_TRIVIAL(error) << boost::format("can't map %1%: %2%")
+			% sum_file % strerror(err);
+		return block_checksums::ptr();
+	}
+	return block_checksums::ptr(new block_checksums(part_file,
+				(uint32_t *) addr, num_pages, writable));
+}
+
+block_checksums::~block_checksums()
+{
+	munmap(sums, num_pages * sizeof(uint32_t));
+}
+
+bool block_checksums::verify(const char *page, off_t pg_idx) const
+{
+	if ((size_t) pg_idx >= num_pages)
+		return true;
+	return crc32c(0, page, PAGE_SIZE) == sums[pg_idx];
+}
+
+void block_checksums::update(const char *page, off_t pg_idx)
+{
+	assert(writable);
+	if ((size_t) pg_idx < num_pages)
+		sums[pg_idx] = crc32c(0, page, PAGE_SIZE);
+}
+
+void report_checksum_error(const std::string &file_name, off_t off,
+		size_t size)
+{
+	num_checksum_errors.inc(1);
+	BOOST_LOG_TRIVIAL(error) << boost::format(
+			"checksum mismatch in %1% bytes at %2% of %3%")
+		% size % off % file_name;
+	if (error_cb)
+		error_cb->invoke(file_name, off, size);
+}
+
+void set_checksum_error_callback(checksum_error_callback::ptr cb)
+{
+	error_cb = cb;
+}
+
+size_t get_num_checksum_errors()
+{
+	return num_checksum_errors.get();
+}
+
+}
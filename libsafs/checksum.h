@@ -0,0 +1,104 @@
+#ifndef __SAFS_CHECKSUM_H__
+#define __SAFS_CHECKSUM_H__
+
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of SAFSlib.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <string>
+
+namespace safs
+{
+
+/*
+ * Compute CRC32C of the data in the buffer. `crc' is the checksum of
+ * the data in front of the buffer and is 0 for the first piece of data.
+ * The SSE4.2 instruction is used if the CPU supports it.
+ */
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len);
+
+/*
+ * Record a checksum mismatch and notify the user.
+ */
+void report_checksum_error(const std::string &file_name, off_t off,
+		size_t size);
+
+/*
+ * This contains the checksums of all pages in a part file of an SAFS file.
+ * The checksums are stored in a file in the same directory as the part
+ * file and are mapped to memory, so the updates of the checksums are
+ * written back to the file by the kernel.
+ */
+class block_checksums
+{
+	std::string part_file;
+	uint32_t *sums;
+	size_t num_pages;
+	bool writable;
+
+	block_checksums(const std::string &part_file, uint32_t *sums,
+			size_t num_pages, bool writable) {
+		this->part_file = part_file;
+		this->sums = sums;
+		this->num_pages = num_pages;
+		this->writable = writable;
+	}
+public:
+	typedef std::shared_ptr<block_checksums> ptr;
+
+	static std::string get_checksum_file(const std::string &part_file);
+	/*
+	 * Compute the checksums of all pages in the part file and store them
+	 * in the checksum file.
+	 */
+	static bool create(const std::string &part_file);
+	/*
+	 * Open the checksums of the part file. It returns NULL if the part file
+	 * doesn't have checksums.
+	 */
+	static ptr open(const std::string &part_file, bool writable);
+
+	~block_checksums();
+
+	const std::string &get_part_file() const {
+		return part_file;
+	}
+
+	size_t get_num_pages() const {
+		return num_pages;
+	}
+
+	/*
+	 * Verify the data of a page in the part file. `pg_idx' is the location
+	 * of the page in the part file. A page without a checksum always passes
+	 * the verification.
+	 */
+	bool verify(const char *page, off_t pg_idx) const;
+	/*
+	 * Update the checksum of a page after it's written to the part file.
+	 */
+	void update(const char *page, off_t pg_idx);
+};
+
+}
+
+#endif
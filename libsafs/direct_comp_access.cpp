@@ -376,4 +376,10 @@ int direct_comp_io::num_pending_ios() const
 	return num_issued_areqs - num_completed_areqs;
 }
 
+bool direct_comp_io::can_sleep() const
+{
+	// Only the requests in the underlying IO wake up the thread.
+	return underlying->num_pending_ios() > 0;
+}
+
 }
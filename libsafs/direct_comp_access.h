@@ -73,6 +73,7 @@ public:
 	virtual void flush_requests();
 	virtual int wait4complete(int num);
 	virtual int num_pending_ios() const;
+	virtual bool can_sleep() const;
 
 	size_t get_num_disk_bytes() {
 		return num_disk_bytes;
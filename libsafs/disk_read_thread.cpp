@@ -27,6 +27,23 @@ namespace safs
 
 const int AIO_HIGH_PRIO_SLOTS = 7;
 const int NUM_DIRTY_PAGES_TO_FETCH = 16 * 18;
+// The period of tuning the polling time.
+const long POLL_TUNE_PERIOD_US = 100000;
+// The max time that an I/O thread polls in the adaptive mode.
+const long MAX_POLL_US = 200;
+
+class poll_timer_task: public timer_task
+{
+	disk_io_thread *t;
+public:
+	poll_timer_task(disk_io_thread *t): timer_task(POLL_TUNE_PERIOD_US) {
+		this->t = t;
+	}
+
+	void run() {
+		t->tune_poll_time(get_timeout());
+	}
+};
 
 /*
  * This is run inside the I/O thread, so it's OK to access its data structure.
@@ -83,6 +100,7 @@ disk_io_thread::disk_io_thread(const logical_file_partition &_partition, int cpu
 	max_flush_delay = 0;
 	min_flush_delay = LONG_MAX;
 	num_msgs = 0;
+	init_stats();
 
 	thread::start();
 }
@@ -122,10 +140,92 @@ disk_io_thread::disk_io_thread(const logical_file_partition &_partition,
 	max_flush_delay = 0;
 	min_flush_delay = LONG_MAX;
 	num_msgs = 0;
+	init_stats();
 
 	thread::start();
 }
 
+void disk_io_thread::init_stats()
+{
+	poll_timer = NULL;
+	num_arrivals = 0;
+	poll_us = 0;
+	num_polls = 0;
+	num_poll_hits = 0;
+	tot_poll_us = 0;
+	gettimeofday(&start_time, NULL);
+}
+
+void disk_io_thread::init()
+{
+	// The timer has to be started in the I/O thread because the timer
+	// signal is delivered to the I/O thread.
+	if (params.is_adaptive_poll() && !params.is_busy_wait()) {
+		poll_timer = new periodic_timer(this, new poll_timer_task(this));
+		poll_timer->start();
+	}
+}
+
+void disk_io_thread::cleanup()
+{
+	if (poll_timer) {
+		delete poll_timer;
+		poll_timer = NULL;
+	}
+	aio->cleanup();
+}
+
+/*
+ * This runs in the timer signal handler of the I/O thread.
+ * If requests arrive frequently, we poll for twice the average interval
+ * between requests, so we are likely to get the next request without
+ * sleeping. Otherwise, polling only wastes CPU.
+ */
+void disk_io_thread::tune_poll_time(long period_us)
+{
+	long num = num_arrivals;
+	num_arrivals = 0;
+	if (num == 0)
+		poll_us = 0;
+	else {
+		long interval = period_us / num;
+		poll_us = interval * 2 <= MAX_POLL_US ? interval * 2 : 0;
+	}
+}
+
+long disk_io_thread::get_poll_time() const
+{
+	if (params.is_busy_wait())
+		return LONG_MAX;
+	else if (params.is_adaptive_poll())
+		return poll_us;
+	else
+		return 0;
+}
+
+int disk_io_thread::poll_reqs(std::vector<io_request> &reqs, long max_us)
+{
+	struct timeval start, curr;
+	gettimeofday(&start, NULL);
+	int num = 0;
+	num_polls++;
+	do {
+		if (aio->num_pending_ios() > 0)
+			aio->poll4complete();
+		num = get_all_reqs(queue, reqs);
+		// We need to stop polling if there are other things to do.
+		if (num > 0 || !comm_queue.is_empty() || !low_prio_queue.is_empty()
+				|| flush_counter.get() > 0 || !is_running())
+			break;
+		gettimeofday(&curr, NULL);
+	} while (time_diff_us(start, curr) < max_us);
+	gettimeofday(&curr, NULL);
+	tot_poll_us += time_diff_us(start, curr);
+	if (num > 0)
+		num_poll_hits++;
+	return num;
+}
+
 /**
  * Notify the IO issuer of the ignored flushes.
  * All flush requests must come from the same IO instance.
@@ -319,6 +419,7 @@ void disk_io_thread::run() {
 			run_commands(comm_queue);
 
 		int num = get_all_reqs(queue, local_reqs);
+		long poll_time = get_poll_time();
 
 		if (is_debug_enabled())
 			printf("I/O thread %d: queue size: %d, low-prio queue size: %d\n",
@@ -346,13 +447,25 @@ void disk_io_thread::run() {
 			 * let's complete the pending IOs first.
 			 */
 			else if (aio->num_pending_ios() > 0) {
-				aio->wait4complete(1);
+				// Poll for a while before blocking in the kernel.
+				if (poll_time > 0)
+					num = poll_reqs(local_reqs, poll_time);
+				if (num == 0 && aio->num_pending_ios() > 0)
+					aio->wait4complete(1);
+			}
+			// Poll for a while before the thread sleeps.
+			else if (poll_time > 0) {
+				num = poll_reqs(local_reqs, poll_time);
+				if (num == 0)
+					break;
 			}
 			else
 				break;
 
-			num = get_all_reqs(queue, local_reqs);
+			num += get_all_reqs(queue, local_reqs);
 		}
+		if (num > 0)
+			num_arrivals = num_arrivals + 1;
 
 		aio->access(local_reqs.data(), local_reqs.size());
 		local_reqs.clear();
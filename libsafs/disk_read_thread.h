@@ -31,6 +31,7 @@
 #include "file_partition.h"
 #include "messaging.h"
 #include "thread.h"
+#include "timer.h"
 
 namespace safs
 {
@@ -146,6 +147,23 @@ class disk_io_thread: public thread
 
 	atomic_integer flush_counter;
 
+	/*
+	 * With adaptive polling, the I/O thread polls the request queue and
+	 * completed I/O for a while before it sleeps or blocks in the kernel.
+	 * The polling time is proportional to the recent interval between
+	 * incoming requests and is tuned periodically by a timer.
+	 */
+	periodic_timer *poll_timer;
+	// The number of times that the thread gets new requests in the current
+	// tuning period. It's reset by the timer.
+	volatile long num_arrivals;
+	// The maximal polling time in microseconds.
+	volatile long poll_us;
+	long num_polls;
+	long num_poll_hits;
+	long tot_poll_us;
+	struct timeval start_time;
+
 	int process_low_prio_msg(message<io_request> &low_prio_msg);
 
 	int get_num_high_prio_reqs() {
@@ -161,6 +179,18 @@ class disk_io_thread: public thread
 
 	void run_commands(thread_safe_FIFO_queue<remote_comm *> &);
 
+	void init_stats();
+	/*
+	 * Get the time (in microseconds) that the I/O thread polls before
+	 * it sleeps.
+	 */
+	long get_poll_time() const;
+	/*
+	 * Poll the request queue and the completed I/O for at most `max_us'
+	 * microseconds. It returns the number of new requests.
+	 */
+	int poll_reqs(std::vector<io_request> &reqs, long max_us);
+
 	int execute_remote_comm(remote_comm *comm) {
 		comm_queue.add(&comm, 1);
 		// We need to wake up the I/O thread to run the command.
@@ -219,11 +249,14 @@ public:
 	}
 
 	void run();
-	void init() {
-	}
-	virtual void cleanup() {
-		aio->cleanup();
-	}
+	void init();
+	virtual void cleanup();
+
+	/*
+	 * Tune the polling time with the number of request arrivals
+	 * in the last period.
+	 */
+	void tune_poll_time(long period_us);
 
 	size_t get_num_reads() const {
 		return num_reads;
@@ -255,6 +288,11 @@ public:
 					min_flush_delay);
 		printf("\tremain %d high-prio requests, %d low-prio requests, %ld messages in total\n",
 				get_num_high_prio_reqs(), get_num_low_prio_reqs(), num_msgs);
+		struct timeval curr;
+		gettimeofday(&curr, NULL);
+		printf("\tpoll %ld times (%ld hits) for %ldus, CPU utilization: %.1f%%\n",
+				num_polls, num_poll_hits, tot_poll_us,
+				((double) get_cpu_time_us()) / time_diff_us(start_time, curr) * 100);
 #endif
 	}
 
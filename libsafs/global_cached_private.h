@@ -285,6 +285,13 @@ public:
 
 	virtual int wait4complete(int num);
 	virtual void notify_completion(io_request *reqs[], int num);
+	/*
+	 * The thread is only woken up by the completion of requests issued
+	 * to the underlying IO, so it can't sleep if there are no such requests.
+	 */
+	virtual bool can_sleep() const {
+		return get_num_underlying_reqs() > 0;
+	}
 
 	/**
 	 * Process the completed requests issued to the disks.
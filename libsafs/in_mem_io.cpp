@@ -17,8 +17,13 @@
  * limitations under the License.
  */
 
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <numa.h>
+
 #include <boost/format.hpp>
 
+#include "log.h"
 #include "in_mem_io.h"
 #include "slab_allocator.h"
 #include "native_file.h"
@@ -43,6 +48,19 @@ public:
 	}
 };
 
+class munmap_delete
+{
+	size_t size;
+public:
+	munmap_delete(size_t size) {
+		this->size = size;
+	}
+
+	void operator()(char *buf) const {
+		munmap(buf, size);
+	}
+};
+
 struct cfree
 {
 public:
@@ -56,6 +74,7 @@ public:
 NUMA_buffer::NUMA_buffer(std::shared_ptr<char> data, size_t length,
 		const NUMA_mapper &_mapper): mapper(_mapper)
 {
+	read_only = false;
 	assert(mapper.get_num_nodes() == 1);
 	bufs.resize(1);
 	buf_lens.resize(1);
@@ -77,6 +96,7 @@ NUMA_buffer::NUMA_buffer(std::shared_ptr<char> data, size_t length,
 NUMA_buffer::NUMA_buffer(size_t length,
 		const NUMA_mapper &_mapper): mapper(_mapper)
 {
+	read_only = false;
 	length = ROUNDUP(length, PAGE_SIZE);
 	this->length = length;
 	bufs.resize(mapper.get_num_nodes());
@@ -126,8 +146,11 @@ NUMA_buffer::data_loc_info NUMA_buffer::get_data_loc(off_t off,
 	}
 
 	size_t local_size;
+	// If all data is on one node, it's stored in contiguous memory.
+	if (bufs.size() == 1)
+		local_size = buf_lens[0] - loc.second;
 	// If it's at the beginning of the range, we have the entire range.
-	if (loc.second % mapper.get_range_size() == 0)
+	else if (loc.second % mapper.get_range_size() == 0)
 		local_size = mapper.get_range_size();
 	else
 		local_size = ROUNDUP(loc.second, mapper.get_range_size()) - loc.second;
@@ -164,6 +187,8 @@ NUMA_buffer::data_info NUMA_buffer::get_data(off_t off, size_t size)
 
 void NUMA_buffer::copy_from(const char *buf, size_t size, off_t off)
 {
+	if (read_only)
+		throw io_exception("can't write to a read-only NUMA buffer");
 	// The required data may not be stored in contiguous memory.
 	while (size > 0) {
 		auto info = get_data(off, size);
@@ -300,6 +325,61 @@ NUMA_buffer::ptr NUMA_buffer::load_safs(const std::string &file_name,
 	return numa_buf;
 }
 
+NUMA_buffer::ptr NUMA_buffer::map(const std::string &file_name)
+{
+	native_file local_f(file_name);
+	if (!local_f.exist())
+		throw io_exception(boost::str(
+					boost::format("Linux file %1% doesn't exist") % file_name));
+	ssize_t file_size = local_f.get_size();
+	assert(file_size > 0);
+
+	int fd = open(file_name.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw io_exception(boost::str(boost::format("can't open %1%: %2%")
+					% file_name % strerror(errno)));
+
+	// The pages are faulted in by the current thread when the file is mapped,
+	// so we interleave the pages of the file on all NUMA nodes through
+	// the memory policy of the current thread.
+	struct bitmask *orig_mask = NULL;
+	if (numa_available() >= 0 && numa_num_configured_nodes() > 1) {
+		orig_mask = numa_get_interleave_mask();
+		numa_set_interleave_mask(numa_all_nodes_ptr);
+	}
+
+	// MAP_HUGETLB only works if the file is in hugetlbfs. Otherwise,
+	// we ask for transparent huge pages.
+	size_t map_size = ROUNDUP(file_size, PAGE_SIZE);
+	void *addr = mmap(NULL, map_size, PROT_READ,
+			MAP_PRIVATE | MAP_POPULATE | MAP_HUGETLB, fd, 0);
+	if (addr == MAP_FAILED) {
+		addr = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE,
+				fd, 0);
+		if (addr != MAP_FAILED)
+			madvise(addr, map_size, MADV_HUGEPAGE);
+	}
+	int err = errno;
+	close(fd);
+	if (orig_mask) {
+		numa_set_interleave_mask(orig_mask);
+		numa_bitmask_free(orig_mask);
+	}
+	if (addr == MAP_FAILED)
+		throw io_exception(boost::str(boost::format("can't map %1%: %2%")
+					% file_name % strerror(err)));
+	BOOST_LOG_TRIVIAL(info) << boost::format("map %1% bytes of %2%")
+		% map_size % file_name;
+
+	// All data is in a single piece of memory, so it's the same as a buffer
+	// on one NUMA node.
+	NUMA_mapper mapper(1, 30);
+	std::shared_ptr<char> data((char *) addr, munmap_delete(map_size));
+	NUMA_buffer::ptr numa_buf(new NUMA_buffer(data, map_size, mapper));
+	numa_buf->read_only = true;
+	return numa_buf;
+}
+
 NUMA_buffer::ptr NUMA_buffer::create(std::shared_ptr<char> data, size_t length,
 		const NUMA_mapper &mapper)
 {
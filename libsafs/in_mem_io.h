@@ -38,6 +38,8 @@ class NUMA_buffer
 	// This is the total length of the buffer.
 	size_t length;
 	NUMA_mapper mapper;
+	// The buffer maps a file read-only, so we can't write data to it.
+	bool read_only;
 
 	struct data_loc_info {
 		int node_id;
@@ -63,6 +65,12 @@ public:
 	 */
 	static ptr load(const std::string &file, const NUMA_mapper &mapper);
 	static ptr load_safs(const std::string &file, const NUMA_mapper &mapper);
+	/*
+	 * Map a file in the local filesystem to memory without copying its data.
+	 * The mapping is read-only and is populated in advance. It's backed by
+	 * huge pages if possible and its pages are interleaved on all NUMA nodes.
+	 */
+	static ptr map(const std::string &file);
 
 	static ptr create(std::shared_ptr<char>, size_t length,
 			const NUMA_mapper &mapper);
@@ -74,6 +82,10 @@ public:
 		return length;
 	}
 
+	bool is_read_only() const {
+		return read_only;
+	}
+
 	/*
 	 * Get the data in the specified location.
 	 * Since the data in the buffer isn't stored contiguously, the size of
@@ -38,6 +38,7 @@
 #include "global_cached_private.h"
 #include "part_global_cached_private.h"
 #include "cache_config.h"
+#include "NUMA_cache.h"
 #include "disk_read_thread.h"
 #include "debugger.h"
 #include "mem_tracker.h"
@@ -846,6 +847,48 @@ void print_io_summary()
 			num_read_bytes, num_reads, num_write_bytes, num_writes);
 }
 
+/*
+ * Get the part of the page cache on the specified NUMA node.
+ */
+static page_cache *get_cache_on_node(int node_id)
+{
+	page_cache *cache = global_data.global_cache.get();
+	if (cache == NULL || node_id < 0)
+		return cache;
+	NUMA_cache *numa_cache = dynamic_cast<NUMA_cache *>(cache);
+	if (numa_cache)
+		return &numa_cache->get_cache_on_node(node_id);
+	else if (cache->get_node_id() == node_id)
+		return cache;
+	else
+		return NULL;
+}
+
+long resize_page_cache(long new_size, int node_id)
+{
+	page_cache *cache = get_cache_on_node(node_id);
+	if (cache == NULL) {
+		BOOST_LOG_TRIVIAL(error) << boost::format(
+				"can't find the page cache on node %1%") % node_id;
+		return 0;
+	}
+	long orig_size = cache->size();
+	long ret = cache->resize(new_size);
+	BOOST_LOG_TRIVIAL(info) << boost::format(
+			"resize the page cache on node %1% from %2% to %3% bytes (request: %4%)")
+		% node_id % orig_size % ret % new_size;
+	return ret;
+}
+
+long get_page_cache_size(int node_id)
+{
+	page_cache *cache = get_cache_on_node(node_id);
+	if (cache == NULL)
+		return 0;
+	else
+		return cache->size();
+}
+
 ssize_t file_io_factory::get_file_size() const
 {
 	safs_file f(*global_data.raid_conf, name);
@@ -893,6 +936,91 @@ public:
 	}
 };
 
+/*
+ * This I/O select works for any type of I/O instances owned by
+ * the current thread. We poll all of them and put the thread to sleep
+ * if none of them has completed enough requests and all I/O instances
+ * with pending requests wake up the owner thread (e.g., remote_io).
+ * Otherwise, we keep polling.
+ * This avoids the case that the thread sleeps in one I/O instance while
+ * requests of another I/O instance have completed.
+ */
+class generic_io_select: public io_select
+{
+	std::vector<io_interface::ptr> ios;
+	std::unordered_set<io_interface *> io_set;
+
+	int poll_ios();
+	bool can_sleep() const;
+public:
+	virtual bool add_io(io_interface::ptr io);
+	virtual int num_pending_ios() const;
+	virtual int wait4complete(int num_to_complete);
+};
+
+bool generic_io_select::add_io(io_interface::ptr io)
+{
+	// A synchronous I/O instance never has pending requests.
+	if (!io->support_aio())
+		return true;
+	auto ret = io_set.insert(io.get());
+	if (ret.second)
+		ios.push_back(io);
+	return true;
+}
+
+int generic_io_select::num_pending_ios() const
+{
+	int num_pending = 0;
+	for (size_t i = 0; i < ios.size(); i++)
+		num_pending += ios[i]->num_pending_ios();
+	return num_pending;
+}
+
+/*
+ * Flush the buffered requests and process the completed requests in
+ * all I/O instances without blocking.
+ */
+int generic_io_select::poll_ios()
+{
+	int num_complete = 0;
+	for (size_t i = 0; i < ios.size(); i++)
+		num_complete += ios[i]->wait4complete(0);
+	return num_complete;
+}
+
+/*
+ * We can sleep only if every I/O instance with pending requests
+ * will wake us up when its requests complete.
+ */
+bool generic_io_select::can_sleep() const
+{
+	for (size_t i = 0; i < ios.size(); i++)
+		if (ios[i]->num_pending_ios() > 0 && !ios[i]->can_sleep())
+			return false;
+	return true;
+}
+
+int generic_io_select::wait4complete(int num_to_complete)
+{
+	thread *curr = thread::get_curr_thread();
+	int num_pending = num_pending_ios();
+	num_to_complete = min(num_pending, num_to_complete);
+
+	int num_complete = poll_ios();
+	while (num_complete < num_to_complete) {
+		if (!params.is_busy_wait() && can_sleep())
+			curr->wait();
+		num_complete += poll_ios();
+	}
+	return num_complete;
+}
+
+}
+
+io_select::ptr io_interface::create_io_select() const
+{
+	return io_select::ptr(new generic_io_select());
 }
 
 io_select::ptr create_io_select(const std::vector<io_interface::ptr> &ios)
@@ -912,8 +1040,16 @@ io_select::ptr create_io_select(const std::vector<io_interface::ptr> &ios)
 	// to create an empty I/O select.
 	if (select == NULL)
 		select = io_select::ptr(new empty_io_select());
-	for (size_t i = 0; i < ios.size(); i++)
-		select->add_io(ios[i]);
+	for (size_t i = 0; i < ios.size(); i++) {
+		// If the I/O instances are of different types, we have to fall back
+		// to the generic I/O select.
+		if (!select->add_io(ios[i])) {
+			select = io_select::ptr(new generic_io_select());
+			for (size_t j = 0; j < ios.size(); j++)
+				BOOST_VERIFY(select->add_io(ios[j]));
+			break;
+		}
+	}
 	return select;
 }
 
@@ -293,6 +293,17 @@ public:
 	virtual int wait4complete(int num) {
 		throw unsupported_exception();
 	}
+	/**
+	 * This method tells whether the thread that owns the I/O instance can
+	 * sleep while it waits for the pending requests. It can sleep only if
+	 * the pending requests are served by other threads, which wake up
+	 * the owner thread when the requests complete. By default, nothing
+	 * wakes up the owner thread, so it has to poll the I/O instance.
+	 * \return boolean.
+	 */
+	virtual bool can_sleep() const {
+		return false;
+	}
 	/**
 	 * This method gets the number of I/O requests pending in the I/O instance.
 	 * \return the number of pending I/O requests.
@@ -366,9 +377,12 @@ public:
 		return IO_UNSUPPORTED;
 	}
 
-	virtual std::shared_ptr<io_select> create_io_select() const {
-		return std::shared_ptr<io_select>();
-	}
+	/**
+	 * This method creates an I/O select that can wait for the I/O instance.
+	 * \return the I/O select or NULL if the I/O instance never needs to
+	 * wait for requests to complete.
+	 */
+	virtual std::shared_ptr<io_select> create_io_select() const;
 };
 
 /**
@@ -377,6 +391,9 @@ public:
  * for I/O completion from all of the I/O instances.
  * Each type of I/O instance has its own io_select. Users have to add
  * an I/O instance to the right I/O select.
+ * All I/O instances in an I/O select have to be owned by the same thread,
+ * which sleeps at most once per round of polling no matter which I/O
+ * instance completes requests first.
  */
 class io_select
 {
@@ -394,6 +411,11 @@ public:
 	 * I/O instances.
 	 */
 	virtual int num_pending_ios() const = 0;
+	/**
+	 * Wait for at least the specified number of requests to complete
+	 * in all of the registered I/O instances.
+	 * \return the number of completed requests.
+	 */
 	virtual int wait4complete(int num_to_complete) = 0;
 };
 
@@ -511,6 +533,14 @@ public:
 class cache_config;
 class RAID_config;
 
+/**
+ * This function creates an I/O select for the I/O instances.
+ * If the I/O instances are of different types, the I/O select polls
+ * each of them and puts the thread to sleep only when none of them
+ * makes progress.
+ * \param ios the I/O instances owned by the current thread.
+ * \return the I/O select.
+ */
 io_select::ptr create_io_select(const std::vector<io_interface::ptr> &ios);
 
 /**
@@ -565,6 +595,60 @@ void print_io_thread_stat();
  */
 void print_io_summary();
 
+/**
+ * This function grows or shrinks the page cache of SAFS at runtime.
+ * When the cache shrinks, clean pages that aren't being used are evicted
+ * and their memory is returned to the operating system, so it can be used
+ * by other components. Dirty and referenced pages are never evicted, so
+ * the cache may not be able to shrink to the requested size.
+ * This function shouldn't be invoked by multiple threads simultaneously.
+ * \param new_size the new size of the page cache in bytes.
+ * \param node_id the NUMA node whose part of the cache is resized.
+ * If it's -1, the cache is resized evenly on all NUMA nodes.
+ * \return the size of the page cache (on the NUMA node) after resizing.
+ */
+long resize_page_cache(long new_size, int node_id = -1);
+
+/**
+ * This function gets the current size of the page cache of SAFS.
+ * \param node_id the NUMA node whose part of the cache is returned.
+ * If it's -1, it returns the size of the cache on all NUMA nodes.
+ * \return the size of the page cache in bytes.
+ */
+long get_page_cache_size(int node_id = -1);
+
+/**
+ * This callback is invoked in an I/O thread when the data read from a disk
+ * doesn't match its checksum. Checksums are only verified when SAFS is
+ * initialized with `verify_checksum' and the file has checksums.
+ */
+class checksum_error_callback
+{
+public:
+	typedef std::shared_ptr<checksum_error_callback> ptr;
+
+	virtual ~checksum_error_callback() {
+	}
+
+	/**
+	 * \param file_name the physical file where the corrupted data is stored.
+	 * \param off the location of the corrupted data in the SAFS file.
+	 * \param size the size of the corrupted data.
+	 */
+	virtual void invoke(const std::string &file_name, off_t off,
+			size_t size) = 0;
+};
+
+/**
+ * This function sets the callback that is invoked on a checksum mismatch.
+ */
+void set_checksum_error_callback(checksum_error_callback::ptr cb);
+
+/**
+ * This function gets the number of checksum mismatches detected so far.
+ */
+size_t get_num_checksum_errors();
+
 /**
  * The users can set the weight of a file. The file weight is used by
  * the page cache. The file with a higher weight can have its data in
@@ -17,6 +17,8 @@
  * limitations under the License.
  */
 
+#include <sys/mman.h>
+
 #include "memory_manager.h"
 
 namespace safs
@@ -68,10 +70,10 @@ bool memory_manager::get_free_pages(int npages,
 		if (num_shrink < npages)
 			num_shrink = npages;
 		char *buf[num_shrink];
-		if (!cache->shrink(num_shrink, buf)) {
+		int num_shrunk = cache->shrink(num_shrink, buf);
+		slab_allocator::free(buf, num_shrunk);
+		if (num_shrunk < npages)
 			return false;
-		}
-		slab_allocator::free(buf, num_shrink);
 		/* now it's guaranteed that we have enough free pages. */
 		ret = slab_allocator::alloc(pages, npages);
 	}
@@ -82,4 +84,13 @@ void memory_manager::free_pages(int npages, char **pages) {
 	slab_allocator::free(pages, npages);
 }
 
+void memory_manager::release_pages(int npages, char **pages) {
+	for (int i = 0; i < npages; i++) {
+		int ret = madvise(pages[i], PAGE_SIZE, MADV_DONTNEED);
+		if (ret < 0)
+			perror("madvise");
+	}
+	slab_allocator::free(pages, npages);
+}
+
 }
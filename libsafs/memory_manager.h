@@ -61,6 +61,12 @@ public:
 
 	bool get_free_pages(int npages, char **pages, page_cache *cache);
 	void free_pages(int npages, char **pages);
+	/*
+	 * Free the pages and return their physical memory to the OS.
+	 * The pages are still kept in the allocator and are backed by
+	 * physical memory again when they are reused.
+	 */
+	void release_pages(int npages, char **pages);
 
 	long average_cache_size() {
 		return get_max_size() / caches.size();
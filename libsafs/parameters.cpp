@@ -60,6 +60,7 @@ sys_parameters::sys_parameters()
 	RAID_mapping_option = RAID5;
 	use_virt_aio = false;
 	verify_content = false;
+	verify_checksum = false;
 	use_flusher = false;
 	cache_large_write = false;
 	vaio_print_freq = 1000000;
@@ -71,6 +72,7 @@ sys_parameters::sys_parameters()
 	max_num_pending_ios = 1000;
 	huge_page_enabled = false;
 	busy_wait = false;
+	adaptive_poll = false;
 	// The number of I/O threads will be determined based on the number of SSDs.
 	num_io_threads = 0;
 	bind_io_thread = false;
@@ -132,6 +134,11 @@ void sys_parameters::init(const std::map<std::string, std::string> &configs)
 		verify_content = true;
 	}
 
+	it = configs.find("verify_checksum");
+	if (it != configs.end()) {
+		verify_checksum = true;
+	}
+
 	it = configs.find("use_flusher");
 	if (it != configs.end()) {
 		use_flusher = true;
@@ -193,6 +200,11 @@ void sys_parameters::init(const std::map<std::string, std::string> &configs)
 		busy_wait = true;
 	}
 
+	it = configs.find("adaptive_poll");
+	if (it != configs.end()) {
+		adaptive_poll = true;
+	}
+
 	it = configs.find("num_io_threads");
 	if (it != configs.end()) {
 		num_io_threads = str2size(it->second);
@@ -215,6 +227,7 @@ void sys_parameters::print()
 	BOOST_LOG_TRIVIAL(info) << "\tRAID_mapping: " << RAID_mapping_option;
 	BOOST_LOG_TRIVIAL(info) << "\tvirt_aio: " << use_virt_aio;
 	BOOST_LOG_TRIVIAL(info) << "\tverify_content: " << verify_content;
+	BOOST_LOG_TRIVIAL(info) << "\tverify_checksum: " << verify_checksum;
 	BOOST_LOG_TRIVIAL(info) << "\tuse_flusher: " << use_flusher;
 	BOOST_LOG_TRIVIAL(info) << "\tcache_large_write: " << cache_large_write;
 	BOOST_LOG_TRIVIAL(info) << "\tvaio_print_freq: " << vaio_print_freq;
@@ -226,6 +239,7 @@ void sys_parameters::print()
 	BOOST_LOG_TRIVIAL(info) << "\tmax_num_pending_ios: " << max_num_pending_ios;
 	BOOST_LOG_TRIVIAL(info) << "\thuge_page_enabled: " << huge_page_enabled;
 	BOOST_LOG_TRIVIAL(info) << "\tbusy_wait: " << busy_wait;
+	BOOST_LOG_TRIVIAL(info) << "\tadaptive_poll: " << adaptive_poll;
 	BOOST_LOG_TRIVIAL(info) << "\tnum_io_threads: " << num_io_threads;
 	BOOST_LOG_TRIVIAL(info) << "\tbind_io_thread: " << bind_io_thread;
 }
@@ -249,6 +263,8 @@ void sys_parameters::print_help()
 	std::cout << "\tvirt_aio: enable virtual AIO for debugging and performance evaluation"
 		<< std::endl;
 	std::cout << "\tverify_content: verify data for testing" << std::endl;
+	std::cout << "\tverify_checksum: verify the checksums of data read from SSDs"
+		<< std::endl;
 	std::cout << "\tuse_flusher: use flusher in the page cache" << std::endl;
 	std::cout << "\tcache_large_write: enable large write in the page cache."
 		<< std::endl;
@@ -267,7 +283,9 @@ void sys_parameters::print_help()
 		<< std::endl;
 	std::cout << "\thuge_page_enabled: determine whether we use huge page for large chunk of memory"
 		<< std::endl;
-	std::cout << "\tbusy_wait: determine whether remote I/O busy wait for I/O completion"
+	std::cout << "\tbusy_wait: determine whether remote I/O and I/O threads busy wait"
+		<< std::endl;
+	std::cout << "\tadaptive_poll: I/O threads poll for a time adapted to the request rate before sleeping"
 		<< std::endl;
 	std::cout << "\tnum_io_threads: the number of threads per NUMA node for I/O processing."
 		<< std::endl;
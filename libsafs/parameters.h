@@ -44,6 +44,7 @@ class sys_parameters
 	int RAID_mapping_option;
 	bool use_virt_aio;
 	bool verify_content;
+	bool verify_checksum;
 	bool use_flusher;
 	bool cache_large_write;
 	int vaio_print_freq;
@@ -55,6 +56,7 @@ class sys_parameters
 	int max_num_pending_ios;
 	bool huge_page_enabled;
 	bool busy_wait;
+	bool adaptive_poll;
 	// The number of I/O threads per NUMA node.
 	int num_io_threads;
 	// Bind a I/O thread to a specific CPU core and ensure no other threads
@@ -72,6 +74,10 @@ public:
 		return busy_wait;
 	}
 
+	bool is_adaptive_poll() const {
+		return adaptive_poll;
+	}
+
 	// in pages
 	int get_RAID_block_size() const {
 		return RAID_block_size;
@@ -105,6 +111,10 @@ public:
 		return verify_content;
 	}
 
+	bool is_verify_checksum() const {
+		return verify_checksum;
+	}
+
 	bool is_use_flusher() const {
 		return use_flusher;
 	}
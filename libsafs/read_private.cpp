@@ -45,6 +45,18 @@ buffered_io::buffered_io(const logical_file_partition &partition_, thread *t,
 			exit(1);
 		}
 	}
+
+	if (params.is_verify_checksum()) {
+		std::vector<block_checksums::ptr> sums(fds.size());
+		bool has_sums = false;
+		for (int i = 0; i < partition.get_num_files(); i++) {
+			sums[i] = block_checksums::open(partition.get_file_name(i),
+					header.is_writable());
+			has_sums = has_sums || sums[i] != NULL;
+		}
+		if (has_sums)
+			checksums = sums;
+	}
 }
 
 io_status buffered_io::access(char *buf, off_t offset, ssize_t size, int access_method) {
@@ -73,4 +85,88 @@ io_status buffered_io::access(char *buf, off_t offset, ssize_t size, int access_
 	return status;
 }
 
+namespace
+{
+
+/*
+ * This iterates the pages that are entirely covered by the buffers
+ * of a request. `func' is invoked on each of the pages with the page
+ * data, the location of the page in the part file and the location
+ * of the page in the request.
+ */
+template<class Func>
+void for_each_page(const io_request &req, const block_identifier &bid,
+		Func func)
+{
+	// The location of the request in the part file.
+	off_t local_off = bid.off * PAGE_SIZE + req.get_offset() % PAGE_SIZE;
+	off_t req_local_off = local_off;
+	for (int i = 0; i < req.get_num_bufs(); i++) {
+		const char *buf = req.get_buf(i);
+		size_t size = req.get_buf_size(i);
+		off_t pg_off = ROUNDUP_PAGE(local_off);
+		for (; pg_off + PAGE_SIZE <= (off_t) (local_off + size); pg_off += PAGE_SIZE)
+			func(buf + (pg_off - local_off), pg_off / PAGE_SIZE,
+					pg_off - req_local_off);
+		local_off += size;
+	}
+}
+
+}
+
+int buffered_io::verify_checksums(const io_request &req) const
+{
+	block_identifier bid;
+	partition.map(req.get_offset() / PAGE_SIZE, bid);
+	const block_checksums *sums = checksums[bid.idx].get();
+	if (sums == NULL)
+		return 0;
+
+	int num_errors = 0;
+	for_each_page(req, bid, [&](const char *page, off_t pg_idx,
+				off_t off_in_req) {
+			if (!sums->verify(page, pg_idx)) {
+				report_checksum_error(sums->get_part_file(),
+					req.get_offset() + off_in_req, PAGE_SIZE);
+				num_errors++;
+			}
+		});
+	return num_errors;
+}
+
+void buffered_io::update_checksums(const io_request &req)
+{
+	block_identifier bid;
+	partition.map(req.get_offset() / PAGE_SIZE, bid);
+	block_checksums *sums = checksums[bid.idx].get();
+	if (sums == NULL)
+		return;
+
+	off_t local_off = bid.off * PAGE_SIZE + req.get_offset() % PAGE_SIZE;
+	off_t first_pg = local_off / PAGE_SIZE;
+	off_t end_pg = ROUNDUP_PAGE(local_off + req.get_size()) / PAGE_SIZE;
+	std::vector<bool> updated(end_pg - first_pg);
+	for_each_page(req, bid, [&](const char *page, off_t pg_idx,
+				off_t off_in_req) {
+			sums->update(page, pg_idx);
+			updated[pg_idx - first_pg] = true;
+		});
+
+	// The pages that are partially written have to be read back from
+	// the disk to compute their checksums.
+	char *page = NULL;
+	for (size_t i = 0; i < updated.size(); i++) {
+		if (updated[i])
+			continue;
+		if (page == NULL)
+			page = (char *) valloc(PAGE_SIZE);
+		off_t pg_idx = first_pg + i;
+		if (pread(fds[bid.idx], page, PAGE_SIZE, pg_idx * PAGE_SIZE)
+				== PAGE_SIZE)
+			sums->update(page, pg_idx);
+	}
+	free(page);
+}
+
 }
+
@@ -28,6 +28,7 @@
 #include "io_interface.h"
 #include "file_partition.h"
 #include "parameters.h"
+#include "checksum.h"
 
 namespace safs
 {
@@ -37,6 +38,11 @@ class buffered_io: public io_interface
 	logical_file_partition partition;
 	/* the array of files that it's going to access */
 	std::vector<int> fds;
+	/*
+	 * The checksums of the pages in the files. They are only loaded
+	 * when we need to verify checksums.
+	 */
+	std::vector<block_checksums::ptr> checksums;
 
 	int flags;
 public:
@@ -79,6 +85,21 @@ public:
 	}
 
 	io_status access(char *buf, off_t offset, ssize_t size, int access_method);
+
+	bool has_checksums() const {
+		return !checksums.empty();
+	}
+
+	/*
+	 * Verify the pages read by the request with their checksums.
+	 * Only the pages that are entirely read by the request are verified.
+	 * It returns the number of corrupted pages.
+	 */
+	int verify_checksums(const io_request &req) const;
+	/*
+	 * Update the checksums of the pages written by the request.
+	 */
+	void update_checksums(const io_request &req);
 };
 
 }
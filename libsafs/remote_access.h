@@ -99,6 +99,12 @@ public:
 	virtual int num_pending_ios() const {
 		return num_issued_reqs.get() - num_completed_reqs.get();
 	}
+	/*
+	 * The I/O threads wake up the owner thread when requests complete.
+	 */
+	virtual bool can_sleep() const {
+		return true;
+	}
 	virtual io_interface *clone(thread *t) const;
 	void flush_requests(int max_cached);
 	virtual void flush_requests();
@@ -26,6 +26,7 @@
 #include "safs_file.h"
 #include "RAID_config.h"
 #include "io_interface.h"
+#include "checksum.h"
 
 namespace safs
 {
@@ -54,7 +55,7 @@ std::vector<std::string> safs_file::erase_header_file(
 {
 	std::vector<std::string> ret;
 	for (auto it = files.begin(); it != files.end(); it++)
-		if (*it != "header")
+		if (*it != "header" && *it != "checksum")
 			ret.push_back(*it);
 	return ret;
 }
@@ -189,6 +190,23 @@ bool safs_file::delete_file()
 	return true;
 }
 
+bool safs_file::create_checksums()
+{
+	if (!exist())
+		return false;
+
+	for (unsigned i = 0; i < native_dirs.size(); i++) {
+		native_dir dir(native_dirs[i].get_file_name());
+		std::vector<std::string> local_files;
+		dir.read_all_files(local_files);
+		local_files = erase_header_file(local_files);
+		assert(local_files.size() == 1);
+		if (!block_checksums::create(dir.get_name() + "/" + local_files[0]))
+			return false;
+	}
+	return true;
+}
+
 std::string safs_file::get_header_file() const
 {
 	if (!header_file.empty())
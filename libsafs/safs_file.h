@@ -84,6 +84,10 @@ class safs_file
 
 	std::string get_header_file() const;
 public:
+	/*
+	 * Remove the metadata files (the header and the checksums) from
+	 * the list of files in a directory of an SAFS file.
+	 */
 	static std::vector<std::string> erase_header_file(
 			const std::vector<std::string> &files);
 
@@ -110,6 +114,11 @@ public:
 			std::shared_ptr<safs_file_group> group = NULL);
 	bool delete_file();
 	bool rename(const std::string &new_name);
+	/*
+	 * Compute the checksums of all pages in the file. The checksums of
+	 * a part file are stored in the directory of the part file.
+	 */
+	bool create_checksums();
 };
 
 class safs_file_group
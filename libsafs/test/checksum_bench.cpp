@@ -0,0 +1,214 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of SAFSlib.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "io_interface.h"
+#include "safs_file.h"
+#include "checksum.h"
+#include "common.h"
+
+using namespace safs;
+
+/*
+ * This benchmark measures the overhead of verifying checksums.
+ * It first measures the throughput of computing CRC32C of pages in memory.
+ * If an SAFS file is given, it then reads the entire file twice with large
+ * requests, with and without verifying checksums, and reports the I/O
+ * throughput and the overhead.
+ */
+
+const size_t MEM_BUF_SIZE = 256 * 1024 * 1024;
+const int NUM_MEM_ITERS = 8;
+const size_t IO_SIZE = 4 * 1024 * 1024;
+const int NUM_PENDING_IOS = 32;
+
+double bench_crc32c()
+{
+	char *buf = (char *) valloc(MEM_BUF_SIZE);
+	for (size_t i = 0; i < MEM_BUF_SIZE; i++)
+		buf[i] = random();
+
+	struct timeval start, end;
+	uint32_t sum = 0;
+	gettimeofday(&start, NULL);
+	for (int k = 0; k < NUM_MEM_ITERS; k++)
+		for (size_t off = 0; off < MEM_BUF_SIZE; off += PAGE_SIZE)
+			sum += crc32c(0, buf + off, PAGE_SIZE);
+	gettimeofday(&end, NULL);
+	double crc_secs = time_diff(start, end);
+
+	char *buf2 = (char *) valloc(MEM_BUF_SIZE);
+	memset(buf2, 0, MEM_BUF_SIZE);
+	gettimeofday(&start, NULL);
+	for (int k = 0; k < NUM_MEM_ITERS; k++) {
+		buf[k] = k;
+		memcpy(buf2, buf, MEM_BUF_SIZE);
+		sum += buf2[random() % MEM_BUF_SIZE];
+	}
+	gettimeofday(&end, NULL);
+	double copy_secs = time_diff(start, end);
+
+	double size_gb = ((double) MEM_BUF_SIZE) * NUM_MEM_ITERS / 1024 / 1024 / 1024;
+	printf("CRC32C on %d-byte pages: %.2f GB/s per core (checksum %x)\n",
+			PAGE_SIZE, size_gb / crc_secs, sum);
+	printf("memcpy: %.2f GB/s per core\n", size_gb / copy_secs);
+	free(buf);
+	free(buf2);
+	return size_gb / crc_secs;
+}
+
+class count_callback: public callback
+{
+	size_t num_bytes;
+public:
+	count_callback() {
+		num_bytes = 0;
+	}
+
+	virtual int invoke(io_request *reqs[], int num) {
+		for (int i = 0; i < num; i++)
+			num_bytes += reqs[i]->get_size();
+		return 0;
+	}
+
+	size_t get_num_bytes() const {
+		return num_bytes;
+	}
+};
+
+/*
+ * Read the entire file and return the I/O throughput in GB/s.
+ */
+double bench_read(config_map::ptr configs, const std::string &file_name,
+		bool verify)
+{
+	if (verify)
+		configs->add_options("verify_checksum=");
+	init_io_system(configs, false);
+	file_io_factory::shared_ptr factory = create_io_factory(file_name,
+			REMOTE_ACCESS);
+	io_interface::ptr io = create_io(factory, thread::get_curr_thread());
+	count_callback *cb = new count_callback();
+	io->set_callback(callback::ptr(cb));
+	size_t file_size = ROUND(factory->get_file_size(), IO_SIZE);
+	std::vector<char *> bufs(NUM_PENDING_IOS);
+	for (size_t i = 0; i < bufs.size(); i++)
+		bufs[i] = (char *) valloc(IO_SIZE);
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	int buf_idx = 0;
+	for (off_t off = 0; (size_t) off < file_size; off += IO_SIZE) {
+		while (io->num_pending_ios() >= NUM_PENDING_IOS)
+			io->wait4complete(1);
+		data_loc_t loc(io->get_file_id(), off);
+		io_request req(bufs[buf_idx], loc, IO_SIZE, READ);
+		buf_idx = (buf_idx + 1) % bufs.size();
+		io->access(&req, 1);
+	}
+	while (io->num_pending_ios() > 0)
+		io->wait4complete(io->num_pending_ios());
+	gettimeofday(&end, NULL);
+
+	double size_gb = ((double) cb->get_num_bytes()) / 1024 / 1024 / 1024;
+	double secs = time_diff(start, end);
+	printf("read %.2f GB %s verifying checksums: %.2f GB/s\n", size_gb,
+			verify ? "with" : "without", size_gb / secs);
+	if (get_num_checksum_errors() > 0)
+		printf("%ld pages are corrupted\n", get_num_checksum_errors());
+	return size_gb / secs;
+}
+
+/*
+ * SAFS reads its configuration when it's initialized, so we run each
+ * step in a separate process.
+ */
+double run_in_process(std::function<double ()> func)
+{
+	int fds[2];
+	if (pipe(fds) < 0) {
+		perror("pipe");
+		exit(-1);
+	}
+	fflush(stdout);
+	pid_t pid = fork();
+	if (pid == 0) {
+		close(fds[0]);
+		double ret = func();
+		fflush(stdout);
+		if (write(fds[1], &ret, sizeof(ret)) != sizeof(ret))
+			perror("write");
+		_exit(0);
+	}
+	close(fds[1]);
+	double ret = -1;
+	if (read(fds[0], &ret, sizeof(ret)) != sizeof(ret))
+		ret = -1;
+	close(fds[0]);
+	waitpid(pid, NULL, 0);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 1 && argc != 3) {
+		fprintf(stderr, "checksum_bench [conf_file file_name]\n");
+		return -1;
+	}
+
+	bench_crc32c();
+	if (argc == 1)
+		return 0;
+
+	config_map::ptr configs = config_map::create(argv[1]);
+	std::string file_name = argv[2];
+	double ret = run_in_process([&]() -> double {
+			init_io_system(configs, false);
+			safs_file f(get_sys_RAID_conf(), file_name);
+			if (!f.exist()) {
+				fprintf(stderr, "%s doesn't exist in SAFS\n", file_name.c_str());
+				return -1;
+			}
+			return f.create_checksums() ? 0 : -1;
+		});
+	if (ret < 0) {
+		fprintf(stderr, "can't compute checksums for %s\n", file_name.c_str());
+		return -1;
+	}
+
+	double base = run_in_process([&]() -> double {
+			return bench_read(configs, file_name, false);
+		});
+	double verified = run_in_process([&]() -> double {
+			return bench_read(configs, file_name, true);
+		});
+	printf("checksum verification overhead: %.2f%%\n",
+			(base - verified) / base * 100);
+	return 0;
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of SAFSlib.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "io_interface.h"
+#include "common.h"
+
+using namespace safs;
+
+/*
+ * This benchmark compares the ways that I/O threads wait for requests and
+ * I/O completion: sleeping, busy waiting and adaptive polling. It issues
+ * small random reads one at a time with pauses in between, and reports
+ * the average latency of a read and the CPU utilization of the process.
+ */
+
+const int NUM_REQS = 20000;
+const int REQS_PER_PAUSE = 100;
+const int PAUSE_US = 1000;
+
+void bench_latency(config_map::ptr configs, const std::string &file_name,
+		const std::string &mode)
+{
+	if (!mode.empty())
+		configs->add_options(mode + "=");
+	init_io_system(configs, false);
+	file_io_factory::shared_ptr factory = create_io_factory(file_name,
+			REMOTE_ACCESS);
+	io_interface::ptr io = create_io(factory, thread::get_curr_thread());
+	size_t num_pages = factory->get_file_size() / PAGE_SIZE;
+	char *buf = (char *) valloc(PAGE_SIZE);
+
+	struct rusage start_usage, end_usage;
+	struct timeval start, end;
+	long io_us = 0;
+	getrusage(RUSAGE_SELF, &start_usage);
+	gettimeofday(&start, NULL);
+	for (int i = 0; i < NUM_REQS; i++) {
+		struct timeval req_start, req_end;
+		gettimeofday(&req_start, NULL);
+		data_loc_t loc(io->get_file_id(), (random() % num_pages) * PAGE_SIZE);
+		io_request req(buf, loc, PAGE_SIZE, READ);
+		io->access(&req, 1);
+		io->wait4complete(1);
+		gettimeofday(&req_end, NULL);
+		io_us += time_diff_us(req_start, req_end);
+		// Pause once in a while, so I/O threads have a chance to sleep.
+		if (i % REQS_PER_PAUSE == 0)
+			usleep(PAUSE_US);
+	}
+	gettimeofday(&end, NULL);
+	getrusage(RUSAGE_SELF, &end_usage);
+
+	long cpu_us = time_diff_us(start_usage.ru_utime, end_usage.ru_utime)
+		+ time_diff_us(start_usage.ru_stime, end_usage.ru_stime);
+	printf("%s: avg latency: %.1fus, CPU utilization: %.1f%%\n",
+			mode.empty() ? "sleep" : mode.c_str(), ((double) io_us) / NUM_REQS,
+			((double) cpu_us) / time_diff_us(start, end) * 100);
+	print_io_thread_stat();
+	free(buf);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		fprintf(stderr, "poll_bench conf_file file_name\n");
+		return -1;
+	}
+
+	std::string modes[] = {"", "busy_wait", "adaptive_poll"};
+	for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+		fflush(stdout);
+		// SAFS reads its configuration when it's initialized, so we run
+		// each mode in a separate process.
+		pid_t pid = fork();
+		if (pid == 0) {
+			bench_latency(config_map::create(argv[1]), argv[2], modes[i]);
+			fflush(stdout);
+			_exit(0);
+		}
+		waitpid(pid, NULL, 0);
+	}
+	return 0;
+}
@@ -159,6 +159,18 @@ public:
 			return gettid();
 	}
 
+	/*
+	 * Get the CPU time consumed by the thread in microseconds.
+	 */
+	long get_cpu_time_us() const {
+		clockid_t cid;
+		struct timespec ts;
+		if (thread_idx < 0 || pthread_getcpuclockid(id, &cid) != 0
+				|| clock_gettime(cid, &ts) != 0)
+			return 0;
+		return ((long) ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+	}
+
 	void start();
 	virtual void run() = 0;
 	virtual void init() {
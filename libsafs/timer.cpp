@@ -290,6 +290,12 @@ periodic_timer::periodic_timer(thread *t, timer_task *task)
 	}
 }
 
+periodic_timer::~periodic_timer()
+{
+	timer_delete(timerid);
+	delete task;
+}
+
 void periodic_timer::set_timeout(int64_t timeout)
 {
 	assert(timeout > 0);
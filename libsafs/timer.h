@@ -122,6 +122,11 @@ class periodic_timer
 	void set_timeout(int64_t timeout);
 public:
 	periodic_timer(thread *t, timer_task *task);
+	/*
+	 * The timer has to be destroyed before the thread it's attached to
+	 * exits. It also destroys the timer task.
+	 */
+	~periodic_timer();
 	void run_task();
 	int get_id() const {
 		return timer_id;
@@ -1,61 +1,111 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of SAFSlib.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
 #include <vector>
 #include <set>
 
 #include "associative_cache.h"
 
-int main()
+using namespace safs;
+
+const int FILE_ID = 0;
+
+/*
+ * Access random pages in the cache and mark them ready.
+ */
+void access_pages(page_cache &cache, int num, std::vector<off_t> &added_offs)
 {
-	associative_cache *cache = new associative_cache(16 * 1024 * 1024, 512 * 1024 * 1024, 0, 1);
-	std::vector<off_t> added_offs;
-	std::set<off_t> evicted_offs;
-	for (int i = 0; i < 4096; i++) {
-		off_t off = (random() & 0xfffffff) * 4096;
-		added_offs.push_back(off);
-		off_t old_off = -1;
-		thread_safe_page *pg = (thread_safe_page *) cache->search(off, old_off);
-		if (old_off != -1)
-			evicted_offs.insert(old_off);
+	for (int i = 0; i < num; i++) {
+		off_t off = (random() & 0xfffffff) * PAGE_SIZE;
+		page_id_t old_id;
+		thread_safe_page *pg = (thread_safe_page *) cache.search(
+				page_id_t(FILE_ID, off), old_id);
+		assert(pg);
+		pg->set_io_pending(false);
+		pg->set_data_ready(true);
 		pg->dec_ref();
+		added_offs.push_back(off);
 	}
+}
 
-	int ret;
-	ret = cache->expand(8 * 1024 * 1024 / 4096);
-	printf("expand %d pages\n", ret);
-	cache->sanity_check();
-	for (size_t i = 0; i < added_offs.size(); i++) {
-		page *pg = cache->search(added_offs[i]);
-		if (pg == NULL)
-			assert(evicted_offs.find(added_offs[i]) != evicted_offs.end());
-		else
+/*
+ * The pages that are still in the cache must have the right offsets.
+ */
+void check_pages(page_cache &cache, const std::vector<off_t> &added_offs)
+{
+	size_t num_found = 0;
+	std::set<off_t> offs(added_offs.begin(), added_offs.end());
+	for (auto it = offs.begin(); it != offs.end(); it++) {
+		page_id_t pg_id(FILE_ID, *it);
+		page *pg = cache.search(pg_id);
+		if (pg) {
+			assert(pg->get_offset() == *it);
 			pg->dec_ref();
+			num_found++;
+		}
 	}
+	assert((long) num_found <= cache.size() / PAGE_SIZE);
+	printf("%ld pages are in the cache of %ld pages\n", num_found,
+			cache.size() / PAGE_SIZE);
+}
 
-	for (int i = 0; i < 4096; i++) {
-		off_t off = (random() & 0xfffffff) * 4096;
-		added_offs.push_back(off);
-		off_t old_off = -1;
-		thread_safe_page *pg = (thread_safe_page *) cache->search(off, old_off);
-		if (old_off != -1)
-			evicted_offs.insert(old_off);
-		pg->dec_ref();
-	}
+void test_resize(long init_size, long new_size)
+{
+	printf("resize the cache from %ld to %ld\n", init_size, new_size);
+	page_cache::ptr cache = associative_cache::create(init_size,
+			MAX_CACHE_SIZE, 0, 1, 1);
+	assert(cache->size() == init_size);
+	std::vector<off_t> added_offs;
+	access_pages(*cache, init_size / PAGE_SIZE * 2, added_offs);
 
-	ret = cache->expand(16 * 1024 * 1024 / 4096);
-	printf("expand %d pages\n", ret);
+	long ret = cache->resize(new_size);
+	printf("the cache has %ld bytes after resizing\n", ret);
+	assert(ret == cache->size());
+	// Nothing is referenced or dirty, so we should be able to get
+	// the requested size.
+	assert(ret == new_size);
 	cache->sanity_check();
-	for (size_t i = 0; i < added_offs.size(); i++) {
-		page *pg = cache->search(added_offs[i]);
-		if (pg == NULL) {
-			if (evicted_offs.find(added_offs[i]) == evicted_offs.end())
-				fprintf(stderr, "can't find off %ld\n", added_offs[i]);
-			assert(evicted_offs.find(added_offs[i]) != evicted_offs.end());
-		}
-		else
-			pg->dec_ref();
-	}
+	check_pages(*cache, added_offs);
 
-	int num_shrink = 8 * 1024 * 1024 / 4096;
-	char *pages[num_shrink];
-	cache->shrink(num_shrink, pages);
+	access_pages(*cache, new_size / PAGE_SIZE * 2, added_offs);
+	cache->sanity_check();
+	check_pages(*cache, added_offs);
+}
+
+int main()
+{
+	long min_size = params.get_SA_min_cell_size() * PAGE_SIZE;
+	// Only change the number of pages in cells.
+	test_resize(min_size * 1024, min_size * 1024 + min_size * 256);
+	test_resize(min_size * 1024 + min_size * 256, min_size * 1024);
+	// The cell table has to expand and shrink.
+	test_resize(min_size * 1024, min_size * 1024 * 4);
+	test_resize(min_size * 1024 * 4, min_size * 1024);
+	// Shrink and grow the same cache.
+	page_cache::ptr cache = associative_cache::create(min_size * 1024,
+			MAX_CACHE_SIZE, 0, 1, 1);
+	std::vector<off_t> added_offs;
+	access_pages(*cache, 1024, added_offs);
+	assert(cache->resize(min_size * 1024 * 2) == min_size * 1024 * 2);
+	assert(cache->resize(min_size * 512) <= min_size * 1024);
+	assert(cache->resize(min_size * 1024 * 2) == min_size * 1024 * 2);
 	cache->sanity_check();
+	check_pages(*cache, added_offs);
+	cache->print_stat();
 }
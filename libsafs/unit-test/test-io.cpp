@@ -223,6 +223,38 @@ void test_remote_io(const std::string &data_file)
 	printf("remote I/O passed the test.\n");
 }
 
+//////////////////////////////// Test I/O select //////////////////////////////
+
+/*
+ * Nothing wakes up the owner thread when AIO requests complete, so
+ * the I/O select has to poll the AIO instance instead of sleeping.
+ */
+void test_aio_select(const std::string &data_file)
+{
+	file_io_factory::shared_ptr factory = create_io_factory(data_file,
+			AIO_ACCESS);
+	io_interface::ptr io = create_io(factory, thread::get_curr_thread());
+	io->set_callback(callback::ptr(new test_callback()));
+	assert(!io->can_sleep());
+	std::vector<io_interface::ptr> ios(1, io);
+	io_select::ptr select = create_io_select(ios);
+	assert(select);
+	for (int i = 0; i < 1000; i++) {
+		std::pair<off_t, size_t> p = get_rand_align_req();
+		data_loc_t loc(io->get_file_id(), p.first);
+		char *buf = NULL;
+		int ret = posix_memalign((void **) &buf, 512, p.second);
+		assert(ret == 0);
+		io_request req(buf, loc, p.second, READ);
+		io->access(&req, 1);
+		while (select->num_pending_ios() > 32)
+			select->wait4complete(1);
+	}
+	while (select->num_pending_ios() > 0)
+		select->wait4complete(select->num_pending_ios());
+	printf("AIO select passed the test.\n");
+}
+
 std::string prepare_file()
 {
 	std::string data_file_name = basename(tempnam(".", "test"));;
@@ -260,6 +292,7 @@ int main(int argc, char *argv[])
 	std::string data_file = prepare_file();
 	test_remote_io(data_file);
 	test_direct_comp(data_file);
+	test_aio_select(data_file);
 
 	safs_file f(get_sys_RAID_conf(), data_file);
 	f.delete_file();
@@ -104,6 +104,9 @@ int aio_ctx_impl::io_wait(struct timespec* to, int num)
     fprintf(stderr, "io_wait: %s\n", strerror(-ret));
     //exit(1);
   }
+  // There aren't completed requests if we poll without blocking.
+  if (n <= 0)
+    return ret;
 
   struct iocb *iocbs[n];
   long res[n];
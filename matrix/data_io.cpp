@@ -20,6 +20,11 @@
 #ifdef USE_GZIP
 #include <zlib.h>
 #endif
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include <sys/mman.h>
 
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
@@ -194,6 +199,184 @@ file_io::ptr gz_file_io::create(const std::string &file)
 	return ptr(new gz_file_io(f));
 }
 
+/*
+ * A gzip file in the BGZF format, which is created by bgzip, is
+ * a sequence of gzip members, each of which has at most 64KB of data and
+ * has its compressed size in the extra field of its header. The members
+ * can be decompressed independently, so multiple threads decompress and
+ * parse a large file in chunks of members.
+ */
+class bgzf_file
+{
+	struct block
+	{
+		off_t off;
+		uint32_t size;
+		uint32_t orig_size;
+	};
+
+	int fd;
+	std::string name;
+	std::vector<block> blocks;
+
+	bgzf_file(int fd, const std::string &name) {
+		this->fd = fd;
+		this->name = name;
+	}
+
+	static bool read_block_size(int fd, off_t off, uint32_t &size);
+public:
+	typedef std::shared_ptr<bgzf_file> ptr;
+
+	static bool is_bgzf(const std::string &file);
+	/*
+	 * It returns NULL if the file isn't in the BGZF format.
+	 */
+	static ptr open(const std::string &file);
+
+	~bgzf_file() {
+		close(fd);
+	}
+
+	size_t get_num_blocks() const {
+		return blocks.size();
+	}
+
+	size_t get_orig_size(size_t idx) const {
+		return blocks[idx].orig_size;
+	}
+
+	/*
+	 * Split the blocks into chunks of [start, end), each of which has
+	 * at least `chunk_size' bytes of data except the last one.
+	 */
+	std::vector<std::pair<size_t, size_t> > get_chunks(size_t chunk_size) const;
+	/*
+	 * Decompress a block and append the data to the buffer.
+	 */
+	void decompress(size_t idx, std::vector<char> &buf) const;
+};
+
+/*
+ * Read the size of the block at `off' from its header.
+ * It returns false if the block isn't a BGZF block.
+ */
+bool bgzf_file::read_block_size(int fd, off_t off, uint32_t &size)
+{
+	// ID1, ID2, CM, FLG, MTIME, XFL, OS and XLEN.
+	unsigned char header[12];
+	if (pread(fd, header, sizeof(header), off) != sizeof(header))
+		return false;
+	const int FEXTRA = 4;
+	if (header[0] != 31 || header[1] != 139 || header[2] != 8
+			|| (header[3] & FEXTRA) == 0)
+		return false;
+	size_t xlen = header[10] | (header[11] << 8);
+	std::vector<unsigned char> extra(xlen);
+	if (pread(fd, extra.data(), xlen, off + sizeof(header)) != (ssize_t) xlen)
+		return false;
+	// Look for the subfield `BC', which has the block size minus 1.
+	for (size_t i = 0; i + 4 <= xlen; ) {
+		size_t len = extra[i + 2] | (extra[i + 3] << 8);
+		if (extra[i] == 'B' && extra[i + 1] == 'C' && len == 2
+				&& i + 6 <= xlen) {
+			size = (extra[i + 4] | (extra[i + 5] << 8)) + 1;
+			return true;
+		}
+		i += 4 + len;
+	}
+	return false;
+}
+
+bool bgzf_file::is_bgzf(const std::string &file)
+{
+	int fd = ::open(file.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	uint32_t size;
+	bool ret = read_block_size(fd, 0, size);
+	close(fd);
+	return ret;
+}
+
+bgzf_file::ptr bgzf_file::open(const std::string &file)
+{
+	int fd = ::open(file.c_str(), O_RDONLY);
+	if (fd < 0) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("fail to open %1%: %2%") % file % strerror(errno);
+		return ptr();
+	}
+	ptr f(new bgzf_file(fd, file));
+	safs::native_file local_f(file);
+	off_t file_size = local_f.get_size();
+	for (off_t off = 0; off < file_size; ) {
+		block b;
+		b.off = off;
+		// The uncompressed size is in the last 4 bytes of the block.
+		unsigned char isize[4];
+		if (!read_block_size(fd, off, b.size) || off + b.size > file_size
+				|| pread(fd, isize, sizeof(isize), off + b.size - 4) != 4) {
+			if (off > 0)
+				BOOST_LOG_TRIVIAL(error) << boost::format(
+						"%1% has a block that isn't in the BGZF format") % file;
+			return ptr();
+		}
+		b.orig_size = isize[0] | (isize[1] << 8) | (isize[2] << 16)
+			| (isize[3] << 24);
+		f->blocks.push_back(b);
+		off += b.size;
+	}
+	return f;
+}
+
+std::vector<std::pair<size_t, size_t> > bgzf_file::get_chunks(
+		size_t chunk_size) const
+{
+	std::vector<std::pair<size_t, size_t> > chunks;
+	size_t start = 0;
+	size_t size = 0;
+	for (size_t i = 0; i < blocks.size(); i++) {
+		size += blocks[i].orig_size;
+		if (size >= chunk_size || i == blocks.size() - 1) {
+			chunks.push_back(std::pair<size_t, size_t>(start, i + 1));
+			start = i + 1;
+			size = 0;
+		}
+	}
+	return chunks;
+}
+
+void bgzf_file::decompress(size_t idx, std::vector<char> &buf) const
+{
+	const block &b = blocks[idx];
+	std::vector<char> in(b.size);
+	if (pread(fd, in.data(), b.size, b.off) != b.size) {
+		BOOST_LOG_TRIVIAL(fatal)
+			<< boost::format("fail to read %1%: %2%") % name % strerror(errno);
+		exit(1);
+	}
+	size_t buf_size = buf.size();
+	buf.resize(buf_size + b.orig_size);
+
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	// Decode the gzip header.
+	int ret = inflateInit2(&strm, 15 + 16);
+	assert(ret == Z_OK);
+	strm.next_in = (Bytef *) in.data();
+	strm.avail_in = in.size();
+	strm.next_out = (Bytef *) buf.data() + buf_size;
+	strm.avail_out = b.orig_size;
+	ret = inflate(&strm, Z_FINISH);
+	inflateEnd(&strm);
+	if (ret != Z_STREAM_END || strm.avail_out != 0) {
+		BOOST_LOG_TRIVIAL(fatal) << boost::format(
+				"fail to decompress a block at %1% in %2%") % b.off % name;
+		exit(1);
+	}
+}
+
 #endif
 
 file_io::ptr file_io::create(const std::string &file_name)
@@ -272,6 +455,26 @@ std::shared_ptr<char> text_file_io::read_lines(
 	return std::shared_ptr<char>(line_buf, del_off_ptr(addr));
 }
 
+size_t line_parser::parse_buf(const char *buf, size_t size,
+		data_frame &df) const
+{
+	const char *line_end;
+	const char *line = buf;
+	std::vector<std::string> lines;
+	while ((line_end = strchr(line, '\n'))) {
+		assert(line_end - buf <= (ssize_t) size);
+		size_t len = line_end - line;
+		if (len > 0 && *(line_end - 1) == '\r')
+			len--;
+		lines.push_back(std::string(line, len));
+		line = line_end + 1;
+	}
+	if (line - buf < (ssize_t) size)
+		lines.push_back(std::string(line));
+
+	return parse(lines, df);
+}
+
 /*
  * Parse the lines in the character buffer.
  * `size' doesn't include '\0'.
@@ -279,24 +482,7 @@ std::shared_ptr<char> text_file_io::read_lines(
 static size_t parse_lines(std::shared_ptr<char> line_buf, size_t size,
 		const line_parser &parser, data_frame &df)
 {
-	char *line_end;
-	char *line = line_buf.get();
-	char *buf_start = line_buf.get();
-	// TODO I need to be careful here. It potentially needs to allocate
-	// a lot of small pieces of memory.
-	std::vector<std::string> lines;
-	while ((line_end = strchr(line, '\n'))) {
-		assert(line_end - buf_start <= (ssize_t) size);
-		*line_end = 0;
-		if (*(line_end - 1) == '\r')
-			*(line_end - 1) = 0;
-		lines.push_back(std::string(line));
-		line = line_end + 1;
-	}
-	if (line - buf_start < (ssize_t) size)
-		lines.push_back(std::string(line));
-	
-	return parser.parse(lines, df);
+	return parser.parse_buf(line_buf.get(), size, df);
 }
 
 namespace
@@ -413,6 +599,75 @@ public:
 	}
 };
 
+#ifdef USE_GZIP
+/*
+ * This decompresses a chunk of blocks in a BGZF file and parses the lines
+ * that start in the chunk.
+ */
+class bgzf_parse_task: public thread_task
+{
+	bgzf_file::ptr file;
+	size_t start;
+	size_t end;
+	const line_parser &parser;
+	data_frame_set &dfs;
+public:
+	bgzf_parse_task(bgzf_file::ptr file, size_t start, size_t end,
+			const line_parser &_parser, data_frame_set &_dfs): parser(
+				_parser), dfs(_dfs) {
+		this->file = file;
+		this->start = start;
+		this->end = end;
+	}
+
+	void run();
+};
+
+void bgzf_parse_task::run()
+{
+	std::vector<char> buf;
+	// The first line belongs to the previous chunk unless the previous
+	// chunk ends with '\n'.
+	bool skip_first = false;
+	for (size_t i = start; i > 0; i--) {
+		if (file->get_orig_size(i - 1) > 0) {
+			file->decompress(i - 1, buf);
+			skip_first = buf.back() != '\n';
+			buf.clear();
+			break;
+		}
+	}
+	for (size_t i = start; i < end; i++)
+		file->decompress(i, buf);
+	size_t line_start = 0;
+	if (skip_first) {
+		char *nl = (char *) memchr(buf.data(), '\n', buf.size());
+		line_start = nl ? nl + 1 - buf.data() : buf.size();
+	}
+	// The last line may continue in the following blocks.
+	if (line_start < buf.size() && buf.back() != '\n') {
+		for (size_t i = end; i < file->get_num_blocks(); i++) {
+			size_t old_size = buf.size();
+			file->decompress(i, buf);
+			char *nl = (char *) memchr(buf.data() + old_size, '\n',
+					buf.size() - old_size);
+			if (nl) {
+				buf.resize(nl + 1 - buf.data());
+				break;
+			}
+		}
+	}
+	// The line buffer must end with '\0'.
+	buf.push_back(0);
+
+	data_frame::ptr df = create_data_frame(parser);
+	if (line_start < buf.size() - 1)
+		parser.parse_buf(buf.data() + line_start, buf.size() - 1 - line_start,
+				*df);
+	dfs.add(df);
+}
+#endif
+
 class file_parse_task: public thread_task
 {
 	file_io::ptr io;
@@ -439,6 +694,70 @@ void file_parse_task::run()
 	}
 }
 
+/*
+ * This creates the tasks that parse the input files. A file is parsed by
+ * a task, or by a task for each chunk if it's in the BGZF format.
+ */
+class parse_task_gen
+{
+	const std::vector<std::string> &files;
+	const line_parser &parser;
+	data_frame_set &dfs;
+	size_t file_idx;
+#ifdef USE_GZIP
+	bgzf_file::ptr bgzf;
+	std::vector<std::pair<size_t, size_t> > chunks;
+	size_t chunk_idx;
+#endif
+public:
+	parse_task_gen(const std::vector<std::string> &_files,
+			const line_parser &_parser, data_frame_set &_dfs): files(
+				_files), parser(_parser), dfs(_dfs) {
+		file_idx = 0;
+#ifdef USE_GZIP
+		chunk_idx = 0;
+#endif
+	}
+
+	/*
+	 * It returns NULL if all files have been parsed.
+	 */
+	thread_task *next();
+};
+
+thread_task *parse_task_gen::next()
+{
+#ifdef USE_GZIP
+	while (true) {
+		if (bgzf && chunk_idx < chunks.size()) {
+			std::pair<size_t, size_t> chunk = chunks[chunk_idx++];
+			return new bgzf_parse_task(bgzf, chunk.first, chunk.second,
+					parser, dfs);
+		}
+		bgzf = NULL;
+		if (file_idx == files.size())
+			return NULL;
+		if (!bgzf_file::is_bgzf(files[file_idx]))
+			break;
+		bgzf = bgzf_file::open(files[file_idx]);
+		// The file starts with a BGZF block, but we can't split it into
+		// blocks. It's still a gzip file, so a single task decompresses
+		// and parses the whole file.
+		if (bgzf == NULL) {
+			file_io::ptr io = gz_file_io::create(files[file_idx++]);
+			return new file_parse_task(io, parser, dfs);
+		}
+		file_idx++;
+		chunks = bgzf->get_chunks(LINE_BLOCK_SIZE);
+		chunk_idx = 0;
+	}
+#endif
+	if (file_idx == files.size())
+		return NULL;
+	file_io::ptr io = file_io::create(files[file_idx++]);
+	return new file_parse_task(io, parser, dfs);
+}
+
 }
 
 data_frame::ptr read_lines(const std::string &file, const line_parser &parser,
@@ -481,15 +800,15 @@ data_frame::ptr read_lines(const std::string &file, const line_parser &parser,
 data_frame::ptr read_lines(const std::vector<std::string> &files,
 		const line_parser &parser, bool in_mem)
 {
+#ifdef USE_GZIP
+	if (files.size() == 1 && !bgzf_file::is_bgzf(files[0]))
+#else
 	if (files.size() == 1)
+#endif
 		return read_lines(files[0], parser, in_mem);
 
-	data_frame::ptr df = data_frame::create();
 	// TODO should I make these NUMA vectors?
-	df->add_vec(parser.get_col_name(0),
-			detail::vec_store::create(0, parser.get_col_type(0), -1, in_mem));
-	df->add_vec(parser.get_col_name(1),
-			detail::vec_store::create(0, parser.get_col_type(1), -1, in_mem));
+	data_frame::ptr df = create_data_frame(parser, in_mem);
 
 	detail::mem_thread_pool::ptr mem_threads
 		= detail::mem_thread_pool::get_global_mem_threads();
@@ -501,16 +820,16 @@ data_frame::ptr read_lines(const std::vector<std::string> &files,
 	 * approach also parallelizes decompression.
 	 *
 	 * TODO it may not work so well if there are a small number of large
-	 * input files.
+	 * input files unless they are in the BGZF format, which are parsed
+	 * by multiple threads in chunks.
 	 */
-	auto file_it = files.begin();
-	while (file_it != files.end()) {
+	parse_task_gen tasks(files, parser, dfs);
+	thread_task *task = tasks.next();
+	while (task) {
 		size_t num_tasks = MAX_PENDING - mem_threads->get_num_pending();
-		for (size_t i = 0; i < num_tasks && file_it != files.end(); i++) {
-			file_io::ptr io = file_io::create(*file_it);
-			file_it++;
-			mem_threads->process_task(-1,
-					new file_parse_task(io, parser, dfs));
+		for (size_t i = 0; i < num_tasks && task; i++) {
+			mem_threads->process_task(-1, task);
+			task = tasks.next();
 		}
 		// This is the only thread that can fetch data frames from the queue.
 		// If there are pending tasks in the thread pool, it's guaranteed
@@ -540,6 +859,186 @@ data_frame::ptr read_lines(const std::vector<std::string> &files,
 	return df;
 }
 
+/*
+ * Find the first '\n' in [p, end). It returns `end' if there isn't one.
+ */
+static inline const char *find_newline(const char *p, const char *end)
+{
+#ifdef __x86_64__
+	const __m128i nl = _mm_set1_epi8('\n');
+	for (; p + 16 <= end; p += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *) p);
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+		if (mask)
+			return p + __builtin_ctz(mask);
+	}
+#endif
+	for (; p < end; p++)
+		if (*p == '\n')
+			return p;
+	return end;
+}
+
+static size_t count_newlines(const char *p, const char *end)
+{
+	size_t num = 0;
+#ifdef __x86_64__
+	const __m128i nl = _mm_set1_epi8('\n');
+	for (; p + 16 <= end; p += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *) p);
+		num += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+	}
+#endif
+	for (; p < end; p++)
+		num += *p == '\n';
+	return num;
+}
+
+static inline bool is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*
+ * Parse an unsigned integer at `p' and return the location behind it.
+ * The caller makes sure `p' points to a digit.
+ */
+static inline const char *parse_uint(const char *p, const char *end,
+		size_t &val)
+{
+	val = 0;
+	for (; p < end && isdigit(*p); p++)
+		val = val * 10 + (*p - '0');
+	return p;
+}
+
+template<class AttrType>
+AttrType parse_attr(const char *p, char **end);
+
+template<>
+int parse_attr<int>(const char *p, char **end)
+{
+	return strtol(p, end, 10);
+}
+
+template<>
+long parse_attr<long>(const char *p, char **end)
+{
+	return strtol(p, end, 10);
+}
+
+template<>
+float parse_attr<float>(const char *p, char **end)
+{
+	return strtof(p, end);
+}
+
+template<>
+double parse_attr<double>(const char *p, char **end)
+{
+	return strtod(p, end);
+}
+
+/*
+ * Parse the edges in the buffer directly to the columns without
+ * splitting the buffer into lines. `attrs' is NULL if the edges don't
+ * have attributes. It returns the number of edges.
+ */
+template<class AttrType>
+static size_t parse_edges(const char *buf, size_t size,
+		fg::vertex_id_t *froms, fg::vertex_id_t *tos, AttrType *attrs)
+{
+	const char *buf_end = buf + size;
+	size_t entry_idx = 0;
+	for (const char *line = buf; line < buf_end; ) {
+		const char *line_end = find_newline(line, buf_end);
+		const char *line_start = line;
+		const char *p = line;
+		line = line_end + 1;
+
+		for (; p < line_end && is_blank(*p); p++);
+		if (p == line_end || *p == '#')
+			continue;
+		// Make sure we get a number.
+		if (!isdigit(*p)) {
+			BOOST_LOG_TRIVIAL(error)
+				<< std::string("the first entry isn't a number: ")
+				+ std::string(p, line_end - p);
+			continue;
+		}
+		size_t from;
+		p = parse_uint(p, line_end, from);
+		assert(from < fg::MAX_VERTEX_ID);
+
+		for (; p < line_end && is_blank(*p); p++);
+		if (p == line_end) {
+			BOOST_LOG_TRIVIAL(error)
+				<< std::string("there isn't second entry: ")
+				+ std::string(line_start, line_end);
+			continue;
+		}
+		// Make sure we get a number.
+		if (!isdigit(*p)) {
+			BOOST_LOG_TRIVIAL(error)
+				<< std::string("the second entry isn't a number: ")
+				+ std::string(p, line_end - p);
+			continue;
+		}
+		size_t to;
+		p = parse_uint(p, line_end, to);
+		assert(to < fg::MAX_VERTEX_ID);
+
+		if (attrs) {
+			for (; p < line_end && is_blank(*p); p++);
+			if (p == line_end) {
+				BOOST_LOG_TRIVIAL(error)
+					<< std::string("there isn't third entry: ")
+					+ std::string(line_start, line_end);
+				continue;
+			}
+			char *attr_end;
+			attrs[entry_idx] = parse_attr<AttrType>(p, &attr_end);
+		}
+		froms[entry_idx] = from;
+		tos[entry_idx] = to;
+		entry_idx++;
+	}
+	return entry_idx;
+}
+
+/*
+ * Parse the edges in the buffer to the data frame. `AttrType' is ignored
+ * if the edges don't have attributes.
+ */
+template<class AttrType>
+static size_t parse_edges(const char *buf, size_t size, bool has_attr,
+		data_frame &df)
+{
+	// Each line has at most one edge.
+	size_t max_num_edges = count_newlines(buf, buf + size) + 1;
+	detail::smp_vec_store::ptr froms = detail::smp_vec_store::create(
+			max_num_edges, get_scalar_type<fg::vertex_id_t>());
+	detail::smp_vec_store::ptr tos = detail::smp_vec_store::create(
+			max_num_edges, get_scalar_type<fg::vertex_id_t>());
+	detail::smp_vec_store::ptr attrs;
+	if (has_attr)
+		attrs = detail::smp_vec_store::create(max_num_edges,
+				get_scalar_type<AttrType>());
+	size_t num_edges = parse_edges<AttrType>(buf, size,
+			(fg::vertex_id_t *) froms->get_raw_arr(),
+			(fg::vertex_id_t *) tos->get_raw_arr(),
+			attrs ? (AttrType *) attrs->get_raw_arr() : NULL);
+	froms->resize(num_edges);
+	tos->resize(num_edges);
+	df.get_vec(0)->append(*froms);
+	df.get_vec(1)->append(*tos);
+	if (attrs) {
+		attrs->resize(num_edges);
+		df.get_vec(2)->append(*attrs);
+	}
+	return num_edges;
+}
+
 /*
  * This class parses a line into an edge (source, destination).
  */
@@ -547,6 +1046,9 @@ class edge_parser: public line_parser
 {
 public:
 	size_t parse(const std::vector<std::string> &lines, data_frame &df) const;
+	size_t parse_buf(const char *buf, size_t size, data_frame &df) const {
+		return parse_edges<int>(buf, size, false, df);
+	}
 	size_t get_num_cols() const {
 		return 2;
 	}
@@ -625,6 +1127,9 @@ class attr_edge_parser: public line_parser
 {
 public:
 	size_t parse(const std::vector<std::string> &lines, data_frame &df) const;
+	size_t parse_buf(const char *buf, size_t size, data_frame &df) const {
+		return parse_edges<AttrType>(buf, size, true, df);
+	}
 	size_t get_num_cols() const {
 		return 3;
 	}
@@ -731,8 +1236,8 @@ size_t attr_edge_parser<AttrType>::parse(const std::vector<std::string> &lines,
 	return froms->get_length();
 }
 
-data_frame::ptr read_edge_list(const std::vector<std::string> &files,
-		bool in_mem, const std::string &edge_attr_type)
+static std::shared_ptr<line_parser> create_edge_parser(
+		const std::string &edge_attr_type)
 {
 	std::shared_ptr<line_parser> parser;
 	if (edge_attr_type.empty())
@@ -745,11 +1250,390 @@ data_frame::ptr read_edge_list(const std::vector<std::string> &files,
 		parser = std::shared_ptr<line_parser>(new attr_edge_parser<float>());
 	else if (edge_attr_type == "D")
 		parser = std::shared_ptr<line_parser>(new attr_edge_parser<double>());
-	else {
+	else
 		BOOST_LOG_TRIVIAL(error) << "unsupported edge attribute type";
+	return parser;
+}
+
+data_frame::ptr read_edge_list(const std::vector<std::string> &files,
+		bool in_mem, const std::string &edge_attr_type)
+{
+	std::shared_ptr<line_parser> parser = create_edge_parser(edge_attr_type);
+	if (parser == NULL)
 		return data_frame::ptr();
-	}
 	return read_lines(files, *parser, in_mem);
 }
 
+namespace
+{
+
+/*
+ * A binary edge list mapped to memory.
+ */
+class bin_edge_file
+{
+	int fd;
+	char *addr;
+	size_t size;
+
+	bin_edge_file(int fd, char *addr, size_t size) {
+		this->fd = fd;
+		this->addr = addr;
+		this->size = size;
+	}
+public:
+	typedef std::shared_ptr<bin_edge_file> ptr;
+
+	static ptr map(const std::string &file);
+
+	~bin_edge_file() {
+		if (size > 0)
+			munmap(addr, size);
+		close(fd);
+	}
+
+	const char *get_data() const {
+		return addr;
+	}
+
+	size_t get_size() const {
+		return size;
+	}
+};
+
+bin_edge_file::ptr bin_edge_file::map(const std::string &file)
+{
+	int fd = open(file.c_str(), O_RDONLY);
+	if (fd < 0) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("fail to open %1%: %2%") % file % strerror(errno);
+		return ptr();
+	}
+	safs::native_file local_f(file);
+	ssize_t size = local_f.get_size();
+	char *addr = NULL;
+	if (size > 0) {
+		addr = (char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) {
+			BOOST_LOG_TRIVIAL(error)
+				<< boost::format("fail to map %1%: %2%") % file % strerror(errno);
+			close(fd);
+			return ptr();
+		}
+		madvise(addr, size, MADV_SEQUENTIAL);
+	}
+	return ptr(new bin_edge_file(fd, addr, size));
+}
+
+/*
+ * Copy the records of edges to the columns of the source vertices,
+ * the destination vertices and the edge attributes.
+ * It returns false if a vertex ID is too large.
+ */
+template<class IdType>
+bool decode_edges(const char *recs, size_t num_edges, size_t attr_size,
+		fg::vertex_id_t *froms, fg::vertex_id_t *tos, char *attrs)
+{
+	const size_t rec_size = sizeof(IdType) * 2 + attr_size;
+	bool valid = true;
+	for (size_t i = 0; i < num_edges; i++) {
+		const char *rec = recs + i * rec_size;
+		IdType from, to;
+		memcpy(&from, rec, sizeof(from));
+		memcpy(&to, rec + sizeof(from), sizeof(to));
+		valid &= (from < fg::MAX_VERTEX_ID && to < fg::MAX_VERTEX_ID);
+		froms[i] = from;
+		tos[i] = to;
+		if (attr_size > 0)
+			memcpy(attrs + i * attr_size, rec + sizeof(from) * 2, attr_size);
+	}
+	return valid;
+}
+
+/*
+ * The opposite of decode_edges. It returns false if a vertex ID
+ * doesn't fit in IdType.
+ */
+template<class IdType>
+bool encode_edges(const fg::vertex_id_t *froms, const fg::vertex_id_t *tos,
+		const char *attrs, size_t num_edges, size_t attr_size, char *recs)
+{
+	const size_t rec_size = sizeof(IdType) * 2 + attr_size;
+	bool valid = true;
+	for (size_t i = 0; i < num_edges; i++) {
+		char *rec = recs + i * rec_size;
+		IdType from = froms[i];
+		IdType to = tos[i];
+		valid &= (from == froms[i] && to == tos[i]);
+		memcpy(rec, &from, sizeof(from));
+		memcpy(rec + sizeof(from), &to, sizeof(to));
+		if (attr_size > 0)
+			memcpy(rec + sizeof(from) * 2, attrs + i * attr_size, attr_size);
+	}
+	return valid;
+}
+
+static bool decode_edges(const char *recs, size_t num_edges, size_t id_size,
+		size_t attr_size, fg::vertex_id_t *froms, fg::vertex_id_t *tos,
+		char *attrs)
+{
+	if (id_size == sizeof(uint32_t))
+		return decode_edges<uint32_t>(recs, num_edges, attr_size, froms, tos,
+				attrs);
+	else
+		return decode_edges<uint64_t>(recs, num_edges, attr_size, froms, tos,
+				attrs);
+}
+
+static size_t get_attr_size(const line_parser &parser)
+{
+	// The third column has the edge attributes.
+	return parser.get_num_cols() > 2 ? parser.get_col_type(2).get_size() : 0;
+}
+
+class bin_decode_task: public thread_task
+{
+	// The records are in the mapped file.
+	bin_edge_file::ptr file;
+	const char *recs;
+	size_t num_edges;
+	size_t id_size;
+	size_t attr_size;
+	fg::vertex_id_t *froms;
+	fg::vertex_id_t *tos;
+	char *attrs;
+	std::atomic<bool> &valid;
+public:
+	bin_decode_task(bin_edge_file::ptr file, const char *recs,
+			size_t num_edges, size_t id_size, size_t attr_size,
+			fg::vertex_id_t *froms, fg::vertex_id_t *tos, char *attrs,
+			std::atomic<bool> &_valid): valid(_valid) {
+		this->file = file;
+		this->recs = recs;
+		this->num_edges = num_edges;
+		this->id_size = id_size;
+		this->attr_size = attr_size;
+		this->froms = froms;
+		this->tos = tos;
+		this->attrs = attrs;
+	}
+
+	void run() {
+		if (!decode_edges(recs, num_edges, id_size, attr_size, froms, tos,
+					attrs))
+			valid = false;
+	}
+};
+
+class bin_encode_task: public thread_task
+{
+	std::shared_ptr<char> lines;
+	size_t size;
+	const line_parser &parser;
+	size_t id_size;
+	int fd;
+	std::atomic<size_t> &out_off;
+	std::atomic<bool> &valid;
+public:
+	bin_encode_task(std::shared_ptr<char> _lines, size_t size,
+			const line_parser &_parser, size_t id_size, int fd,
+			std::atomic<size_t> &_out_off, std::atomic<bool> &_valid): parser(
+				_parser), out_off(_out_off), valid(_valid) {
+		this->lines = _lines;
+		this->size = size;
+		this->id_size = id_size;
+		this->fd = fd;
+	}
+
+	void run();
+};
+
+void bin_encode_task::run()
+{
+	data_frame::ptr df = create_data_frame(parser);
+	parse_lines(lines, size, parser, *df);
+	size_t num_edges = df->get_num_entries();
+	size_t attr_size = get_attr_size(parser);
+	std::vector<char> buf(num_edges * (id_size * 2 + attr_size));
+	const fg::vertex_id_t *froms = (const fg::vertex_id_t *)
+		detail::smp_vec_store::cast(df->get_vec(0))->get_raw_arr();
+	const fg::vertex_id_t *tos = (const fg::vertex_id_t *)
+		detail::smp_vec_store::cast(df->get_vec(1))->get_raw_arr();
+	const char *attrs = NULL;
+	if (attr_size > 0)
+		attrs = detail::smp_vec_store::cast(df->get_vec(2))->get_raw_arr();
+	bool ret;
+	if (id_size == sizeof(uint32_t))
+		ret = encode_edges<uint32_t>(froms, tos, attrs, num_edges, attr_size,
+				buf.data());
+	else
+		ret = encode_edges<uint64_t>(froms, tos, attrs, num_edges, attr_size,
+				buf.data());
+	if (!ret)
+		valid = false;
+
+	off_t off = out_off.fetch_add(buf.size());
+	const char *p = buf.data();
+	size_t remain = buf.size();
+	while (remain > 0) {
+		ssize_t write_ret = pwrite(fd, p, remain, off);
+		if (write_ret < 0) {
+			BOOST_LOG_TRIVIAL(fatal)
+				<< boost::format("fail to write the binary edge list: %1%")
+				% strerror(errno);
+			exit(1);
+		}
+		p += write_ret;
+		off += write_ret;
+		remain -= write_ret;
+	}
+}
+
+}
+
+data_frame::ptr read_bin_edge_list(const std::vector<std::string> &files,
+		bool in_mem, size_t id_size, const std::string &edge_attr_type)
+{
+	if (id_size != sizeof(uint32_t) && id_size != sizeof(uint64_t)) {
+		BOOST_LOG_TRIVIAL(error) << "vertex IDs have to be 4 or 8 bytes";
+		return data_frame::ptr();
+	}
+	// The parser only describes the columns.
+	std::shared_ptr<line_parser> parser = create_edge_parser(edge_attr_type);
+	if (parser == NULL)
+		return data_frame::ptr();
+	size_t attr_size = get_attr_size(*parser);
+	size_t rec_size = id_size * 2 + attr_size;
+
+	std::vector<bin_edge_file::ptr> bin_files;
+	size_t num_edges = 0;
+	for (size_t i = 0; i < files.size(); i++) {
+		bin_edge_file::ptr f = bin_edge_file::map(files[i]);
+		if (f == NULL)
+			return data_frame::ptr();
+		if (f->get_size() % rec_size != 0) {
+			BOOST_LOG_TRIVIAL(error)
+				<< boost::format("the size of %1% isn't a multiple of %2% bytes")
+				% files[i] % rec_size;
+			return data_frame::ptr();
+		}
+		num_edges += f->get_size() / rec_size;
+		bin_files.push_back(f);
+	}
+
+	/*
+	 * If the data frame is in memory, threads copy the records to
+	 * the columns directly. Otherwise, the records are copied to
+	 * a block of columns in memory first, which is appended to the columns
+	 * in external memory.
+	 */
+	std::vector<detail::vec_store::ptr> cols(parser->get_num_cols());
+	for (size_t i = 0; i < cols.size(); i++)
+		cols[i] = detail::vec_store::create(in_mem ? num_edges : 0,
+				parser->get_col_type(i), -1, in_mem);
+	detail::mem_thread_pool::ptr mem_threads
+		= detail::mem_thread_pool::get_global_mem_threads();
+	const size_t block_size = LINE_BLOCK_SIZE / rec_size;
+	std::atomic<bool> valid(true);
+	size_t col_off = 0;
+	for (size_t i = 0; i < bin_files.size(); i++) {
+		size_t file_edges = bin_files[i]->get_size() / rec_size;
+		for (size_t start = 0; start < file_edges; start += block_size) {
+			size_t num = std::min(block_size, file_edges - start);
+			const char *recs = bin_files[i]->get_data() + start * rec_size;
+			std::vector<detail::smp_vec_store::ptr> block(cols.size());
+			for (size_t j = 0; j < cols.size(); j++) {
+				if (in_mem)
+					block[j] = detail::smp_vec_store::cast(cols[j]);
+				else
+					block[j] = detail::smp_vec_store::create(num,
+							parser->get_col_type(j));
+			}
+			size_t block_off = in_mem ? col_off : 0;
+			fg::vertex_id_t *froms
+				= (fg::vertex_id_t *) block[0]->get_raw_arr() + block_off;
+			fg::vertex_id_t *tos
+				= (fg::vertex_id_t *) block[1]->get_raw_arr() + block_off;
+			char *attrs = attr_size > 0
+				? block[2]->get_raw_arr() + block_off * attr_size : NULL;
+			if (in_mem)
+				mem_threads->process_task(-1, new bin_decode_task(bin_files[i],
+							recs, num, id_size, attr_size, froms, tos, attrs,
+							valid));
+			else {
+				if (!decode_edges(recs, num, id_size, attr_size, froms, tos,
+							attrs))
+					valid = false;
+				for (size_t j = 0; j < cols.size(); j++)
+					cols[j]->append(*block[j]);
+			}
+			col_off += num;
+		}
+	}
+	if (in_mem)
+		mem_threads->wait4complete();
+	if (!valid) {
+		BOOST_LOG_TRIVIAL(error) << "some vertex IDs are too large";
+		return data_frame::ptr();
+	}
+
+	data_frame::ptr df = data_frame::create();
+	for (size_t i = 0; i < cols.size(); i++)
+		df->add_vec(parser->get_col_name(i), cols[i]);
+	return df;
+}
+
+size_t text2bin_edge_list(const std::vector<std::string> &files,
+		const std::string &out_file, size_t id_size,
+		const std::string &edge_attr_type)
+{
+	if (id_size != sizeof(uint32_t) && id_size != sizeof(uint64_t)) {
+		BOOST_LOG_TRIVIAL(error) << "vertex IDs have to be 4 or 8 bytes";
+		return 0;
+	}
+	std::shared_ptr<line_parser> parser = create_edge_parser(edge_attr_type);
+	if (parser == NULL)
+		return 0;
+	int fd = open(out_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+			S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (fd < 0) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("fail to open %1%: %2%") % out_file % strerror(errno);
+		return 0;
+	}
+
+	detail::mem_thread_pool::ptr mem_threads
+		= detail::mem_thread_pool::get_global_mem_threads();
+	const size_t MAX_PENDING = mem_threads->get_num_threads() * 3;
+	std::atomic<size_t> out_off(0);
+	std::atomic<bool> valid(true);
+	// Threads parse blocks of lines and write the edges to the location
+	// they reserve in the output file.
+	for (size_t i = 0; i < files.size(); i++) {
+		file_io::ptr io = file_io::create(files[i]);
+		if (io == NULL) {
+			mem_threads->wait4complete();
+			close(fd);
+			return 0;
+		}
+		while (!io->eof()) {
+			// Limit the memory used by the blocks of lines in the queue.
+			if (mem_threads->get_num_pending() >= MAX_PENDING)
+				mem_threads->wait4complete();
+			size_t size = 0;
+			std::shared_ptr<char> lines = io->read_lines(LINE_BLOCK_SIZE, size);
+			mem_threads->process_task(-1, new bin_encode_task(lines, size,
+						*parser, id_size, fd, out_off, valid));
+		}
+	}
+	mem_threads->wait4complete();
+	close(fd);
+	if (!valid) {
+		BOOST_LOG_TRIVIAL(error)
+			<< boost::format("some vertex IDs don't fit in %1% bytes") % id_size;
+		return 0;
+	}
+	return out_off / (id_size * 2 + get_attr_size(*parser));
+}
+
 }
@@ -41,6 +41,12 @@ class line_parser
 public:
 	virtual size_t parse(const std::vector<std::string> &lines,
 			data_frame &df) const = 0;
+	/*
+	 * Parse the lines in a buffer that ends with '\0'. `size' doesn't
+	 * include '\0'. By default, it splits the buffer into lines.
+	 */
+	virtual size_t parse_buf(const char *buf, size_t size,
+			data_frame &df) const;
 	virtual size_t get_num_cols() const = 0;
 	virtual const scalar_type &get_col_type(off_t idx) const = 0;
 	virtual std::string get_col_name(off_t idx) const = 0;
@@ -51,6 +57,27 @@ std::shared_ptr<data_frame> read_lines(const std::vector<std::string> &files,
 std::shared_ptr<data_frame> read_edge_list(const std::vector<std::string> &files,
 		bool in_mem, const std::string &attr_type);
 
+/*
+ * A binary edge list stores each edge in a packed record of the source
+ * vertex, the destination vertex and the edge attribute if the edges
+ * have attributes. The vertex IDs are 4-byte or 8-byte unsigned integers
+ * and all data is in the byte order of the machine.
+ *
+ * The binary edge lists are mapped to memory and the records are copied
+ * to the columns of the data frame without parsing.
+ */
+std::shared_ptr<data_frame> read_bin_edge_list(
+		const std::vector<std::string> &files, bool in_mem, size_t id_size,
+		const std::string &attr_type);
+/*
+ * Convert edge lists in the text format to a binary edge list.
+ * The edges in the binary edge list may be in a different order.
+ * It returns the number of edges.
+ */
+size_t text2bin_edge_list(const std::vector<std::string> &files,
+		const std::string &out_file, size_t id_size,
+		const std::string &attr_type);
+
 }
 
 #endif
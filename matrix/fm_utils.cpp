@@ -48,7 +48,7 @@ edge_list::ptr edge_list::create(data_frame::ptr df, bool directed)
 		assert(vec->get_type() == get_scalar_type<fg::vertex_id_t>());
 		max_vid = std::max(max_vid, vec->max<fg::vertex_id_t>());
 	}
-	printf("max id: %d\n", max_vid);
+	printf("max id: %ld\n", (size_t) max_vid);
 
 	detail::vec_store::ptr seq_vec = detail::create_seq_vec_store<fg::vertex_id_t>(
 			0, max_vid, 1);
@@ -529,8 +529,8 @@ static std::pair<fg::vertex_index::ptr, detail::vec_store::ptr> create_fg_direct
 				fg::ext_mem_undirected_vertex::vsize2num_edges(
 					out_adjs->get_length(i), edge_data_size));
 	}
-	printf("#out edges: %d, #in edges: %ld\n",
-			vector::create(num_out_edges)->sum<fg::vsize_t>(), num_edges);
+	printf("#out edges: %ld, #in edges: %ld\n",
+			(size_t) vector::create(num_out_edges)->sum<fg::vsize_t>(), num_edges);
 	assert(vector::create(num_out_edges)->sum<fg::vsize_t>() == num_edges);
 	gettimeofday(&end, NULL);
 	printf("It takes %.3f seconds to get #out-edges\n", time_diff(start, end));
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2014 Open Connectome Project (http://openconnecto.me)
+ * Written by Da Zheng (zhengda1936@gmail.com)
+ *
+ * This file is part of FlashMatrix.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * This converts edge lists in the text format to a binary edge list,
+ * which `el2fg -b' loads without parsing.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <vector>
+#include <string>
+
+#include "common.h"
+
+#include "native_file.h"
+
+#include "data_io.h"
+#include "sparse_matrix.h"
+
+using namespace fm;
+
+void print_usage()
+{
+	fprintf(stderr, "convert edge lists in text to a binary edge list\n");
+	fprintf(stderr, "el2bin [options] conf_file edge_file bin_file\n");
+	fprintf(stderr, "-i size: the size of vertex IDs in bytes, 4 or 8 (default: 4)\n");
+	fprintf(stderr, "-t type: the edge attribute type\n");
+}
+
+int main(int argc, char *argv[])
+{
+	size_t id_size = 4;
+	int opt;
+	int num_opts = 0;
+	std::string edge_attr_type;
+	while ((opt = getopt(argc, argv, "i:t:")) != -1) {
+		num_opts++;
+		switch (opt) {
+			case 'i':
+				id_size = atoi(optarg);
+				num_opts++;
+				break;
+			case 't':
+				edge_attr_type = optarg;
+				num_opts++;
+				break;
+			default:
+				print_usage();
+				exit(1);
+		}
+	}
+
+	argv += 1 + num_opts;
+	argc -= 1 + num_opts;
+	if (argc < 3) {
+		print_usage();
+		exit(1);
+	}
+
+	std::string conf_file = argv[0];
+	std::string file_name = argv[1];
+	std::string bin_file = argv[2];
+
+	std::vector<std::string> files;
+	safs::native_file f(file_name);
+	if (f.exist() && !f.is_dir())
+		files.push_back(file_name);
+	else if (f.exist() && f.is_dir()) {
+		safs::native_dir d(file_name);
+		d.read_all_files(files);
+		for (size_t i = 0; i < files.size(); i++)
+			files[i] = file_name + "/" + files[i];
+	}
+	else {
+		fprintf(stderr, "The input file %s doesn't exist\n", file_name.c_str());
+		return -1;
+	}
+	printf("read edges from %ld files\n", files.size());
+
+	config_map::ptr configs = config_map::create(conf_file);
+	init_flash_matrix(configs);
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+	size_t num_edges = text2bin_edge_list(files, bin_file, id_size,
+			edge_attr_type);
+	gettimeofday(&end, NULL);
+	destroy_flash_matrix();
+	if (num_edges == 0) {
+		fprintf(stderr, "can't convert the edge lists\n");
+		return -1;
+	}
+	printf("It takes %.3f seconds to convert %ld edges\n",
+			time_diff(start, end), num_edges);
+	return 0;
+}
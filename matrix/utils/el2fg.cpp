@@ -54,6 +54,7 @@ void print_usage()
 	fprintf(stderr, "-s size: sort buffer size\n");
 	fprintf(stderr, "-g size: groupby buffer size\n");
 	fprintf(stderr, "-t type: the edge attribute type\n");
+	fprintf(stderr, "-b size: binary edge lists with vertex IDs of the size in bytes\n");
 }
 
 int main(int argc, char *argv[])
@@ -66,7 +67,8 @@ int main(int argc, char *argv[])
 	int opt;
 	int num_opts = 0;
 	std::string edge_attr_type;
-	while ((opt = getopt(argc, argv, "uUes:g:t:")) != -1) {
+	size_t bin_id_size = 0;
+	while ((opt = getopt(argc, argv, "uUes:g:t:b:")) != -1) {
 		num_opts++;
 		switch (opt) {
 			case 'u':
@@ -90,6 +92,10 @@ int main(int argc, char *argv[])
 				edge_attr_type = optarg;
 				num_opts++;
 				break;
+			case 'b':
+				bin_id_size = atoi(optarg);
+				num_opts++;
+				break;
 			default:
 				print_usage();
 				exit(1);
@@ -142,8 +148,15 @@ int main(int argc, char *argv[])
 		 */
 		printf("start to read and parse edge list\n");
 		gettimeofday(&start, NULL);
-		data_frame::ptr df = read_edge_list(files, in_mem, edge_attr_type);
-		assert(df);
+		data_frame::ptr df;
+		if (bin_id_size > 0)
+			df = read_bin_edge_list(files, in_mem, bin_id_size, edge_attr_type);
+		else
+			df = read_edge_list(files, in_mem, edge_attr_type);
+		if (df == NULL) {
+			fprintf(stderr, "can't read the edge lists\n");
+			exit(1);
+		}
 		gettimeofday(&end, NULL);
 		printf("It takes %.3f seconds to parse the edge lists\n",
 				time_diff(start, end));
@@ -522,6 +522,26 @@ void comm_rename(int argc, char *argv[])
 				new_name.c_str());
 }
 
+void comm_checksum(int argc, char *argv[])
+{
+	if (argc < 1) {
+		fprintf(stderr, "checksum file_name\n");
+		return;
+	}
+
+	init_io_system(configs, false);
+	std::string file_name = argv[0];
+	safs_file f(get_sys_RAID_conf(), file_name);
+	if (!f.exist()) {
+		fprintf(stderr, "%s doesn't exist in SAFS\n", file_name.c_str());
+		return;
+	}
+
+	bool ret = f.create_checksums();
+	if (!ret)
+		fprintf(stderr, "can't compute checksums for %s\n", file_name.c_str());
+}
+
 typedef void (*command_func_t)(int argc, char *argv[]);
 
 struct command
@@ -551,6 +571,8 @@ struct command commands[] = {
 		"info file_name: show the information of an SAFS file"},
 	{"rename", comm_rename,
 		"rename file_name new_name: rename an SAFS file"},
+	{"checksum", comm_checksum,
+		"checksum file_name: compute the checksums of the pages in an SAFS file"},
 };
 
 int get_num_commands()